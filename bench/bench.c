@@ -0,0 +1,492 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "memoria.h"
+#include "entrada.h"
+#include "lexico.h"
+#include "balanceamento.h"
+#include "sintatico.h"
+#include "semantico.h"
+#include "diagnostico.h"
+#include "lote.h"
+#include "gerador.h"
+
+/* --- Medições do Front-end --- */
+
+/* Cada medição repete a fase até somar BENCH_MIN_SECONDS e BENCH_MIN_RUNS
+ * execuções, e fica com a mais rápida: é a que menos sofre com ruído. */
+#define BENCH_MIN_SECONDS 0.5
+#define BENCH_MIN_RUNS 3
+#define BENCH_PADDING 64
+#define BENCH_DEFAULT_TOLERANCE 20.0
+#define BENCH_MAX_METRICS 64
+
+/* As medições usam entradas muito maiores que o orçamento de uma
+ * compilação: o limite só existe para não estourar. */
+#define BENCH_BUDGET (1L << 40)
+
+typedef struct {
+    char name[64];
+    double value;
+} Metric;
+
+typedef struct {
+    const char* content;
+    long length;
+    const char* path;       /* cópia em disco, para a leitura */
+    int* words;             /* (offset, tamanho) das palavras do texto */
+    long word_count;
+    long tokens;
+    Metric metrics[BENCH_MAX_METRICS];
+    int metric_count;
+} Bench;
+
+/* Resultado de uma execução de uma fase. */
+typedef struct {
+    long units;             /* tokens, palavras ou bytes processados */
+    long allocations;
+    long peak;
+} RunResult;
+
+typedef RunResult (*BenchPhase)(Bench* bench);
+
+/* Impede que o compilador descarte as chamadas a is_keyword. */
+static volatile long keyword_sink;
+
+static void add_metric(Bench* bench, const char* phase, const char* metric, double value) {
+    if (bench->metric_count == BENCH_MAX_METRICS) return;
+    Metric* m = &bench->metrics[bench->metric_count++];
+    snprintf(m->name, sizeof(m->name), "%s.%s", phase, metric);
+    m->value = value;
+}
+
+static void bench_memory(MemoryContext* memory) {
+    memory_context_init(memory);
+    memory->budget = BENCH_BUDGET;
+}
+
+/* --- Fases --- */
+
+static RunResult run_lexer(Bench* bench) {
+    MemoryContext memory;
+    Arena arena;
+    bench_memory(&memory);
+    arena_init(&arena, &memory);
+    LexerContext lexer;
+    lexer_init(&lexer, bench->content, &arena);
+    long tokens = 0;
+    Token token;
+    do {
+        token = get_next_token(&lexer);
+        tokens++;
+    } while (token.type != TOKEN_EOF && token.type != TOKEN_ERRO);
+    arena_destroy(&arena);
+    RunResult result = { tokens, memory.allocations, memory.max_used };
+    return result;
+}
+
+static RunResult run_balance(Bench* bench) {
+    MemoryContext memory;
+    Arena arena;
+    bench_memory(&memory);
+    arena_init(&arena, &memory);
+    BalanceState balance;
+    balance_init(&balance, &arena);
+    check_balance(&balance, bench->content);
+    arena_destroy(&arena);
+    RunResult result = { bench->length, memory.allocations, memory.max_used };
+    return result;
+}
+
+static RunResult run_keywords(Bench* bench) {
+    long found = 0;
+    for (long i = 0; i < bench->word_count; i++) {
+        found += is_keyword(bench->content + bench->words[2 * i], bench->words[2 * i + 1]) != 0;
+    }
+    keyword_sink = found;
+    RunResult result = { bench->word_count, 0, 0 };
+    return result;
+}
+
+static RunResult run_read(Bench* bench) {
+    MemoryContext memory;
+    Arena arena;
+    bench_memory(&memory);
+    arena_init(&arena, &memory);
+    long length = 0;
+    if (read_file_content(bench->path, &arena, &length) == NULL) {
+        length = 0;
+    }
+    arena_destroy(&arena);
+    RunResult result = { length, memory.allocations, memory.max_used };
+    return result;
+}
+
+/* Lexer, parser e árvore: como em --sintatico, sem imprimir a árvore. */
+static RunResult run_parser(Bench* bench) {
+    MemoryContext memory;
+    Arena lexer_arena;
+    Arena ast_arena;
+    Arena node_arena;
+    bench_memory(&memory);
+    arena_init(&lexer_arena, &memory);
+    arena_init(&ast_arena, &memory);
+    arena_init(&node_arena, &memory);
+    LexerContext lexer;
+    lexer_init(&lexer, bench->content, &lexer_arena);
+    Interner interner;
+    interner_init(&interner, &ast_arena);
+    Ast ast;
+    ast_init(&ast, bench->content, &interner, &ast_arena, &node_arena);
+    Parser parser;
+    if (!parse_program(&parser, &lexer, &ast)) {
+        printf("Erro na linha %d: %s\n", parser.error_line, parser.error_msg);
+    }
+    arena_destroy(&lexer_arena);
+    arena_destroy(&ast_arena);
+    arena_destroy(&node_arena);
+    RunResult result = { bench->tokens, memory.allocations, memory.max_used };
+    return result;
+}
+
+/* Todo o front-end, até a verificação semântica. */
+static RunResult run_semantic(Bench* bench) {
+    MemoryContext memory;
+    Arena lexer_arena;
+    Arena ast_arena;
+    Arena node_arena;
+    bench_memory(&memory);
+    arena_init(&lexer_arena, &memory);
+    arena_init(&ast_arena, &memory);
+    arena_init(&node_arena, &memory);
+    LexerContext lexer;
+    lexer_init(&lexer, bench->content, &lexer_arena);
+    Interner interner;
+    interner_init(&interner, &ast_arena);
+    Ast ast;
+    ast_init(&ast, bench->content, &interner, &ast_arena, &node_arena);
+    Parser parser;
+    if (parse_program(&parser, &lexer, &ast)) {
+        arena_reset(&lexer_arena);
+        Diagnostics diagnostics;
+        diagnostics_init(&diagnostics, &lexer_arena);
+        check_program(&ast, &diagnostics, &lexer_arena);
+    }
+    arena_destroy(&lexer_arena);
+    arena_destroy(&ast_arena);
+    arena_destroy(&node_arena);
+    RunResult result = { bench->tokens, memory.allocations, memory.max_used };
+    return result;
+}
+
+/* --- Execução e Relatório --- */
+
+/* Roda a fase e registra as métricas dela. unit é o nome da unidade de
+ * RunResult.units ("tokens", "palavras"); com NULL, são bytes. */
+static void measure(Bench* bench, const char* name, BenchPhase phase, const char* unit) {
+    double best = -1.0;
+    double total = 0.0;
+    RunResult result = { 0, 0, 0 };
+    for (int runs = 0; runs < BENCH_MIN_RUNS || total < BENCH_MIN_SECONDS; runs++) {
+        double start = monotonic_seconds();
+        result = phase(bench);
+        double elapsed = monotonic_seconds() - start;
+        total += elapsed;
+        if (best < 0.0 || elapsed < best) best = elapsed;
+    }
+    if (best <= 0.0) best = 1e-9;
+
+    double mb_s = bench->length / best / (1024.0 * 1024.0);
+    printf("%-12s %10.3f ms", name, best * 1000.0);
+    if (unit == NULL) {
+        mb_s = result.units / best / (1024.0 * 1024.0);
+        printf("  %10.1f MB/s", mb_s);
+        add_metric(bench, name, "mb_s", mb_s);
+    } else {
+        double per_second = result.units / best;
+        if (strcmp(unit, "tokens") == 0) {
+            printf("  %10.1f MB/s", mb_s);
+            add_metric(bench, name, "mb_s", mb_s);
+        }
+        printf("  %12.0f %s/s", per_second, unit);
+        char metric[32];
+        snprintf(metric, sizeof(metric), "%s_s", unit);
+        add_metric(bench, name, metric, per_second);
+    }
+    if (bench->tokens > 0 && result.allocations > 0) {
+        double per_token = (double)result.allocations / bench->tokens;
+        printf("  %.3g aloc/token", per_token);
+        add_metric(bench, name, "alocacoes_token", per_token);
+    }
+    if (result.peak > 0) {
+        printf("  %ld bytes no pico", result.peak);
+        add_metric(bench, name, "memoria_max", (double)result.peak);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+/* Posições das palavras (letras seguidas) do conteúdo: palavras
+ * reservadas, nomes sem prefixo e palavras dos textos. */
+static void collect_words(Bench* bench, Arena* arena) {
+    long capacity = bench->length / 4 + 1;
+    bench->words = (int*)arena_alloc(arena, capacity * 2 * sizeof(int));
+    bench->word_count = 0;
+    const char* s = bench->content;
+    for (long i = 0; i < bench->length && bench->word_count < capacity;) {
+        if (!isalpha((unsigned char)s[i]) || (i > 0 && (isalnum((unsigned char)s[i - 1]) || s[i - 1] == '_' || s[i - 1] == '!'))) {
+            i++;
+            continue;
+        }
+        long start = i;
+        while (i < bench->length && isalnum((unsigned char)s[i])) i++;
+        bench->words[2 * bench->word_count] = (int)start;
+        bench->words[2 * bench->word_count + 1] = (int)(i - start);
+        bench->word_count++;
+    }
+}
+
+/* --- Linha de Base --- */
+
+/* Uma métrica por linha ("nome valor"), depois de um cabeçalho com a
+ * entrada usada: só faz sentido comparar medições da mesma entrada. */
+static void header_line(const GenOptions* options, char* out, size_t size) {
+    snprintf(out, size, "# entrada tamanho=%ld perfil=%s semente=%llu",
+             options->size, gen_profile_name(options->profile),
+             (unsigned long long)options->seed);
+}
+
+static int save_baseline(const Bench* bench, const GenOptions* options, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        printf("Erro ao criar o arquivo %s\n", path);
+        return 1;
+    }
+    char header[160];
+    header_line(options, header, sizeof(header));
+    fprintf(out, "%s\n", header);
+    for (int i = 0; i < bench->metric_count; i++) {
+        fprintf(out, "%s %.9g\n", bench->metrics[i].name, bench->metrics[i].value);
+    }
+    fclose(out);
+    printf("Linha de base gravada em %s.\n", path);
+    return 0;
+}
+
+/* Vazões (métricas terminadas em _s) não podem cair, e memória e
+ * alocações não podem subir, mais que tolerance por cento. Retorna o
+ * número de regressões, ou -1 se a base não puder ser usada. */
+static int compare_baseline(const Bench* bench, const GenOptions* options, const char* path, double tolerance) {
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        printf("Erro ao abrir o arquivo %s\n", path);
+        return -1;
+    }
+    char line[256];
+    char header[160];
+    header_line(options, header, sizeof(header));
+    if (fgets(line, sizeof(line), in) == NULL || strncmp(line, header, strlen(header)) != 0) {
+        printf("A linha de base %s foi medida com outra entrada.\n", path);
+        fclose(in);
+        return -1;
+    }
+
+    printf("\nComparação com %s (tolerância %.1f%%):\n", path, tolerance);
+    int regressions = 0;
+    char name[64];
+    double base;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (sscanf(line, "%63s %lf", name, &base) != 2) continue;
+        const Metric* current = NULL;
+        for (int i = 0; i < bench->metric_count; i++) {
+            if (strcmp(bench->metrics[i].name, name) == 0) current = &bench->metrics[i];
+        }
+        if (current == NULL) {
+            printf("  %-28s ausente na medição atual\n", name);
+            continue;
+        }
+        size_t length = strlen(name);
+        int higher_is_better = length > 2 && strcmp(name + length - 2, "_s") == 0;
+        double change = base != 0.0 ? (current->value - base) / base * 100.0 : 0.0;
+        int worse = higher_is_better ? change < -tolerance : change > tolerance;
+        printf("  %-28s %14.6g -> %14.6g  %+7.1f%%%s\n", name, base, current->value, change,
+               worse ? "  REGRESSÃO" : "");
+        regressions += worse;
+    }
+    fclose(in);
+    if (regressions > 0) {
+        printf("Reprovado: %d regressão(ões).\n", regressions);
+    } else {
+        printf("Aprovado.\n");
+    }
+    return regressions;
+}
+
+/* --- Comandos --- */
+
+static void usage(void) {
+    printf("Uso:\n");
+    printf("  bench gerar [--tamanho=TAM] [--perfil=P] [--semente=N] [--erros=N] arquivo\n");
+    printf("  bench medir [--tamanho=TAM] [--perfil=P] [--semente=N] [--base=ARQ]\n");
+    printf("              [--gravar-base=ARQ] [--tolerancia=PCT]\n");
+    printf("TAM aceita K, M e G (64K, 16M). Perfis:");
+    for (int i = 0; i < NUM_PERFIS; i++) {
+        printf(" %s", gen_profile_name((GenProfile)i));
+    }
+    printf(".\n");
+}
+
+static const char* option_value(const char* arg, const char* name) {
+    size_t length = strlen(name);
+    return strncmp(arg, name, length) == 0 && arg[length] == '=' ? arg + length + 1 : NULL;
+}
+
+/* Lê as opções do gerador; as demais ficam para o comando. Retorna -1 se
+ * alguma for inválida. */
+static int parse_generator_option(const char* arg, GenOptions* options) {
+    const char* value;
+    if ((value = option_value(arg, "--tamanho")) != NULL) {
+        options->size = gen_parse_size(value);
+        if (options->size < 1024) {
+            printf("Tamanho inválido: %s (mínimo 1K)\n", value);
+            return -1;
+        }
+    } else if ((value = option_value(arg, "--perfil")) != NULL) {
+        if (gen_profile_from_string(value, &options->profile) != 0) {
+            printf("Perfil desconhecido: %s\n", value);
+            return -1;
+        }
+    } else if ((value = option_value(arg, "--semente")) != NULL) {
+        options->seed = strtoull(value, NULL, 10);
+    } else if ((value = option_value(arg, "--erros")) != NULL) {
+        options->errors = atoi(value);
+        if (options->errors < 0) options->errors = 0;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static int command_generate(int argc, char** argv, GenOptions* options) {
+    const char* path = NULL;
+    for (int i = 2; i < argc; i++) {
+        int parsed = parse_generator_option(argv[i], options);
+        if (parsed < 0) return 1;
+        if (parsed == 0) path = argv[i];
+    }
+    if (path == NULL) {
+        usage();
+        return 1;
+    }
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        printf("Erro ao criar o arquivo %s\n", path);
+        return 1;
+    }
+    long written = generate_program(out, options);
+    fclose(out);
+    printf("%s: %ld bytes, perfil %s, semente %llu, %d erro(s).\n", path, written,
+           gen_profile_name(options->profile), (unsigned long long)options->seed, options->errors);
+    return 0;
+}
+
+static int command_measure(int argc, char** argv, GenOptions* options) {
+    const char* baseline = NULL;
+    const char* record = NULL;
+    double tolerance = BENCH_DEFAULT_TOLERANCE;
+    for (int i = 2; i < argc; i++) {
+        int parsed = parse_generator_option(argv[i], options);
+        const char* value;
+        if (parsed < 0) return 1;
+        if (parsed > 0) continue;
+        if ((value = option_value(argv[i], "--base")) != NULL) {
+            baseline = value;
+        } else if ((value = option_value(argv[i], "--gravar-base")) != NULL) {
+            record = value;
+        } else if ((value = option_value(argv[i], "--tolerancia")) != NULL) {
+            tolerance = atof(value);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (options->errors > 0) {
+        printf("As medições usam programas sem erros; --erros é só para gerar.\n");
+        return 1;
+    }
+
+    /* A entrada é gerada em memória, com os zeros de folga que os núcleos
+     * de varredura esperam, e copiada para um arquivo temporário usado
+     * pela medição da leitura. */
+    MemoryContext memory;
+    Arena arena;
+    bench_memory(&memory);
+    arena_init(&arena, &memory);
+    char* generated = NULL;
+    size_t generated_size = 0;
+    FILE* stream = open_memstream(&generated, &generated_size);
+    if (stream == NULL) {
+        printf("Erro ao gerar a entrada\n");
+        return 1;
+    }
+    generate_program(stream, options);
+    fclose(stream);
+
+    Bench bench;
+    memset(&bench, 0, sizeof(bench));
+    char* content = (char*)arena_alloc(&arena, generated_size + BENCH_PADDING);
+    memcpy(content, generated, generated_size);
+    memset(content + generated_size, 0, BENCH_PADDING);
+    free(generated);
+    bench.content = content;
+    bench.length = (long)generated_size;
+
+    char path[] = "/tmp/bench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, content, generated_size) != (ssize_t)generated_size) {
+        printf("Erro ao criar o arquivo temporário\n");
+        if (fd >= 0) close(fd);
+        arena_destroy(&arena);
+        return 1;
+    }
+    close(fd);
+    bench.path = path;
+
+    collect_words(&bench, &arena);
+    bench.tokens = run_lexer(&bench).units;
+
+    printf("Entrada: %ld bytes, %ld tokens, perfil %s, semente %llu.\n\n", bench.length, bench.tokens,
+           gen_profile_name(options->profile), (unsigned long long)options->seed);
+    measure(&bench, "lexer", run_lexer, "tokens");
+    measure(&bench, "balanco", run_balance, NULL);
+    measure(&bench, "palavras", run_keywords, "palavras");
+    measure(&bench, "leitura", run_read, NULL);
+    measure(&bench, "sintatico", run_parser, "tokens");
+    measure(&bench, "semantico", run_semantic, "tokens");
+    unlink(path);
+
+    int status = 0;
+    if (record != NULL) {
+        status = save_baseline(&bench, options, record);
+    }
+    if (baseline != NULL) {
+        status = compare_baseline(&bench, options, baseline, tolerance) != 0;
+    }
+    arena_destroy(&arena);
+    return status;
+}
+
+int main(int argc, char** argv) {
+    GenOptions options = { 16L * 1024 * 1024, PERFIL_MISTO, 1, 0 };
+    if (argc >= 2 && strcmp(argv[1], "gerar") == 0) {
+        options.size = 64L * 1024;
+        return command_generate(argc, argv, &options);
+    }
+    if (argc >= 2 && strcmp(argv[1], "medir") == 0) {
+        return command_measure(argc, argv, &options);
+    }
+    usage();
+    return 1;
+}
@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "gerador.h"
+
+/* Os programas usam só o que as análises aceitam sem erro: variáveis
+ * inteiras declaradas no início de cada função, funções com dois
+ * parâmetros inteiros e um retorno, chamadas só a funções anteriores. */
+
+typedef enum {
+    CMD_ATRIBUICAO, CMD_SE, CMD_PARA, CMD_ESCREVA, CMD_CHAMADA, CMD_INCREMENTO,
+    NUM_COMANDOS
+} GenStatement;
+
+/* Peso de cada comando em cada perfil. */
+static const int statement_weights[NUM_PERFIS][NUM_COMANDOS] = {
+    /*                      atrib  se  para  escreva  chamada  incr */
+    [PERFIL_MISTO]        = {  4,   2,   2,     2,       2,      1 },
+    [PERFIL_FUNCOES]      = {  1,   0,   0,     1,       6,      0 },
+    [PERFIL_CONDICIONAIS] = {  1,   8,   0,     1,       0,      0 },
+    [PERFIL_LACOS]        = {  1,   0,   8,     1,       0,      1 },
+    [PERFIL_TEXTOS]       = {  1,   0,   0,     8,       0,      0 },
+    [PERFIL_OPERADORES]   = {  8,   1,   0,     0,       1,      2 },
+};
+
+static const char* const profile_names[NUM_PERFIS] = {
+    [PERFIL_MISTO] = "misto",
+    [PERFIL_FUNCOES] = "funcoes",
+    [PERFIL_CONDICIONAIS] = "condicionais",
+    [PERFIL_LACOS] = "lacos",
+    [PERFIL_TEXTOS] = "textos",
+    [PERFIL_OPERADORES] = "operadores",
+};
+
+static const char* const words[] = {
+    "valor", "resultado", "soma", "total", "linha", "coluna", "maior", "menor",
+    "entrada", "saida", "contador", "media", "indice", "passo", "limite", "teste",
+};
+
+#define GEN_MAX_DEPTH 3
+#define GEN_MAX_LOCALS 6
+
+typedef struct {
+    FILE* out;
+    long written;
+    uint64_t state;
+    const GenOptions* options;
+    long next_error;
+    int errors_left;
+    int functions;
+    int locals;
+    int depth;
+} Generator;
+
+const char* gen_profile_name(GenProfile profile) {
+    return profile >= 0 && profile < NUM_PERFIS ? profile_names[profile] : NULL;
+}
+
+int gen_profile_from_string(const char* name, GenProfile* profile) {
+    for (int i = 0; i < NUM_PERFIS; i++) {
+        if (strcmp(name, profile_names[i]) == 0) {
+            *profile = (GenProfile)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+long gen_parse_size(const char* text) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    if (end == text || value <= 0) return -1;
+    switch (*end) {
+        case '\0': return value;
+        case 'K': case 'k': value *= 1024L; break;
+        case 'M': case 'm': value *= 1024L * 1024L; break;
+        case 'G': case 'g': value *= 1024L * 1024L * 1024L; break;
+        default: return -1;
+    }
+    return end[1] == '\0' ? value : -1;
+}
+
+/* --- Escrita --- */
+
+/* xorshift64*: determinístico e igual em qualquer plataforma. */
+static uint64_t next_random(Generator* gen) {
+    gen->state ^= gen->state >> 12;
+    gen->state ^= gen->state << 25;
+    gen->state ^= gen->state >> 27;
+    return gen->state * 0x2545F4914F6CDD1DULL;
+}
+
+static int pick(Generator* gen, int count) {
+    return (int)((next_random(gen) >> 33) % (uint64_t)count);
+}
+
+static void emit(Generator* gen, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vfprintf(gen->out, format, args);
+    va_end(args);
+    if (length > 0) gen->written += length;
+}
+
+static void indent(Generator* gen) {
+    emit(gen, "%*s", (gen->depth + 1) * 4, "");
+}
+
+/* --- Expressões --- */
+
+static void variable(Generator* gen) {
+    int index = pick(gen, gen->locals + 2);
+    if (index == 0) {
+        emit(gen, "!a");
+    } else if (index == 1) {
+        emit(gen, "!b");
+    } else {
+        emit(gen, "!v%d", index - 2);
+    }
+}
+
+/* Expressão inteira com até `budget` operadores. */
+static void expression(Generator* gen, int budget) {
+    static const char* const operators[] = { " + ", " - ", " * ", " / ", " + ", " - " };
+    if (budget <= 0) {
+        if (pick(gen, 3) == 0) {
+            emit(gen, "%d", pick(gen, 1000));
+        } else {
+            variable(gen);
+        }
+        return;
+    }
+    switch (pick(gen, 6)) {
+        case 0:
+            emit(gen, "(");
+            expression(gen, budget - 1);
+            emit(gen, ")");
+            break;
+        case 1:
+            if (gen->functions > 0) {
+                emit(gen, "__f%d(", pick(gen, gen->functions));
+                expression(gen, budget / 2);
+                emit(gen, ", ");
+                expression(gen, budget / 2);
+                emit(gen, ")");
+                break;
+            }
+            /* fall through */
+        case 2:
+            variable(gen);
+            emit(gen, " ^ %d", 1 + pick(gen, 3));
+            break;
+        default: {
+            int left = pick(gen, budget);
+            expression(gen, left);
+            emit(gen, "%s", operators[pick(gen, 6)]);
+            expression(gen, budget - 1 - left);
+            break;
+        }
+    }
+}
+
+static void condition(Generator* gen) {
+    static const char* const relations[] = { " < ", " <= ", " > ", " >= ", " == " };
+    int expression_budget = gen->options->profile == PERFIL_OPERADORES ? 3 : 1;
+    expression(gen, expression_budget);
+    emit(gen, "%s", relations[pick(gen, 5)]);
+    expression(gen, expression_budget);
+    if (pick(gen, 3) == 0) {
+        emit(gen, pick(gen, 2) ? " && " : " || ");
+        variable(gen);
+        emit(gen, " > 0");
+    }
+}
+
+static void text_literal(Generator* gen) {
+    int length = gen->options->profile == PERFIL_TEXTOS ? 40 + pick(gen, 160) : 8 + pick(gen, 40);
+    int written = 0;
+    emit(gen, "\"");
+    while (written < length) {
+        const char* word = words[pick(gen, (int)(sizeof(words) / sizeof(words[0])))];
+        /* Textos podem atravessar linhas. */
+        const char* separator = gen->options->profile == PERFIL_TEXTOS && pick(gen, 12) == 0 ? "\n" : " ";
+        emit(gen, "%s%s", word, separator);
+        written += (int)strlen(word) + 1;
+    }
+    emit(gen, "\"");
+}
+
+/* --- Comandos --- */
+
+static void statements(Generator* gen, int count);
+
+static void block(Generator* gen, int count) {
+    emit(gen, "{\n");
+    gen->depth++;
+    statements(gen, count);
+    gen->depth--;
+    indent(gen);
+    emit(gen, "}");
+}
+
+/* Um comando com erro léxico ou de balanceamento. */
+static void error_statement(Generator* gen) {
+    static const char* const errors[] = {
+        "!v0 = y + 1;",
+        "!v0 = !v0 +++ 1;",
+        "se (!a != !b) { !v0 = 1; }",
+        "!v0 = !a << 2;",
+        "!v0 = (!a + 1));",
+        "!v0 = !a =< 2;",
+    };
+    indent(gen);
+    emit(gen, "%s\n", errors[pick(gen, (int)(sizeof(errors) / sizeof(errors[0])))]);
+}
+
+static GenStatement choose_statement(Generator* gen) {
+    const int* weights = statement_weights[gen->options->profile];
+    int total = 0;
+    for (int i = 0; i < NUM_COMANDOS; i++) total += weights[i];
+    int choice = pick(gen, total);
+    for (int i = 0; i < NUM_COMANDOS; i++) {
+        if (choice < weights[i]) return (GenStatement)i;
+        choice -= weights[i];
+    }
+    return CMD_ATRIBUICAO;
+}
+
+static void statement(Generator* gen) {
+    if (gen->errors_left > 0 && gen->written >= gen->next_error) {
+        error_statement(gen);
+        gen->errors_left--;
+        gen->next_error += gen->options->size / (gen->options->errors + 1);
+        return;
+    }
+    GenStatement kind = choose_statement(gen);
+    if ((kind == CMD_SE || kind == CMD_PARA) && gen->depth >= GEN_MAX_DEPTH) kind = CMD_ATRIBUICAO;
+    if (kind == CMD_CHAMADA && gen->functions == 0) kind = CMD_ESCREVA;
+    int expression_budget = gen->options->profile == PERFIL_OPERADORES ? 6 + pick(gen, 10) : 1 + pick(gen, 3);
+
+    indent(gen);
+    switch (kind) {
+        case CMD_ATRIBUICAO:
+            variable(gen);
+            emit(gen, " = ");
+            expression(gen, expression_budget);
+            emit(gen, ";\n");
+            break;
+        case CMD_SE:
+            emit(gen, "se (");
+            condition(gen);
+            emit(gen, ") ");
+            block(gen, 1 + pick(gen, 3));
+            if (pick(gen, 2)) {
+                emit(gen, " senao ");
+                block(gen, 1 + pick(gen, 2));
+            }
+            emit(gen, "\n");
+            break;
+        case CMD_PARA:
+            emit(gen, "para (!v0 = 0; !v0 < %d; !v0++) ", 1 + pick(gen, 100));
+            block(gen, 1 + pick(gen, 3));
+            emit(gen, "\n");
+            break;
+        case CMD_ESCREVA:
+            emit(gen, "escreva(");
+            text_literal(gen);
+            emit(gen, ", ");
+            expression(gen, 1);
+            emit(gen, ");\n");
+            break;
+        case CMD_CHAMADA:
+            variable(gen);
+            emit(gen, " = __f%d(", pick(gen, gen->functions));
+            expression(gen, 1);
+            emit(gen, ", ");
+            expression(gen, 1);
+            emit(gen, ");\n");
+            break;
+        case CMD_INCREMENTO:
+            variable(gen);
+            emit(gen, pick(gen, 2) ? "++;\n" : "--;\n");
+            break;
+        default:
+            break;
+    }
+}
+
+static void statements(Generator* gen, int count) {
+    for (int i = 0; i < count; i++) {
+        statement(gen);
+    }
+}
+
+static void locals(Generator* gen) {
+    gen->locals = 1 + pick(gen, GEN_MAX_LOCALS);
+    indent(gen);
+    emit(gen, "inteiro");
+    for (int i = 0; i < gen->locals; i++) {
+        emit(gen, i == 0 ? " !v%d = %d" : ", !v%d = %d", i, pick(gen, 100));
+    }
+    emit(gen, ";\n");
+}
+
+static void function(Generator* gen) {
+    emit(gen, "funcao __f%d(inteiro !a, inteiro !b) {\n", gen->functions);
+    locals(gen);
+    statements(gen, 2 + pick(gen, gen->options->profile == PERFIL_FUNCOES ? 2 : 6));
+    indent(gen);
+    emit(gen, "retorno ");
+    expression(gen, 2);
+    emit(gen, ";\n}\n\n");
+    gen->functions++;
+}
+
+long generate_program(FILE* out, const GenOptions* options) {
+    Generator gen;
+    memset(&gen, 0, sizeof(gen));
+    gen.out = out;
+    gen.options = options;
+    gen.state = options->seed * 0x9E3779B97F4A7C15ULL + 1;
+    gen.errors_left = options->errors;
+    gen.next_error = options->errors > 0 ? options->size / (options->errors + 1) : 0;
+
+    /* A principal fica com algumas centenas de bytes no fim. */
+    while (gen.written < options->size - 512) {
+        function(&gen);
+    }
+    emit(&gen, "principal() {\n");
+    locals(&gen);
+    emit(&gen, "    inteiro !a = 1, !b = 2;\n");
+    statements(&gen, 4);
+    while (gen.errors_left > 0) {
+        error_statement(&gen);
+        gen.errors_left--;
+    }
+    emit(&gen, "}\n");
+    return gen.written;
+}
@@ -0,0 +1,42 @@
+#ifndef GERADOR_H
+#define GERADOR_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* --- Gerador de Programas Sintéticos --- */
+
+/* Perfis: qual construção domina o programa gerado. */
+typedef enum {
+    PERFIL_MISTO,
+    PERFIL_FUNCOES,     /* muitas funções curtas e chamadas */
+    PERFIL_CONDICIONAIS, /* se/senao aninhados */
+    PERFIL_LACOS,       /* para aninhados */
+    PERFIL_TEXTOS,      /* escreva com textos longos */
+    PERFIL_OPERADORES,  /* expressões longas */
+    NUM_PERFIS
+} GenProfile;
+
+typedef struct {
+    long size;          /* tamanho aproximado em bytes (passa um pouco) */
+    GenProfile profile;
+    uint64_t seed;
+    int errors;         /* erros léxicos e de balanceamento espalhados */
+} GenOptions;
+
+/* Nome do perfil, ou NULL. */
+const char* gen_profile_name(GenProfile profile);
+
+/* Retorna 0 e preenche *profile, ou -1 se o nome não existir. */
+int gen_profile_from_string(const char* name, GenProfile* profile);
+
+/* "4096", "64K", "16M" ou "1G". Retorna -1 se inválido. */
+long gen_parse_size(const char* text);
+
+/* Escreve em out um programa determinístico (a mesma semente gera o
+ * mesmo texto): sem erros, ele passa pelas análises léxica, sintática e
+ * semântica. Com options->errors > 0, os erros são espalhados em
+ * intervalos regulares. Retorna o número de bytes escritos. */
+long generate_program(FILE* out, const GenOptions* options);
+
+#endif
@@ -0,0 +1,194 @@
+/* Suporte de execução dos programas compilados com --nativo.
+ *
+ * O assembly gerado chama estas funções para escreva, leia, textos e
+ * potências; o resto (inteiros, decimais, saltos, chamadas) é código de
+ * máquina direto. Ligar junto com o arquivo gerado:
+ *
+ *     gcc programa.s runtime/execucao.c -o programa -lm
+ *
+ * Os textos seguem o layout esperado pelo gerador: tamanho em 8 bytes
+ * seguido do ponteiro para os bytes, sempre terminados em '\0'. O
+ * comportamento acompanha o da máquina virtual (--run). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+
+#define RT_TEXT_LINE_SIZE 4096
+#define RT_SIGNAL_STACK_SIZE 65536
+
+typedef struct {
+    int64_t length;
+    const char* data;
+} rt_texto;
+
+/* --- Início --- */
+
+static char rt_pilha_sinal[RT_SIGNAL_STACK_SIZE];
+
+/* Recursão sem fim esgota a pilha do processo: o acesso à página de
+ * guarda gera SIGSEGV, tratado numa pilha alternativa. */
+static void rt_estouro_pilha(int sinal) {
+    static const char mensagem[] = "Erro de execução: Estouro da pilha de chamadas\n";
+    (void)sinal;
+    fflush(stdout);
+    if (write(STDOUT_FILENO, mensagem, sizeof(mensagem) - 1) < 0) _exit(1);
+    _exit(1);
+}
+
+/* Chamada por main antes das globais. */
+void rt_iniciar(void) {
+    stack_t pilha;
+    pilha.ss_sp = rt_pilha_sinal;
+    pilha.ss_size = sizeof(rt_pilha_sinal);
+    pilha.ss_flags = 0;
+    sigaltstack(&pilha, NULL);
+
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = rt_estouro_pilha;
+    acao.sa_flags = SA_ONSTACK;
+    sigemptyset(&acao.sa_mask);
+    sigaction(SIGSEGV, &acao, NULL);
+}
+
+/* --- Textos --- */
+
+/* Textos criados em execução nunca são liberados: vivem até o fim do
+ * programa, como os da arena da máquina virtual. */
+static rt_texto* rt_texto_novo(const char* data, int64_t length) {
+    rt_texto* text = (rt_texto*)malloc(sizeof(rt_texto) + (size_t)length + 1);
+    if (text == NULL) {
+        fflush(stdout);
+        fprintf(stderr, "ERRO: Memória Insuficiente.\n");
+        exit(1);
+    }
+    char* copy = (char*)(text + 1);
+    memcpy(copy, data, (size_t)length);
+    copy[length] = '\0';
+    text->length = length;
+    text->data = copy;
+    return text;
+}
+
+const rt_texto* rt_texto_cortar(const rt_texto* text, int64_t size) {
+    if (text->length <= size) return text;
+    return rt_texto_novo(text->data, size);
+}
+
+const rt_texto* rt_texto_de_inteiro(int64_t value) {
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%lld", (long long)value);
+    return rt_texto_novo(buffer, length);
+}
+
+const rt_texto* rt_texto_de_decimal(double value) {
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+    return rt_texto_novo(buffer, length);
+}
+
+double rt_texto_para_decimal(const rt_texto* text) {
+    return strtod(text->data, NULL);
+}
+
+/* decimal para inteiro trunca; valores fora do intervalo saturam. */
+int64_t rt_texto_para_inteiro(const rt_texto* text) {
+    char* end;
+    long long i = strtoll(text->data, &end, 10);
+    if (*end == '\0' && end != text->data) return i;
+    double d = strtod(text->data, NULL);
+    if (d != d) return 0;
+    if (d >= 9.2e18) return INT64_MAX;
+    if (d <= -9.2e18) return INT64_MIN;
+    return (int64_t)d;
+}
+
+/* Byte a byte; retorna negativo, zero ou positivo. */
+int64_t rt_texto_comparar(const rt_texto* left, const rt_texto* right) {
+    int64_t length = left->length < right->length ? left->length : right->length;
+    int order = memcmp(left->data, right->data, (size_t)length);
+    if (order != 0) return order;
+    return left->length - right->length;
+}
+
+/* --- Aritmética --- */
+
+/* Expoente negativo só tem resultado inteiro para as bases 1 e -1. */
+int64_t rt_potencia_inteiro(int64_t base, int64_t exponent) {
+    if (exponent < 0) {
+        if (base == 1) return 1;
+        if (base == -1) return (exponent & 1) ? -1 : 1;
+        return 0;
+    }
+    uint64_t result = 1;
+    uint64_t factor = (uint64_t)base;
+    while (exponent > 0) {
+        if (exponent & 1) result *= factor;
+        factor *= factor;
+        exponent >>= 1;
+    }
+    return (int64_t)result;
+}
+
+double rt_potencia(double base, double exponent) {
+    return pow(base, exponent);
+}
+
+void rt_divisao_por_zero(int64_t line) {
+    fflush(stdout);
+    printf("Erro de execução na linha %lld: Divisão por zero\n", (long long)line);
+    exit(1);
+}
+
+/* --- Entrada e Saída --- */
+
+void rt_escreva_inteiro(int64_t value) {
+    printf("%lld", (long long)value);
+}
+
+void rt_escreva_decimal(double value) {
+    printf("%.15g", value);
+}
+
+void rt_escreva_texto(const rt_texto* text) {
+    fwrite(text->data, 1, (size_t)text->length, stdout);
+}
+
+void rt_escreva_fim(void) {
+    putchar('\n');
+}
+
+/* Números são lidos como palavras; textos, até o fim da linha. No fim da
+ * entrada, o valor é o padrão do tipo. */
+int64_t rt_leia_inteiro(void) {
+    long long i = 0;
+    fflush(stdout);
+    if (scanf("%lld", &i) != 1) i = 0;
+    return i;
+}
+
+double rt_leia_decimal(void) {
+    double d = 0.0;
+    fflush(stdout);
+    if (scanf("%lf", &d) != 1) d = 0.0;
+    return d;
+}
+
+const rt_texto* rt_leia_texto(void) {
+    char line[RT_TEXT_LINE_SIZE];
+    fflush(stdout);
+    int c = getchar();
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n') c = getchar();
+    int length = 0;
+    while (c != EOF && c != '\n') {
+        if (length < RT_TEXT_LINE_SIZE) line[length++] = (char)c;
+        c = getchar();
+    }
+    if (length > 0 && line[length - 1] == '\r') length--;
+    return rt_texto_novo(line, length);
+}
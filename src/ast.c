@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"
+
+#define AST_INITIAL_CAPACITY 256
+#define AST_INITIAL_CONSTANTS 32
+
+void ast_init(Ast* ast, const char* source, Interner* interner, Arena* arena, Arena* node_arena) {
+    ast->arena = arena;
+    ast->node_arena = node_arena;
+    ast->interner = interner;
+    ast->source = source;
+    ast->capacity = AST_INITIAL_CAPACITY;
+    ast->nodes = (AstNode*)arena_alloc(node_arena, ast->capacity * sizeof(AstNode));
+    memset(&ast->nodes[AST_NULL], 0, sizeof(AstNode));
+    ast->count = 1;
+    ast->root = AST_NULL;
+    ast->constants = NULL;
+    ast->constants_count = 0;
+    ast->constants_capacity = 0;
+}
+
+AstIndex ast_add(Ast* ast, AstKind kind, int line) {
+    if (ast->count == ast->capacity) {
+        ast->nodes = (AstNode*)arena_grow(ast->node_arena, ast->nodes,
+                                          ast->capacity * sizeof(AstNode),
+                                          2 * ast->capacity * sizeof(AstNode));
+        ast->capacity *= 2;
+    }
+    AstIndex index = ast->count++;
+    AstNode* node = &ast->nodes[index];
+    memset(node, 0, sizeof(*node));
+    node->kind = (uint8_t)kind;
+    node->line = line;
+    return index;
+}
+
+void ast_reserve(Ast* ast, uint32_t count) {
+    uint32_t capacity = ast->capacity;
+    while (count > capacity) capacity *= 2;
+    if (capacity != ast->capacity) {
+        ast->nodes = (AstNode*)arena_grow(ast->node_arena, ast->nodes,
+                                          ast->capacity * sizeof(AstNode),
+                                          capacity * sizeof(AstNode));
+        ast->capacity = capacity;
+    }
+}
+
+AstIndex ast_append_fragment(Ast* ast, const Ast* fragment, SymbolId* names) {
+    if (fragment->count <= 2) return AST_NULL;
+    ast_reserve(ast, ast->count + fragment->count - 2);
+
+    /* O nó 1 do fragmento é o PROGRAMA dele: o nó i vai para i + base. */
+    uint32_t base = ast->count - 2;
+    for (uint32_t i = 2; i < fragment->count; i++) {
+        AstNode node = fragment->nodes[i];
+        for (int c = 0; c < 4; c++) {
+            if (node.child[c] != AST_NULL) node.child[c] += base;
+        }
+        if (node.next != AST_NULL) node.next += base;
+        if (node.symbol != SYMBOL_NULL) {
+            if (names[node.symbol] == SYMBOL_NULL) {
+                const SymbolName* name = interner_name(fragment->interner, node.symbol);
+                names[node.symbol] = interner_intern(ast->interner, name->text, name->length);
+            }
+            node.symbol = names[node.symbol];
+        }
+        ast->nodes[ast->count++] = node;
+    }
+    AstIndex first = fragment->nodes[fragment->root].child[0];
+    return first != AST_NULL ? first + base : AST_NULL;
+}
+
+void ast_set_constant(Ast* ast, AstIndex index, TokenType type, AstConstant value) {
+    if (ast->constants_count == ast->constants_capacity) {
+        uint32_t capacity = ast->constants_capacity == 0 ? AST_INITIAL_CONSTANTS : 2 * ast->constants_capacity;
+        ast->constants = (AstConstant*)arena_grow(ast->arena, ast->constants,
+                                                  ast->constants_capacity * sizeof(AstConstant),
+                                                  capacity * sizeof(AstConstant));
+        ast->constants_capacity = capacity;
+    }
+    ast->constants[ast->constants_count] = value;
+    AstNode* node = ast_node(ast, index);
+    node->kind = AST_LITERAL;
+    node->op = (uint8_t)type;
+    node->flags = AST_CONSTANTE;
+    node->offset = (int)ast->constants_count++;
+    node->length = 0;
+    node->symbol = SYMBOL_NULL;
+    memset(node->child, 0, sizeof(node->child));
+}
+
+int64_t ast_literal_int(const Ast* ast, const AstNode* node) {
+    if (node->flags & AST_CONSTANTE) return ast->constants[node->offset].i;
+    return strtoll(&ast->source[node->offset], NULL, 10);
+}
+
+double ast_literal_decimal(const Ast* ast, const AstNode* node) {
+    if (node->flags & AST_CONSTANTE) return ast->constants[node->offset].d;
+    return strtod(&ast->source[node->offset], NULL);
+}
+
+const char* ast_kind_to_string(AstKind kind) {
+    switch (kind) {
+        case AST_PROGRAMA: return "PROGRAMA";
+        case AST_FUNCAO: return "FUNCAO";
+        case AST_PRINCIPAL: return "PRINCIPAL";
+        case AST_PARAMETRO: return "PARAMETRO";
+        case AST_DECLARACAO: return "DECLARACAO";
+        case AST_DECLARADOR: return "DECLARADOR";
+        case AST_BLOCO: return "BLOCO";
+        case AST_SE: return "SE";
+        case AST_PARA: return "PARA";
+        case AST_LEIA: return "LEIA";
+        case AST_ESCREVA: return "ESCREVA";
+        case AST_RETORNO: return "RETORNO";
+        case AST_EXPRESSAO: return "EXPRESSAO";
+        case AST_ATRIBUICAO: return "ATRIBUICAO";
+        case AST_BINARIO: return "BINARIO";
+        case AST_UNARIO: return "UNARIO";
+        case AST_INCREMENTO: return "INCREMENTO";
+        case AST_CHAMADA: return "CHAMADA";
+        case AST_VARIAVEL: return "VARIAVEL";
+        case AST_LITERAL: return "LITERAL";
+        default: return "DESCONHECIDO";
+    }
+}
+
+static void dump_node(const Ast* ast, AstIndex index, int depth, FILE* out) {
+    const AstNode* node = ast_node(ast, index);
+    fprintf(out, "%*s%s", depth * 2, "", ast_kind_to_string((AstKind)node->kind));
+    if (node->op != 0) {
+        fprintf(out, " %s", token_type_to_string((TokenType)node->op));
+    }
+    if (node->kind == AST_INCREMENTO) {
+        fprintf(out, node->flags & AST_PREFIXO ? " prefixo" : " posfixo");
+    }
+    if (node->flags & AST_CONSTANTE) {
+        if (node->op == TOKEN_LITERAL_DEC) fprintf(out, " %.17g", ast_literal_decimal(ast, node));
+        else fprintf(out, " %lld", (long long)ast_literal_int(ast, node));
+    } else if (node->symbol != SYMBOL_NULL) {
+        /* Pelo nome internado: nós criados pelo otimizador não estão no
+         * código-fonte. */
+        const SymbolName* name = interner_name(ast->interner, node->symbol);
+        fprintf(out, " '%.*s' #%u", (int)name->length, name->text, node->symbol);
+    } else if (node->length > 0 || node->kind == AST_LITERAL) {
+        fprintf(out, " '%.*s'", node->length, &ast->source[node->offset]);
+    }
+    fprintf(out, " (linha %d)\n", node->line);
+
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node->child[i]; child != AST_NULL; child = ast_node(ast, child)->next) {
+            dump_node(ast, child, depth + 1, out);
+        }
+    }
+}
+
+void ast_dump(const Ast* ast, FILE* out) {
+    if (ast->root != AST_NULL) {
+        dump_node(ast, ast->root, 0, out);
+    }
+}
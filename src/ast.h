@@ -0,0 +1,123 @@
+#ifndef AST_H
+#define AST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "memoria.h"
+#include "lexico.h"
+#include "simbolos.h"
+
+/* --- Árvore Sintática Plana --- */
+
+/* Os nós ficam num único vetor contíguo, alocado numa arena própria; os
+ * filhos são índices de 32 bits nesse vetor. O índice 0 é reservado e
+ * significa "nenhum nó". Listas (comandos de um bloco, argumentos, ...)
+ * são encadeadas pelo campo next do primeiro elemento. */
+typedef uint32_t AstIndex;
+#define AST_NULL 0
+
+typedef enum {
+    AST_PROGRAMA,    /* child[0]: primeiro item (funções, principal, globais) */
+    AST_FUNCAO,      /* nome; child[0]: parâmetros; child[1]: corpo;
+                      * type: tipo do primeiro retorno */
+    AST_PRINCIPAL,   /* child[1]: corpo */
+    AST_PARAMETRO,   /* op: tipo; nome */
+    AST_DECLARACAO,  /* op: tipo; child[0]: declaradores */
+    AST_DECLARADOR,  /* nome; child[0]: tamanho (literal); child[1]: valor inicial */
+    AST_BLOCO,       /* child[0]: comandos */
+    AST_SE,          /* child[0]: condição; child[1]: então; child[2]: senão */
+    AST_PARA,        /* child[0]: inicializações; child[1]: condição;
+                      * child[2]: atualizações; child[3]: corpo */
+    AST_LEIA,        /* child[0]: variáveis */
+    AST_ESCREVA,     /* child[0]: expressões */
+    AST_RETORNO,     /* child[0]: expressão */
+    AST_EXPRESSAO,   /* comando de expressão; child[0]: expressão */
+    AST_ATRIBUICAO,  /* child[0]: variável; child[1]: valor */
+    AST_BINARIO,     /* op: operador; child[0], child[1] */
+    AST_UNARIO,      /* op: TOKEN_OP_SUB; child[0] */
+    AST_INCREMENTO,  /* op: TOKEN_OP_INC/DEC; flags: AST_PREFIXO; child[0]: variável */
+    AST_CHAMADA,     /* nome; child[0]: argumentos */
+    AST_VARIAVEL,    /* nome */
+    AST_LITERAL      /* op: TOKEN_LITERAL_INT/DEC/TEXTO; texto do literal */
+} AstKind;
+
+#define AST_PREFIXO 1
+#define AST_CONSTANTE 2  /* LITERAL calculado pelo otimizador: offset indexa ast->constants */
+
+/* Nome e literais não são copiados: (offset, length) apontam para o
+ * conteúdo analisado, como nos tokens. Nós com nome (funções, parâmetros,
+ * declaradores, variáveis e chamadas) também guardam o id internado. */
+typedef struct {
+    uint8_t kind;
+    uint8_t flags;
+    uint8_t op;
+    uint8_t type;      /* DataType, preenchido pela análise semântica */
+    int line;
+    int offset;
+    int length;
+    SymbolId symbol;
+    AstIndex child[4];
+    AstIndex next;
+} AstNode;
+
+/* Valor de um literal que não está no código-fonte. */
+typedef union {
+    int64_t i;
+    double d;
+} AstConstant;
+
+typedef struct {
+    AstNode* nodes;
+    uint32_t count;
+    uint32_t capacity;
+    AstIndex root;
+    const char* source;
+    Interner* interner;
+    AstConstant* constants;
+    uint32_t constants_count;
+    uint32_t constants_capacity;
+    Arena* arena;
+    Arena* node_arena;
+} Ast;
+
+/* A árvore inteira é descartada com arena_reset/arena_destroy de arena e
+ * de node_arena. O vetor de nós é a única alocação de node_arena, e por
+ * isso cresce no lugar, sem deixar cópias antigas no orçamento; pode ser a
+ * própria arena, se o desperdício não importar. O interner pode ser
+ * compartilhado entre várias árvores. */
+void ast_init(Ast* ast, const char* source, Interner* interner, Arena* arena, Arena* node_arena);
+
+/* Acrescenta um nó e retorna seu índice. Os ponteiros para nós deixam de
+ * valer quando o vetor cresce: guarde índices. */
+AstIndex ast_add(Ast* ast, AstKind kind, int line);
+
+static inline AstNode* ast_node(const Ast* ast, AstIndex index) {
+    return &ast->nodes[index];
+}
+
+/* Garante espaço para count nós no total, com a mesma capacidade que o
+ * vetor teria ao crescer nó a nó. */
+void ast_reserve(Ast* ast, uint32_t count);
+
+/* Copia para o fim de ast os itens de fragment, uma árvore de
+ * parse_fragment sobre o mesmo conteúdo, traduzindo índices e ids de
+ * nomes (names: por id de fragment->interner, 0 = ainda não traduzido).
+ * Os nomes são internados na ordem dos nós, então copiar os fragmentos
+ * na ordem do código dá os mesmos ids da análise serial. Retorna o
+ * primeiro item copiado, ainda fora da lista do programa. */
+AstIndex ast_append_fragment(Ast* ast, const Ast* fragment, SymbolId* names);
+
+/* Transforma o nó em LITERAL de um valor calculado (TOKEN_LITERAL_INT
+ * ou TOKEN_LITERAL_DEC), mantendo linha e next. */
+void ast_set_constant(Ast* ast, AstIndex index, TokenType type, AstConstant value);
+
+/* Valor de um literal inteiro ou decimal, do código-fonte ou calculado. */
+int64_t ast_literal_int(const Ast* ast, const AstNode* node);
+double ast_literal_decimal(const Ast* ast, const AstNode* node);
+
+const char* ast_kind_to_string(AstKind kind);
+
+/* Imprime a árvore indentada, um nó por linha. */
+void ast_dump(const Ast* ast, FILE* out);
+
+#endif
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include "memoria.h"
+#include "balanceamento.h"
+
+char balance_opening(char closing) {
+    switch (closing) {
+        case ')': return '(';
+        case '}': return '{';
+        case ']': return '[';
+        default: return closing;
+    }
+}
+
+void balance_init(BalanceState* state, Arena* arena) {
+    state->top = NULL;
+    state->spare = NULL;
+    state->depth = 0;
+    state->error_line = -1;
+    state->arena = arena;
+}
+
+void balance_push(BalanceState* state, char symbol, int line) {
+    BalanceSegment* top = state->top;
+    if (top == NULL || top->count == BALANCE_SEGMENT_SIZE) {
+        BalanceSegment* segment = state->spare;
+        if (segment != NULL) {
+            state->spare = NULL;
+        } else {
+            segment = (BalanceSegment*)arena_alloc(state->arena, sizeof(BalanceSegment));
+        }
+        segment->prev = top;
+        segment->count = 0;
+        state->top = top = segment;
+    }
+    top->entries[top->count].symbol = symbol;
+    top->entries[top->count].line = line;
+    top->count++;
+    state->depth++;
+}
+
+/* Remove o topo; o segmento esvaziado fica de reserva para o próximo push. */
+static BalanceEntry balance_pop(BalanceState* state) {
+    BalanceSegment* top = state->top;
+    BalanceEntry entry = top->entries[--top->count];
+    state->depth--;
+    if (top->count == 0 && top->prev != NULL) {
+        state->top = top->prev;
+        state->spare = top;
+    }
+    return entry;
+}
+
+void balance_clear(BalanceState* state) {
+    while (state->depth > 0) {
+        balance_pop(state);
+    }
+}
+
+void balance_drop(BalanceState* state) {
+    balance_pop(state);
+}
+
+static void stray_message(char symbol, int line, char* msg, size_t size) {
+    snprintf(msg, size, "Símbolos desbalanceados: '%c' na linha %d sem abertura correspondente",
+             symbol, line);
+}
+
+static void mismatch_message(BalanceEntry top, char symbol, int line, char* msg, size_t size) {
+    snprintf(msg, size, "Símbolos desbalanceados: '%c' aberto na linha %d, fechado por '%c' na linha %d",
+             top.symbol, top.line, symbol, line);
+}
+
+int balance_close(BalanceState* state, char symbol, int line, char* msg, size_t size) {
+    if (state->depth == 0) {
+        stray_message(symbol, line, msg, size);
+        return 0;
+    }
+    BalanceEntry top = balance_pop(state);
+    if (top.symbol != balance_opening(symbol)) {
+        mismatch_message(top, symbol, line, msg, size);
+        return 0;
+    }
+    return 1;
+}
+
+/* Quantas aberturas estão acima da última `symbol` da pilha, ou -1. */
+static int balance_find(const BalanceState* state, char symbol) {
+    int above = 0;
+    for (const BalanceSegment* segment = state->top; segment != NULL; segment = segment->prev) {
+        for (int i = segment->count - 1; i >= 0; i--) {
+            if (segment->entries[i].symbol == symbol) return above;
+            above++;
+        }
+    }
+    return -1;
+}
+
+int balance_close_recovering(BalanceState* state, char symbol, int line, char* msg, size_t size) {
+    int above = balance_find(state, balance_opening(symbol));
+    if (above < 0) {
+        stray_message(symbol, line, msg, size);
+        return 0;
+    }
+    BalanceEntry top = balance_pop(state);
+    if (above == 0) return 1;
+    mismatch_message(top, symbol, line, msg, size);
+    for (int i = 0; i < above; i++) {
+        balance_pop(state);
+    }
+    return 0;
+}
+
+void balance_unclosed_message(char symbol, int open_line, int line, char* msg, size_t size) {
+    snprintf(msg, size, "Símbolos desbalanceados: '%c' aberto na linha %d não foi fechado até a linha %d",
+             symbol, open_line, line);
+}
+
+int balance_finish(BalanceState* state, int line, char* msg, size_t size) {
+    if (state->depth == 0) return 1;
+    BalanceSegment* top = state->top;
+    BalanceEntry* entry = &top->entries[top->count - 1];
+    balance_unclosed_message(entry->symbol, entry->line, line, msg, size);
+    return 0;
+}
+
+int check_balance(BalanceState* state, const char* content) {
+    char msg[160];
+    int line = 1;
+    int i = 0;
+    char c;
+    int in_string = 0;
+    int ok = 1;
+
+    balance_clear(state);
+    while (ok && (c = content[i++]) != '\0') {
+        if (c == '\n') {
+            line++;
+            continue;
+        }
+
+        if (c == '"') {
+            if (in_string) {
+                ok = balance_close(state, '"', line, msg, sizeof(msg));
+                in_string = 0;
+            } else {
+                balance_push(state, '"', line);
+                in_string = 1;
+            }
+        } else if (!in_string) {
+            if (c == '(' || c == '{' || c == '[') {
+                balance_push(state, c, line);
+            } else if (c == ')' || c == '}' || c == ']') {
+                ok = balance_close(state, c, line, msg, sizeof(msg));
+            }
+        }
+    }
+    if (ok) {
+        ok = balance_finish(state, line, msg, sizeof(msg));
+    }
+    if (!ok) {
+        state->error_line = line;
+    }
+
+    balance_clear(state);
+    return ok;
+}
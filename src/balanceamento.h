@@ -0,0 +1,68 @@
+#ifndef BALANCEAMENTO_H
+#define BALANCEAMENTO_H
+
+#include <stddef.h>
+#include "memoria.h"
+
+/* --- Verificação de Balanceamento --- */
+
+/* Símbolo de abertura pendente e a linha em que apareceu. */
+typedef struct {
+    char symbol;
+    int line;
+} BalanceEntry;
+
+#define BALANCE_SEGMENT_SIZE 256
+
+/* Segmento da pilha de aberturas. Novos segmentos são encadeados sob
+ * demanda, então a profundidade não tem limite fixo e nada é copiado. */
+typedef struct BalanceSegment {
+    struct BalanceSegment* prev;
+    int count;
+    BalanceEntry entries[BALANCE_SEGMENT_SIZE];
+} BalanceSegment;
+
+/* Estado de balanceamento de uma compilação. Os segmentos vêm de arena,
+ * que não pode ser NULL; error_line guarda a linha do último erro
+ * encontrado por check_balance. */
+typedef struct {
+    BalanceSegment* top;
+    BalanceSegment* spare;
+    int depth;
+    int error_line;
+    Arena* arena;
+} BalanceState;
+
+/* Símbolo de abertura que `closing` fecha. */
+char balance_opening(char closing);
+
+void balance_init(BalanceState* state, Arena* arena);
+void balance_push(BalanceState* state, char symbol, int line);
+
+/* Descarta todas as aberturas pendentes. */
+void balance_clear(BalanceState* state);
+
+/* Descarta a abertura do topo; a pilha não pode estar vazia. */
+void balance_drop(BalanceState* state);
+
+/* Fecha o topo com `symbol`. Retorna 1 se emparelhou; caso contrário
+ * escreve o diagnóstico em msg e retorna 0. */
+int balance_close(BalanceState* state, char symbol, int line, char* msg, size_t size);
+
+/* Como balance_close, para continuar a análise depois de um erro: se a
+ * abertura correspondente estiver mais abaixo, as aberturas acima dela são
+ * descartadas junto com ela; se não houver nenhuma, o símbolo é ignorado e
+ * a pilha não muda. */
+int balance_close_recovering(BalanceState* state, char symbol, int line, char* msg, size_t size);
+
+/* Diagnóstico de um símbolo aberto em open_line e nunca fechado. */
+void balance_unclosed_message(char symbol, int open_line, int line, char* msg, size_t size);
+
+/* Verifica se restou alguma abertura no fim da entrada. */
+int balance_finish(BalanceState* state, int line, char* msg, size_t size);
+
+/* Passada independente sobre um buffer inteiro; o lexer já faz a mesma
+ * verificação enquanto gera os tokens. Define state->error_line. */
+int check_balance(BalanceState* state, const char* content);
+
+#endif
@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+#define CACHE_MAGIC 0x45484343u  /* "CCHE" em little-endian */
+#define CACHE_KIND_TOKENS 1
+#define CACHE_KIND_AST 2
+#define CACHE_PATH_SIZE 512
+#define CACHE_NAME_SIZE 40       /* 32 dígitos hexadecimais + ".tok" */
+
+/* Cabeçalho das entradas, gravado como está na memória: numa máquina com
+ * outra ordem de bytes o magic não confere e a entrada é ignorada. Os
+ * registros vêm logo depois, alinhados em 8 bytes. */
+typedef struct {
+    uint32_t magic;
+    uint16_t kind;
+    uint16_t header_size;
+    uint64_t version;
+    CacheKey key;
+    uint64_t count;     /* tokens ou nós */
+    uint64_t names;     /* árvore: ids internados, contando o 0 */
+    uint64_t root;      /* árvore: índice da raiz */
+    uint64_t payload;   /* bytes depois do cabeçalho */
+    char error_msg[LEXER_ERROR_MSG_SIZE];
+} CacheHeader;
+
+/* --- Chave --- */
+
+#define CACHE_PRIME1 0x9E3779B185EBCA87ULL
+#define CACHE_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define CACHE_PRIME3 0x165667B19E3779F9ULL
+#define CACHE_PRIME4 0x85EBCA77C2B2AE63ULL
+
+static uint64_t rotate_left(uint64_t x, int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+static uint64_t avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= CACHE_PRIME2;
+    h ^= h >> 29;
+    h *= CACHE_PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* A versão do compilador e os tamanhos dos registros gravados. */
+static uint64_t version_hash(void) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const char* c = CACHE_COMPILER_VERSION; *c != '\0'; c++) {
+        h = (h ^ (unsigned char)*c) * 0x100000001b3ULL;
+    }
+    h ^= (uint64_t)sizeof(Token) << 16 ^ (uint64_t)sizeof(AstNode) << 32 ^ (uint64_t)sizeof(CacheHeader) << 48;
+    return avalanche(h);
+}
+
+/* Duas cadeias independentes, com multiplicadores diferentes, andam
+ * juntas pelo conteúdo; o processador executa as duas em paralelo. */
+CacheKey cache_key(const char* data, long length) {
+    uint64_t version = version_hash();
+    uint64_t a = version ^ CACHE_PRIME1;
+    uint64_t b = rotate_left(version, 32) ^ CACHE_PRIME2;
+    long i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        a = rotate_left(a + word * CACHE_PRIME2, 31) * CACHE_PRIME1;
+        b = rotate_left(b ^ word * CACHE_PRIME4, 27) * CACHE_PRIME3 + CACHE_PRIME4;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, (size_t)(length - i));
+    a = rotate_left(a + tail * CACHE_PRIME2, 31) * CACHE_PRIME1;
+    b = rotate_left(b ^ tail * CACHE_PRIME4, 27) * CACHE_PRIME3 + CACHE_PRIME4;
+
+    CacheKey key;
+    key.hash[0] = avalanche(a ^ (uint64_t)length);
+    key.hash[1] = avalanche(b + (uint64_t)length * CACHE_PRIME3);
+    key.length = (uint64_t)length;
+    return key;
+}
+
+/* --- Diretório --- */
+
+int cache_init(Cache* cache, const char* dir, long max_bytes) {
+    cache->dir = dir;
+    cache->max_bytes = max_bytes;
+    cache->usage = &cache->usage_storage;
+    atomic_init(&cache->usage->bytes, 0);
+    atomic_init(&cache->usage->scanned, 0);
+    atomic_init(&cache->usage->evicting, 0);
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) return -1;
+    struct stat info;
+    if (stat(dir, &info) != 0 || !S_ISDIR(info.st_mode) || access(dir, R_OK | W_OK | X_OK) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static void entry_path(const Cache* cache, CacheKey key, const char* suffix, char* path) {
+    snprintf(path, CACHE_PATH_SIZE, "%s/%016llx%016llx.%s", cache->dir,
+             (unsigned long long)key.hash[0], (unsigned long long)key.hash[1], suffix);
+}
+
+typedef struct {
+    char name[CACHE_NAME_SIZE];
+    long size;
+    struct timespec used;
+} CacheEntry;
+
+static int compare_entries(const void* a, const void* b) {
+    const struct timespec* x = &((const CacheEntry*)a)->used;
+    const struct timespec* y = &((const CacheEntry*)b)->used;
+    if (x->tv_sec != y->tv_sec) return x->tv_sec < y->tv_sec ? -1 : 1;
+    return (x->tv_nsec > y->tv_nsec) - (x->tv_nsec < y->tv_nsec);
+}
+
+static int is_entry_name(const char* name) {
+    size_t length = strlen(name);
+    return length == CACHE_NAME_SIZE - 4 &&
+           (strcmp(name + 32, ".tok") == 0 || strcmp(name + 32, ".ast") == 0);
+}
+
+/* Temporário de uma gravação que não terminou (o processo caiu). Os de
+ * gravações em andamento são recentes e ficam. */
+static void remove_stale_temp(int dir_fd, const char* name, time_t now) {
+    struct stat info;
+    if (strncmp(name, ".temp-", 6) == 0 && fstatat(dir_fd, name, &info, 0) == 0 &&
+        S_ISREG(info.st_mode) && now - info.st_mtime > CACHE_TEMP_MAX_AGE_SECONDS) {
+        unlinkat(dir_fd, name, 0);
+    }
+}
+
+/* LRU pelo horário de modificação, renovado a cada acerto: quando o total
+ * passa do limite, as entradas usadas há mais tempo são apagadas até o
+ * total cair a CACHE_LOW_WATER_PERCENT do limite. Retorna o total que
+ * restou no diretório. */
+static long evict(const Cache* cache) {
+    DIR* dir = opendir(cache->dir);
+    if (dir == NULL) return 0;
+    MemoryContext memory;
+    Arena arena;
+    memory_context_init(&memory);
+    arena_init(&arena, &memory);
+
+    int capacity = 64;
+    int count = 0;
+    long total = 0;
+    CacheEntry* entries = (CacheEntry*)arena_alloc(&arena, capacity * sizeof(CacheEntry));
+    time_t now = time(NULL);
+    struct dirent* item;
+    while ((item = readdir(dir)) != NULL) {
+        struct stat info;
+        if (item->d_name[0] == '.') {
+            remove_stale_temp(dirfd(dir), item->d_name, now);
+            continue;
+        }
+        if (!is_entry_name(item->d_name) || fstatat(dirfd(dir), item->d_name, &info, 0) != 0 ||
+            !S_ISREG(info.st_mode)) {
+            continue;
+        }
+        if (count == capacity) {
+            entries = (CacheEntry*)arena_grow(&arena, entries, capacity * sizeof(CacheEntry),
+                                              2 * capacity * sizeof(CacheEntry));
+            capacity *= 2;
+        }
+        memcpy(entries[count].name, item->d_name, CACHE_NAME_SIZE - 4 + 1);
+        entries[count].size = (long)info.st_size;
+        entries[count].used = info.st_mtim;
+        total += entries[count].size;
+        count++;
+    }
+
+    if (total > cache->max_bytes) {
+        long low_water = cache->max_bytes / 100 * CACHE_LOW_WATER_PERCENT;
+        qsort(entries, count, sizeof(CacheEntry), compare_entries);
+        for (int i = 0; i < count && total > low_water; i++) {
+            /* Outro processo pode ter apagado a mesma entrada. */
+            unlinkat(dirfd(dir), entries[i].name, 0);
+            total -= entries[i].size;
+        }
+    }
+    closedir(dir);
+    arena_destroy(&arena);
+    return total;
+}
+
+/* Soma uma entrada nova à estimativa e varre o diretório só na primeira
+ * gravação do processo ou quando a estimativa passa do limite. Gravações
+ * de outros processos só entram na estimativa na varredura seguinte. */
+static void account_entry(const Cache* cache, long bytes) {
+    CacheUsage* usage = cache->usage;
+    long total = atomic_fetch_add(&usage->bytes, bytes) + bytes;
+    if (atomic_load(&usage->scanned) && total <= cache->max_bytes) return;
+    if (atomic_exchange(&usage->evicting, 1)) return;
+    /* Gravações de outras threads durante a varredura continuam somadas
+     * (as que a varredura viu contam duas vezes, o que só a adianta). */
+    long before = atomic_load(&usage->bytes);
+    atomic_fetch_add(&usage->bytes, evict(cache) - before);
+    atomic_store(&usage->scanned, 1);
+    atomic_store(&usage->evicting, 0);
+}
+
+/* --- Entradas --- */
+
+/* Mapeia a entrada e confere o cabeçalho. Entradas de outra versão não
+ * chegam aqui (o nome depende da versão); uma entrada com o nome certo e
+ * o conteúdo errado está corrompida e é apagada. */
+static const CacheHeader* open_entry(const Cache* cache, CacheKey key, int kind, MappedFile* file,
+                                     MemoryContext* memory) {
+    char path[CACHE_PATH_SIZE];
+    entry_path(cache, key, kind == CACHE_KIND_TOKENS ? "tok" : "ast", path);
+    if (map_file(file, path, memory) != MAP_OK) return NULL;
+    const CacheHeader* header = (const CacheHeader*)file->data;
+    if ((size_t)file->length < sizeof(CacheHeader) || header->magic != CACHE_MAGIC ||
+        header->kind != kind || header->header_size != sizeof(CacheHeader) ||
+        header->version != version_hash() || memcmp(&header->key, &key, sizeof(key)) != 0 ||
+        header->payload != (uint64_t)file->length - sizeof(CacheHeader) ||
+        memchr(header->error_msg, '\0', sizeof(header->error_msg)) == NULL) {
+        unmap_file(file);
+        unlink(path);
+        return NULL;
+    }
+    /* Mais recente no LRU. */
+    utimensat(AT_FDCWD, path, NULL, 0);
+    return header;
+}
+
+static void discard_entry(const Cache* cache, CacheKey key, int kind, MappedFile* file) {
+    char path[CACHE_PATH_SIZE];
+    entry_path(cache, key, kind == CACHE_KIND_TOKENS ? "tok" : "ast", path);
+    unmap_file(file);
+    unlink(path);
+}
+
+/* Arquivo temporário no próprio diretório, para o rename ser atômico. */
+static FILE* open_temp(const Cache* cache, char* temp_path) {
+    snprintf(temp_path, CACHE_PATH_SIZE, "%s/.temp-XXXXXX", cache->dir);
+    int fd = mkstemp(temp_path);
+    if (fd < 0) return NULL;
+    /* mkstemp cria com 0600; o cache pode ser compartilhado. */
+    fchmod(fd, 0644);
+    FILE* file = fdopen(fd, "wb");
+    if (file == NULL) {
+        close(fd);
+        unlink(temp_path);
+        return NULL;
+    }
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    fwrite(&header, sizeof(header), 1, file);
+    return file;
+}
+
+/* Escreve o cabeçalho definitivo e publica a entrada. */
+static void commit_entry(const Cache* cache, FILE* file, const char* temp_path, CacheHeader* header) {
+    header->magic = CACHE_MAGIC;
+    header->header_size = sizeof(CacheHeader);
+    header->version = version_hash();
+    long bytes = (long)(sizeof(*header) + header->payload);
+    int ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(header, sizeof(*header), 1, file) == 1;
+    ok = fflush(file) == 0 && ok;
+    ok = fclose(file) == 0 && ok;
+    char path[CACHE_PATH_SIZE];
+    entry_path(cache, header->key, header->kind == CACHE_KIND_TOKENS ? "tok" : "ast", path);
+    if (!ok || rename(temp_path, path) != 0) {
+        unlink(temp_path);
+        return;
+    }
+    account_entry(cache, bytes);
+}
+
+/* --- Tokens --- */
+
+static int valid_token(Token token, uint64_t length) {
+    return token.type >= TOKEN_EOF && token.type <= TOKEN_PONTO && token.offset >= 0 &&
+           token.length >= 0 && (uint64_t)token.offset + (uint64_t)token.length <= length &&
+           token.line >= 0;
+}
+
+int cache_load_tokens(const Cache* cache, CacheKey key, CachedTokens* cached, MemoryContext* memory) {
+    const CacheHeader* header = open_entry(cache, key, CACHE_KIND_TOKENS, &cached->file, memory);
+    if (header == NULL) return 0;
+    const Token* tokens = (const Token*)(cached->file.data + sizeof(CacheHeader));
+    long count = (long)header->count;
+    int valid = count >= 1 && header->payload == (uint64_t)count * sizeof(Token);
+    for (long i = 0; valid && i < count; i++) {
+        /* Só o último é EOF ou ERRO. */
+        int last = tokens[i].type == TOKEN_EOF || tokens[i].type == TOKEN_ERRO;
+        valid = valid_token(tokens[i], key.length) && last == (i == count - 1);
+    }
+    if (!valid) {
+        discard_entry(cache, key, CACHE_KIND_TOKENS, &cached->file);
+        return 0;
+    }
+    cached->tokens = tokens;
+    cached->count = count;
+    cached->error_msg = header->error_msg;
+    return 1;
+}
+
+void cache_release_tokens(CachedTokens* cached) {
+    unmap_file(&cached->file);
+}
+
+int cache_begin_tokens(CacheWriter* writer, const Cache* cache, CacheKey key) {
+    writer->cache = cache;
+    writer->key = key;
+    writer->count = 0;
+    writer->file = cache != NULL ? open_temp(cache, writer->temp_path) : NULL;
+    return writer->file != NULL ? 0 : -1;
+}
+
+void cache_add_token(CacheWriter* writer, Token token) {
+    if (writer->file == NULL) return;
+    fwrite(&token, sizeof(token), 1, writer->file);
+    writer->count++;
+}
+
+void cache_finish_tokens(CacheWriter* writer, const char* error_msg) {
+    if (writer->file == NULL) return;
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.kind = CACHE_KIND_TOKENS;
+    header.key = writer->key;
+    header.count = (uint64_t)writer->count;
+    header.payload = (uint64_t)writer->count * sizeof(Token);
+    if (error_msg != NULL) {
+        snprintf(header.error_msg, sizeof(header.error_msg), "%s", error_msg);
+    }
+    commit_entry(writer->cache, writer->file, writer->temp_path, &header);
+    writer->file = NULL;
+}
+
+/* --- Árvore Sintática --- */
+
+/* Índices dentro do vetor, tipos conhecidos e posições dentro do
+ * conteúdo: uma árvore carregada nunca leva as fases seguintes para fora
+ * da memória. */
+static int valid_nodes(const AstNode* nodes, uint64_t count, uint64_t names, uint64_t length) {
+    for (uint64_t i = 1; i < count; i++) {
+        const AstNode* node = &nodes[i];
+        if (node->kind > AST_LITERAL || (node->flags & AST_CONSTANTE) || node->symbol >= names ||
+            node->offset < 0 || node->length < 0 ||
+            (uint64_t)node->offset + (uint64_t)node->length > length || node->next >= count) {
+            return 0;
+        }
+        for (int c = 0; c < 4; c++) {
+            if (node->child[c] >= count) return 0;
+        }
+    }
+    return 1;
+}
+
+/* Os nomes vêm depois dos nós: comprimento (u32) e texto, na ordem dos
+ * ids a partir do 1. */
+static int valid_names(const char* data, const char* end, uint64_t names) {
+    for (uint64_t id = 1; id < names; id++) {
+        uint32_t length;
+        if (end - data < (long)sizeof(length)) return 0;
+        memcpy(&length, data, sizeof(length));
+        data += sizeof(length);
+        if (length == 0 || (uint64_t)(end - data) < length) return 0;
+        data += length;
+    }
+    return data == end;
+}
+
+int cache_load_ast(const Cache* cache, CacheKey key, Ast* ast, MemoryContext* memory) {
+    MappedFile file;
+    const CacheHeader* header = open_entry(cache, key, CACHE_KIND_AST, &file, memory);
+    if (header == NULL) return 0;
+    const AstNode* nodes = (const AstNode*)(file.data + sizeof(CacheHeader));
+    const char* names = (const char*)nodes + header->count * sizeof(AstNode);
+    const char* end = file.data + file.length;
+    int valid = header->count >= 1 && header->count <= UINT32_MAX && header->names >= 1 &&
+                header->root < header->count &&
+                header->count * sizeof(AstNode) <= header->payload &&
+                valid_nodes(nodes, header->count, header->names, key.length) &&
+                valid_names(names, end, header->names);
+    if (!valid) {
+        discard_entry(cache, key, CACHE_KIND_AST, &file);
+        return 0;
+    }
+
+    /* Internados na ordem dos ids: o interner está vazio, então cada nome
+     * recebe o mesmo id da análise original. */
+    for (uint64_t id = 1; id < header->names; id++) {
+        uint32_t length;
+        memcpy(&length, names, sizeof(length));
+        names += sizeof(length);
+        interner_intern(ast->interner, names, (int)length);
+        names += length;
+    }
+    uint32_t count = (uint32_t)header->count;
+    if (count > ast->capacity) {
+        ast->nodes = (AstNode*)arena_grow(ast->node_arena, ast->nodes, ast->capacity * sizeof(AstNode),
+                                          count * sizeof(AstNode));
+        ast->capacity = count;
+    }
+    memcpy(ast->nodes, nodes, count * sizeof(AstNode));
+    ast->count = count;
+    ast->root = (AstIndex)header->root;
+    unmap_file(&file);
+    return 1;
+}
+
+void cache_store_ast(const Cache* cache, CacheKey key, const Ast* ast) {
+    char temp_path[CACHE_PATH_SIZE];
+    if (ast->constants_count > 0) return;
+    FILE* file = open_temp(cache, temp_path);
+    if (file == NULL) return;
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.kind = CACHE_KIND_AST;
+    header.key = key;
+    header.count = ast->count;
+    header.names = ast->interner->count;
+    header.root = ast->root;
+    header.payload = ast->count * sizeof(AstNode);
+    fwrite(ast->nodes, sizeof(AstNode), ast->count, file);
+    for (uint32_t id = 1; id < ast->interner->count; id++) {
+        const SymbolName* name = interner_name(ast->interner, id);
+        uint32_t length = (uint32_t)name->length;
+        fwrite(&length, sizeof(length), 1, file);
+        fwrite(name->text, 1, length, file);
+        header.payload += sizeof(length) + length;
+    }
+    commit_entry(cache, file, temp_path, &header);
+}
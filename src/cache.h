@@ -0,0 +1,107 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "memoria.h"
+#include "entrada.h"
+#include "lexico.h"
+#include "ast.h"
+
+/* --- Cache de Compilação em Disco --- */
+
+/* Entra na chave de todas as entradas: mudar o analisador léxico ou o
+ * sintático exige mudar a versão, e as entradas antigas deixam de ser
+ * encontradas (e saem pelo limite de tamanho). */
+#ifndef CACHE_COMPILER_VERSION
+#define CACHE_COMPILER_VERSION "compilador-18"
+#endif
+
+#define CACHE_DEFAULT_LIMIT_MB 256
+
+/* Ao passar do limite, as entradas mais antigas são apagadas até o total
+ * cair a esta porcentagem dele. */
+#define CACHE_LOW_WATER_PERCENT 75
+
+/* Temporários mais velhos que isto são de gravações interrompidas. */
+#define CACHE_TEMP_MAX_AGE_SECONDS 3600
+
+/* Total estimado do diretório, somado a cada gravação. A primeira
+ * gravação do processo varre o diretório; depois, ele só é varrido de
+ * novo quando a estimativa passa do limite. */
+typedef struct {
+    atomic_long bytes;
+    atomic_int scanned;
+    atomic_int evicting;  /* uma thread varre por vez */
+} CacheUsage;
+
+/* Diretório das entradas e limite do tamanho total; dir == NULL desliga.
+ * As funções recebem const Cache*: o que muda fica em usage, que aponta
+ * para usage_storage. */
+typedef struct {
+    const char* dir;
+    long max_bytes;
+    CacheUsage* usage;
+    CacheUsage usage_storage;
+} Cache;
+
+/* Endereço de um conteúdo: dois hashes de 64 bits independentes (com a
+ * versão do compilador) e o tamanho. */
+typedef struct {
+    uint64_t hash[2];
+    uint64_t length;
+} CacheKey;
+
+/* Cria o diretório, se preciso. Retorna 0, ou -1 se ele não puder ser
+ * usado. */
+int cache_init(Cache* cache, const char* dir, long max_bytes);
+
+/* Uma passada pelo conteúdo, 8 bytes por vez. */
+CacheKey cache_key(const char* data, long length);
+
+/* --- Tokens --- */
+
+/* Sequência de tokens de um arquivo, terminada no TOKEN_EOF ou no
+ * TOKEN_ERRO, mapeada direto do disco: os registros são lidos no lugar. */
+typedef struct {
+    MappedFile file;
+    const Token* tokens;
+    long count;
+    const char* error_msg;
+} CachedTokens;
+
+/* Retorna 1 e preenche cached se houver uma entrada válida para key; a
+ * entrada vira a mais recente do LRU. Tipos, linhas e offsets de todos
+ * os registros são conferidos (contra key.length) antes do uso. */
+int cache_load_tokens(const Cache* cache, CacheKey key, CachedTokens* cached, MemoryContext* memory);
+void cache_release_tokens(CachedTokens* cached);
+
+/* Grava os tokens à medida que o lexer os produz, num arquivo temporário
+ * que só vira a entrada (rename) em cache_finish_tokens: outro processo
+ * nunca vê uma entrada pela metade. */
+typedef struct {
+    const Cache* cache;
+    CacheKey key;
+    FILE* file;
+    char temp_path[512];
+    long count;
+} CacheWriter;
+
+int cache_begin_tokens(CacheWriter* writer, const Cache* cache, CacheKey key);
+void cache_add_token(CacheWriter* writer, Token token);
+/* error_msg é a mensagem do TOKEN_ERRO final, se houver. */
+void cache_finish_tokens(CacheWriter* writer, const char* error_msg);
+
+/* --- Árvore Sintática --- */
+
+/* Carrega a árvore de um conteúdo já analisado para ast, iniciada com
+ * ast_init sobre o mesmo conteúdo: os nós são copiados de uma vez e os
+ * nomes internados de novo na mesma ordem, então os ids são os mesmos.
+ * Retorna 1 se houver uma entrada válida. */
+int cache_load_ast(const Cache* cache, CacheKey key, Ast* ast, MemoryContext* memory);
+
+/* Grava uma árvore recém-analisada (antes da análise semântica). */
+void cache_store_ast(const Cache* cache, CacheKey key, const Ast* ast);
+
+#endif
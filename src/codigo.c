@@ -0,0 +1,909 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "codigo.h"
+#include "simbolos.h"
+
+#define PROGRAM_INITIAL_CODE 1024
+#define PROGRAM_INITIAL_CONSTANTS 64
+#define PROGRAM_INITIAL_LINES 64
+#define MAX_SLOTS 65535
+
+typedef struct FunctionCode FunctionCode;
+
+typedef struct {
+    const Ast* ast;
+    Program* program;
+    FunctionCode* fragment; /* em paralelo: código da função atual; NULL em série */
+    Diagnostics* diagnostics;
+    SymbolTable symbols;
+    uint32_t* slots;    /* por nó: slot do declarador/parâmetro ou índice da função */
+    int locals;         /* slots usados na função atual */
+    int in_function;    /* 0 enquanto gera a inicialização das globais */
+    int depth;          /* profundidade da pilha de expressões */
+    int max_depth;
+    int last_line;
+    int zero_decimal;   /* constantes padrão, criadas sob demanda (-1) */
+    int empty_text;
+} Compiler;
+
+/* Variável já resolvida pela tabela de símbolos. */
+typedef struct {
+    int global;
+    uint16_t slot;
+    DataType type;
+    int size;           /* tamanho de um texto (0 = sem limite) */
+} VarRef;
+
+/* --- Emissão --- */
+
+static const AstNode* node_at(const Compiler* compiler, AstIndex index) {
+    return ast_node(compiler->ast, index);
+}
+
+static DataType static_type(const Compiler* compiler, AstIndex index) {
+    return (DataType)node_at(compiler, index)->type;
+}
+
+static void emit_byte(Compiler* compiler, uint8_t byte) {
+    Program* program = compiler->program;
+    if (program->count == program->capacity) {
+        program->code = (uint8_t*)arena_grow(program->arena, program->code,
+                                             program->capacity, 2 * program->capacity);
+        program->capacity *= 2;
+    }
+    program->code[program->count++] = byte;
+}
+
+static void emit_u16(Compiler* compiler, uint32_t value) {
+    emit_byte(compiler, (uint8_t)(value & 0xFF));
+    emit_byte(compiler, (uint8_t)(value >> 8));
+}
+
+static void emit_u32(Compiler* compiler, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        emit_byte(compiler, (uint8_t)(value >> (8 * i)));
+    }
+}
+
+static void patch_u32(Compiler* compiler, uint32_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        compiler->program->code[offset + i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/* effect: quanto a instrução muda a profundidade da pilha. */
+static void emit_op(Compiler* compiler, Opcode op, int effect) {
+    emit_byte(compiler, (uint8_t)op);
+    compiler->depth += effect;
+    if (compiler->depth > compiler->max_depth) {
+        compiler->max_depth = compiler->depth;
+    }
+}
+
+static void emit_op_u16(Compiler* compiler, Opcode op, int effect, uint32_t operand) {
+    emit_op(compiler, op, effect);
+    emit_u16(compiler, operand);
+}
+
+static void note_operand(Compiler* compiler, int constant);
+
+/* Salto para frente: retorna a posição do operando, corrigida depois com
+ * patch_jump. */
+static uint32_t emit_jump(Compiler* compiler, Opcode op, int effect) {
+    emit_op(compiler, op, effect);
+    uint32_t operand = compiler->program->count;
+    note_operand(compiler, 0);
+    emit_u32(compiler, 0);
+    return operand;
+}
+
+static void patch_jump(Compiler* compiler, uint32_t operand) {
+    patch_u32(compiler, operand, compiler->program->count);
+}
+
+static void emit_jump_to(Compiler* compiler, Opcode op, int effect, uint32_t target) {
+    emit_op(compiler, op, effect);
+    note_operand(compiler, 0);
+    emit_u32(compiler, target);
+}
+
+static void mark_line(Compiler* compiler, int line) {
+    Program* program = compiler->program;
+    if (line == compiler->last_line) return;
+    compiler->last_line = line;
+    if (program->lines_count > 0 && program->lines[program->lines_count - 1].offset == program->count) {
+        program->lines[program->lines_count - 1].line = line;
+        return;
+    }
+    if (program->lines_count == program->lines_capacity) {
+        program->lines = (LineEntry*)arena_grow(program->arena, program->lines,
+                                                program->lines_capacity * sizeof(LineEntry),
+                                                2 * program->lines_capacity * sizeof(LineEntry));
+        program->lines_capacity *= 2;
+    }
+    program->lines[program->lines_count].offset = program->count;
+    program->lines[program->lines_count].line = line;
+    program->lines_count++;
+}
+
+static int add_constant(Compiler* compiler, Value value) {
+    Program* program = compiler->program;
+    if (program->constants_count == program->constants_capacity) {
+        program->constants = (Value*)arena_grow(program->arena, program->constants,
+                                                program->constants_capacity * sizeof(Value),
+                                                2 * program->constants_capacity * sizeof(Value));
+        program->constants_capacity *= 2;
+    }
+    program->constants[program->constants_count] = value;
+    return (int)program->constants_count++;
+}
+
+static void emit_constant_index(Compiler* compiler, int index) {
+    emit_op(compiler, OP_CONST, 1);
+    note_operand(compiler, 1);
+    emit_u32(compiler, (uint32_t)index);
+}
+
+static void emit_constant(Compiler* compiler, Value value) {
+    if (value.type == TYPE_INTEIRO && value.as.i >= INT32_MIN && value.as.i <= INT32_MAX) {
+        emit_op(compiler, OP_INT, 1);
+        emit_u32(compiler, (uint32_t)(int32_t)value.as.i);
+        return;
+    }
+    emit_constant_index(compiler, add_constant(compiler, value));
+}
+
+static Value make_text(Compiler* compiler, const char* data, int length) {
+    Arena* arena = compiler->program->arena;
+    char* copy = (char*)arena_alloc(arena, length + 1);
+    memcpy(copy, data, length);
+    copy[length] = '\0';
+    Text* text = (Text*)arena_alloc(arena, sizeof(Text));
+    text->length = length;
+    text->data = copy;
+    Value value;
+    value.type = TYPE_TEXTO;
+    value.as.t = text;
+    return value;
+}
+
+/* Valor inicial de uma variável declarada sem valor. */
+static void emit_default(Compiler* compiler, DataType type) {
+    Value value;
+    value.type = TYPE_INTEIRO;
+    value.as.i = 0;
+    if (type == TYPE_DECIMAL) {
+        if (compiler->zero_decimal < 0) {
+            value.type = TYPE_DECIMAL;
+            value.as.d = 0.0;
+            compiler->zero_decimal = add_constant(compiler, value);
+        }
+        emit_constant_index(compiler, compiler->zero_decimal);
+    } else if (type == TYPE_TEXTO) {
+        if (compiler->empty_text < 0) {
+            compiler->empty_text = add_constant(compiler, make_text(compiler, "", 0));
+        }
+        emit_constant_index(compiler, compiler->empty_text);
+    } else {
+        emit_constant(compiler, value);
+    }
+}
+
+/* Converte o topo para o tipo da variável; textos são cortados ao tamanho
+ * declarado. */
+static void emit_convert(Compiler* compiler, DataType target, DataType value, int size) {
+    if (target != value || value == TYPE_NENHUM) {
+        if (target == TYPE_INTEIRO) emit_op(compiler, OP_TO_I, 0);
+        else if (target == TYPE_DECIMAL) emit_op(compiler, OP_TO_D, 0);
+        else if (target == TYPE_TEXTO) emit_op(compiler, OP_TO_T, 0);
+    }
+    if (target == TYPE_TEXTO && size > 0 && size < MAX_SLOTS) {
+        emit_op_u16(compiler, OP_FIT_T, 0, (uint32_t)size);
+    }
+}
+
+/* --- Variáveis --- */
+
+static int declared_size(const Compiler* compiler, AstIndex declarator) {
+    const AstNode* node = node_at(compiler, declarator);
+    if (node->kind != AST_DECLARADOR || node->child[0] == AST_NULL) return 0;
+    return atoi(&compiler->ast->source[node_at(compiler, node->child[0])->offset]);
+}
+
+static VarRef resolve(Compiler* compiler, AstIndex var) {
+    VarRef ref = { 1, 0, TYPE_NENHUM, 0 };
+    int found = symtab_lookup(&compiler->symbols, node_at(compiler, var)->symbol);
+    if (found < 0) {
+        /* A análise semântica já garante que não acontece. */
+        return ref;
+    }
+    const Symbol* symbol = symtab_symbol(&compiler->symbols, found);
+    ref.global = symbol->depth == 0;
+    ref.slot = (uint16_t)compiler->slots[symbol->node];
+    ref.type = data_type_from_token((TokenType)symbol->type);
+    ref.size = ref.type == TYPE_TEXTO ? declared_size(compiler, symbol->node) : 0;
+    return ref;
+}
+
+static void emit_load(Compiler* compiler, VarRef ref) {
+    emit_op_u16(compiler, ref.global ? OP_LOAD_GLOBAL : OP_LOAD_LOCAL, 1, ref.slot);
+}
+
+/* keep: a atribuição é uma expressão e o valor continua na pilha. */
+static void emit_store(Compiler* compiler, VarRef ref, int keep) {
+    if (keep) {
+        emit_op_u16(compiler, ref.global ? OP_STORE_GLOBAL : OP_STORE_LOCAL, 0, ref.slot);
+    } else {
+        emit_op_u16(compiler, ref.global ? OP_SET_GLOBAL : OP_SET_LOCAL, -1, ref.slot);
+    }
+}
+
+static int allocate_slot(Compiler* compiler, int line) {
+    int slot = compiler->in_function ? compiler->locals++ : compiler->program->globals++;
+    if (slot >= MAX_SLOTS) {
+        diagnostics_add(compiler->diagnostics, DIAG_ERRO, line,
+                        "Variáveis demais (o limite é %d por função e %d globais)", MAX_SLOTS, MAX_SLOTS);
+        return 0;
+    }
+    return slot;
+}
+
+/* --- Expressões --- */
+
+static DataType compile_expression(Compiler* compiler, AstIndex index);
+
+static DataType compile_literal(Compiler* compiler, const AstNode* node) {
+    const char* text = &compiler->ast->source[node->offset];
+    Value value;
+    switch ((TokenType)node->op) {
+        case TOKEN_LITERAL_INT:
+            value.type = TYPE_INTEIRO;
+            value.as.i = ast_literal_int(compiler->ast, node);
+            break;
+        case TOKEN_LITERAL_DEC:
+            value.type = TYPE_DECIMAL;
+            value.as.d = ast_literal_decimal(compiler->ast, node);
+            break;
+        default:
+            value = make_text(compiler, text, node->length);
+            break;
+    }
+    emit_constant(compiler, value);
+    return (DataType)value.type;
+}
+
+static DataType compile_assignment(Compiler* compiler, AstIndex index, int keep) {
+    AstIndex target = node_at(compiler, index)->child[0];
+    AstIndex value = node_at(compiler, index)->child[1];
+    VarRef ref = resolve(compiler, target);
+    emit_convert(compiler, ref.type, compile_expression(compiler, value), ref.size);
+    emit_store(compiler, ref, keep);
+    return ref.type;
+}
+
+static DataType compile_increment(Compiler* compiler, AstIndex index, int keep) {
+    const AstNode* node = node_at(compiler, index);
+    VarRef ref = resolve(compiler, node->child[0]);
+    Opcode op = node->op == TOKEN_OP_INC
+        ? (ref.global ? OP_INC_GLOBAL : OP_INC_LOCAL)
+        : (ref.global ? OP_DEC_GLOBAL : OP_DEC_LOCAL);
+    int prefix = node->flags & AST_PREFIXO;
+    if (keep && !prefix) emit_load(compiler, ref);
+    emit_op_u16(compiler, op, 0, ref.slot);
+    if (keep && prefix) emit_load(compiler, ref);
+    return ref.type;
+}
+
+static int arithmetic_index(TokenType op) {
+    switch (op) {
+        case TOKEN_OP_SOMA: return 0;
+        case TOKEN_OP_SUB: return 1;
+        case TOKEN_OP_MULT: return 2;
+        case TOKEN_OP_DIV: return 3;
+        default: return 4; /* TOKEN_OP_EXP */
+    }
+}
+
+static int comparison_index(TokenType op) {
+    switch (op) {
+        case TOKEN_OP_IGUAL: return 0;
+        case TOKEN_OP_DIF: return 1;
+        case TOKEN_OP_MENOR: return 2;
+        case TOKEN_OP_MENOR_IGUAL: return 3;
+        case TOKEN_OP_MAIOR: return 4;
+        case TOKEN_OP_MAIOR_IGUAL: return 5;
+        default: return -1;
+    }
+}
+
+static int is_numeric(DataType type) {
+    return type == TYPE_INTEIRO || type == TYPE_DECIMAL;
+}
+
+/* Família da instrução: 0 = _I, 1 = _D, 2 = genérica. */
+static int operand_family(DataType left, DataType right) {
+    if (left == TYPE_INTEIRO && right == TYPE_INTEIRO) return 0;
+    if (is_numeric(left) && is_numeric(right)) return 1;
+    return 2;
+}
+
+/* Empilha os dois operandos, promovendo inteiros a decimal quando a
+ * família é _D. */
+static int compile_operands(Compiler* compiler, AstIndex left, AstIndex right) {
+    int family = operand_family(static_type(compiler, left), static_type(compiler, right));
+    DataType type = compile_expression(compiler, left);
+    if (family == 1 && type == TYPE_INTEIRO) emit_op(compiler, OP_TO_D, 0);
+    type = compile_expression(compiler, right);
+    if (family == 1 && type == TYPE_INTEIRO) emit_op(compiler, OP_TO_D, 0);
+    return family;
+}
+
+/* "a && b" e "a || b" com curto-circuito; o resultado é 0 ou 1. */
+static DataType compile_logic(Compiler* compiler, AstIndex index) {
+    const AstNode* node = node_at(compiler, index);
+    int is_and = node->op == TOKEN_OP_E;
+    AstIndex right = node->child[1];
+    compile_expression(compiler, node->child[0]);
+    uint32_t short_circuit = emit_jump(compiler, is_and ? OP_JUMP_IF_FALSE : OP_JUMP_IF_TRUE, -1);
+    compile_expression(compiler, right);
+    emit_op(compiler, OP_BOOL, 0);
+    uint32_t end = emit_jump(compiler, OP_JUMP, 0);
+    compiler->depth--;
+    patch_jump(compiler, short_circuit);
+    emit_op(compiler, OP_INT, 1);
+    emit_u32(compiler, is_and ? 0 : 1);
+    patch_jump(compiler, end);
+    return TYPE_INTEIRO;
+}
+
+static DataType compile_binary(Compiler* compiler, AstIndex index) {
+    const AstNode* node = node_at(compiler, index);
+    TokenType op = (TokenType)node->op;
+    if (op == TOKEN_OP_E || op == TOKEN_OP_OU) {
+        return compile_logic(compiler, index);
+    }
+    int family = compile_operands(compiler, node->child[0], node->child[1]);
+    int comparison = comparison_index(op);
+    if (comparison >= 0) {
+        emit_op(compiler, (Opcode)(OP_EQ_I + 6 * family + comparison), -1);
+        return TYPE_INTEIRO;
+    }
+    emit_op(compiler, (Opcode)(OP_ADD_I + 6 * family + arithmetic_index(op)), -1);
+    return family == 0 ? TYPE_INTEIRO : family == 1 ? TYPE_DECIMAL : TYPE_NENHUM;
+}
+
+static DataType compile_call(Compiler* compiler, AstIndex index) {
+    const AstNode* call = node_at(compiler, index);
+    int found = symtab_lookup(&compiler->symbols, call->symbol);
+    AstIndex function = symtab_symbol(&compiler->symbols, found)->node;
+    AstIndex param = node_at(compiler, function)->child[0];
+    int argc = 0;
+    for (AstIndex arg = call->child[0]; arg != AST_NULL; arg = node_at(compiler, arg)->next) {
+        DataType type = compile_expression(compiler, arg);
+        DataType target = data_type_from_token((TokenType)node_at(compiler, param)->op);
+        emit_convert(compiler, target, type, 0);
+        param = node_at(compiler, param)->next;
+        argc++;
+    }
+    emit_op_u16(compiler, OP_CALL, 1 - argc, compiler->slots[function]);
+    return static_type(compiler, index);
+}
+
+static DataType compile_expression(Compiler* compiler, AstIndex index) {
+    const AstNode* node = node_at(compiler, index);
+    mark_line(compiler, node->line);
+    switch ((AstKind)node->kind) {
+        case AST_LITERAL:
+            return compile_literal(compiler, node);
+        case AST_VARIAVEL: {
+            VarRef ref = resolve(compiler, index);
+            emit_load(compiler, ref);
+            return ref.type;
+        }
+        case AST_ATRIBUICAO:
+            return compile_assignment(compiler, index, 1);
+        case AST_INCREMENTO:
+            return compile_increment(compiler, index, 1);
+        case AST_BINARIO:
+            return compile_binary(compiler, index);
+        case AST_UNARIO: {
+            DataType type = compile_expression(compiler, node->child[0]);
+            int family = operand_family(type, type);
+            emit_op(compiler, (Opcode)(OP_NEG_I + 6 * family), 0);
+            return family == 2 ? TYPE_NENHUM : type;
+        }
+        case AST_CHAMADA:
+            return compile_call(compiler, index);
+        default:
+            emit_default(compiler, TYPE_INTEIRO);
+            return TYPE_INTEIRO;
+    }
+}
+
+/* Expressão usada como comando: o valor é descartado. */
+static void compile_effect(Compiler* compiler, AstIndex index) {
+    const AstNode* node = node_at(compiler, index);
+    mark_line(compiler, node->line);
+    if (node->kind == AST_ATRIBUICAO) {
+        compile_assignment(compiler, index, 0);
+    } else if (node->kind == AST_INCREMENTO) {
+        compile_increment(compiler, index, 0);
+    } else {
+        compile_expression(compiler, index);
+        emit_op(compiler, OP_POP, -1);
+    }
+}
+
+/* Salta para target se a condição for verdadeira. Comparações entre
+ * inteiros viram uma só instrução. */
+static void compile_branch_if_true(Compiler* compiler, AstIndex condition, uint32_t target) {
+    const AstNode* node = node_at(compiler, condition);
+    int comparison = node->kind == AST_BINARIO ? comparison_index((TokenType)node->op) : -1;
+    if (comparison >= 0 &&
+        operand_family(static_type(compiler, node->child[0]), static_type(compiler, node->child[1])) == 0) {
+        mark_line(compiler, node->line);
+        compile_operands(compiler, node->child[0], node->child[1]);
+        emit_jump_to(compiler, (Opcode)(OP_JUMP_IF_EQ_I + comparison), -2, target);
+        return;
+    }
+    compile_expression(compiler, condition);
+    emit_jump_to(compiler, OP_JUMP_IF_TRUE, -1, target);
+}
+
+/* --- Comandos --- */
+
+static void compile_statement(Compiler* compiler, AstIndex index);
+
+static void compile_statements(Compiler* compiler, AstIndex first) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(compiler, item)->next) {
+        compile_statement(compiler, item);
+    }
+}
+
+static void compile_declaration(Compiler* compiler, AstIndex index) {
+    TokenType token_type = (TokenType)node_at(compiler, index)->op;
+    DataType type = data_type_from_token(token_type);
+    for (AstIndex declarator = node_at(compiler, index)->child[0]; declarator != AST_NULL;
+         declarator = node_at(compiler, declarator)->next) {
+        const AstNode* node = node_at(compiler, declarator);
+        mark_line(compiler, node->line);
+        int size = type == TYPE_TEXTO ? declared_size(compiler, declarator) : 0;
+        if (node->child[1] != AST_NULL) {
+            emit_convert(compiler, type, compile_expression(compiler, node->child[1]), size);
+        } else {
+            emit_default(compiler, type);
+        }
+
+        VarRef ref = { !compiler->in_function, 0, type, size };
+        ref.slot = (uint16_t)allocate_slot(compiler, node->line);
+        compiler->slots[declarator] = ref.slot;
+        symtab_declare(&compiler->symbols, node->symbol, SYMBOL_VARIAVEL, token_type, declarator);
+        emit_store(compiler, ref, 0);
+    }
+}
+
+static void compile_if(Compiler* compiler, const AstNode* node) {
+    AstIndex else_branch = node->child[2];
+    AstIndex then_branch = node->child[1];
+    compile_expression(compiler, node->child[0]);
+    uint32_t skip_then = emit_jump(compiler, OP_JUMP_IF_FALSE, -1);
+    compile_statement(compiler, then_branch);
+    if (else_branch == AST_NULL) {
+        patch_jump(compiler, skip_then);
+        return;
+    }
+    uint32_t skip_else = emit_jump(compiler, OP_JUMP, 0);
+    patch_jump(compiler, skip_then);
+    compile_statement(compiler, else_branch);
+    patch_jump(compiler, skip_else);
+}
+
+/* O teste fica depois do corpo: cada volta executa um único salto
+ * condicional. */
+static void compile_for(Compiler* compiler, const AstNode* node) {
+    AstIndex parts[4] = { node->child[0], node->child[1], node->child[2], node->child[3] };
+    for (AstIndex init = parts[0]; init != AST_NULL; init = node_at(compiler, init)->next) {
+        compile_effect(compiler, init);
+    }
+    uint32_t to_condition = emit_jump(compiler, OP_JUMP, 0);
+    uint32_t body = compiler->program->count;
+    compile_statement(compiler, parts[3]);
+    for (AstIndex update = parts[2]; update != AST_NULL; update = node_at(compiler, update)->next) {
+        compile_effect(compiler, update);
+    }
+    patch_jump(compiler, to_condition);
+    if (parts[1] != AST_NULL) {
+        compile_branch_if_true(compiler, parts[1], body);
+    } else {
+        emit_jump_to(compiler, OP_JUMP, 0, body);
+    }
+}
+
+static void compile_statement(Compiler* compiler, AstIndex index) {
+    const AstNode* node = node_at(compiler, index);
+    mark_line(compiler, node->line);
+    switch ((AstKind)node->kind) {
+        case AST_BLOCO:
+            symtab_enter(&compiler->symbols);
+            compile_statements(compiler, node->child[0]);
+            symtab_leave(&compiler->symbols);
+            break;
+        case AST_DECLARACAO:
+            compile_declaration(compiler, index);
+            break;
+        case AST_SE:
+            compile_if(compiler, node);
+            break;
+        case AST_PARA:
+            compile_for(compiler, node);
+            break;
+        case AST_LEIA:
+            for (AstIndex var = node->child[0]; var != AST_NULL; var = node_at(compiler, var)->next) {
+                VarRef ref = resolve(compiler, var);
+                emit_op(compiler, OP_READ, 1);
+                emit_byte(compiler, (uint8_t)ref.type);
+                emit_convert(compiler, ref.type, ref.type, ref.size);
+                emit_store(compiler, ref, 0);
+            }
+            break;
+        case AST_ESCREVA:
+            for (AstIndex expr = node->child[0]; expr != AST_NULL; expr = node_at(compiler, expr)->next) {
+                compile_expression(compiler, expr);
+                emit_op(compiler, OP_PRINT, -1);
+            }
+            emit_op(compiler, OP_PRINT_NL, 0);
+            break;
+        case AST_RETORNO:
+            compile_expression(compiler, node->child[0]);
+            emit_op(compiler, OP_RETURN, -1);
+            break;
+        case AST_EXPRESSAO:
+            compile_effect(compiler, node->child[0]);
+            break;
+        default:
+            break;
+    }
+}
+
+/* --- Funções e Programa --- */
+
+static void compile_function(Compiler* compiler, AstIndex index, FunctionInfo* info) {
+    const AstNode* node = node_at(compiler, index);
+    AstIndex body = node->child[1];
+    info->entry = compiler->program->count;
+    info->name = node->symbol;
+    compiler->in_function = 1;
+    compiler->locals = 0;
+    compiler->depth = 0;
+    compiler->max_depth = 0;
+
+    symtab_enter(&compiler->symbols);
+    for (AstIndex param = node->child[0]; param != AST_NULL; param = node_at(compiler, param)->next) {
+        compiler->slots[param] = (uint32_t)allocate_slot(compiler, node->line);
+        symtab_declare(&compiler->symbols, node_at(compiler, param)->symbol, SYMBOL_PARAMETRO,
+                       node_at(compiler, param)->op, param);
+    }
+    info->params = (uint16_t)compiler->locals;
+    compile_statements(compiler, node_at(compiler, body)->child[0]);
+    symtab_leave(&compiler->symbols);
+
+    /* Caminhos que chegam ao fim sem retorno devolvem 0. */
+    emit_default(compiler, TYPE_INTEIRO);
+    emit_op(compiler, OP_RETURN, -1);
+    info->locals = (uint16_t)compiler->locals;
+    info->max_stack = (uint32_t)(compiler->locals + compiler->max_depth);
+}
+
+static void program_init(Program* program, Arena* arena) {
+    program->arena = arena;
+    program->capacity = PROGRAM_INITIAL_CODE;
+    program->code = (uint8_t*)arena_alloc(arena, program->capacity);
+    program->count = 0;
+    program->constants_capacity = PROGRAM_INITIAL_CONSTANTS;
+    program->constants = (Value*)arena_alloc(arena, program->constants_capacity * sizeof(Value));
+    program->constants_count = 0;
+    program->lines_capacity = PROGRAM_INITIAL_LINES;
+    program->lines = (LineEntry*)arena_alloc(arena, program->lines_capacity * sizeof(LineEntry));
+    program->lines_count = 0;
+    program->globals = 0;
+    program->functions = NULL;
+    program->functions_count = 0;
+    program->entry_max_stack = 0;
+}
+
+static void compiler_init(Compiler* compiler, const Ast* ast, Program* program,
+                          Diagnostics* diagnostics, uint32_t* slots, Arena* arena) {
+    compiler->ast = ast;
+    compiler->program = program;
+    compiler->fragment = NULL;
+    compiler->diagnostics = diagnostics;
+    compiler->slots = slots;
+    compiler->in_function = 0;
+    compiler->locals = 0;
+    compiler->depth = 0;
+    compiler->max_depth = 0;
+    compiler->last_line = 0;
+    compiler->zero_decimal = -1;
+    compiler->empty_text = -1;
+    symtab_init(&compiler->symbols, ast->interner, arena);
+}
+
+/* Numera as funções (principal é a última), gera a entrada (globais na
+ * ordem do código, depois a chamada a principal) e aloca a tabela de
+ * funções. */
+static void compile_entry(Compiler* compiler, Arena* arena) {
+    const Ast* ast = compiler->ast;
+    Program* program = compiler->program;
+    AstIndex first = ast_node(ast, ast->root)->child[0];
+    AstIndex principal = AST_NULL;
+    int functions = 0;
+    for (AstIndex item = first; item != AST_NULL; item = node_at(compiler, item)->next) {
+        const AstNode* node = node_at(compiler, item);
+        if (node->kind == AST_FUNCAO) {
+            compiler->slots[item] = (uint32_t)functions++;
+            symtab_declare(&compiler->symbols, node->symbol, SYMBOL_FUNCAO, TOKEN_EOF, item);
+        } else if (node->kind == AST_PRINCIPAL) {
+            principal = item;
+        }
+    }
+    compiler->slots[principal] = (uint32_t)functions++;
+    program->functions_count = functions;
+    program->functions = (FunctionInfo*)arena_alloc(arena, functions * sizeof(FunctionInfo));
+
+    for (AstIndex item = first; item != AST_NULL; item = node_at(compiler, item)->next) {
+        if (node_at(compiler, item)->kind == AST_DECLARACAO) {
+            compile_declaration(compiler, item);
+        }
+    }
+    mark_line(compiler, node_at(compiler, principal)->line);
+    emit_op_u16(compiler, OP_CALL, 1, compiler->slots[principal]);
+    emit_op(compiler, OP_POP, -1);
+    emit_op(compiler, OP_HALT, 0);
+    program->entry_max_stack = (uint32_t)compiler->max_depth;
+}
+
+int compile_program(const Ast* ast, Program* program, Diagnostics* diagnostics, Arena* arena) {
+    program_init(program, arena);
+    Compiler compiler;
+    uint32_t* slots = (uint32_t*)arena_alloc(arena, ast->count * sizeof(uint32_t));
+    compiler_init(&compiler, ast, program, diagnostics, slots, arena);
+    int errors_before = diagnostics->errors;
+
+    compile_entry(&compiler, arena);
+    AstIndex first = ast_node(ast, ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&compiler, item)->next) {
+        AstKind kind = (AstKind)node_at(&compiler, item)->kind;
+        if (kind == AST_FUNCAO || kind == AST_PRINCIPAL) {
+            compile_function(&compiler, item, &program->functions[compiler.slots[item]]);
+        }
+    }
+    return diagnostics->errors - errors_before;
+}
+
+/* --- Geração Paralela --- */
+
+/* Cada função é gerada num Program próprio, a partir da posição 0 e com
+ * suas próprias constantes. Os operandos que dependem dessas posições
+ * (destinos de salto e índices de constantes) são anotados para serem
+ * corrigidos quando o código é copiado para o programa final. */
+typedef struct {
+    uint32_t offset;    /* posição do operando u32 */
+    int constant;       /* 1: índice de constante; 0: destino de salto */
+} Relocation;
+
+struct FunctionCode {
+    AstIndex function;
+    Program program;
+    FunctionInfo info;
+    Relocation* relocations;
+    int relocations_count;
+    int relocations_capacity;
+    int zero_decimal;   /* constantes padrão da função, ou -1 */
+    int empty_text;
+    Diagnostics* diagnostics;
+    int first_diagnostic;
+    int diagnostics_count;
+};
+
+static void note_operand(Compiler* compiler, int constant) {
+    FunctionCode* code = compiler->fragment;
+    if (code == NULL) return;
+    if (code->relocations_count == code->relocations_capacity) {
+        int capacity = code->relocations_capacity > 0 ? 2 * code->relocations_capacity : 64;
+        code->relocations = (Relocation*)arena_grow(code->program.arena, code->relocations,
+                                                    code->relocations_capacity * sizeof(Relocation),
+                                                    capacity * sizeof(Relocation));
+        code->relocations_capacity = capacity;
+    }
+    code->relocations[code->relocations_count].offset = compiler->program->count;
+    code->relocations[code->relocations_count].constant = constant;
+    code->relocations_count++;
+}
+
+typedef struct {
+    Compiler compiler;
+    Diagnostics diagnostics;
+    int started;
+} CompileWorker;
+
+typedef struct {
+    const Ast* ast;
+    uint32_t* slots;
+    FunctionCode* functions;    /* funções e principal, na ordem do código */
+    int count;
+    atomic_int next;
+    CompileWorker* workers;
+    Arena* worker_arenas;
+} ParallelCompile;
+
+/* A tabela de cada trabalhador tem as funções e todas as globais, como a
+ * da geração serial depois da entrada; os slots são os mesmos, do vetor
+ * comum (cada nó só é escrito por quem gera a sua função). */
+static void compile_worker(void* arg) {
+    ParallelCompile* job = (ParallelCompile*)arg;
+    int index = pool_worker_index();
+    CompileWorker* worker = &job->workers[index];
+    Compiler* compiler = &worker->compiler;
+    Arena* arena = &job->worker_arenas[index];
+    if (!worker->started) {
+        diagnostics_init(&worker->diagnostics, arena);
+        compiler_init(compiler, job->ast, NULL, &worker->diagnostics, job->slots, arena);
+        AstIndex first = ast_node(job->ast, job->ast->root)->child[0];
+        for (AstIndex item = first; item != AST_NULL; item = node_at(compiler, item)->next) {
+            const AstNode* node = node_at(compiler, item);
+            if (node->kind == AST_FUNCAO) {
+                symtab_declare(&compiler->symbols, node->symbol, SYMBOL_FUNCAO, TOKEN_EOF, item);
+            } else if (node->kind == AST_DECLARACAO) {
+                for (AstIndex declarator = node->child[0]; declarator != AST_NULL;
+                     declarator = node_at(compiler, declarator)->next) {
+                    symtab_declare(&compiler->symbols, node_at(compiler, declarator)->symbol,
+                                   SYMBOL_VARIAVEL, node->op, declarator);
+                }
+            }
+        }
+        worker->started = 1;
+    }
+
+    for (;;) {
+        int position = atomic_fetch_add(&job->next, 1);
+        if (position >= job->count) break;
+        FunctionCode* code = &job->functions[position];
+        program_init(&code->program, arena);
+        code->relocations = NULL;
+        code->relocations_count = 0;
+        code->relocations_capacity = 0;
+        compiler->program = &code->program;
+        compiler->fragment = code;
+        compiler->last_line = 0;
+        compiler->zero_decimal = -1;
+        compiler->empty_text = -1;
+        code->diagnostics = &worker->diagnostics;
+        code->first_diagnostic = worker->diagnostics.count;
+        compile_function(compiler, code->function, &code->info);
+        code->diagnostics_count = worker->diagnostics.count - code->first_diagnostic;
+        code->zero_decimal = compiler->zero_decimal;
+        code->empty_text = compiler->empty_text;
+    }
+}
+
+/* Constante de uma função no programa final. As constantes padrão são
+ * compartilhadas, como na geração serial, e as outras entram na ordem em
+ * que a função as criou: o vetor final é o mesmo. */
+static int merge_constant(Compiler* compiler, const FunctionCode* code, int index) {
+    if (index == code->zero_decimal) {
+        if (compiler->zero_decimal < 0) {
+            compiler->zero_decimal = add_constant(compiler, code->program.constants[index]);
+        }
+        return compiler->zero_decimal;
+    }
+    if (index == code->empty_text) {
+        if (compiler->empty_text < 0) {
+            compiler->empty_text = add_constant(compiler, code->program.constants[index]);
+        }
+        return compiler->empty_text;
+    }
+    return add_constant(compiler, code->program.constants[index]);
+}
+
+static void merge_function(Compiler* compiler, const FunctionCode* code, int* constants) {
+    Program* program = compiler->program;
+    const Program* source = &code->program;
+    uint32_t base = program->count;
+
+    for (uint32_t i = 0; i < source->constants_count; i++) {
+        constants[i] = merge_constant(compiler, code, (int)i);
+    }
+    while (program->capacity < base + source->count) {
+        program->code = (uint8_t*)arena_grow(program->arena, program->code,
+                                             program->capacity, 2 * program->capacity);
+        program->capacity *= 2;
+    }
+    memcpy(&program->code[base], source->code, source->count);
+    program->count = base + source->count;
+    for (int r = 0; r < code->relocations_count; r++) {
+        const Relocation* relocation = &code->relocations[r];
+        uint32_t offset = base + relocation->offset;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= (uint32_t)program->code[offset + i] << (8 * i);
+        }
+        patch_u32(compiler, offset, relocation->constant ? (uint32_t)constants[value] : base + value);
+    }
+
+    /* As linhas passam por mark_line, que descarta as repetidas. */
+    uint32_t end = program->count;
+    for (int l = 0; l < source->lines_count; l++) {
+        program->count = base + source->lines[l].offset;
+        mark_line(compiler, source->lines[l].line);
+    }
+    program->count = end;
+
+    FunctionInfo* info = &program->functions[compiler->slots[code->function]];
+    *info = code->info;
+    info->entry += base;
+}
+
+int compile_program_parallel(const Ast* ast, Program* program, Diagnostics* diagnostics,
+                             ThreadPool* pool, Arena* worker_arenas, Arena* arena) {
+    program_init(program, arena);
+    Compiler compiler;
+    uint32_t* slots = (uint32_t*)arena_alloc(arena, ast->count * sizeof(uint32_t));
+    compiler_init(&compiler, ast, program, diagnostics, slots, arena);
+    int errors_before = diagnostics->errors;
+    compile_entry(&compiler, arena);
+
+    ParallelCompile job;
+    job.ast = ast;
+    job.slots = slots;
+    job.count = program->functions_count;
+    job.functions = (FunctionCode*)arena_alloc(arena, job.count * sizeof(FunctionCode));
+    int position = 0;
+    AstIndex first = ast_node(ast, ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&compiler, item)->next) {
+        AstKind kind = (AstKind)node_at(&compiler, item)->kind;
+        if (kind == AST_FUNCAO || kind == AST_PRINCIPAL) {
+            job.functions[position++].function = item;
+        }
+    }
+    atomic_init(&job.next, 0);
+    int workers = pool_size(pool);
+    job.workers = (CompileWorker*)arena_alloc(arena, workers * sizeof(CompileWorker));
+    memset(job.workers, 0, workers * sizeof(CompileWorker));
+    job.worker_arenas = worker_arenas;
+
+    for (int w = 0; w < workers; w++) {
+        pool_submit(pool, compile_worker, &job);
+    }
+    pool_wait(pool);
+
+    uint32_t constants_capacity = 0;
+    for (int f = 0; f < job.count; f++) {
+        if (job.functions[f].program.constants_count > constants_capacity) {
+            constants_capacity = job.functions[f].program.constants_count;
+        }
+    }
+    int* constants = (int*)arena_alloc(arena, (constants_capacity + 1) * sizeof(int));
+    for (int f = 0; f < job.count; f++) {
+        const FunctionCode* code = &job.functions[f];
+        merge_function(&compiler, code, constants);
+        diagnostics_append(diagnostics, code->diagnostics, code->first_diagnostic, code->diagnostics_count);
+    }
+    return diagnostics->errors - errors_before;
+}
+
+int program_line(const Program* program, uint32_t offset) {
+    int low = 0;
+    int high = program->lines_count - 1;
+    int line = 0;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (program->lines[middle].offset <= offset) {
+            line = program->lines[middle].line;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return line;
+}
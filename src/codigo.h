@@ -0,0 +1,132 @@
+#ifndef CODIGO_H
+#define CODIGO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ast.h"
+#include "semantico.h"
+#include "diagnostico.h"
+#include "paralelo.h"
+
+/* --- Valores --- */
+
+/* Textos são imutáveis e ficam em arenas; cortar um texto ao tamanho da
+ * variável só cria outra visão sobre os mesmos bytes. */
+typedef struct {
+    int length;
+    const char* data;
+} Text;
+
+/* inteiro e decimal são guardados diretamente no valor, sem alocação; o
+ * tipo (DataType) só é consultado pelas instruções genéricas. */
+typedef struct {
+    uint8_t type;
+    union {
+        int64_t i;
+        double d;
+        const Text* t;
+    } as;
+} Value;
+
+/* --- Código de Máquina Virtual --- */
+
+/* Máquina de pilha. Cada instrução é um byte, seguido dos operandos em
+ * little-endian: s = slot ou função (u16), c = constante ou destino de
+ * salto (u32), n = inteiro imediato (i32), t = DataType (u8).
+ *
+ * Instruções _I e _D são escolhidas pelo compilador quando os tipos dos
+ * operandos são conhecidos (a análise semântica os anota na árvore); as
+ * genéricas consultam o tipo de cada valor em tempo de execução. As
+ * comparações empilham o inteiro 0 ou 1. */
+#define OPCODES(X) \
+    X(INT)           /* n: empilha um inteiro */                          \
+    X(CONST)         /* c: empilha uma constante */                       \
+    X(LOAD_LOCAL)    /* s */                                              \
+    X(STORE_LOCAL)   /* s: guarda o topo sem desempilhar */               \
+    X(SET_LOCAL)     /* s: guarda e desempilha */                         \
+    X(LOAD_GLOBAL)   /* s */                                              \
+    X(STORE_GLOBAL)  /* s */                                              \
+    X(SET_GLOBAL)    /* s */                                              \
+    X(INC_LOCAL) X(DEC_LOCAL) X(INC_GLOBAL) X(DEC_GLOBAL) /* s */         \
+    X(POP)                                                                \
+    X(ADD_I) X(SUB_I) X(MUL_I) X(DIV_I) X(POW_I) X(NEG_I)                 \
+    X(ADD_D) X(SUB_D) X(MUL_D) X(DIV_D) X(POW_D) X(NEG_D)                 \
+    X(ADD) X(SUB) X(MUL) X(DIV) X(POW) X(NEG)                             \
+    X(EQ_I) X(NE_I) X(LT_I) X(LE_I) X(GT_I) X(GE_I)                       \
+    X(EQ_D) X(NE_D) X(LT_D) X(LE_D) X(GT_D) X(GE_D)                       \
+    X(EQ) X(NE) X(LT) X(LE) X(GT) X(GE)                                   \
+    X(TO_I) X(TO_D) X(TO_T)  /* converte o topo */                        \
+    X(FIT_T)         /* s: corta o texto do topo a s caracteres */        \
+    X(BOOL)          /* topo vira 0 ou 1 */                               \
+    X(JUMP)          /* c */                                              \
+    X(JUMP_IF_FALSE) /* c: desempilha */                                  \
+    X(JUMP_IF_TRUE)  /* c: desempilha */                                  \
+    /* c: comparam e desempilham os dois inteiros do topo e saltam se a  \
+     * comparação for verdadeira (condição do laço "para") */            \
+    X(JUMP_IF_EQ_I) X(JUMP_IF_NE_I) X(JUMP_IF_LT_I)                       \
+    X(JUMP_IF_LE_I) X(JUMP_IF_GT_I) X(JUMP_IF_GE_I)                       \
+    X(CALL)          /* s: função; os argumentos estão no topo */         \
+    X(RETURN)        /* devolve o topo ao chamador */                     \
+    X(PRINT)         /* escreve e desempilha o topo */                    \
+    X(PRINT_NL)                                                           \
+    X(READ)          /* t: lê um valor da entrada e o empilha */          \
+    X(HALT)
+
+#define OPCODE_ENUM(name) OP_##name,
+typedef enum {
+    OPCODES(OPCODE_ENUM)
+    OP_COUNT
+} Opcode;
+#undef OPCODE_ENUM
+
+typedef struct {
+    uint32_t entry;     /* posição da primeira instrução */
+    uint16_t params;
+    uint16_t locals;    /* parâmetros + variáveis locais */
+    uint32_t max_stack; /* locals + maior profundidade da pilha */
+    SymbolId name;
+} FunctionInfo;
+
+/* Tabela de linhas: só as posições em que a linha muda. */
+typedef struct {
+    uint32_t offset;
+    int line;
+} LineEntry;
+
+/* O programa começa em code[0], que inicializa as globais, chama
+ * principal e termina em OP_HALT. */
+typedef struct {
+    uint8_t* code;
+    uint32_t count;
+    uint32_t capacity;
+    Value* constants;
+    uint32_t constants_count;
+    uint32_t constants_capacity;
+    FunctionInfo* functions;
+    int functions_count;
+    uint16_t globals;
+    uint32_t entry_max_stack;
+    LineEntry* lines;
+    int lines_count;
+    int lines_capacity;
+    Arena* arena;
+} Program;
+
+/* Gera o código de uma árvore já verificada, sem erros semânticos.
+ * Programas que excedem os limites do formato (65535 variáveis numa
+ * função, por exemplo) geram erros em diagnostics. Retorna o número de
+ * erros. */
+int compile_program(const Ast* ast, Program* program, Diagnostics* diagnostics, Arena* arena);
+
+/* Como compile_program, com as funções geradas em paralelo no pool, cada
+ * uma num código próprio em worker_arenas[pool_worker_index()], e copiadas
+ * na ordem do código para program. O programa é o mesmo da geração
+ * serial; textos constantes ficam nas arenas dos trabalhadores, que
+ * precisam durar tanto quanto program. */
+int compile_program_parallel(const Ast* ast, Program* program, Diagnostics* diagnostics,
+                             ThreadPool* pool, Arena* worker_arenas, Arena* arena);
+
+/* Linha do código-fonte da instrução em offset. */
+int program_line(const Program* program, uint32_t offset);
+
+#endif
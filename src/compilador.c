@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <setjmp.h>
+#include <pthread.h>
+#include "memoria.h"
+#include "lexico.h"
+#include "varredura.h"
+#include "compilador.h"
+
+/* Tokens convertidos de cada vez por compilador_lexer_next. */
+#define LIBRARY_BATCH 256
+
+struct CompiladorLexer {
+    MemoryContext memory;
+    Arena arena;
+    LexerContext lexer;
+    char* copy;             /* cópia do buffer (COMPILADOR_COPIAR), ou NULL */
+    Token last;
+    int failed;             /* faltou memória */
+    jmp_buf recover;
+};
+
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+int compilador_api_version(void) {
+    return COMPILADOR_API_VERSION;
+}
+
+/* O contexto e a cópia vêm do sistema, fora do orçamento: só a análise é
+ * contabilizada no MemoryContext do contexto. */
+CompiladorLexer* compilador_lexer_create(const char* buffer, long length, int options) {
+    if (buffer == NULL || length < 0 || length > INT_MAX - 1) return NULL;
+    pthread_once(&kernels_once, scan_init);
+
+    CompiladorLexer* lexer = (CompiladorLexer*)calloc(1, sizeof(CompiladorLexer));
+    if (lexer == NULL) return NULL;
+    if (options & COMPILADOR_COPIAR) {
+        lexer->copy = (char*)malloc(length + 1);
+        if (lexer->copy == NULL) {
+            free(lexer);
+            return NULL;
+        }
+        memcpy(lexer->copy, buffer, length);
+        lexer->copy[length] = '\0';
+        buffer = lexer->copy;
+    }
+    memory_context_init(&lexer->memory);
+    lexer->memory.recover = &lexer->recover;
+    arena_init(&lexer->arena, &lexer->memory);
+    lexer_init(&lexer->lexer, buffer, &lexer->arena);
+    lexer->last.type = TOKEN_EOF;
+    return lexer;
+}
+
+void compilador_lexer_destroy(CompiladorLexer* lexer) {
+    if (lexer == NULL) return;
+    arena_destroy(&lexer->arena);
+    free(lexer->copy);
+    free(lexer);
+}
+
+void compilador_lexer_set_memory_limit(CompiladorLexer* lexer, long bytes) {
+    lexer->memory.budget = bytes;
+}
+
+/* Os tokens passam por um lote de Token e são convertidos campo a campo:
+ * CompiladorToken não depende do formato interno. */
+int compilador_lexer_next(CompiladorLexer* lexer, CompiladorToken* tokens, int max) {
+    if (lexer->failed) return -1;
+    if (setjmp(lexer->recover) != 0) {
+        lexer->failed = 1;
+        return -1;
+    }
+    Token batch[LIBRARY_BATCH];
+    int written = 0;
+    while (written < max) {
+        int wanted = max - written < LIBRARY_BATCH ? max - written : LIBRARY_BATCH;
+        int count = get_next_tokens(&lexer->lexer, batch, wanted);
+        for (int i = 0; i < count; i++) {
+            CompiladorToken* token = &tokens[written + i];
+            token->type = (int)batch[i].type;
+            token->offset = batch[i].offset;
+            token->length = batch[i].length;
+            token->line = batch[i].line;
+        }
+        written += count;
+        if (count > 0) lexer->last = batch[count - 1];
+        if (count < wanted) break;
+    }
+    return written;
+}
+
+int compilador_lexer_diagnostic(const CompiladorLexer* lexer, CompiladorDiagnostic* diagnostic) {
+    if (lexer->failed) {
+        diagnostic->line = lexer->lexer.line;
+        diagnostic->offset = -1;
+        diagnostic->message = "Memória insuficiente para a análise";
+        return 1;
+    }
+    if (lexer->last.type != TOKEN_ERRO) return 0;
+    diagnostic->line = lexer->last.line;
+    diagnostic->offset = lexer->last.offset;
+    diagnostic->message = lexer->lexer.error_msg;
+    return 1;
+}
+
+long compilador_lexer_max_memory(const CompiladorLexer* lexer) {
+    return lexer->memory.max_used;
+}
+
+const char* compilador_token_name(int type) {
+    if (type < TOKEN_EOF || type > TOKEN_PONTO) return NULL;
+    return token_type_to_string((TokenType)type);
+}
@@ -0,0 +1,79 @@
+#ifndef COMPILADOR_H
+#define COMPILADOR_H
+
+/* --- Biblioteca do Analisador Léxico --- */
+
+/* Interface estável para usar o analisador léxico dentro de outro
+ * programa (build/libcompilador.a ou .so). Não depende dos cabeçalhos
+ * internos de src/: tipos e funções daqui só mudam com
+ * COMPILADOR_API_VERSION. Não há estado global escondido nem exit():
+ * cada contexto é independente, e contextos diferentes podem ser usados
+ * ao mesmo tempo em threads diferentes. A biblioteca não escreve nada na
+ * saída. */
+
+#define COMPILADOR_API_VERSION 1
+
+/* Na biblioteca compartilhada, compilada com -fvisibility=hidden, só
+ * estas funções são exportadas. */
+#if defined(__GNUC__)
+#define COMPILADOR_API __attribute__((visibility("default")))
+#else
+#define COMPILADOR_API
+#endif
+
+/* Os tipos seguem a ordem de TokenType e novos tipos só entram no fim;
+ * compilador_token_name dá o nome de cada um. */
+#define COMPILADOR_TOKEN_EOF 0
+#define COMPILADOR_TOKEN_ERRO 1
+
+/* Token sem cópia: o lexema é buffer[offset, offset + length). Num texto,
+ * o trecho não inclui as aspas. */
+typedef struct {
+    int type;
+    int offset;
+    int length;
+    int line;
+} CompiladorToken;
+
+typedef struct {
+    int line;
+    int offset;             /* início do trecho rejeitado, ou -1 */
+    const char* message;    /* válida até a próxima chamada com o contexto */
+} CompiladorDiagnostic;
+
+/* Opções de compilador_lexer_create. */
+#define COMPILADOR_COPIAR 1     /* o contexto guarda uma cópia do buffer */
+
+typedef struct CompiladorLexer CompiladorLexer;
+
+COMPILADOR_API int compilador_api_version(void);
+
+/* Cria um contexto sobre buffer[0, length). Sem COMPILADOR_COPIAR, o
+ * buffer é usado sem cópia: buffer[length] deve ser '\0' e o buffer deve
+ * existir até compilador_lexer_destroy. Retorna NULL se faltar memória ou
+ * se length passar de INT_MAX. */
+COMPILADOR_API CompiladorLexer* compilador_lexer_create(const char* buffer, long length, int options);
+COMPILADOR_API void compilador_lexer_destroy(CompiladorLexer* lexer);
+
+/* Limite de memória do contexto, em bytes (padrão: MAX_MEMORY_KB).
+ * Ultrapassá-lo é um erro da análise, e não do processo. */
+COMPILADOR_API void compilador_lexer_set_memory_limit(CompiladorLexer* lexer, long bytes);
+
+/* Escreve em tokens até max tokens seguintes e retorna quantos escreveu.
+ * O balanceamento de (), {}, [] e aspas é verificado na mesma passada. O
+ * último token da análise é COMPILADOR_TOKEN_EOF ou COMPILADOR_TOKEN_ERRO;
+ * depois dele, retorna 0. Retorna -1 se faltar memória (o contexto não
+ * pode mais ser usado). */
+COMPILADOR_API int compilador_lexer_next(CompiladorLexer* lexer, CompiladorToken* tokens, int max);
+
+/* Retorna 1 e preenche *diagnostic se a análise terminou em erro (léxico,
+ * de balanceamento ou de memória), ou 0. */
+COMPILADOR_API int compilador_lexer_diagnostic(const CompiladorLexer* lexer, CompiladorDiagnostic* diagnostic);
+
+/* Pico de memória do contexto, em bytes. */
+COMPILADOR_API long compilador_lexer_max_memory(const CompiladorLexer* lexer);
+
+/* Nome de um tipo de token ("ID_VAR", "OP_SOMA"...), ou NULL. */
+COMPILADOR_API const char* compilador_token_name(int type);
+
+#endif
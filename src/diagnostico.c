@@ -0,0 +1,94 @@
+#include <stdarg.h>
+#include <string.h>
+#include "diagnostico.h"
+
+#define DIAGNOSTICS_INITIAL_CAPACITY 16
+#define DIAGNOSTIC_MESSAGE_SIZE 256
+
+void diagnostics_init(Diagnostics* diagnostics, Arena* arena) {
+    diagnostics->arena = arena;
+    diagnostics->items = NULL;
+    diagnostics->count = 0;
+    diagnostics->capacity = 0;
+    diagnostics->errors = 0;
+    diagnostics->warnings = 0;
+}
+
+static void diagnostics_reserve(Diagnostics* diagnostics, int needed) {
+    if (needed <= diagnostics->capacity) return;
+    int capacity = diagnostics->capacity > 0 ? 2 * diagnostics->capacity : DIAGNOSTICS_INITIAL_CAPACITY;
+    while (capacity < needed) capacity *= 2;
+    diagnostics->items = (Diagnostic*)arena_grow(diagnostics->arena, diagnostics->items,
+                                                 diagnostics->capacity * sizeof(Diagnostic),
+                                                 capacity * sizeof(Diagnostic));
+    diagnostics->capacity = capacity;
+}
+
+static void diagnostics_vadd(Diagnostics* diagnostics, DiagnosticSeverity severity, int line,
+                             int column, const char* format, va_list args) {
+    diagnostics_reserve(diagnostics, diagnostics->count + 1);
+
+    char buffer[DIAGNOSTIC_MESSAGE_SIZE];
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    if (length >= (int)sizeof(buffer)) length = sizeof(buffer) - 1;
+    char* message = (char*)arena_alloc(diagnostics->arena, length + 1);
+    memcpy(message, buffer, length + 1);
+
+    Diagnostic* diagnostic = &diagnostics->items[diagnostics->count++];
+    diagnostic->severity = severity;
+    diagnostic->line = line;
+    diagnostic->column = column;
+    diagnostic->message = message;
+    if (severity == DIAG_ERRO) {
+        diagnostics->errors++;
+    } else {
+        diagnostics->warnings++;
+    }
+}
+
+void diagnostics_add(Diagnostics* diagnostics, DiagnosticSeverity severity, int line,
+                     const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    diagnostics_vadd(diagnostics, severity, line, 0, format, args);
+    va_end(args);
+}
+
+void diagnostics_add_at(Diagnostics* diagnostics, DiagnosticSeverity severity, int line, int column,
+                        const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    diagnostics_vadd(diagnostics, severity, line, column, format, args);
+    va_end(args);
+}
+
+void diagnostics_append(Diagnostics* diagnostics, const Diagnostics* source, int first, int count) {
+    if (count == 0) return;
+    diagnostics_reserve(diagnostics, diagnostics->count + count);
+    for (int i = first; i < first + count; i++) {
+        const Diagnostic* diagnostic = &source->items[i];
+        diagnostics->items[diagnostics->count++] = *diagnostic;
+        if (diagnostic->severity == DIAG_ERRO) {
+            diagnostics->errors++;
+        } else {
+            diagnostics->warnings++;
+        }
+    }
+}
+
+void diagnostics_print(const Diagnostics* diagnostics, FILE* out) {
+    for (int i = 0; i < diagnostics->count; i++) {
+        const Diagnostic* diagnostic = &diagnostics->items[i];
+        const char* severity = diagnostic->severity == DIAG_ERRO ? "ERRO" : "ALERTA";
+        /* Algumas mensagens do lexer já começam com "ERRO: " na saída
+         * padrão; aqui a severidade já vem no início da linha. */
+        const char* message = diagnostic->message;
+        if (strncmp(message, "ERRO: ", 6) == 0) message += 6;
+        if (diagnostic->column > 0) {
+            fprintf(out, "%s na linha %d, coluna %d: %s\n", severity,
+                    diagnostic->line, diagnostic->column, message);
+        } else {
+            fprintf(out, "%s na linha %d: %s\n", severity, diagnostic->line, message);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef DIAGNOSTICO_H
+#define DIAGNOSTICO_H
+
+#include <stdio.h>
+#include "memoria.h"
+
+/* --- Diagnósticos --- */
+
+/* Erros impedem as fases seguintes; alertas só são exibidos. */
+typedef enum {
+    DIAG_ERRO,
+    DIAG_ALERTA
+} DiagnosticSeverity;
+
+typedef struct {
+    DiagnosticSeverity severity;
+    int line;
+    int column;             /* a partir de 1, ou 0 se não houver */
+    const char* message;
+} Diagnostic;
+
+/* Lista de diagnósticos de uma compilação, na ordem em que foram
+ * encontrados. Mensagens e vetor ficam na arena. */
+typedef struct {
+    Diagnostic* items;
+    int count;
+    int capacity;
+    int errors;
+    int warnings;
+    Arena* arena;
+} Diagnostics;
+
+void diagnostics_init(Diagnostics* diagnostics, Arena* arena);
+
+/* Acrescenta um diagnóstico formatado como printf. */
+void diagnostics_add(Diagnostics* diagnostics, DiagnosticSeverity severity, int line,
+                     const char* format, ...);
+
+/* Como diagnostics_add, com a coluna da linha. */
+void diagnostics_add_at(Diagnostics* diagnostics, DiagnosticSeverity severity, int line, int column,
+                        const char* format, ...);
+
+/* Acrescenta ao fim de diagnostics count diagnósticos de source, a partir
+ * de first. As mensagens não são copiadas: a arena de source precisa
+ * durar tanto quanto diagnostics. */
+void diagnostics_append(Diagnostics* diagnostics, const Diagnostics* source, int first, int count);
+
+/* Uma linha por diagnóstico: "ERRO na linha N: ..." ou "ALERTA na linha N: ...";
+ * com coluna, "ERRO na linha N, coluna C: ...". */
+void diagnostics_print(const Diagnostics* diagnostics, FILE* out);
+
+#endif
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "entrada.h"
+
+char* read_file_content(const char* filepath, Arena* arena, long* length_out) {
+    FILE* file = fopen(filepath, "r");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* buffer = (char*)arena_alloc(arena, length + 1);
+    length = (long)fread(buffer, 1, length, file);
+    buffer[length] = '\0';
+    fclose(file);
+    if (length_out != NULL) {
+        *length_out = length;
+    }
+    return buffer;
+}
+
+/* O arquivo é mapeado sobre uma região anônima uma página maior: o resto
+ * da última página do arquivo e a página extra são zeros, então o '\0'
+ * final existe mesmo quando o tamanho é múltiplo da página, e as leituras
+ * alinhadas dos núcleos de varredura nunca saem da região. */
+int map_file(MappedFile* file, const char* filepath, MemoryContext* memory) {
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        return MAP_ERRO_ABERTURA;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return MAP_ERRO_ABERTURA;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        close(fd);
+        return MAP_NAO_REGULAR;
+    }
+    if ((long)info.st_size > MAP_TAMANHO_MAXIMO) {
+        close(fd);
+        return MAP_GRANDE_DEMAIS;
+    }
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t length = (size_t)info.st_size;
+    size_t size = (length / page + 1) * page;
+    char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return MAP_ERRO_ABERTURA;
+    }
+    if (length > 0) {
+        if (mmap(data, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(data, size);
+            close(fd);
+            return MAP_ERRO_ABERTURA;
+        }
+        madvise(data, length, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    file->data = data;
+    file->length = (long)length;
+    file->size = size;
+    file->memory = memory;
+    memory_add_mapped(memory, (long)size);
+    return MAP_OK;
+}
+
+void unmap_file(MappedFile* file) {
+    if (file->data == NULL) return;
+    munmap((void*)file->data, file->size);
+    memory_add_mapped(file->memory, -(long)file->size);
+    file->data = NULL;
+}
@@ -0,0 +1,40 @@
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <stddef.h>
+#include <limits.h>
+#include "memoria.h"
+
+/* --- Leitura de Arquivo --- */
+
+/* Lê o arquivo inteiro para a arena, terminado em '\0'. Retorna NULL se o
+ * arquivo não puder ser aberto; *length recebe o tamanho, se não for NULL.
+ * Usada para arquivos pequenos que precisam ser alterados (listas @). */
+char* read_file_content(const char* filepath, Arena* arena, long* length);
+
+/* --- Arquivo Mapeado em Memória --- */
+
+#define MAP_OK 0
+#define MAP_ERRO_ABERTURA -1
+#define MAP_NAO_REGULAR 1   /* pipe, terminal etc.: use a leitura em fluxo */
+#define MAP_GRANDE_DEMAIS 2 /* maior que MAP_TAMANHO_MAXIMO: idem */
+
+/* Posições do lexer e offsets dos tokens são int: o conteúdo inteiro, com
+ * o '\0' final, precisa ser endereçável por eles. */
+#define MAP_TAMANHO_MAXIMO ((long)INT_MAX - 1)
+
+/* Conteúdo somente leitura, terminado em '\0', sem cópia para o heap. */
+typedef struct {
+    const char* data;
+    long length;
+    size_t size;            /* tamanho total do mapeamento */
+    MemoryContext* memory;  /* onde o mapeamento é contabilizado */
+} MappedFile;
+
+/* Mapeia o arquivo e contabiliza o mapeamento em memory->mapped, fora do
+ * orçamento do heap. Retorna MAP_OK, MAP_ERRO_ABERTURA, MAP_NAO_REGULAR ou
+ * MAP_GRANDE_DEMAIS. */
+int map_file(MappedFile* file, const char* filepath, MemoryContext* memory);
+void unmap_file(MappedFile* file);
+
+#endif
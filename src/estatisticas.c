@@ -0,0 +1,338 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "memoria.h"
+#include "lexico.h"
+#include "estatisticas.h"
+
+int stats_active;
+
+/* Com -DSTATS_DISABLED só restam a opção e o aviso de stats_start. */
+#ifndef STATS_DISABLED
+
+#define STATS_TOKEN_TYPES (TOKEN_PONTO + 1)
+
+/* Pontos de alocação exibidos no relatório em texto (o JSON traz todos). */
+#define STATS_TEXT_SITES 10
+
+/* Contadores de uma thread: só ela escreve neles, sem operações
+ * atômicas. Ficam no heap, e não em _Thread_local, porque o relatório é
+ * feito depois que as threads do pool já terminaram. */
+typedef struct StatsThread {
+    double wall[NUM_PHASES];
+    double cpu[NUM_PHASES];
+    long runs[NUM_PHASES];
+    long tokens[STATS_TOKEN_TYPES];
+    long bytes;
+    long lines;
+    long inputs;
+    struct StatsThread* next;
+} StatsThread;
+
+static StatsFormat stats_format;
+static double start_wall;
+static _Thread_local StatsThread* local_stats;
+static StatsThread* all_threads;
+static pthread_mutex_t threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static AllocSite* _Atomic all_sites;
+
+static const char* const phase_names[NUM_PHASES] = {
+    [PHASE_LEITURA] = "leitura",
+    [PHASE_BALANCEAMENTO] = "balanceamento",
+    [PHASE_LEXICA] = "lexica",
+    [PHASE_SINTATICA] = "sintatica",
+    [PHASE_SEMANTICA] = "semantica",
+    [PHASE_OTIMIZACAO] = "otimizacao",
+    [PHASE_GERACAO] = "geracao",
+    [PHASE_EXECUCAO] = "execucao",
+};
+
+static double clock_seconds(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/* A memória das estatísticas vem direto do sistema: ela não entra no
+ * orçamento nem nos totais que estão sendo medidos. */
+static StatsThread* thread_stats(void) {
+    StatsThread* stats = local_stats;
+    if (stats == NULL) {
+        stats = (StatsThread*)calloc(1, sizeof(StatsThread));
+        if (stats == NULL) {
+            printf("ERRO: Falha ao alocar memória.\n");
+            exit(1);
+        }
+        pthread_mutex_lock(&threads_lock);
+        stats->next = all_threads;
+        all_threads = stats;
+        pthread_mutex_unlock(&threads_lock);
+        local_stats = stats;
+    }
+    return stats;
+}
+
+/* --- Coleta --- */
+
+static int size_bucket(size_t size) {
+    int bucket = 0;
+    size_t limit = 16;
+    while (size > limit && bucket < STATS_SIZE_BUCKETS - 1) {
+        limit <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void stats_record_alloc(AllocSite* site, size_t size) {
+    if (atomic_exchange_explicit(&site->registered, 1, memory_order_relaxed) == 0) {
+        AllocSite* head = atomic_load(&all_sites);
+        do {
+            site->next = head;
+        } while (!atomic_compare_exchange_weak(&all_sites, &head, site));
+    }
+    atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->bytes, (long)size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->sizes[size_bucket(size)], 1, memory_order_relaxed);
+}
+
+void stats_record_token(int type) {
+    if (type >= 0 && type < STATS_TOKEN_TYPES) {
+        thread_stats()->tokens[type]++;
+    }
+}
+
+void stats_record_input(long bytes, long lines) {
+    StatsThread* stats = thread_stats();
+    stats->bytes += bytes;
+    stats->lines += lines;
+    stats->inputs++;
+}
+
+void stats_timer_begin(StatsTimer* timer, StatsPhase phase) {
+    timer->phase = phase;
+    timer->wall = clock_seconds(CLOCK_MONOTONIC);
+    timer->cpu = clock_seconds(CLOCK_THREAD_CPUTIME_ID);
+}
+
+void stats_timer_end(StatsTimer* timer) {
+    StatsThread* stats = thread_stats();
+    stats->wall[timer->phase] += clock_seconds(CLOCK_MONOTONIC) - timer->wall;
+    stats->cpu[timer->phase] += clock_seconds(CLOCK_THREAD_CPUTIME_ID) - timer->cpu;
+    stats->runs[timer->phase]++;
+}
+
+/* --- Relatório --- */
+
+/* Soma das threads. Chamado no atexit, quando elas já terminaram. */
+static StatsThread merge_threads(void) {
+    StatsThread total;
+    memset(&total, 0, sizeof(total));
+    pthread_mutex_lock(&threads_lock);
+    for (StatsThread* stats = all_threads; stats != NULL; stats = stats->next) {
+        for (int p = 0; p < NUM_PHASES; p++) {
+            total.wall[p] += stats->wall[p];
+            total.cpu[p] += stats->cpu[p];
+            total.runs[p] += stats->runs[p];
+        }
+        for (int t = 0; t < STATS_TOKEN_TYPES; t++) {
+            total.tokens[t] += stats->tokens[t];
+        }
+        total.bytes += stats->bytes;
+        total.lines += stats->lines;
+        total.inputs += stats->inputs;
+    }
+    pthread_mutex_unlock(&threads_lock);
+    return total;
+}
+
+static int compare_sites(const void* a, const void* b) {
+    long left = atomic_load(&(*(AllocSite* const*)a)->bytes);
+    long right = atomic_load(&(*(AllocSite* const*)b)->bytes);
+    return (left < right) - (left > right);
+}
+
+/* Pontos de alocação do maior para o menor em bytes; *count recebe o
+ * número de pontos. O vetor é liberado por quem chama. */
+static AllocSite** sorted_sites(int* count) {
+    *count = 0;
+    for (AllocSite* site = atomic_load(&all_sites); site != NULL; site = site->next) {
+        (*count)++;
+    }
+    AllocSite** sites = (AllocSite**)calloc(*count + 1, sizeof(AllocSite*));
+    if (sites == NULL) {
+        *count = 0;
+        return NULL;
+    }
+    int i = 0;
+    for (AllocSite* site = atomic_load(&all_sites); site != NULL; site = site->next) {
+        sites[i++] = site;
+    }
+    qsort(sites, *count, sizeof(AllocSite*), compare_sites);
+    return sites;
+}
+
+/* Fase em que o lexer rodou: a léxica, ou a sintática, que puxa os
+ * tokens do lexer. */
+static StatsPhase lexing_phase(const StatsThread* total) {
+    return total->runs[PHASE_LEXICA] > 0 ? PHASE_LEXICA : PHASE_SINTATICA;
+}
+
+static long total_tokens(const StatsThread* total) {
+    long tokens = 0;
+    for (int t = 0; t < STATS_TOKEN_TYPES; t++) {
+        tokens += total->tokens[t];
+    }
+    return tokens;
+}
+
+static void size_label(int bucket, char* out, size_t size) {
+    long limit = 16L << bucket;
+    if (bucket == STATS_SIZE_BUCKETS - 1) {
+        snprintf(out, size, ">%ld", limit / 2);
+    } else {
+        snprintf(out, size, "%ld", limit);
+    }
+}
+
+static void report_text(FILE* out, const StatsThread* total, double wall, double cpu) {
+    fprintf(out, "\n--- Estatísticas ---\n");
+    fprintf(out, "Tempo total: %.3f ms (CPU do processo: %.3f ms).\n", wall * 1000.0, cpu * 1000.0);
+    fprintf(out, "%-15s %12s %12s %8s\n", "Fase", "Parede (ms)", "CPU (ms)", "Vezes");
+    for (int p = 0; p < NUM_PHASES; p++) {
+        if (total->runs[p] == 0) continue;
+        fprintf(out, "%-15s %12.3f %12.3f %8ld\n", phase_names[p],
+                total->wall[p] * 1000.0, total->cpu[p] * 1000.0, total->runs[p]);
+    }
+
+    long tokens = total_tokens(total);
+    double lex_wall = total->wall[lexing_phase(total)];
+    fprintf(out, "Entrada: %ld arquivo(s), %ld bytes, %ld linhas, %ld tokens.\n",
+            total->inputs, total->bytes, total->lines, tokens);
+    if (lex_wall > 0.0) {
+        fprintf(out, "Vazão (fase %s): %.1f MB/s, %.0f tokens/s.\n", phase_names[lexing_phase(total)],
+                total->bytes / lex_wall / (1024.0 * 1024.0), tokens / lex_wall);
+    }
+    if (tokens > 0) {
+        fprintf(out, "Tokens por tipo:\n");
+        for (int t = 0; t < STATS_TOKEN_TYPES; t++) {
+            if (total->tokens[t] > 0) {
+                fprintf(out, "  %-20s %12ld\n", token_type_to_string((TokenType)t), total->tokens[t]);
+            }
+        }
+    }
+    fprintf(out, "Memória: pico de %ld bytes em arenas.\n", memory_total_peak());
+
+    int count;
+    AllocSite** sites = sorted_sites(&count);
+    if (count > 0) {
+        fprintf(out, "Alocações por ponto de chamada (%d ponto(s), os maiores em bytes):\n", count);
+        for (int i = 0; i < count && i < STATS_TEXT_SITES; i++) {
+            AllocSite* site = sites[i];
+            fprintf(out, "  %s:%d %s: %ld vez(es), %ld bytes; tamanhos:", site->file, site->line,
+                    site->function, atomic_load(&site->count), atomic_load(&site->bytes));
+            for (int b = 0; b < STATS_SIZE_BUCKETS; b++) {
+                long n = atomic_load(&site->sizes[b]);
+                if (n == 0) continue;
+                char label[24];
+                size_label(b, label, sizeof(label));
+                fprintf(out, " %s%s=%ld", b == STATS_SIZE_BUCKETS - 1 ? "" : "<=", label, n);
+            }
+            fprintf(out, "\n");
+        }
+    }
+    free(sites);
+}
+
+/* Uma linha de JSON, fácil de juntar de várias máquinas. */
+static void report_json(FILE* out, const StatsThread* total, double wall, double cpu) {
+    fprintf(out, "{\"tempo_ms\":%.3f,\"cpu_ms\":%.3f,\"fases\":{", wall * 1000.0, cpu * 1000.0);
+    int first = 1;
+    for (int p = 0; p < NUM_PHASES; p++) {
+        if (total->runs[p] == 0) continue;
+        fprintf(out, "%s\"%s\":{\"parede_ms\":%.3f,\"cpu_ms\":%.3f,\"vezes\":%ld}", first ? "" : ",",
+                phase_names[p], total->wall[p] * 1000.0, total->cpu[p] * 1000.0, total->runs[p]);
+        first = 0;
+    }
+
+    long tokens = total_tokens(total);
+    double lex_wall = total->wall[lexing_phase(total)];
+    fprintf(out, "},\"entrada\":{\"arquivos\":%ld,\"bytes\":%ld,\"linhas\":%ld,\"tokens\":%ld}",
+            total->inputs, total->bytes, total->lines, tokens);
+    fprintf(out, ",\"vazao\":{\"fase\":\"%s\",\"mb_s\":%.3f,\"tokens_s\":%.0f}",
+            phase_names[lexing_phase(total)],
+            lex_wall > 0.0 ? total->bytes / lex_wall / (1024.0 * 1024.0) : 0.0,
+            lex_wall > 0.0 ? tokens / lex_wall : 0.0);
+
+    fprintf(out, ",\"tokens\":{");
+    first = 1;
+    for (int t = 0; t < STATS_TOKEN_TYPES; t++) {
+        if (total->tokens[t] == 0) continue;
+        fprintf(out, "%s\"%s\":%ld", first ? "" : ",", token_type_to_string((TokenType)t), total->tokens[t]);
+        first = 0;
+    }
+    fprintf(out, "},\"memoria\":{\"pico\":%ld}", memory_total_peak());
+
+    fprintf(out, ",\"alocacoes\":[");
+    int count;
+    AllocSite** sites = sorted_sites(&count);
+    for (int i = 0; i < count; i++) {
+        AllocSite* site = sites[i];
+        fprintf(out, "%s{\"arquivo\":\"%s\",\"linha\":%d,\"funcao\":\"%s\",\"vezes\":%ld,\"bytes\":%ld,\"tamanhos\":{",
+                i == 0 ? "" : ",", site->file, site->line, site->function,
+                atomic_load(&site->count), atomic_load(&site->bytes));
+        first = 1;
+        for (int b = 0; b < STATS_SIZE_BUCKETS; b++) {
+            long n = atomic_load(&site->sizes[b]);
+            if (n == 0) continue;
+            char label[24];
+            size_label(b, label, sizeof(label));
+            fprintf(out, "%s\"%s\":%ld", first ? "" : ",", label, n);
+            first = 0;
+        }
+        fprintf(out, "}}");
+    }
+    free(sites);
+    fprintf(out, "]}\n");
+}
+
+static void stats_report(void) {
+    double wall = clock_seconds(CLOCK_MONOTONIC) - start_wall;
+    double cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    StatsThread total = merge_threads();
+    fflush(stdout);
+    if (stats_format == STATS_JSON) {
+        report_json(stderr, &total, wall, cpu);
+    } else {
+        report_text(stderr, &total, wall, cpu);
+    }
+}
+
+#endif
+
+int stats_format_from_string(const char* name, StatsFormat* format) {
+    if (strcmp(name, "texto") == 0) {
+        *format = STATS_TEXTO;
+    } else if (strcmp(name, "json") == 0) {
+        *format = STATS_JSON;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+void stats_start(StatsFormat format) {
+#ifdef STATS_DISABLED
+    (void)format;
+    fprintf(stderr, "Estatísticas desativadas nesta compilação (-DSTATS_DISABLED).\n");
+#else
+    stats_format = format;
+    start_wall = clock_seconds(CLOCK_MONOTONIC);
+    if (!stats_active) {
+        stats_active = 1;
+        atexit(stats_report);
+    }
+#endif
+}
@@ -0,0 +1,104 @@
+#ifndef ESTATISTICAS_H
+#define ESTATISTICAS_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+/* --- Estatísticas de Execução --- */
+
+/* Com -DSTATS_DISABLED, todas as chamadas abaixo viram funções vazias e
+ * somem do código gerado. Sem ela, nada é coletado até stats_start (opção
+ * --stats): o custo nos caminhos quentes é um teste de stats_active. */
+
+typedef enum {
+    PHASE_LEITURA,
+    PHASE_BALANCEAMENTO,  /* só quando é uma passada separada (--paralelo) */
+    PHASE_LEXICA,
+    PHASE_SINTATICA,      /* inclui a análise léxica, puxada pelo parser */
+    PHASE_SEMANTICA,
+    PHASE_OTIMIZACAO,
+    PHASE_GERACAO,
+    PHASE_EXECUCAO,
+    NUM_PHASES
+} StatsPhase;
+
+typedef enum {
+    STATS_TEXTO,
+    STATS_JSON
+} StatsFormat;
+
+/* Tamanhos de alocação em potências de 2: até 16 bytes, até 32, ..., e
+ * o último balde para o resto. */
+#define STATS_SIZE_BUCKETS 16
+
+/* Um ponto de chamada de arena_alloc, arena_grow ou Malloc. É uma
+ * variável estática criada pela macro do ponto (memoria.h) e entra na
+ * lista de pontos na primeira alocação. */
+typedef struct AllocSite {
+    const char* file;
+    int line;
+    const char* function;
+    atomic_long count;
+    atomic_long bytes;
+    atomic_long sizes[STATS_SIZE_BUCKETS];
+    atomic_int registered;
+    struct AllocSite* next;
+} AllocSite;
+
+/* Tempo de uma fase, medido na thread que a executa. */
+typedef struct {
+    StatsPhase phase;
+    double wall;
+    double cpu;
+} StatsTimer;
+
+extern int stats_active;
+
+/* Liga a coleta; o relatório é escrito na saída de erro quando o processo
+ * termina (atexit), em qualquer modo e mesmo depois de um exit(1). */
+void stats_start(StatsFormat format);
+
+/* Retorna 0 e preenche *format ("texto" ou "json"), ou -1. */
+int stats_format_from_string(const char* name, StatsFormat* format);
+
+void stats_record_alloc(AllocSite* site, size_t size);
+void stats_record_token(int type);
+void stats_record_input(long bytes, long lines);
+void stats_timer_begin(StatsTimer* timer, StatsPhase phase);
+void stats_timer_end(StatsTimer* timer);
+
+#ifdef STATS_DISABLED
+
+static inline void stats_alloc(AllocSite* site, size_t size) { (void)site; (void)size; }
+static inline void stats_token(int type) { (void)type; }
+static inline void stats_input(long bytes, long lines) { (void)bytes; (void)lines; }
+static inline void stats_begin(StatsTimer* timer, StatsPhase phase) { (void)timer; (void)phase; }
+static inline void stats_end(StatsTimer* timer) { (void)timer; }
+
+#else
+
+static inline void stats_alloc(AllocSite* site, size_t size) {
+    if (stats_active) stats_record_alloc(site, size);
+}
+
+/* Um token entregue (não conta os que o lexer refaz ou descarta). */
+static inline void stats_token(int type) {
+    if (stats_active) stats_record_token(type);
+}
+
+/* Bytes e linhas de uma entrada analisada. */
+static inline void stats_input(long bytes, long lines) {
+    if (stats_active) stats_record_input(bytes, lines);
+}
+
+static inline void stats_begin(StatsTimer* timer, StatsPhase phase) {
+    if (stats_active) stats_timer_begin(timer, phase);
+}
+
+static inline void stats_end(StatsTimer* timer) {
+    if (stats_active) stats_timer_end(timer);
+}
+
+#endif
+
+#endif
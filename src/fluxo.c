@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "memoria.h"
+#include "varredura.h"
+#include "fluxo.h"
+#include "estatisticas.h"
+
+/* Bytes que o autômato pode examinar depois do fim de um token (a regra
+ * dos 3 caracteres especiais olha dois adiante). Um token que termina
+ * mais perto que isso do fim dos dados lidos pode mudar com mais dados. */
+#define STREAM_LOOKAHEAD 4
+
+/* Os núcleos vetoriais leem blocos alinhados de até 32 bytes além do '\0'. */
+#define STREAM_PADDING 32
+
+int stream_open(StreamLexer* stream, const char* path, Arena* arena) {
+    if (strcmp(path, "-") == 0) {
+        stream->fd = STDIN_FILENO;
+        stream->owns_fd = 0;
+    } else {
+        stream->fd = open(path, O_RDONLY);
+        if (stream->fd < 0) return -1;
+        stream->owns_fd = 1;
+    }
+    stream->buffer = (char*)arena_alloc(arena, STREAM_BUFFER_SIZE + 1 + STREAM_PADDING);
+    stream->buffer[0] = '\0';
+    stream->end = 0;
+    stream->eof = 0;
+    stream->bytes = 0;
+    stream->base = 0;
+    lexer_init(&stream->lexer, stream->buffer, arena);
+    return 0;
+}
+
+void stream_close(StreamLexer* stream) {
+    if (stream->owns_fd) {
+        close(stream->fd);
+    }
+    stream->fd = -1;
+}
+
+/* Descarta o que vem antes de keep, move o restante para o início da
+ * janela e lê mais dados depois dele. Retorna 0 se a janela já está cheia
+ * com dados de um único token. */
+static int stream_refill(StreamLexer* stream, int keep) {
+    int kept = stream->end - keep;
+    memmove(stream->buffer, stream->buffer + keep, kept);
+    stream->end = kept;
+    stream->base += keep;
+    stream->lexer.pos -= keep;
+    if (kept == STREAM_BUFFER_SIZE) {
+        return 0;
+    }
+
+    ssize_t count;
+    do {
+        count = read(stream->fd, stream->buffer + kept, STREAM_BUFFER_SIZE - kept);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) {
+        stream->eof = 1;
+    } else {
+        stream->end += (int)count;
+        stream->bytes += count;
+    }
+    stream->buffer[stream->end] = '\0';
+    return 1;
+}
+
+/* Texto que não cabe na janela, com as aspas em buffer[0]: o restante da
+ * entrada é percorrido sem ser guardado, somando as linhas em *line, até
+ * as aspas de fechamento ou o fim. A janela fica vazia, com base nas
+ * aspas de abertura. Retorna o comprimento até o fim da entrada, ou -1 se
+ * o texto fecha (e o token não cabe na janela). */
+static long stream_skip_string(StreamLexer* stream, int* line) {
+    long quote = stream->base;
+    int p = scan_kernels->skip_string(stream->buffer, 1, line);
+    while (p == stream->end && !stream->eof) {
+        stream_refill(stream, stream->end);
+        p = scan_kernels->skip_string(stream->buffer, 0, line);
+    }
+    long length = stream->base + p - quote;
+    int closed = stream->buffer[p] == '"';
+    stream->base = quote;
+    stream->end = 0;
+    stream->buffer[0] = '\0';
+    stream->lexer.pos = 0;
+    stream->eof = 1;
+    return closed ? -1 : length;
+}
+
+/* Cada token é reconhecido sobre os dados já lidos. Se ele chega perto
+ * do fim da janela antes do fim da entrada, pode continuar nos próximos
+ * dados: a janela é recarregada e o token, reconhecido de novo desde o
+ * início. O balanceamento só é aplicado ao token aceito. */
+Token stream_next_token(StreamLexer* stream) {
+    LexerContext* lexer = &stream->lexer;
+    for (;;) {
+        /* Espaços em branco são descartados antes da recarga, então uma
+         * sequência longa deles não ocupa a janela. */
+        int pos = scan_kernels->skip_whitespace(stream->buffer, lexer->pos, &lexer->line);
+        lexer->pos = pos;
+        if (pos == stream->end && !stream->eof) {
+            stream_refill(stream, pos);
+            continue;
+        }
+
+        int line = lexer->line;
+        Token token = get_next_token_unbalanced(lexer);
+        if (stream->eof || lexer->pos + STREAM_LOOKAHEAD <= stream->end) {
+            lexer_balance_token(&lexer->balance, stream->buffer, &token, lexer->error_msg);
+            stats_token(token.type);
+            return token;
+        }
+
+        lexer->pos = pos;
+        lexer->line = line;
+        if (!stream_refill(stream, pos)) {
+            /* Um texto sem fim tem o mesmo diagnóstico da análise do
+             * arquivo inteiro, com as linhas contadas até o fim. */
+            long length = -1;
+            if (stream->buffer[0] == '"') {
+                int last_line = line;
+                length = stream_skip_string(stream, &last_line);
+                if (length >= 0) {
+                    balance_unclosed_message('"', line, last_line, lexer->error_msg, LEXER_ERROR_MSG_SIZE);
+                }
+            }
+            if (length < 0) {
+                snprintf(lexer->error_msg, LEXER_ERROR_MSG_SIZE,
+                         "Token maior que o buffer de leitura (%d bytes)", STREAM_BUFFER_SIZE);
+            }
+            stream->eof = 1;
+            token.type = TOKEN_ERRO;
+            token.offset = 0;
+            token.length = length > 0 ? (int)length : 0;
+            token.line = line;
+            stats_token(token.type);
+            return token;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef FLUXO_H
+#define FLUXO_H
+
+#include "lexico.h"
+
+/* --- Análise Léxica em Fluxo --- */
+
+/* Janela de leitura: a memória usada não depende do tamanho da entrada.
+ * Um único token (por exemplo, um texto) precisa caber nela; um texto sem
+ * fim é percorrido até o fim da entrada sem ser guardado. */
+#ifndef STREAM_BUFFER_SIZE
+#define STREAM_BUFFER_SIZE (256 * 1024)
+#endif
+
+/* Lexer sobre um descritor (entrada padrão, pipe ou arquivo) lido aos
+ * poucos. Os tokens apontam para lexer.content e valem até a próxima
+ * chamada de stream_next_token. */
+typedef struct {
+    int fd;
+    int owns_fd;
+    char* buffer;
+    int end;    /* bytes válidos em buffer */
+    long base;  /* posição de buffer[0] na entrada */
+    int eof;
+    long bytes; /* total lido da entrada */
+    LexerContext lexer;
+} StreamLexer;
+
+/* Abre path ("-" é a entrada padrão); o buffer e a pilha de balanceamento
+ * ficam em arena. Retorna 0, ou -1 se não for possível abrir. */
+int stream_open(StreamLexer* stream, const char* path, Arena* arena);
+
+/* Como get_next_token: tokens, linhas e diagnósticos são os mesmos da
+ * análise do arquivo inteiro. */
+Token stream_next_token(StreamLexer* stream);
+void stream_close(StreamLexer* stream);
+
+#endif
@@ -0,0 +1,373 @@
+#include <stdint.h>
+#include <string.h>
+#include "memoria.h"
+#include "balanceamento.h"
+#include "incremental.h"
+
+/* O autômato lê no máximo 2 caracteres além do fim de um token: em "+=a",
+ * o '+' só é aceito depois de ler '=' e 'a'. Uma edição que começa antes
+ * disso pode mudar o token. */
+#define LEXER_LOOKAHEAD 2
+
+/* Um texto começa na aspa de abertura, um caractere antes de offset, e
+ * termina depois da aspa de fechamento. */
+static long token_start(Token token) {
+    return token.type == TOKEN_LITERAL_TEXTO ? token.offset - 1 : token.offset;
+}
+
+static long token_end(Token token) {
+    return token.type == TOKEN_LITERAL_TEXTO ? token.offset + token.length + 1 : token.offset + token.length;
+}
+
+static int count_newlines(const char* text, long length) {
+    int lines = 0;
+    if (length <= 0) return 0;
+    const char* end = text + length;
+    while ((text = memchr(text, '\n', end - text)) != NULL) {
+        lines++;
+        text++;
+    }
+    return lines;
+}
+
+/* --- Memória --- */
+
+/* No pior caso há um token por byte. O texto e os vetores de tokens e de
+ * profundidades crescem dobrando; a área de trabalho guarda os tokens
+ * novos e a pilha de uma edição. O orçamento só aumenta. */
+static void reserve_budget(IncrementalLexer* inc, long length) {
+    long per_byte = 2 * (1 + (long)sizeof(Token) + (long)sizeof(int)) + 2 * ((long)sizeof(Token) + (long)sizeof(int));
+    long budget = MAX_MEMORY_KB * 1024L + per_byte * (length + INCREMENTAL_PADDING);
+    if (budget > inc->memory->budget) {
+        inc->memory->budget = budget;
+    }
+}
+
+/* Cada vetor fica sozinho na sua arena, então crescer realoca o bloco no
+ * lugar de deixar a cópia antiga para trás. */
+static void reserve_content(IncrementalLexer* inc, long length) {
+    long needed = length + INCREMENTAL_PADDING;
+    if (needed <= inc->capacity) return;
+    long capacity = inc->capacity * 2 > needed ? inc->capacity * 2 : needed;
+    if (capacity < 4096) capacity = 4096;
+    inc->content = (char*)arena_grow(&inc->text_arena, inc->content, inc->capacity, capacity);
+    inc->capacity = capacity;
+}
+
+static void reserve_tokens(IncrementalLexer* inc, long count) {
+    if (count <= inc->token_capacity) return;
+    long capacity = inc->token_capacity * 2 > count ? inc->token_capacity * 2 : count;
+    if (capacity < 1024) capacity = 1024;
+    inc->tokens = (Token*)arena_grow(&inc->token_arena, inc->tokens,
+                                     inc->token_capacity * sizeof(Token), capacity * sizeof(Token));
+    inc->depth = (int*)arena_grow(&inc->depth_arena, inc->depth,
+                                  inc->token_capacity * sizeof(int), capacity * sizeof(int));
+    inc->token_capacity = capacity;
+}
+
+void incremental_init(IncrementalLexer* inc, MemoryContext* memory) {
+    memset(inc, 0, sizeof(*inc));
+    inc->memory = memory;
+    arena_init(&inc->text_arena, memory);
+    arena_init(&inc->token_arena, memory);
+    arena_init(&inc->depth_arena, memory);
+    arena_init(&inc->scratch, memory);
+    inc->lex_error = -1;
+    inc->balance_error = -1;
+    inc->balance_open = -1;
+}
+
+void incremental_destroy(IncrementalLexer* inc) {
+    arena_destroy(&inc->scratch);
+    arena_destroy(&inc->depth_arena);
+    arena_destroy(&inc->token_arena);
+    arena_destroy(&inc->text_arena);
+    inc->content = NULL;
+    inc->tokens = NULL;
+    inc->depth = NULL;
+}
+
+/* --- Balanceamento --- */
+
+/* Último token antes de `first` com a pilha vazia: dali o balanceamento
+ * pode recomeçar sem reconstruir a pilha. */
+static long balance_restart(const IncrementalLexer* inc, long first) {
+    long from = first;
+    while (from > 0 && inc->depth[from] != 0) {
+        from--;
+    }
+    return from;
+}
+
+/* Verifica o balanceamento a partir de `from` (pilha vazia). A pilha
+ * guarda os índices das aberturas, para que o diagnóstico possa ser
+ * refeito depois com as linhas atuais. Um fechamento sem par é ignorado e
+ * a verificação segue, então depth vale para todos os tokens. Os tokens a
+ * partir de `kept` são a cauda antiga, deslocada de `shift` posições: um
+ * ponto da cauda com a pilha vazia nas duas sequências encerra a
+ * verificação, e daí em diante vale o resultado antigo. O resultado
+ * antigo só guarda o primeiro erro: se ele ficou antes desse ponto e a
+ * edição o removeu, um erro seguinte da cauda não está registrado, e a
+ * verificação continua até achá-lo. */
+static void rebalance(IncrementalLexer* inc, long from, long kept, long shift,
+                      long old_error, long old_open) {
+    const char* src = inc->content;
+    int* stack = NULL;
+    long capacity = 0;
+    long depth = 0;
+    long error = -1;
+    long error_open = -1;
+    if (old_error >= 0 && old_error < from) {
+        error = old_error;
+        error_open = old_open;
+    }
+
+    for (long i = from; i < inc->count; i++) {
+        if (depth == 0 && i >= kept && inc->depth[i] == 0 &&
+            (error >= 0 || old_error < 0 || old_error >= i - shift)) {
+            if (error < 0 && old_error >= 0) {
+                error = old_error + shift;
+                error_open = old_open >= 0 ? old_open + shift : -1;
+            }
+            break;
+        }
+        inc->depth[i] = (int)depth;
+        inc->rebalanced++;
+
+        Token token = inc->tokens[i];
+        switch (token.type) {
+            case TOKEN_LPAREN: case TOKEN_LBRACE: case TOKEN_LBRACKET:
+                if (depth == capacity) {
+                    long grown = capacity > 0 ? capacity * 2 : 256;
+                    stack = (int*)arena_grow(&inc->scratch, stack, capacity * sizeof(int), grown * sizeof(int));
+                    capacity = grown;
+                }
+                stack[depth++] = (int)i;
+                continue;
+            case TOKEN_RPAREN: case TOKEN_RBRACE: case TOKEN_RBRACKET:
+                if (depth > 0 && src[inc->tokens[stack[depth - 1]].offset] == balance_opening(src[token.offset])) {
+                    depth--;
+                    continue;
+                }
+                break;
+            case TOKEN_EOF:
+                if (depth == 0) continue;
+                break;
+            default:
+                continue;
+        }
+        if (error < 0) {
+            error = i;
+            error_open = depth > 0 ? stack[depth - 1] : -1;
+        }
+    }
+    inc->balance_error = error;
+    inc->balance_open = error_open;
+}
+
+/* Monta o resultado da análise serial, que termina no primeiro erro
+ * léxico ou de balanceamento. As mensagens são refeitas a partir dos
+ * tokens, com as linhas atuais. */
+static void finish_result(IncrementalLexer* inc) {
+    long lex_error = inc->lex_error;
+    long balance_error = inc->balance_error;
+    if (balance_error >= 0 && (lex_error < 0 || balance_error < lex_error)) {
+        Token token = inc->tokens[balance_error];
+        BalanceState state;
+        balance_init(&state, &inc->scratch);
+        if (inc->balance_open >= 0) {
+            Token open = inc->tokens[inc->balance_open];
+            balance_push(&state, inc->content[open.offset], open.line);
+        }
+        if (token.type == TOKEN_EOF) {
+            balance_finish(&state, token.line, inc->error_msg, LEXER_ERROR_MSG_SIZE);
+        } else {
+            balance_close(&state, inc->content[token.offset], token.line, inc->error_msg, LEXER_ERROR_MSG_SIZE);
+        }
+        token.type = TOKEN_ERRO;
+        inc->result_count = balance_error + 1;
+        inc->result_last = token;
+    } else if (lex_error >= 0) {
+        Token token = inc->tokens[lex_error];
+        LexerContext lexer;
+        lexer_init_at(&lexer, inc->content, (int)token.offset, token.line, &inc->scratch);
+        get_next_token_unbalanced(&lexer);
+        memcpy(inc->error_msg, lexer.error_msg, LEXER_ERROR_MSG_SIZE);
+        inc->result_count = lex_error + 1;
+        inc->result_last = token;
+    } else {
+        inc->error_msg[0] = '\0';
+        inc->result_count = inc->count;
+        inc->result_last = inc->tokens[inc->count - 1];
+    }
+}
+
+/* --- Edição --- */
+
+/* Primeiro token que a edição em offset pode mudar: o primeiro cuja
+ * leitura chega a offset. Os tokens estão em ordem e não se sobrepõem. */
+static long first_affected(const IncrementalLexer* inc, long offset) {
+    long low = 0;
+    long high = inc->count;
+    while (low < high) {
+        long middle = low + (high - low) / 2;
+        if (token_end(inc->tokens[middle]) + LEXER_LOOKAHEAD > offset) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+static void replace_text(IncrementalLexer* inc, long offset, long removed, const char* text, long inserted) {
+    long length = inc->length - removed + inserted;
+    reserve_content(inc, length);
+    memmove(inc->content + offset + inserted, inc->content + offset + removed, inc->length - offset - removed);
+    memcpy(inc->content + offset, text, inserted);
+    memset(inc->content + length, 0, INCREMENTAL_PADDING);
+    inc->length = length;
+}
+
+void incremental_edit(IncrementalLexer* inc, long offset, long removed, const char* text, long inserted) {
+    arena_reset(&inc->scratch);
+    reserve_budget(inc, inc->length - removed + inserted);
+    inc->relexed = 0;
+    inc->rebalanced = 0;
+
+    /* O TOKEN_EOF sempre é alcançado, então first < count. */
+    long first = first_affected(inc, offset);
+    long byte_delta = inserted - removed;
+    int line_delta = count_newlines(text, inserted) - count_newlines(inc->content + offset, removed);
+    replace_text(inc, offset, removed, text, inserted);
+
+    /* Recomeça onde o lexer estava depois do último token intacto: uma
+     * fronteira de token, fora de qualquer texto. */
+    int pos = 0;
+    int line = 1;
+    if (first > 0) {
+        Token previous = inc->tokens[first - 1];
+        pos = (int)token_end(previous);
+        line = previous.line + count_newlines(inc->content + token_start(previous),
+                                              pos - token_start(previous));
+    }
+    inc->restart_line = line;
+    long balance_from = balance_restart(inc, first);
+
+    /* Tokens novos até o primeiro que começa, depois da edição, no início
+     * de um token antigo: os dois lexers estão no estado inicial diante do
+     * mesmo resto, então dali em diante as sequências coincidem. */
+    LexerContext lexer;
+    lexer_init_at(&lexer, inc->content, pos, line, &inc->scratch);
+    Token* fresh = NULL;
+    long fresh_count = 0;
+    long fresh_capacity = 0;
+    long old = first;
+    long old_edit_end = offset + removed;
+    long new_edit_end = offset + inserted;
+    int synced = 0;
+    for (;;) {
+        Token token = get_next_token_unbalanced(&lexer);
+        long start = token_start(token);
+        if (start >= new_edit_end) {
+            while (old < inc->count && token_start(inc->tokens[old]) + byte_delta < start) {
+                old++;
+            }
+            if (old < inc->count && token_start(inc->tokens[old]) >= old_edit_end &&
+                token_start(inc->tokens[old]) + byte_delta == start) {
+                synced = 1;
+                break;
+            }
+        }
+        if (fresh_count == fresh_capacity) {
+            long grown = fresh_capacity > 0 ? fresh_capacity * 2 : 256;
+            fresh = (Token*)arena_grow(&inc->scratch, fresh, fresh_capacity * sizeof(Token), grown * sizeof(Token));
+            fresh_capacity = grown;
+        }
+        fresh[fresh_count++] = token;
+        if (token.type == TOKEN_EOF) break;
+    }
+    inc->relexed = fresh_count;
+
+    /* Troca os tokens [first, old) pelos novos e desloca a cauda. */
+    long old_lex_error = inc->lex_error;
+    long tail = synced ? inc->count - old : 0;
+    long kept = first + fresh_count;
+    reserve_tokens(inc, kept + tail);
+    memmove(&inc->tokens[kept], &inc->tokens[old], tail * sizeof(Token));
+    memmove(&inc->depth[kept], &inc->depth[old], tail * sizeof(int));
+    if (fresh_count > 0) {
+        memcpy(&inc->tokens[first], fresh, fresh_count * sizeof(Token));
+    }
+    inc->count = kept + tail;
+    if (old_lex_error < 0 || old_lex_error >= first) {
+        inc->lex_error = -1;
+    }
+    for (long i = first; i < kept; i++) {
+        if (inc->lex_error < 0 && inc->tokens[i].type == TOKEN_ERRO) inc->lex_error = i;
+    }
+    for (long i = kept; i < kept + tail; i++) {
+        inc->tokens[i].offset += (int)byte_delta;
+        inc->tokens[i].line += line_delta;
+        if (inc->lex_error < 0 && inc->tokens[i].type == TOKEN_ERRO) inc->lex_error = i;
+    }
+
+    rebalance(inc, balance_from, synced ? kept : inc->count, kept - old,
+              inc->balance_error, inc->balance_open);
+    finish_result(inc);
+}
+
+void incremental_load(IncrementalLexer* inc, const char* content, long length) {
+    inc->length = 0;
+    inc->count = 0;
+    inc->lex_error = -1;
+    inc->balance_error = -1;
+    inc->balance_open = -1;
+    incremental_edit(inc, 0, 0, content, length);
+}
+
+/* --- Diferença entre Versões --- */
+
+static long common_prefix(const char* a, const char* b, long limit) {
+    long i = 0;
+    while (i + 8 <= limit) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        if (x != y) break;
+        i += 8;
+    }
+    while (i < limit && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+/* Como common_prefix, de trás para frente a partir de a_end e b_end. */
+static long common_suffix(const char* a_end, const char* b_end, long limit) {
+    long i = 0;
+    while (i + 8 <= limit) {
+        uint64_t x, y;
+        memcpy(&x, a_end - i - 8, 8);
+        memcpy(&y, b_end - i - 8, 8);
+        if (x != y) break;
+        i += 8;
+    }
+    while (i < limit && a_end[-i - 1] == b_end[-i - 1]) {
+        i++;
+    }
+    return i;
+}
+
+int incremental_update(IncrementalLexer* inc, const char* content, long length) {
+    if (inc->content == NULL) {
+        incremental_load(inc, content, length);
+        return 1;
+    }
+    long limit = inc->length < length ? inc->length : length;
+    long prefix = common_prefix(inc->content, content, limit);
+    if (prefix == limit && inc->length == length) return 0;
+    long suffix = common_suffix(inc->content + inc->length, content + length, limit - prefix);
+    incremental_edit(inc, prefix, inc->length - prefix - suffix, content + prefix, length - prefix - suffix);
+    return 1;
+}
@@ -0,0 +1,69 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "memoria.h"
+#include "lexico.h"
+
+/* --- Análise Léxica Incremental --- */
+
+/* Zeros depois do conteúdo: as leituras alinhadas dos núcleos de
+ * varredura podem passar do '\0' final. */
+#define INCREMENTAL_PADDING 64
+
+/* Conteúdo e tokens de um arquivo que muda aos poucos (modo --watch).
+ * tokens é a sequência do lexer sem balanceamento até o TOKEN_EOF, que
+ * continua depois de um TOKEN_ERRO (do fim do token rejeitado): corrigir
+ * um erro não obriga a analisar todo o resto de novo. depth[i] é a
+ * profundidade da pilha de balanceamento antes do token i.
+ * result_count, result_last e error_msg são a sequência que a análise
+ * serial produziria: result_last é o TOKEN_EOF ou o TOKEN_ERRO final. */
+typedef struct {
+    MemoryContext* memory;
+    Arena text_arena;
+    Arena token_arena;
+    Arena depth_arena;
+    Arena scratch;       /* tokens novos e pilha de uma edição */
+    char* content;
+    long length;
+    long capacity;
+    Token* tokens;
+    int* depth;
+    long count;
+    long token_capacity;
+    long lex_error;      /* primeiro TOKEN_ERRO, ou -1 */
+    long balance_error;  /* primeiro token rejeitado pelo balanceamento, ou -1 */
+    long balance_open;   /* abertura envolvida nesse erro, ou -1 */
+
+    long result_count;
+    Token result_last;
+    char error_msg[LEXER_ERROR_MSG_SIZE];
+
+    /* Custo da última atualização. */
+    long relexed;        /* tokens produzidos de novo pelo lexer */
+    long rebalanced;     /* tokens que passaram de novo pelo balanceamento */
+    int restart_line;    /* linha onde o lexer recomeçou */
+} IncrementalLexer;
+
+/* Os dados ficam em arenas próprias, contabilizadas em memory; o
+ * orçamento de memory cresce com o conteúdo. */
+void incremental_init(IncrementalLexer* inc, MemoryContext* memory);
+void incremental_destroy(IncrementalLexer* inc);
+
+/* Troca todo o conteúdo e analisa do início. */
+void incremental_load(IncrementalLexer* inc, const char* content, long length);
+
+/* Troca content[offset, offset + removed) por text[0, inserted). O lexer
+ * recomeça no fim do último token que a edição não alcança (fora de
+ * qualquer texto) e para no primeiro token que começa, depois da edição,
+ * onde um token antigo começava: dali em diante a sequência antiga vale,
+ * com offsets e linhas deslocados. O balanceamento recomeça no último
+ * ponto de profundidade zero antes da edição e para no primeiro ponto de
+ * profundidade zero comum às duas sequências depois do erro de
+ * balanceamento antigo, se houver. */
+void incremental_edit(IncrementalLexer* inc, long offset, long removed, const char* text, long inserted);
+
+/* Compara com a versão nova do conteúdo e aplica a diferença (entre o
+ * prefixo e o sufixo comuns) como uma edição. Retorna 0 se nada mudou. */
+int incremental_update(IncrementalLexer* inc, const char* content, long length);
+
+#endif
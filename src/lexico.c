@@ -1,116 +1,682 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "memoria.h"
+#include "lexico.h"
+#include "varredura.h"
+#include "balanceamento.h"
+#include "estatisticas.h"
 
-char reserveWords[11][256] = { 
-  "pricipal",
-  "funcao",
-  "retorno",
-  "leia",
-  "escreva",
-  "se",
-  "senao",
-  "para",
-  "inteiro",
-  "texto",
-  "decimal",
+const char* token_type_to_string(TokenType type) {
+    switch (type) {
+        case TOKEN_EOF: return "EOF";
+        case TOKEN_ERRO: return "ERRO";
+        case TOKEN_PRINCIPAL: return "PRINCIPAL";
+        case TOKEN_FUNCAO: return "FUNCAO";
+        case TOKEN_RETORNO: return "RETORNO";
+        case TOKEN_LEIA: return "LEIA";
+        case TOKEN_ESCREVA: return "ESCREVA";
+        case TOKEN_SE: return "SE";
+        case TOKEN_SENAO: return "SENAO";
+        case TOKEN_PARA: return "PARA";
+        case TOKEN_INTEIRO: return "INTEIRO";
+        case TOKEN_TEXTO: return "TEXTO";
+        case TOKEN_DECIMAL: return "DECIMAL";
+        case TOKEN_ID_VAR: return "ID_VAR";
+        case TOKEN_ID_FUNC: return "ID_FUNC";
+        case TOKEN_LITERAL_INT: return "LITERAL_INT";
+        case TOKEN_LITERAL_DEC: return "LITERAL_DEC";
+        case TOKEN_LITERAL_TEXTO: return "LITERAL_TEXTO";
+        case TOKEN_OP_SOMA: return "OP_SOMA";
+        case TOKEN_OP_SUB: return "OP_SUB";
+        case TOKEN_OP_MULT: return "OP_MULT";
+        case TOKEN_OP_DIV: return "OP_DIV";
+        case TOKEN_OP_EXP: return "OP_EXP";
+        case TOKEN_OP_ATRIB: return "OP_ATRIB";
+        case TOKEN_OP_IGUAL: return "OP_IGUAL";
+        case TOKEN_OP_DIF: return "OP_DIF";
+        case TOKEN_OP_MENOR: return "OP_MENOR";
+        case TOKEN_OP_MENOR_IGUAL: return "OP_MENOR_IGUAL";
+        case TOKEN_OP_MAIOR: return "OP_MAIOR";
+        case TOKEN_OP_MAIOR_IGUAL: return "OP_MAIOR_IGUAL";
+        case TOKEN_OP_E: return "OP_E";
+        case TOKEN_OP_OU: return "OP_OU";
+        case TOKEN_OP_INC: return "OP_INC";
+        case TOKEN_OP_DEC: return "OP_DEC";
+        case TOKEN_LPAREN: return "LPAREN";
+        case TOKEN_RPAREN: return "RPAREN";
+        case TOKEN_LBRACE: return "LBRACE";
+        case TOKEN_RBRACE: return "RBRACE";
+        case TOKEN_LBRACKET: return "LBRACKET";
+        case TOKEN_RBRACKET: return "RBRACKET";
+        case TOKEN_VIRGULA: return "VIRGULA";
+        case TOKEN_PONTO_VIRGULA: return "PONTO_VIRGULA";
+        case TOKEN_PONTO: return "PONTO";
+        default: return "DESCONHECIDO";
+    }
+}
+
+/* --- Tabelas do Autômato --- */
+
+/* Classes de caractere. As classes a partir de CC_EXCL são os "caracteres
+ * especiais" da regra de sequências inválidas de 3 ou mais símbolos. */
+typedef enum {
+    CC_OUTRO, CC_ESPACO, CC_NOVA_LINHA, CC_FIM,
+    CC_MINUSCULA, CC_MAIUSCULA, CC_DIGITO, CC_SUBLINHADO, CC_ASPAS,
+    CC_PONTO, CC_VIRGULA, CC_PONTO_VIRGULA,
+    CC_ABRE_PAREN, CC_FECHA_PAREN, CC_ABRE_CHAVE, CC_FECHA_CHAVE,
+    CC_ABRE_COLCHETE, CC_FECHA_COLCHETE,
+    CC_EXCL, CC_IGUAL, CC_MAIS, CC_MENOS, CC_MULT, CC_DIV, CC_EXP,
+    CC_MENOR, CC_MAIOR, CC_E, CC_OU,
+    NUM_CLASSES
+} CharClass;
+
+static const unsigned char char_class[256] = {
+    ['\0'] = CC_FIM,
+    [' '] = CC_ESPACO, ['\t'] = CC_ESPACO, ['\v'] = CC_ESPACO, ['\f'] = CC_ESPACO,
+    ['\r'] = CC_ESPACO, ['\\'] = CC_ESPACO, ['\n'] = CC_NOVA_LINHA,
+    ['a'] = CC_MINUSCULA, ['b'] = CC_MINUSCULA, ['c'] = CC_MINUSCULA, ['d'] = CC_MINUSCULA,
+    ['e'] = CC_MINUSCULA, ['f'] = CC_MINUSCULA, ['g'] = CC_MINUSCULA, ['h'] = CC_MINUSCULA,
+    ['i'] = CC_MINUSCULA, ['j'] = CC_MINUSCULA, ['k'] = CC_MINUSCULA, ['l'] = CC_MINUSCULA,
+    ['m'] = CC_MINUSCULA, ['n'] = CC_MINUSCULA, ['o'] = CC_MINUSCULA, ['p'] = CC_MINUSCULA,
+    ['q'] = CC_MINUSCULA, ['r'] = CC_MINUSCULA, ['s'] = CC_MINUSCULA, ['t'] = CC_MINUSCULA,
+    ['u'] = CC_MINUSCULA, ['v'] = CC_MINUSCULA, ['w'] = CC_MINUSCULA, ['x'] = CC_MINUSCULA,
+    ['y'] = CC_MINUSCULA, ['z'] = CC_MINUSCULA,
+    ['A'] = CC_MAIUSCULA, ['B'] = CC_MAIUSCULA, ['C'] = CC_MAIUSCULA, ['D'] = CC_MAIUSCULA,
+    ['E'] = CC_MAIUSCULA, ['F'] = CC_MAIUSCULA, ['G'] = CC_MAIUSCULA, ['H'] = CC_MAIUSCULA,
+    ['I'] = CC_MAIUSCULA, ['J'] = CC_MAIUSCULA, ['K'] = CC_MAIUSCULA, ['L'] = CC_MAIUSCULA,
+    ['M'] = CC_MAIUSCULA, ['N'] = CC_MAIUSCULA, ['O'] = CC_MAIUSCULA, ['P'] = CC_MAIUSCULA,
+    ['Q'] = CC_MAIUSCULA, ['R'] = CC_MAIUSCULA, ['S'] = CC_MAIUSCULA, ['T'] = CC_MAIUSCULA,
+    ['U'] = CC_MAIUSCULA, ['V'] = CC_MAIUSCULA, ['W'] = CC_MAIUSCULA, ['X'] = CC_MAIUSCULA,
+    ['Y'] = CC_MAIUSCULA, ['Z'] = CC_MAIUSCULA,
+    ['0'] = CC_DIGITO, ['1'] = CC_DIGITO, ['2'] = CC_DIGITO, ['3'] = CC_DIGITO, ['4'] = CC_DIGITO,
+    ['5'] = CC_DIGITO, ['6'] = CC_DIGITO, ['7'] = CC_DIGITO, ['8'] = CC_DIGITO, ['9'] = CC_DIGITO,
+    ['_'] = CC_SUBLINHADO, ['"'] = CC_ASPAS,
+    ['.'] = CC_PONTO, [','] = CC_VIRGULA, [';'] = CC_PONTO_VIRGULA,
+    ['('] = CC_ABRE_PAREN, [')'] = CC_FECHA_PAREN,
+    ['{'] = CC_ABRE_CHAVE, ['}'] = CC_FECHA_CHAVE,
+    ['['] = CC_ABRE_COLCHETE, [']'] = CC_FECHA_COLCHETE,
+    ['!'] = CC_EXCL, ['='] = CC_IGUAL, ['+'] = CC_MAIS, ['-'] = CC_MENOS,
+    ['*'] = CC_MULT, ['/'] = CC_DIV, ['^'] = CC_EXP,
+    ['<'] = CC_MENOR, ['>'] = CC_MAIOR, ['&'] = CC_E, ['|'] = CC_OU,
+};
+
+/* Estados. ST_PAR_* são os estados após dois caracteres especiais: um
+ * terceiro especial gera o erro de sequência inválida, qualquer outro
+ * caractere aceita o resultado indicado pelo nome. Estados a partir de
+ * ST_PRIMEIRO_FINAL são finais e têm uma ação em final_actions. */
+typedef enum {
+    ST_NENHUM,
+    ST_INICIO, ST_SUBLINHADO, ST_SUBLINHADO_DUPLO, ST_FUNCAO, ST_PALAVRA,
+    ST_INTEIRO, ST_DECIMAL, ST_TEXTO, ST_VARIAVEL,
+    ST_EXCL, ST_IGUAL, ST_MAIS, ST_MENOS, ST_MULT, ST_DIV, ST_EXP,
+    ST_MENOR, ST_MAIOR, ST_E, ST_OU,
+    ST_PAR_INC, ST_PAR_DEC, ST_PAR_IGUAL, ST_PAR_MENOR_IGUAL, ST_PAR_DIF,
+    ST_PAR_MAIOR_IGUAL, ST_PAR_E, ST_PAR_OU, ST_PAR_SOMA, ST_PAR_SUB,
+    ST_PAR_MULT, ST_PAR_DIV, ST_PAR_EXP, ST_PAR_ATRIB, ST_PAR_MENOR, ST_PAR_MAIOR,
+    ST_PAR_ERRO_DIF, ST_PAR_ERRO_INVERTIDO, ST_PAR_ERRO_MENOR, ST_PAR_ERRO_MAIOR,
+    ST_PAR_ERRO_VAR, ST_PAR_INESPERADO,
+
+    ST_PRIMEIRO_FINAL,
+    FIM_EOF = ST_PRIMEIRO_FINAL, FIM_PALAVRA, FIM_FUNCAO, FIM_INTEIRO, FIM_DECIMAL,
+    FIM_TEXTO, FIM_VARIAVEL,
+    FIM_SOMA, FIM_SUB, FIM_MULT, FIM_DIV, FIM_EXP, FIM_ATRIB, FIM_IGUAL, FIM_DIF,
+    FIM_MENOR, FIM_MENOR_IGUAL, FIM_MAIOR, FIM_MAIOR_IGUAL, FIM_E, FIM_OU,
+    FIM_INC, FIM_DEC,
+    FIM_LPAREN, FIM_RPAREN, FIM_LBRACE, FIM_RBRACE, FIM_LBRACKET, FIM_RBRACKET,
+    FIM_VIRGULA, FIM_PONTO_VIRGULA, FIM_PONTO,
+    FIM_ERRO_SEQUENCIA, FIM_ERRO_FUNCAO, FIM_ERRO_TEXTO, FIM_ERRO_VAR,
+    FIM_ERRO_DIF, FIM_ERRO_INVERTIDO, FIM_ERRO_MENOR, FIM_ERRO_MAIOR, FIM_INESPERADO,
+    NUM_STATES
+} LexerState;
+
+/* Transições de dois caracteres especiais, na ordem das classes CC_EXCL..CC_OU. */
+#define PARES(excl, igual, mais, menos, mult, div, exp, menor, maior, e, ou) \
+    [CC_EXCL] = excl, [CC_IGUAL] = igual, [CC_MAIS] = mais, [CC_MENOS] = menos, \
+    [CC_MULT] = mult, [CC_DIV] = div, [CC_EXP] = exp, [CC_MENOR] = menor, \
+    [CC_MAIOR] = maior, [CC_E] = e, [CC_OU] = ou
+#define PARES_UNIFORMES(d) PARES(d, d, d, d, d, d, d, d, d, d, d)
+#define ALFANUMERICOS(d) [CC_MINUSCULA] = d, [CC_MAIUSCULA] = d, [CC_DIGITO] = d
+
+/* Transições explícitas; ST_NENHUM significa "use default_transition". */
+static const unsigned char transitions[ST_PRIMEIRO_FINAL][NUM_CLASSES] = {
+    [ST_INICIO] = {
+        [CC_FIM] = FIM_EOF,
+        [CC_MINUSCULA] = ST_PALAVRA, [CC_MAIUSCULA] = ST_PALAVRA, [CC_DIGITO] = ST_INTEIRO,
+        [CC_SUBLINHADO] = ST_SUBLINHADO, [CC_ASPAS] = ST_TEXTO,
+        [CC_PONTO] = FIM_PONTO, [CC_VIRGULA] = FIM_VIRGULA, [CC_PONTO_VIRGULA] = FIM_PONTO_VIRGULA,
+        [CC_ABRE_PAREN] = FIM_LPAREN, [CC_FECHA_PAREN] = FIM_RPAREN,
+        [CC_ABRE_CHAVE] = FIM_LBRACE, [CC_FECHA_CHAVE] = FIM_RBRACE,
+        [CC_ABRE_COLCHETE] = FIM_LBRACKET, [CC_FECHA_COLCHETE] = FIM_RBRACKET,
+        PARES(ST_EXCL, ST_IGUAL, ST_MAIS, ST_MENOS, ST_MULT, ST_DIV, ST_EXP,
+              ST_MENOR, ST_MAIOR, ST_E, ST_OU),
+    },
+    [ST_SUBLINHADO] = { [CC_SUBLINHADO] = ST_SUBLINHADO_DUPLO },
+    [ST_SUBLINHADO_DUPLO] = { ALFANUMERICOS(ST_FUNCAO) },
+    [ST_FUNCAO] = { ALFANUMERICOS(ST_FUNCAO) },
+    [ST_PALAVRA] = { ALFANUMERICOS(ST_PALAVRA) },
+    [ST_INTEIRO] = { [CC_DIGITO] = ST_INTEIRO, [CC_PONTO] = ST_DECIMAL },
+    [ST_DECIMAL] = { [CC_DIGITO] = ST_DECIMAL },
+    [ST_TEXTO] = { [CC_ASPAS] = FIM_TEXTO, [CC_FIM] = FIM_ERRO_TEXTO },
+    [ST_VARIAVEL] = { ALFANUMERICOS(ST_VARIAVEL) },
+
+    /*                excl                 igual                    mais            menos
+                      mult                 div                      exp             menor
+                      maior                e                        ou */
+    [ST_EXCL] = { [CC_MINUSCULA] = ST_VARIAVEL,
+        PARES(ST_PAR_ERRO_VAR,  ST_PAR_ERRO_DIF,       ST_PAR_ERRO_VAR, ST_PAR_ERRO_VAR,
+              ST_PAR_ERRO_VAR,  ST_PAR_ERRO_VAR,       ST_PAR_ERRO_VAR, ST_PAR_ERRO_VAR,
+              ST_PAR_ERRO_VAR,  ST_PAR_ERRO_VAR,       ST_PAR_ERRO_VAR) },
+    [ST_IGUAL] = {
+        PARES(ST_PAR_ATRIB,     ST_PAR_IGUAL,          ST_PAR_ATRIB,    ST_PAR_ATRIB,
+              ST_PAR_ATRIB,     ST_PAR_ATRIB,          ST_PAR_ATRIB,    ST_PAR_ERRO_INVERTIDO,
+              ST_PAR_ERRO_INVERTIDO, ST_PAR_ATRIB,     ST_PAR_ATRIB) },
+    [ST_MAIS] = {
+        PARES(ST_PAR_SOMA,      ST_PAR_SOMA,           ST_PAR_INC,      ST_PAR_SOMA,
+              ST_PAR_SOMA,      ST_PAR_SOMA,           ST_PAR_SOMA,     ST_PAR_SOMA,
+              ST_PAR_SOMA,      ST_PAR_SOMA,           ST_PAR_SOMA) },
+    [ST_MENOS] = {
+        PARES(ST_PAR_SUB,       ST_PAR_SUB,            ST_PAR_SUB,      ST_PAR_DEC,
+              ST_PAR_SUB,       ST_PAR_SUB,            ST_PAR_SUB,      ST_PAR_SUB,
+              ST_PAR_SUB,       ST_PAR_SUB,            ST_PAR_SUB) },
+    [ST_MULT] = { PARES_UNIFORMES(ST_PAR_MULT) },
+    [ST_DIV] = { PARES_UNIFORMES(ST_PAR_DIV) },
+    [ST_EXP] = { PARES_UNIFORMES(ST_PAR_EXP) },
+    [ST_MENOR] = {
+        PARES(ST_PAR_MENOR,     ST_PAR_MENOR_IGUAL,    ST_PAR_MENOR,    ST_PAR_MENOR,
+              ST_PAR_MENOR,     ST_PAR_MENOR,          ST_PAR_MENOR,    ST_PAR_ERRO_MENOR,
+              ST_PAR_DIF,       ST_PAR_MENOR,          ST_PAR_MENOR) },
+    [ST_MAIOR] = {
+        PARES(ST_PAR_MAIOR,     ST_PAR_MAIOR_IGUAL,    ST_PAR_MAIOR,    ST_PAR_MAIOR,
+              ST_PAR_MAIOR,     ST_PAR_MAIOR,          ST_PAR_MAIOR,    ST_PAR_ERRO_MAIOR,
+              ST_PAR_ERRO_MAIOR, ST_PAR_MAIOR,         ST_PAR_MAIOR) },
+    [ST_E] = {
+        PARES(ST_PAR_INESPERADO, ST_PAR_INESPERADO,    ST_PAR_INESPERADO, ST_PAR_INESPERADO,
+              ST_PAR_INESPERADO, ST_PAR_INESPERADO,    ST_PAR_INESPERADO, ST_PAR_INESPERADO,
+              ST_PAR_INESPERADO, ST_PAR_E,             ST_PAR_INESPERADO) },
+    [ST_OU] = {
+        PARES(ST_PAR_INESPERADO, ST_PAR_INESPERADO,    ST_PAR_INESPERADO, ST_PAR_INESPERADO,
+              ST_PAR_INESPERADO, ST_PAR_INESPERADO,    ST_PAR_INESPERADO, ST_PAR_INESPERADO,
+              ST_PAR_INESPERADO, ST_PAR_INESPERADO,    ST_PAR_OU) },
+
+    [ST_PAR_INC] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_DEC] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_IGUAL] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_MENOR_IGUAL] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_DIF] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_MAIOR_IGUAL] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_E] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_OU] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_SOMA] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_SUB] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_MULT] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_DIV] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_EXP] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_ATRIB] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_MENOR] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_MAIOR] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_ERRO_DIF] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_ERRO_INVERTIDO] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_ERRO_MENOR] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_ERRO_MAIOR] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_ERRO_VAR] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+    [ST_PAR_INESPERADO] = { PARES_UNIFORMES(FIM_ERRO_SEQUENCIA) },
+};
+
+/* Destino para toda classe sem transição explícita. */
+static const unsigned char default_transition[ST_PRIMEIRO_FINAL] = {
+    [ST_INICIO] = FIM_INESPERADO,
+    [ST_SUBLINHADO] = FIM_INESPERADO,
+    [ST_SUBLINHADO_DUPLO] = FIM_ERRO_FUNCAO,
+    [ST_FUNCAO] = FIM_FUNCAO,
+    [ST_PALAVRA] = FIM_PALAVRA,
+    [ST_INTEIRO] = FIM_INTEIRO,
+    [ST_DECIMAL] = FIM_DECIMAL,
+    [ST_TEXTO] = ST_TEXTO,
+    [ST_VARIAVEL] = FIM_VARIAVEL,
+    [ST_EXCL] = FIM_ERRO_VAR,
+    [ST_IGUAL] = FIM_ATRIB,
+    [ST_MAIS] = FIM_SOMA,
+    [ST_MENOS] = FIM_SUB,
+    [ST_MULT] = FIM_MULT,
+    [ST_DIV] = FIM_DIV,
+    [ST_EXP] = FIM_EXP,
+    [ST_MENOR] = FIM_MENOR,
+    [ST_MAIOR] = FIM_MAIOR,
+    [ST_E] = FIM_INESPERADO,
+    [ST_OU] = FIM_INESPERADO,
+    [ST_PAR_INC] = FIM_INC,
+    [ST_PAR_DEC] = FIM_DEC,
+    [ST_PAR_IGUAL] = FIM_IGUAL,
+    [ST_PAR_MENOR_IGUAL] = FIM_MENOR_IGUAL,
+    [ST_PAR_DIF] = FIM_DIF,
+    [ST_PAR_MAIOR_IGUAL] = FIM_MAIOR_IGUAL,
+    [ST_PAR_E] = FIM_E,
+    [ST_PAR_OU] = FIM_OU,
+    [ST_PAR_SOMA] = FIM_SOMA,
+    [ST_PAR_SUB] = FIM_SUB,
+    [ST_PAR_MULT] = FIM_MULT,
+    [ST_PAR_DIV] = FIM_DIV,
+    [ST_PAR_EXP] = FIM_EXP,
+    [ST_PAR_ATRIB] = FIM_ATRIB,
+    [ST_PAR_MENOR] = FIM_MENOR,
+    [ST_PAR_MAIOR] = FIM_MAIOR,
+    [ST_PAR_ERRO_DIF] = FIM_ERRO_DIF,
+    [ST_PAR_ERRO_INVERTIDO] = FIM_ERRO_INVERTIDO,
+    [ST_PAR_ERRO_MENOR] = FIM_ERRO_MENOR,
+    [ST_PAR_ERRO_MAIOR] = FIM_ERRO_MAIOR,
+    [ST_PAR_ERRO_VAR] = FIM_ERRO_VAR,
+    [ST_PAR_INESPERADO] = FIM_INESPERADO,
+};
+
+/* Estados de repetição, avançados em bloco pelos núcleos de varredura. */
+typedef enum { RUN_NENHUM, RUN_ALFANUMERICO, RUN_DIGITOS, RUN_TEXTO } RunKind;
+
+static const unsigned char run_kind[ST_PRIMEIRO_FINAL] = {
+    [ST_FUNCAO] = RUN_ALFANUMERICO,
+    [ST_PALAVRA] = RUN_ALFANUMERICO,
+    [ST_VARIAVEL] = RUN_ALFANUMERICO,
+    [ST_INTEIRO] = RUN_DIGITOS,
+    [ST_DECIMAL] = RUN_DIGITOS,
+    [ST_TEXTO] = RUN_TEXTO,
 };
 
-char operators[14][256] = {
-  "+",
-  "-",
-  "*",
-  "/",
-  "^",
-  "=",
-  "==",
-  "<",
-  ">",
-  "<=",
-  ">=",
-  "<>",
-  "&&",
-  "||"
+/* Comprimento do lexema de um estado final: fixo (>= 0), até o último
+ * caractere lido exclusive (LEN_ATE_ANTERIOR) ou inclusive (LEN_ATE_ATUAL). */
+#define LEN_ATE_ANTERIOR (-1)
+#define LEN_ATE_ATUAL (-2)
+
+typedef struct {
+    TokenType type;
+    signed char length;
+    const char* message; /* formato com os caracteres do lexema, para erros */
+} FinalAction;
+
+static const FinalAction final_actions[NUM_STATES - ST_PRIMEIRO_FINAL] = {
+#define ACAO(estado, tipo, comprimento, mensagem) \
+    [(estado) - ST_PRIMEIRO_FINAL] = { tipo, comprimento, mensagem }
+    ACAO(FIM_EOF, TOKEN_EOF, LEN_ATE_ANTERIOR, NULL),
+    ACAO(FIM_PALAVRA, TOKEN_ERRO, LEN_ATE_ANTERIOR, "Identificador inválido (deve começar com '!' ou '__')"),
+    ACAO(FIM_FUNCAO, TOKEN_ID_FUNC, LEN_ATE_ANTERIOR, NULL),
+    ACAO(FIM_INTEIRO, TOKEN_LITERAL_INT, LEN_ATE_ANTERIOR, NULL),
+    ACAO(FIM_DECIMAL, TOKEN_LITERAL_DEC, LEN_ATE_ANTERIOR, NULL),
+    ACAO(FIM_TEXTO, TOKEN_LITERAL_TEXTO, LEN_ATE_ATUAL, NULL),
+    ACAO(FIM_VARIAVEL, TOKEN_ID_VAR, LEN_ATE_ANTERIOR, NULL),
+    ACAO(FIM_SOMA, TOKEN_OP_SOMA, 1, NULL),
+    ACAO(FIM_SUB, TOKEN_OP_SUB, 1, NULL),
+    ACAO(FIM_MULT, TOKEN_OP_MULT, 1, NULL),
+    ACAO(FIM_DIV, TOKEN_OP_DIV, 1, NULL),
+    ACAO(FIM_EXP, TOKEN_OP_EXP, 1, NULL),
+    ACAO(FIM_ATRIB, TOKEN_OP_ATRIB, 1, NULL),
+    ACAO(FIM_IGUAL, TOKEN_OP_IGUAL, 2, NULL),
+    ACAO(FIM_DIF, TOKEN_OP_DIF, 2, NULL),
+    ACAO(FIM_MENOR, TOKEN_OP_MENOR, 1, NULL),
+    ACAO(FIM_MENOR_IGUAL, TOKEN_OP_MENOR_IGUAL, 2, NULL),
+    ACAO(FIM_MAIOR, TOKEN_OP_MAIOR, 1, NULL),
+    ACAO(FIM_MAIOR_IGUAL, TOKEN_OP_MAIOR_IGUAL, 2, NULL),
+    ACAO(FIM_E, TOKEN_OP_E, 2, NULL),
+    ACAO(FIM_OU, TOKEN_OP_OU, 2, NULL),
+    ACAO(FIM_INC, TOKEN_OP_INC, 2, NULL),
+    ACAO(FIM_DEC, TOKEN_OP_DEC, 2, NULL),
+    ACAO(FIM_LPAREN, TOKEN_LPAREN, 1, NULL),
+    ACAO(FIM_RPAREN, TOKEN_RPAREN, 1, NULL),
+    ACAO(FIM_LBRACE, TOKEN_LBRACE, 1, NULL),
+    ACAO(FIM_RBRACE, TOKEN_RBRACE, 1, NULL),
+    ACAO(FIM_LBRACKET, TOKEN_LBRACKET, 1, NULL),
+    ACAO(FIM_RBRACKET, TOKEN_RBRACKET, 1, NULL),
+    ACAO(FIM_VIRGULA, TOKEN_VIRGULA, 1, NULL),
+    ACAO(FIM_PONTO_VIRGULA, TOKEN_PONTO_VIRGULA, 1, NULL),
+    ACAO(FIM_PONTO, TOKEN_PONTO, 1, NULL),
+    ACAO(FIM_ERRO_SEQUENCIA, TOKEN_ERRO, 3, "ERRO: Sequência inválida de 3 ou mais caracteres especiais: %c%c%c"),
+    ACAO(FIM_ERRO_FUNCAO, TOKEN_ERRO, 2, "Nome de função inválido: '__' deve ser seguido por um caractere alfanumérico."),
+    ACAO(FIM_ERRO_TEXTO, TOKEN_ERRO, LEN_ATE_ANTERIOR, "String não terminada"), /* ver lexer_scan */
+    ACAO(FIM_ERRO_VAR, TOKEN_ERRO, 1, "Nome de variável inválido"),
+    ACAO(FIM_ERRO_DIF, TOKEN_ERRO, 2, "Operador inválido: !="),
+    ACAO(FIM_ERRO_INVERTIDO, TOKEN_ERRO, 2, "Operador invertido inválido"),
+    ACAO(FIM_ERRO_MENOR, TOKEN_ERRO, 2, "Operador duplicado inválido: <<"),
+    ACAO(FIM_ERRO_MAIOR, TOKEN_ERRO, 2, "Operador duplicado/invertido inválido"),
+    ACAO(FIM_INESPERADO, TOKEN_ERRO, 1, "Caractere ou sequência inesperada começando com: %c"),
+#undef ACAO
 };
 
-int prefix(const char *pre, const char *str) {
-    int returnValue = -1;
+int lexer_balance_token(BalanceState* balance, const char* src, Token* token, char* error_msg) {
+    int balanced = 1;
+    switch (token->type) {
+        case TOKEN_LPAREN: case TOKEN_LBRACE: case TOKEN_LBRACKET:
+            balance_push(balance, src[token->offset], token->line);
+            break;
+        case TOKEN_RPAREN: case TOKEN_RBRACE: case TOKEN_RBRACKET:
+            balanced = balance_close(balance, src[token->offset], token->line,
+                                     error_msg, LEXER_ERROR_MSG_SIZE);
+            break;
+        case TOKEN_EOF:
+            balanced = balance_finish(balance, token->line, error_msg, LEXER_ERROR_MSG_SIZE);
+            balance_clear(balance);
+            break;
+        default:
+            break;
+    }
+    if (!balanced) {
+        token->type = TOKEN_ERRO;
+    }
+    return balanced;
+}
 
-    if(strncmp(pre, str, strlen(pre)) == 0 && strlen(str) >= strlen(pre) + 1) {
-      
-      returnValue = 0;
-    } 
-  return returnValue;
+/* Executa o autômato a partir de src[*pos]: um laço por byte, sem ctype.
+ * Espaços em branco antes do token e o corpo de identificadores, números e
+ * textos são pulados em bloco pelos núcleos de varredura. Com balance,
+ * parênteses, chaves, colchetes e aspas são verificados na mesma passada. */
+static Token lexer_scan(const char* src, int* pos, int* line, BalanceState* balance, char* error_msg) {
+    const ScanKernels* kernels = scan_kernels;
+    int p = kernels->skip_whitespace(src, *pos, line);
+    int start = p;
+    int token_line = *line;
+    unsigned state = ST_INICIO;
+
+    while (1) {
+        unsigned cls = char_class[(unsigned char)src[p++]];
+        unsigned next = transitions[state][cls];
+        state = next != ST_NENHUM ? next : default_transition[state];
+        if (state >= ST_PRIMEIRO_FINAL) break;
+        switch (run_kind[state]) {
+            case RUN_ALFANUMERICO: p = kernels->skip_alnum(src, p); break;
+            case RUN_DIGITOS: p = kernels->skip_digits(src, p); break;
+            case RUN_TEXTO: p = kernels->skip_string(src, p, line); break;
+        }
+    }
+
+    const FinalAction* action = &final_actions[state - ST_PRIMEIRO_FINAL];
+    if (action->length >= 0) {
+        p = start + action->length;
+    } else if (action->length == LEN_ATE_ANTERIOR) {
+        p--;
+    }
+    *pos = p;
 
+    Token token;
+    token.type = action->type;
+    token.offset = start;
+    token.length = p - start;
+    token.line = token_line;
+
+    if (state == FIM_PALAVRA) {
+        int keyword_token = is_keyword(&src[start], token.length);
+        if (keyword_token) {
+            token.type = (TokenType)keyword_token;
+            return token;
+        }
+    } else if (state == FIM_TEXTO) {
+        token.offset++;
+        token.length -= 2;
+    } else if (state == FIM_ERRO_TEXTO) {
+        balance_unclosed_message('"', token_line, *line, error_msg, LEXER_ERROR_MSG_SIZE);
+        return token;
+    }
+    if (balance != NULL && !lexer_balance_token(balance, src, &token, error_msg)) {
+        return token;
+    }
+    if (token.type == TOKEN_ERRO) {
+        char c1 = src[start];
+        char c2 = c1 ? src[start + 1] : '\0';
+        char c3 = c2 ? src[start + 2] : '\0';
+        snprintf(error_msg, LEXER_ERROR_MSG_SIZE, action->message, c1, c2, c3);
+    }
+    return token;
 }
 
+/* --- Recuperação de Erros --- */
 
-int is_separator(char c) {
-    return c == ' ' || c == ',' || c == '(' || c == ')' || 
-           c == ';' || c == '{' || c == '}' || c == '\n' || c == '\0';
+/* Classes em que a análise retoma depois de um erro. */
+static int is_sync_class(unsigned cls) {
+    return cls == CC_FIM || cls == CC_ESPACO || cls == CC_NOVA_LINHA || cls == CC_ASPAS ||
+           (cls >= CC_VIRGULA && cls <= CC_FECHA_COLCHETE);
+}
+
+/* Coluna de content[offset], a partir de 1, contada em caracteres UTF-8.
+ * Só é calculada para erros, voltando até o início da linha. */
+static int column_at(const char* content, int offset) {
+    int column = 1;
+    for (int i = offset - 1; i >= 0 && content[i] != '\n'; i--) {
+        column += ((unsigned char)content[i] & 0xC0) != 0x80;
+    }
+    return column;
 }
 
-int isVaribleOrFunction(char *token) {
-  if (prefix("__", token) == 0 || prefix("!", token) == 0) {
-    return 0; 
-  }else {
-    return -1;
-  }
+static void lexer_report(LexerContext* ctx, int line, int offset, const char* message) {
+    Diagnostics* diagnostics = ctx->diagnostics;
+    if (ctx->after_error && diagnostics->count > 0) {
+        const Diagnostic* last = &diagnostics->items[diagnostics->count - 1];
+        if (last->line == line && strcmp(last->message, message) == 0) return;
+    }
+    diagnostics_add_at(diagnostics, DIAG_ERRO, line, column_at(ctx->content, offset), "%s", message);
+    ctx->after_error = 1;
 }
 
-int isReservedWord(char *token) {
-  int i = 0;
-  for(i = 0; i < 11; i++) {
-    if(strcmp(token, reserveWords[i]) == 0) {
-      return 0; 
+/* Depois de um TOKEN_ERRO: um texto sem fim vai até o fim do conteúdo, e a
+ * análise recomeça no fim da linha das aspas; os outros erros pulam até o
+ * próximo separador. */
+static void lexer_resync(LexerContext* ctx, Token error) {
+    const char* src = ctx->content;
+    int p = ctx->pos;
+    if (src[error.offset] == '"') {
+        p = error.offset + 1;
+        while (src[p] != '\n' && src[p] != '\0') p++;
+        ctx->line = error.line;
+    } else {
+        while (!is_sync_class(char_class[(unsigned char)src[p]])) p++;
     }
-  }
-  return -1; 
+    ctx->pos = p;
 }
 
-int isOperator(char *token) {
-  int i = 0;
-  for(i = 0; i < 14; i++) {
-    if(strcmp(token, operators[i]) == 0) {
-      return 0;   
+/* Balanceamento com recuperação. Retorna 0 se o token fechou um símbolo
+ * errado ou se o conteúdo terminou com aberturas pendentes. */
+static int lexer_balance_recovering(LexerContext* ctx, const Token* token) {
+    BalanceState* balance = &ctx->balance;
+    char symbol = ctx->content[token->offset];
+    switch (token->type) {
+        case TOKEN_LPAREN: case TOKEN_LBRACE: case TOKEN_LBRACKET:
+            balance_push(balance, symbol, token->line);
+            return 1;
+        case TOKEN_RPAREN: case TOKEN_RBRACE: case TOKEN_RBRACKET:
+            if (balance_close_recovering(balance, symbol, token->line, ctx->error_msg,
+                                         LEXER_ERROR_MSG_SIZE)) {
+                return 1;
+            }
+            lexer_report(ctx, token->line, token->offset, ctx->error_msg);
+            return 0;
+        case TOKEN_EOF: {
+            int balanced = 1;
+            while (ctx->diagnostics->errors < ctx->error_limit &&
+                   !balance_finish(balance, token->line, ctx->error_msg, LEXER_ERROR_MSG_SIZE)) {
+                lexer_report(ctx, token->line, token->offset, ctx->error_msg);
+                balance_drop(balance);
+                balanced = 0;
+            }
+            balance_clear(balance);
+            return balanced;
+        }
+        default:
+            return 1;
     }
-  }
-  return -1;
 }
 
-int verifySymbols(char line[256], int listNumberd) {
-  int i = 0;
-  int j = 0;
+static Token lexer_scan_recovering(LexerContext* ctx) {
+    while (ctx->diagnostics->errors < ctx->error_limit) {
+        Token token = lexer_scan(ctx->content, &ctx->pos, &ctx->line, NULL, ctx->error_msg);
+        if (token.type == TOKEN_ERRO) {
+            lexer_report(ctx, token.line, token.offset, ctx->error_msg);
+            lexer_resync(ctx, token);
+            continue;
+        }
+        if (lexer_balance_recovering(ctx, &token)) {
+            ctx->after_error = 0;
+        }
+        return token;
+    }
+    Token token = { TOKEN_EOF, ctx->pos, 0, ctx->line };
+    return token;
+}
+
+void lexer_enable_recovery(LexerContext* ctx, Diagnostics* diagnostics, int error_limit) {
+    ctx->diagnostics = diagnostics;
+    ctx->error_limit = error_limit;
+    ctx->after_error = 0;
+}
+
+char* token_text(LexerContext* ctx, Token token) {
+    if (token.type == TOKEN_EOF) return NULL;
+    const char* text = token.type == TOKEN_ERRO ? ctx->error_msg : &ctx->content[token.offset];
+    int length = token.type == TOKEN_ERRO ? (int)strlen(ctx->error_msg) : token.length;
+
+    char* copy = (char*)arena_alloc(ctx->arena, length + 1);
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+/* --- Palavras Reservadas --- */
 
-  char *tokens;
+/* Hash perfeito sobre (comprimento, primeira letra, última letra): as 11
+ * palavras caem em posições distintas de uma tabela de 32. A posição de
+ * cada entrada é calculada pela mesma fórmula em tempo de compilação; uma
+ * colisão apareceria como aviso de inicializador sobrescrito. */
+#define KEYWORD_TABLE_SIZE 32
+#define KEYWORD_SLOT(first, last, length) \
+    ((((unsigned)(length) << 1) + (unsigned char)(first) + (unsigned char)(last)) & (KEYWORD_TABLE_SIZE - 1))
 
-  int errorFlag = 0;
+typedef struct {
+    const char* text;
+    int length;
+    TokenType type;
+} Keyword;
 
-  tokens = (char *)malloc(256 * sizeof(char));
+static const Keyword keyword_table[KEYWORD_TABLE_SIZE] = {
+#define KEYWORD(text, first, last, type) \
+    [KEYWORD_SLOT(first, last, sizeof(text) - 1)] = { text, sizeof(text) - 1, type }
+    KEYWORD("principal", 'p', 'l', TOKEN_PRINCIPAL),
+    KEYWORD("funcao", 'f', 'o', TOKEN_FUNCAO),
+    KEYWORD("retorno", 'r', 'o', TOKEN_RETORNO),
+    KEYWORD("leia", 'l', 'a', TOKEN_LEIA),
+    KEYWORD("escreva", 'e', 'a', TOKEN_ESCREVA),
+    KEYWORD("se", 's', 'e', TOKEN_SE),
+    KEYWORD("senao", 's', 'o', TOKEN_SENAO),
+    KEYWORD("para", 'p', 'a', TOKEN_PARA),
+    KEYWORD("inteiro", 'i', 'o', TOKEN_INTEIRO),
+    KEYWORD("texto", 't', 'o', TOKEN_TEXTO),
+    KEYWORD("decimal", 'd', 'l', TOKEN_DECIMAL),
+#undef KEYWORD
+};
+
+/* Mapeia o trecho str[0..length) para o TokenType da palavra reservada,
+ * ou 0, sem alocar e com no máximo uma comparação. */
+int is_keyword(const char* str, int length) {
+    if (length <= 0) return 0;
+    const Keyword* keyword = &keyword_table[KEYWORD_SLOT(str[0], str[length - 1], length)];
+    if (keyword->length == length && memcmp(str, keyword->text, length) == 0) {
+        return keyword->type;
+    }
+    return 0;
+}
+
+void lexer_init(LexerContext* ctx, const char* content, Arena* arena) {
+    ctx->content = content;
+    ctx->pos = 0;
+    ctx->line = 1;
+    ctx->finished = 0;
+    ctx->arena = arena;
+    ctx->error_msg[0] = '\0';
+    ctx->diagnostics = NULL;
+    ctx->error_limit = 0;
+    ctx->after_error = 0;
+    balance_init(&ctx->balance, arena);
+}
+
+/* O lexer com recuperação é o mesmo autômato; só o tratamento de erros e
+ * do balanceamento muda. */
+static Token lexer_next(LexerContext* ctx) {
+    if (ctx->diagnostics != NULL) return lexer_scan_recovering(ctx);
+    return lexer_scan(ctx->content, &ctx->pos, &ctx->line, &ctx->balance, ctx->error_msg);
+}
 
-  
-  
-  while (line[i] != '\0') {
-    if (is_separator(line[i]) == 0) {
-      j = 0;
+Token get_next_token(LexerContext* ctx) {
+    Token token = lexer_next(ctx);
+    stats_token(token.type);
+    return token;
+}
 
-      while(is_separator(line[i]) == 0 && line[i] != '\0') {
-        tokens[j++] = line[i++];
-      }
-      tokens[j] = '\0';
-      printf("Token: %s\n", tokens);
-      if(isReservedWord(tokens) != 0 && isVaribleOrFunction(tokens) != 0 && isOperator(tokens) != 0) {
-        errorFlag = 1;
-        printf("Erro na linha %d, na palavra '%s'\n", listNumberd, tokens);
-        break;
-      }
-    }else {
-      i++;
+int get_next_tokens(LexerContext* ctx, Token* tokens, int max) {
+    int count = 0;
+    while (count < max && !ctx->finished) {
+        Token token = lexer_next(ctx);
+        stats_token(token.type);
+        tokens[count++] = token;
+        ctx->finished = token.type == TOKEN_EOF || token.type == TOKEN_ERRO;
     }
-  }
+    return count;
+}
 
-  return errorFlag;
+void lexer_init_at(LexerContext* ctx, const char* content, int pos, int line, Arena* arena) {
+    lexer_init(ctx, content, arena);
+    ctx->pos = pos;
+    ctx->line = line;
 }
 
+Token get_next_token_unbalanced(LexerContext* ctx) {
+    return lexer_scan(ctx->content, &ctx->pos, &ctx->line, NULL, ctx->error_msg);
+}
+
+Token lexer_match(const char* text) {
+    char error_msg[LEXER_ERROR_MSG_SIZE];
+    int pos = 0;
+    int line = 1;
+    return lexer_scan(text, &pos, &line, NULL, error_msg);
+}
 
+/* --- Analisador por Linha --- */
 
+/* As palavras são trechos (início, tamanho) da própria linha: nada é
+ * copiado, e a linha pode ter qualquer tamanho. */
+
+static int has_prefix(const char* pre, const char* word, int length) {
+    int size = (int)strlen(pre);
+    return length > size && strncmp(pre, word, size) == 0;
+}
+
+static int is_separator(char c) {
+    return c == ' ' || c == ',' || c == '(' || c == ')' ||
+           c == ';' || c == '{' || c == '}' || c == '\n' || c == '\0';
+}
+
+static int is_variable_or_function(const char* word, int length) {
+    return has_prefix("__", word, length) || has_prefix("!", word, length);
+}
+
+/* Um operador inteiro: o token reconhecido no início da palavra é um
+ * operador e termina junto com ela. */
+static int is_operator(const char* word, int length) {
+    Token match = lexer_match(word);
+    return match.type >= TOKEN_OP_SOMA && match.type <= TOKEN_OP_DEC &&
+           match.offset == 0 && match.length == length;
+}
+
+int verifySymbols(const char* line, int lineNumber) {
+    int i = 0;
+    while (line[i] != '\0') {
+        if (is_separator(line[i])) {
+            i++;
+            continue;
+        }
+        int start = i;
+        while (!is_separator(line[i])) {
+            i++;
+        }
+        const char* word = line + start;
+        int length = i - start;
+        printf("Token: %.*s\n", length, word);
+        if (!is_keyword(word, length) && !is_variable_or_function(word, length) && !is_operator(word, length)) {
+            printf("Erro na linha %d, na palavra '%.*s'\n", lineNumber, length, word);
+            return 1;
+        }
+    }
+    return 0;
+}
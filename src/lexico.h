@@ -1,7 +1,109 @@
 #ifndef LEXICO_H
 #define LEXICO_H
 
-int verifySymbols(char line[256], int lineNumber); 
+#include "memoria.h"
+#include "balanceamento.h"
+#include "diagnostico.h"
+
+/* --- Analisador Léxico --- */
+
+typedef enum {
+    TOKEN_EOF, TOKEN_ERRO,
+    /* Palavras Reservadas */
+    TOKEN_PRINCIPAL, TOKEN_FUNCAO, TOKEN_RETORNO, TOKEN_LEIA, TOKEN_ESCREVA,
+    TOKEN_SE, TOKEN_SENAO, TOKEN_PARA, TOKEN_INTEIRO, TOKEN_TEXTO, TOKEN_DECIMAL,
+    /* Identificadores */
+    TOKEN_ID_VAR, TOKEN_ID_FUNC,
+    /* Literais */
+    TOKEN_LITERAL_INT, TOKEN_LITERAL_DEC, TOKEN_LITERAL_TEXTO,
+    /* Operadores */
+    TOKEN_OP_SOMA, TOKEN_OP_SUB, TOKEN_OP_MULT, TOKEN_OP_DIV, TOKEN_OP_EXP,
+    TOKEN_OP_ATRIB, TOKEN_OP_IGUAL, TOKEN_OP_DIF, TOKEN_OP_MENOR, TOKEN_OP_MENOR_IGUAL,
+    TOKEN_OP_MAIOR, TOKEN_OP_MAIOR_IGUAL, TOKEN_OP_E, TOKEN_OP_OU, TOKEN_OP_INC, TOKEN_OP_DEC,
+    /* Separadores */
+    TOKEN_LPAREN, TOKEN_RPAREN, TOKEN_LBRACE, TOKEN_RBRACE,
+    TOKEN_LBRACKET, TOKEN_RBRACKET, TOKEN_VIRGULA, TOKEN_PONTO_VIRGULA, TOKEN_PONTO
+} TokenType;
+
+/* Token sem cópia: (offset, length) apontam para o conteúdo do contexto.
+ * Textos próprios só são criados sob demanda (token_text) e mensagens de
+ * erro ficam em error_msg do contexto, válida até o próximo erro. */
+typedef struct {
+    TokenType type;
+    int offset;
+    int length;
+    int line;
+} Token;
+
+#define LEXER_ERROR_MSG_SIZE 160
+
+/* Limite padrão de erros com recuperação (--max-erros). */
+#define LEXER_ERROR_LIMIT 100
+
+/* Estado de uma análise léxica. Não há estado global: contextos
+ * diferentes podem ser usados ao mesmo tempo em threads diferentes. */
+typedef struct {
+    const char* content;
+    int pos;
+    int line;
+    int finished;   /* get_next_tokens já entregou o último token */
+    BalanceState balance;
+    Arena* arena;
+    char error_msg[LEXER_ERROR_MSG_SIZE];
+    Diagnostics* diagnostics;   /* com recuperação, os erros; ou NULL */
+    int error_limit;
+    int after_error;            /* nenhum token válido desde o último erro */
+} LexerContext;
+
+const char* token_type_to_string(TokenType type);
+int is_keyword(const char* str, int length);
+
+/* Prepara ctx para percorrer content desde o início; a pilha de
+ * balanceamento é alocada em arena. */
+void lexer_init(LexerContext* ctx, const char* content, Arena* arena);
+Token get_next_token(LexerContext* ctx);
+
+/* Preenche tokens com até max tokens seguintes, numa única chamada, e
+ * retorna quantos foram escritos. O TOKEN_EOF ou o TOKEN_ERRO final é o
+ * último token do lote; depois dele, retorna 0. */
+int get_next_tokens(LexerContext* ctx, Token* tokens, int max);
+
+/* Liga a recuperação de erros: em vez de terminar no primeiro TOKEN_ERRO,
+ * o lexer registra cada erro em diagnostics, com linha e coluna, e volta a
+ * analisar no próximo separador (espaço, quebra de linha, ';', ',', aspas,
+ * parênteses, chaves ou colchetes); um texto sem fim recomeça na linha
+ * seguinte à das aspas. Erros de balanceamento não interrompem a análise:
+ * um fechamento sem abertura é ignorado, e um fechamento trocado descarta
+ * as aberturas até a correspondente. Um erro igual ao anterior, na mesma
+ * linha e sem token válido entre os dois, não é repetido. Os tokens
+ * seguem sem TOKEN_ERRO; com error_limit erros, a análise para e o
+ * próximo token é TOKEN_EOF. */
+void lexer_enable_recovery(LexerContext* ctx, Diagnostics* diagnostics, int error_limit);
+
+/* Começa em content[pos], na linha `line`; pos deve estar numa fronteira
+ * de token (por exemplo, logo após uma quebra de linha fora de texto). */
+void lexer_init_at(LexerContext* ctx, const char* content, int pos, int line, Arena* arena);
+
+/* Como get_next_token, sem verificar o balanceamento; usado quando os
+ * símbolos são verificados depois, sobre a sequência de tokens. */
+Token get_next_token_unbalanced(LexerContext* ctx);
+
+/* Aplica um token já reconhecido (de src) à pilha de balanceamento. Se os
+ * símbolos não fecham, o token vira TOKEN_ERRO, a mensagem vai para
+ * error_msg e a função retorna 0. */
+int lexer_balance_token(BalanceState* balance, const char* src, Token* token, char* error_msg);
+
+/* Cópia própria do lexema (ou da mensagem de erro), alocada na arena do
+ * contexto. */
+char* token_text(LexerContext* ctx, Token token);
+
+/* Reconhece um único token em text[0..]; usado pelo analisador por linha. */
+Token lexer_match(const char* text);
+
+/* Analisador por linha: verifica se cada palavra da linha (de qualquer
+ * tamanho) é palavra reservada, nome com prefixo ou operador. Imprime as
+ * palavras e retorna 1 na primeira inválida. */
+int verifySymbols(const char* line, int lineNumber);
 
 
 #endif 
@@ -0,0 +1,209 @@
+#include <string.h>
+#include "memoria.h"
+#include "varredura.h"
+#include "balanceamento.h"
+#include "lexico_paralelo.h"
+#include "estatisticas.h"
+
+/* Um arquivo grande é cortado em pedaços que começam logo após uma quebra
+ * de linha. Fora de um texto, nenhum token atravessa uma quebra de linha,
+ * então esses cortes caem sempre entre tokens; um operador de vários
+ * caracteres nunca é dividido. A única exceção são textos com quebras de
+ * linha, tratados pela contagem de aspas: como a linguagem não tem escapes
+ * nem comentários, um pedaço começa dentro de um texto exatamente quando
+ * há um número ímpar de '"' antes dele.
+ *
+ * Cada pedaço emite os tokens que começam dentro dele, lendo além do seu
+ * fim se o último token continuar no pedaço seguinte (o conteúdo inteiro
+ * está em memória); o pedaço seguinte pula esse resto. */
+
+typedef struct ParallelLex ParallelLex;
+
+typedef struct {
+    ParallelLex* job;
+    int start;
+    int end;        /* tokens que começam em [start, end) pertencem ao pedaço */
+    int newlines;
+    int quotes;
+    int first_line;
+    int in_string;
+    TokenBlock* first;
+    TokenBlock* last;
+    int has_error;
+    char error_msg[LEXER_ERROR_MSG_SIZE];
+} LexChunk;
+
+struct ParallelLex {
+    const char* content;
+    Arena* worker_arenas;
+};
+
+/* --- Primeira Fase: Contagem --- */
+
+static void count_chunk(void* arg) {
+    LexChunk* chunk = (LexChunk*)arg;
+    const char* src = chunk->job->content;
+    int newlines = 0;
+    int quotes = 0;
+    for (int i = chunk->start; i < chunk->end; i++) {
+        newlines += (src[i] == '\n');
+        quotes += (src[i] == '"');
+    }
+    chunk->newlines = newlines;
+    chunk->quotes = quotes;
+}
+
+/* --- Segunda Fase: Análise de Cada Pedaço --- */
+
+static void append_token(LexChunk* chunk, Arena* arena, Token token) {
+    TokenBlock* block = chunk->last;
+    if (block == NULL || block->count == TOKEN_BLOCK_SIZE) {
+        block = (TokenBlock*)arena_alloc(arena, sizeof(TokenBlock));
+        block->next = NULL;
+        block->count = 0;
+        if (chunk->last != NULL) {
+            chunk->last->next = block;
+        } else {
+            chunk->first = block;
+        }
+        chunk->last = block;
+    }
+    block->tokens[block->count++] = token;
+}
+
+static void lex_chunk(void* arg) {
+    LexChunk* chunk = (LexChunk*)arg;
+    Arena* arena = &chunk->job->worker_arenas[pool_worker_index()];
+    const char* src = chunk->job->content;
+    int pos = chunk->start;
+    int line = chunk->first_line;
+
+    if (chunk->in_string) {
+        /* O texto foi aberto num pedaço anterior, que emite o token inteiro. */
+        pos = scan_kernels->skip_string(src, pos, &line);
+        if (src[pos] == '"') pos++;
+    }
+
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_LEXICA);
+    LexerContext lexer;
+    lexer_init_at(&lexer, src, pos, line, arena);
+    for (;;) {
+        Token token = get_next_token_unbalanced(&lexer);
+        int token_start = token.type == TOKEN_LITERAL_TEXTO ? token.offset - 1 : token.offset;
+        if (token_start >= chunk->end) break;
+
+        append_token(chunk, arena, token);
+        if (token.type == TOKEN_EOF) break;
+        if (token.type == TOKEN_ERRO && !chunk->has_error) {
+            /* Só o primeiro erro importa: a sequência final termina nele. */
+            chunk->has_error = 1;
+            memcpy(chunk->error_msg, lexer.error_msg, sizeof(chunk->error_msg));
+            break;
+        }
+    }
+    stats_end(&timer);
+}
+
+/* --- Junção --- */
+
+/* Liga os blocos dos pedaços em ordem e verifica o balanceamento sobre a
+ * sequência, como o lexer serial faria, cortando-a no primeiro erro. */
+static void join_chunks(const char* src, LexChunk* chunks, int count, Arena* arena,
+                        TokenStream* stream) {
+    BalanceState balance;
+    balance_init(&balance, arena);
+    TokenBlock* tail = NULL;
+
+    for (int c = 0; c < count; c++) {
+        LexChunk* chunk = &chunks[c];
+        for (TokenBlock* block = chunk->first; block != NULL; block = block->next) {
+            if (tail != NULL) {
+                tail->next = block;
+            } else {
+                stream->first = block;
+            }
+            tail = block;
+
+            for (int i = 0; i < block->count; i++) {
+                Token* token = &block->tokens[i];
+                int balanced;
+                if (token->type == TOKEN_ERRO) {
+                    memcpy(stream->error_msg, chunk->error_msg, LEXER_ERROR_MSG_SIZE);
+                    balanced = 0;
+                } else {
+                    balanced = lexer_balance_token(&balance, src, token, stream->error_msg);
+                }
+                stream->count++;
+                stats_token(token->type);
+                if (!balanced || token->type == TOKEN_EOF) {
+                    stream->status = !balanced;
+                    block->count = i + 1;
+                    block->next = NULL;
+                    balance_clear(&balance);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void lex_parallel(ThreadPool* pool, const char* content, long length,
+                  Arena* worker_arenas, Arena* arena, TokenStream* stream) {
+    ParallelLex job = { content, worker_arenas };
+
+    stream->first = NULL;
+    stream->count = 0;
+    stream->status = 0;
+    stream->error_msg[0] = '\0';
+
+    /* Cortes logo após a primeira quebra de linha depois de cada múltiplo
+     * de PARALLEL_CHUNK_SIZE. */
+    int capacity = (int)(length / PARALLEL_CHUNK_SIZE) + 1;
+    LexChunk* chunks = (LexChunk*)arena_alloc(arena, capacity * sizeof(LexChunk));
+    int count = 0;
+    long start = 0;
+    do {
+        long end = length;
+        if (length - start > PARALLEL_CHUNK_SIZE) {
+            const char* newline = memchr(content + start + PARALLEL_CHUNK_SIZE, '\n',
+                                         length - start - PARALLEL_CHUNK_SIZE);
+            if (newline != NULL) end = newline - content + 1;
+        }
+        LexChunk* chunk = &chunks[count++];
+        memset(chunk, 0, sizeof(*chunk));
+        chunk->job = &job;
+        chunk->start = (int)start;
+        chunk->end = (int)end;
+        start = end;
+    } while (start < length);
+
+    for (int c = 0; c < count; c++) {
+        pool_submit(pool, count_chunk, &chunks[c]);
+    }
+    pool_wait(pool);
+
+    /* Soma de prefixos: linha inicial e paridade das aspas de cada pedaço. */
+    int line = 1;
+    int quotes = 0;
+    for (int c = 0; c < count; c++) {
+        chunks[c].first_line = line;
+        chunks[c].in_string = quotes & 1;
+        line += chunks[c].newlines;
+        quotes += chunks[c].quotes;
+    }
+    /* O último pedaço também emite o TOKEN_EOF, que começa em length. */
+    chunks[count - 1].end = (int)length + 1;
+
+    for (int c = 0; c < count; c++) {
+        pool_submit(pool, lex_chunk, &chunks[c]);
+    }
+    pool_wait(pool);
+
+    /* A junção é a passada de balanceamento que o lexer serial faz token
+     * a token. */
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_BALANCEAMENTO);
+    join_chunks(content, chunks, count, arena, stream);
+    stats_end(&timer);
+}
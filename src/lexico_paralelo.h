@@ -0,0 +1,46 @@
+#ifndef LEXICO_PARALELO_H
+#define LEXICO_PARALELO_H
+
+#include "lexico.h"
+#include "paralelo.h"
+
+/* --- Análise Léxica Paralela de um Arquivo --- */
+
+/* Tamanho aproximado de cada pedaço; o corte é feito na quebra de linha
+ * seguinte. Arquivos menores que um pedaço são analisados numa só tarefa. */
+#ifndef PARALLEL_CHUNK_SIZE
+#define PARALLEL_CHUNK_SIZE (256 * 1024)
+#endif
+
+#ifndef TOKEN_BLOCK_SIZE
+#define TOKEN_BLOCK_SIZE 1000
+#endif
+
+/* Tokens guardados em blocos encadeados: cada pedaço preenche seus
+ * próprios blocos e a junção só liga as listas, sem copiar tokens. */
+typedef struct TokenBlock {
+    struct TokenBlock* next;
+    int count;
+    Token tokens[TOKEN_BLOCK_SIZE];
+} TokenBlock;
+
+/* Sequência completa de tokens, igual à do lexer serial: termina no
+ * TOKEN_EOF ou no primeiro TOKEN_ERRO, cuja mensagem fica em error_msg. */
+typedef struct {
+    TokenBlock* first;
+    long count;
+    int status; /* 0 = ok, 1 = terminou em erro */
+    char error_msg[LEXER_ERROR_MSG_SIZE];
+} TokenStream;
+
+/* Analisa content[0..length) em pedaços paralelos no pool. Os tokens de
+ * cada pedaço vão para worker_arenas[pool_worker_index()] (uma arena por
+ * trabalhador, cada uma com seu MemoryContext); a lista de pedaços e a
+ * pilha de balanceamento ficam em arena, da thread que chama. Linhas,
+ * tokens e diagnósticos são os mesmos da análise serial. Como os offsets
+ * dos pedaços e dos tokens são int, length não pode passar de
+ * MAP_TAMANHO_MAXIMO (entrada.h). */
+void lex_parallel(ThreadPool* pool, const char* content, long length,
+                  Arena* worker_arenas, Arena* arena, TokenStream* stream);
+
+#endif
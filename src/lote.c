@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "memoria.h"
+#include "entrada.h"
+#include "paralelo.h"
+#include "fluxo.h"
+#include "lote.h"
+#include "estatisticas.h"
+
+/* Memória de um trabalhador; a arena é esvaziada a cada arquivo. */
+typedef struct {
+    MemoryContext memory;
+    Arena lexer_arena;
+} WorkerState;
+
+typedef struct {
+    FileJob* job;
+    WorkerState* workers;
+    const Cache* cache;
+} BatchTask;
+
+double monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/* Conta os tokens até o fim ou até o primeiro erro. */
+static void count_tokens(FileJob* job, Token token, const char* error_msg) {
+    job->lines = token.line;
+    if (token.type == TOKEN_EOF) return;
+    job->tokens++;
+    if (token.type == TOKEN_ERRO) {
+        job->status = 1;
+        job->error_line = token.line;
+        memcpy(job->message, error_msg, sizeof(job->message));
+    }
+}
+
+/* Com o cache, um arquivo já visto custa só o hash do conteúdo: o
+ * resultado sai do último token gravado. */
+static void lex_mapped(WorkerState* worker, FileJob* job, const MappedFile* file, const Cache* cache) {
+    CacheKey key;
+    memset(&key, 0, sizeof(key));
+    if (cache != NULL) {
+        key = cache_key(file->data, file->length);
+        CachedTokens cached;
+        if (cache_load_tokens(cache, key, &cached, &worker->memory)) {
+            job->tokens = cached.count - 1;
+            count_tokens(job, cached.tokens[cached.count - 1], cached.error_msg);
+            job->cached = 1;
+            cache_release_tokens(&cached);
+            return;
+        }
+    }
+    CacheWriter store;
+    cache_begin_tokens(&store, cache, key);
+    LexerContext lexer;
+    lexer_init(&lexer, file->data, &worker->lexer_arena);
+    Token token;
+    do {
+        token = get_next_token(&lexer);
+        count_tokens(job, token, lexer.error_msg);
+        cache_add_token(&store, token);
+    } while (token.type != TOKEN_EOF && token.type != TOKEN_ERRO);
+    cache_finish_tokens(&store, lexer.error_msg);
+}
+
+/* Arquivos regulares são mapeados; pipes e afins, e arquivos grandes
+ * demais para o mapeamento, são lidos em fluxo. */
+static void compile_file(WorkerState* worker, FileJob* job, const Cache* cache) {
+    double start = monotonic_seconds();
+    worker->memory.max_used = worker->memory.current_used;
+
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_LEITURA);
+    MappedFile file;
+    int mapped = map_file(&file, job->path, &worker->memory);
+    stats_end(&timer);
+    if (mapped == MAP_OK) {
+        job->bytes = file.length;
+        stats_begin(&timer, PHASE_LEXICA);
+        lex_mapped(worker, job, &file, cache);
+        stats_end(&timer);
+        stats_input(file.length, job->lines);
+        unmap_file(&file);
+    } else {
+        StreamLexer stream;
+        if ((mapped == MAP_NAO_REGULAR || mapped == MAP_GRANDE_DEMAIS) && stream_open(&stream, job->path, &worker->lexer_arena) == 0) {
+            stats_begin(&timer, PHASE_LEXICA);
+            Token token;
+            do {
+                token = stream_next_token(&stream);
+                count_tokens(job, token, stream.lexer.error_msg);
+            } while (token.type != TOKEN_EOF && token.type != TOKEN_ERRO);
+            stats_end(&timer);
+            job->bytes = stream.bytes;
+            stats_input(stream.bytes, job->lines);
+            stream_close(&stream);
+        } else {
+            job->status = 2;
+            snprintf(job->message, sizeof(job->message), "Erro ao abrir o arquivo %s", job->path);
+        }
+    }
+
+    job->max_memory = worker->memory.max_used;
+    job->seconds = monotonic_seconds() - start;
+    /* Os blocos são liberados, não só reiniciados: assim a memória máxima
+     * de cada arquivo não depende de quais arquivos o trabalhador já
+     * analisou antes. */
+    arena_destroy(&worker->lexer_arena);
+}
+
+static void batch_task(void* arg) {
+    BatchTask* task = (BatchTask*)arg;
+    compile_file(&task->workers[pool_worker_index()], task->job, task->cache);
+}
+
+static void print_job(const FileJob* job) {
+    if (job->status == 2) {
+        printf("%s: %s\n", job->path, job->message);
+        return;
+    }
+    if (job->status == 1) {
+        printf("%s: ERRO na linha %d: %s\n", job->path, job->error_line, job->message);
+    } else {
+        printf("%s: OK\n", job->path);
+    }
+    printf("    %ld tokens, %ld bytes, memória máxima %ld bytes, %.3f ms%s\n",
+           job->tokens, job->bytes, job->max_memory, job->seconds * 1000.0,
+           job->cached ? " (cache)" : "");
+}
+
+int run_batch(const char** paths, int count, int threads, const Cache* cache) {
+    MemoryContext batch_memory;
+    Arena batch_arena;
+    memory_context_init(&batch_memory);
+    batch_memory.budget = BATCH_LIST_MEMORY_KB * 1024L;
+    arena_init(&batch_arena, &batch_memory);
+
+    double start = monotonic_seconds();
+    ThreadPool* pool = pool_create(threads);
+    int workers_count = pool_size(pool);
+
+    WorkerState* workers = (WorkerState*)arena_alloc(&batch_arena, workers_count * sizeof(WorkerState));
+    for (int i = 0; i < workers_count; i++) {
+        memory_context_init(&workers[i].memory);
+        arena_init(&workers[i].lexer_arena, &workers[i].memory);
+    }
+
+    FileJob* jobs = (FileJob*)arena_alloc(&batch_arena, count * sizeof(FileJob));
+    BatchTask* tasks = (BatchTask*)arena_alloc(&batch_arena, count * sizeof(BatchTask));
+    for (int i = 0; i < count; i++) {
+        memset(&jobs[i], 0, sizeof(FileJob));
+        jobs[i].path = paths[i];
+        tasks[i].job = &jobs[i];
+        tasks[i].workers = workers;
+        tasks[i].cache = cache;
+        pool_submit(pool, batch_task, &tasks[i]);
+    }
+    pool_wait(pool);
+    pool_destroy(pool);
+    double elapsed = monotonic_seconds() - start;
+
+    /* Diagnósticos na ordem dos arquivos, independente do escalonamento. */
+    int failed = 0;
+    long tokens = 0;
+    long bytes = 0;
+    int cached = 0;
+    const FileJob* largest = NULL;
+    for (int i = 0; i < count; i++) {
+        print_job(&jobs[i]);
+        failed += jobs[i].status != 0;
+        tokens += jobs[i].tokens;
+        bytes += jobs[i].bytes;
+        cached += jobs[i].cached;
+        if (largest == NULL || jobs[i].max_memory > largest->max_memory) {
+            largest = &jobs[i];
+        }
+    }
+
+    printf("\nResumo: %d arquivos, %d com erro, %d threads.\n", count, failed, workers_count);
+    printf("Tokens: %ld, bytes: %ld, tempo total: %.3f ms (%.2f MB/s).\n",
+           tokens, bytes, elapsed * 1000.0, elapsed > 0 ? bytes / elapsed / (1024.0 * 1024.0) : 0.0);
+    if (cache != NULL) {
+        printf("Cache: %d de %d arquivos sem nova análise.\n", cached, count);
+    }
+    if (largest != NULL) {
+        printf("Maior uso de memória por arquivo: %ld bytes (%s).\n", largest->max_memory, largest->path);
+    }
+    printf("Valor máximo de memória utilizada: %ld bytes.\n", memory_total_peak());
+
+    for (int i = 0; i < workers_count; i++) {
+        arena_destroy(&workers[i].lexer_arena);
+    }
+    arena_destroy(&batch_arena);
+    return failed > 0;
+}
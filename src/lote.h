@@ -0,0 +1,35 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+#include "lexico.h"
+#include "cache.h"
+
+/* --- Compilação em Lote --- */
+
+/* Orçamento da lista de arquivos do lote (não é memória de compilação). */
+#define BATCH_LIST_MEMORY_KB (64 * 1024)
+
+/* Resultado da análise de um arquivo do lote. */
+typedef struct {
+    const char* path;
+    int status; /* 0 = ok, 1 = erro léxico/balanceamento, 2 = falha de leitura */
+    int error_line;
+    char message[LEXER_ERROR_MSG_SIZE];
+    long tokens;
+    long bytes;
+    int lines;  /* linha do último token */
+    long max_memory;
+    double seconds;
+    int cached; /* tokens vindos do cache */
+} FileJob;
+
+/* Analisa os arquivos em paralelo com `threads` trabalhadores (<= 0 usa
+ * todas as CPUs) e imprime, na ordem dos caminhos, o diagnóstico de cada
+ * arquivo e um resumo. Com cache != NULL, arquivos já analisados não são
+ * analisados de novo. Retorna 1 se algum arquivo falhou. */
+int run_batch(const char** paths, int count, int threads, const Cache* cache);
+
+/* Segundos de um relógio monotônico. */
+double monotonic_seconds(void);
+
+#endif
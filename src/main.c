@@ -1,516 +1,846 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
-
-/* --- Protótipos --- */
-void* Malloc(size_t size);
-void Free(void* ptr, size_t size);
-
-char* my_strdup(const char* s) {
-    if (s == NULL) return NULL;
-    size_t len = strlen(s) + 1;
-    char* new_s = (char*)Malloc(len);
-    if (new_s == NULL) return NULL;
-    memcpy(new_s, s, len);
-    return new_s;
+#include "memoria.h"
+#include "lexico.h"
+#include "varredura.h"
+#include "entrada.h"
+#include "lote.h"
+#include "paralelo.h"
+#include "lexico_paralelo.h"
+#include "fluxo.h"
+#include "saida.h"
+#include "ast.h"
+#include "sintatico.h"
+#include "sintatico_paralelo.h"
+#include "semantico.h"
+#include "codigo.h"
+#include "maquina.h"
+#include "nativo.h"
+#include "otimizador.h"
+#include "cache.h"
+#include "servidor.h"
+#include "observador.h"
+#include "estatisticas.h"
+
+/* Conta (paths == NULL) ou preenche os caminhos de uma lista @arquivo:
+ * um caminho por linha, linhas vazias ignoradas. */
+static int collect_list(char* content, const char** paths) {
+    int count = 0;
+    char* line = content;
+    while (*line != '\0') {
+        char* end = strchr(line, '\n');
+        char* next = end != NULL ? end + 1 : line + strlen(line);
+        if (end == NULL) end = next;
+        if (end > line && end[-1] == '\r') end--;
+        if (end > line) {
+            if (paths != NULL) {
+                *end = '\0';
+                paths[count] = line;
+            }
+            count++;
+        }
+        line = next;
+    }
+    return count;
+}
+
+/* Modo lote: main -j N arquivo1 arquivo2 ... ou @lista. */
+static int main_batch(int argc, char *argv[], const Cache* cache) {
+    MemoryContext list_memory;
+    Arena list_arena;
+    memory_context_init(&list_memory);
+    list_memory.budget = BATCH_LIST_MEMORY_KB * 1024L;
+    arena_init(&list_arena, &list_memory);
+
+    int threads = 0;
+    int count = 0;
+    char** lists = (char**)arena_alloc(&list_arena, argc * sizeof(char*));
+    for (int i = 1; i < argc; i++) {
+        lists[i] = NULL;
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            threads = atoi(argv[i] + 2);
+        } else if (argv[i][0] == '@') {
+            lists[i] = read_file_content(argv[i] + 1, &list_arena, NULL);
+            if (lists[i] == NULL) {
+                printf("Erro ao abrir o arquivo %s\n", argv[i] + 1);
+                arena_destroy(&list_arena);
+                return 1;
+            }
+            count += collect_list(lists[i], NULL);
+        } else {
+            count++;
+        }
+    }
+
+    const char** paths = (const char**)arena_alloc(&list_arena, (count + 1) * sizeof(char*));
+    int filled = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0) {
+            i++;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            continue;
+        } else if (lists[i] != NULL) {
+            filled += collect_list(lists[i], paths + filled);
+        } else {
+            paths[filled++] = argv[i];
+        }
+    }
+
+    int status = run_batch(paths, count, threads, cache);
+    arena_destroy(&list_arena);
+    return status;
 }
 
-size_t my_strnlen(const char *s, size_t maxlen) {
-    size_t len = 0;
-    while (len < maxlen && s[len] != '\0') {
-        len++;
+/* Esvazia a saída dos tokens e imprime o resumo. Nos modos binário e
+ * NDJSON o resumo vai para a saída de erro, junto com a mensagem de erro
+ * que o formato binário não carrega. */
+static void finish_output(TokenWriter* writer, Token last, const char* error_msg,
+                          long max_memory, long mapped) {
+    writer_flush(writer);
+    FILE* report = writer_report_file(writer);
+    if (last.type == TOKEN_ERRO && writer->mode != OUTPUT_TEXTO) {
+        fprintf(report, "Erro na linha %d: %s\n", last.line, error_msg);
+    }
+    if (last.type != TOKEN_ERRO) {
+        fprintf(report, "\nVerificação de balanceamento concluída com sucesso.\n");
+    }
+    fprintf(report, "\nAnálise léxica concluída.\n");
+    fprintf(report, "Valor máximo de memória utilizada: %ld bytes.\n", max_memory);
+    if (mapped > 0) {
+        fprintf(report, "Arquivo mapeado em memória (fora do orçamento): %ld bytes.\n", mapped);
     }
-    return len;
 }
 
-char* my_strndup(const char* s, size_t n) {
-    if (s == NULL) return NULL;
-    size_t len = my_strnlen(s, n);
-    char* new_s = (char*)Malloc(len + 1);
-    if (new_s == NULL) return NULL;
-    memcpy(new_s, s, len);
-    new_s[len] = '\0';
-    return new_s;
+static int open_failed(const char* filepath) {
+    printf("Erro ao abrir o arquivo %s\n", filepath);
+    return 1;
 }
 
-int is_special_char(char c) {
-    return (c == '!' || c == '=' || c == '+' || c == '-' ||
-            c == '*' || c == '/' || c == '^' || c == '<' ||
-            c == '>' || c == '&' || c == '|');
+/* Modos que precisam do conteúdo inteiro não aceitam arquivos maiores que
+ * MAP_TAMANHO_MAXIMO; a análise léxica os lê em fluxo. */
+static int map_failed(const char* filepath, int mapped) {
+    if (mapped == MAP_GRANDE_DEMAIS) {
+        printf("Arquivo %s grande demais: o máximo é de %ld bytes (use --fluxo para a análise léxica)\n",
+               filepath, MAP_TAMANHO_MAXIMO);
+        return 1;
+    }
+    return open_failed(filepath);
 }
 
-/* --- Configuração de Memória --- */
-#define MAX_MEMORY_KB 2048
-long current_memory_used = 0;
-long max_memory_used = 0;
+/* Modo fluxo: a entrada é lida aos poucos numa janela de tamanho fixo, e
+ * a memória usada não depende do tamanho dela. Usado para "-" (entrada
+ * padrão), pipes, arquivos maiores que MAP_TAMANHO_MAXIMO e com --fluxo. */
+static int main_stream(const char* filepath, OutputMode output) {
+    MemoryContext memory;
+    Arena lexer_arena;
+    memory_context_init(&memory);
+    arena_init(&lexer_arena, &memory);
+
+    StreamLexer stream;
+    if (stream_open(&stream, filepath, &lexer_arena) != 0) {
+        arena_destroy(&lexer_arena);
+        return open_failed(filepath);
+    }
+
+    TokenWriter writer;
+    writer_init(&writer, output, stdout, &lexer_arena);
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_LEXICA);
+    Token token;
+    do {
+        token = stream_next_token(&stream);
+        writer_token(&writer, stream.buffer, stream.base, token, stream.lexer.error_msg);
+    } while (token.type != TOKEN_EOF && token.type != TOKEN_ERRO);
+    stats_end(&timer);
+    stats_input(stream.bytes, token.line);
+    stream_close(&stream);
+
+    finish_output(&writer, token, stream.lexer.error_msg, memory.max_used, 0);
+
+    arena_destroy(&lexer_arena);
+    memory_shutdown();
+    return token.type == TOKEN_ERRO;
+}
 
-void* Malloc(size_t size) {
-    if (current_memory_used + size > MAX_MEMORY_KB * 1024) {
-        printf("ERRO: Memória Insuficiente.\n");
-        exit(1);
+/* Modo recuperação: main --recuperar [--max-erros=N] arquivo. A análise
+ * continua depois de cada erro léxico; os erros, com linha e coluna, vêm
+ * depois dos tokens, e o código de saída é 1 se houver algum. Pipes, a
+ * entrada padrão e arquivos maiores que MAP_TAMANHO_MAXIMO são lidos em
+ * fluxo e param no primeiro erro. */
+static int main_recovering(const char* filepath, OutputMode output, int error_limit) {
+    MemoryContext memory;
+    Arena lexer_arena;
+    memory_context_init(&memory);
+    arena_init(&lexer_arena, &memory);
+
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_LEITURA);
+    MappedFile file;
+    int mapped = strcmp(filepath, "-") == 0 ? MAP_NAO_REGULAR : map_file(&file, filepath, &memory);
+    stats_end(&timer);
+    if (mapped == MAP_NAO_REGULAR || mapped == MAP_GRANDE_DEMAIS) {
+        arena_destroy(&lexer_arena);
+        return main_stream(filepath, output);
     }
-    void* ptr = malloc(size);
-    if (ptr == NULL) {
-        printf("ERRO: Falha ao alocar memória.\n");
-        exit(1);
+    if (mapped != MAP_OK) {
+        arena_destroy(&lexer_arena);
+        return open_failed(filepath);
     }
-    current_memory_used += size;
-    if (current_memory_used > max_memory_used) {
-        max_memory_used = current_memory_used;
+
+    LexerContext lexer;
+    lexer_init(&lexer, file.data, &lexer_arena);
+    Diagnostics diagnostics;
+    diagnostics_init(&diagnostics, &lexer_arena);
+    lexer_enable_recovery(&lexer, &diagnostics, error_limit);
+    TokenWriter writer;
+    writer_init(&writer, output, stdout, &lexer_arena);
+    Token token;
+    stats_begin(&timer, PHASE_LEXICA);
+    do {
+        token = get_next_token(&lexer);
+        writer_token(&writer, file.data, 0, token, lexer.error_msg);
+    } while (token.type != TOKEN_EOF);
+    stats_end(&timer);
+    stats_input(file.length, token.line);
+
+    writer_flush(&writer);
+    FILE* report = writer_report_file(&writer);
+    diagnostics_print(&diagnostics, report);
+    if (token.offset < file.length) {
+        fprintf(report, "Limite de %d erro(s) atingido na linha %d: o restante do arquivo não foi analisado.\n",
+                error_limit, token.line);
     }
-    if (current_memory_used > (MAX_MEMORY_KB * 1024 * 0.9) && current_memory_used < (MAX_MEMORY_KB * 1024)) {
-        printf("ALERTA: Memória utilizada entre 90%% e 99%% do total disponível.\n");
+    fprintf(report, "\nAnálise léxica concluída: %d erro(s).\n", diagnostics.errors);
+    fprintf(report, "Valor máximo de memória utilizada: %ld bytes.\n", memory.max_used);
+    if (memory.mapped > 0) {
+        fprintf(report, "Arquivo mapeado em memória (fora do orçamento): %ld bytes.\n", memory.mapped);
     }
-    return ptr;
+
+    arena_destroy(&lexer_arena);
+    unmap_file(&file);
+    memory_shutdown();
+    return diagnostics.errors > 0;
 }
 
-void Free(void* ptr, size_t size) {
-    if (ptr != NULL) {
-        free(ptr);
-        current_memory_used -= size;
+/* Modo paralelo: main --paralelo [-j N] arquivo. Um único arquivo é
+ * analisado em pedaços paralelos; a saída é a mesma do modo serial.
+ * Arquivos maiores que MAP_TAMANHO_MAXIMO são lidos em fluxo. */
+static int main_parallel(int argc, char *argv[], OutputMode output) {
+    const char* filepath = "programa2.txt";
+    int threads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--paralelo") == 0) {
+            continue;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            threads = atoi(argv[i] + 2);
+        } else {
+            filepath = argv[i];
+        }
     }
-}
 
-/* --- Verificação de Balanceamento --- */
-#define STACK_SIZE 1024
-char balance_stack[STACK_SIZE];
-int stack_top = -1;
-int balance_error_line = -1;
+    MemoryContext memory;
+    Arena arena;
+    memory_context_init(&memory);
+    arena_init(&arena, &memory);
+
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_LEITURA);
+    MappedFile file;
+    int mapped = map_file(&file, filepath, &memory);
+    stats_end(&timer);
+    if (mapped == MAP_GRANDE_DEMAIS) {
+        /* Os offsets dos pedaços e dos tokens são int: acima do limite do
+         * mapeamento, a análise é a serial em fluxo, com a mesma saída. */
+        arena_destroy(&arena);
+        return main_stream(filepath, output);
+    }
+    if (mapped != MAP_OK) {
+        arena_destroy(&arena);
+        return open_failed(filepath);
+    }
 
-void push(char c) {
-    if (stack_top < STACK_SIZE - 1) {
-        balance_stack[++stack_top] = c;
-    } else {
-        printf("ERRO na linha %d: Estouro da pilha de balanceamento.\n", balance_error_line);
-        exit(1);
+    /* Os tokens crescem com a entrada: cada trabalhador pode guardar, no
+     * pior caso, um token por byte. */
+    ThreadPool* pool = pool_create(threads);
+    int workers = pool_size(pool);
+    MemoryContext* worker_memory = (MemoryContext*)arena_alloc(&arena, workers * sizeof(MemoryContext));
+    Arena* worker_arenas = (Arena*)arena_alloc(&arena, workers * sizeof(Arena));
+    for (int w = 0; w < workers; w++) {
+        memory_context_init(&worker_memory[w]);
+        worker_memory[w].budget += 2 * (file.length + 1) * (long)sizeof(Token);
+        arena_init(&worker_arenas[w], &worker_memory[w]);
     }
-}
 
-char pop() {
-    if (stack_top >= 0) {
-        return balance_stack[stack_top--];
+    TokenStream stream;
+    lex_parallel(pool, file.data, file.length, worker_arenas, &arena, &stream);
+    pool_destroy(pool);
+
+    TokenWriter writer;
+    writer_init(&writer, output, stdout, &arena);
+    Token last = { TOKEN_EOF, 0, 0, 0 };
+    for (TokenBlock* block = stream.first; block != NULL; block = block->next) {
+        for (int i = 0; i < block->count; i++) {
+            last = block->tokens[i];
+            writer_token(&writer, file.data, 0, last, stream.error_msg);
+        }
     }
-    return '\0';
+    finish_output(&writer, last, stream.error_msg, memory_total_peak(), memory.mapped);
+    stats_input(file.length, last.line);
+
+    for (int w = 0; w < workers; w++) {
+        arena_destroy(&worker_arenas[w]);
+    }
+    unmap_file(&file);
+    arena_destroy(&arena);
+    memory_shutdown();
+    return stream.status;
 }
 
-int is_empty() {
-    return stack_top == -1;
+/* Até onde vai main_front_end. */
+typedef enum {
+    STAGE_SINTATICO,  /* --sintatico: imprime a árvore */
+    STAGE_SEMANTICO,  /* --semantico: imprime os diagnósticos */
+    STAGE_EXECUCAO,   /* --run: gera o código e executa */
+    STAGE_NATIVO      /* --nativo=saida.s: gera assembly x86-64 */
+} Stage;
+
+/* Escreve o assembly de uma árvore sem erros em target. */
+static int write_native(const Ast* ast, const char* target, Arena* arena) {
+    FILE* out = fopen(target, "w");
+    if (out == NULL) {
+        printf("Erro ao criar o arquivo %s\n", target);
+        return 0;
+    }
+    native_emit(ast, out, arena);
+    int ok = fclose(out) == 0;
+    if (ok) {
+        printf("Assembly gerado em %s (ligue com runtime/execucao.c).\n", target);
+    }
+    return ok;
 }
 
-int check_balance(const char* content) {
-    int line = 1;
-    int i = 0;
-    char c;
-    int in_string = 0;
+/* Orçamento de uma compilação de length bytes nos modos que analisam o
+ * programa inteiro. A árvore e o interner crescem com a entrada, como os
+ * tokens no modo paralelo do lexer: no pior caso, um nó por byte, num
+ * vetor que dobra de tamanho. */
+static long front_end_budget(long length) {
+    return MAX_MEMORY_KB * 1024L + 2 * (length + 1) * (long)sizeof(AstNode);
+}
 
-    while ((c = content[i++]) != '\0') {
-        if (c == '\n') {
-            line++;
-            continue;
+/* Modos que analisam o programa inteiro: main --sintatico|--semantico|--run
+ * arquivo, ou main --nativo=saida.s arquivo. Erros léxicos e sintáticos
+ * param a análise no primeiro; a verificação semântica reporta todos os
+ * problemas de uma vez. Com --run, a saída padrão fica só para o
+ * programa: diagnósticos vão para a saída de erro e a execução só começa
+ * se não houver erros. Com --nativo, target é o arquivo gerado. Antes
+ * de gerar código, a árvore passa pelo otimizador no nível pedido; com
+ * show_passes, a árvore de cada passo vai para o relatório. Com cache,
+ * a árvore de um conteúdo já analisado é carregada sem lexer nem parser.
+ * Com parallel (--paralelo [-j N]), a análise sintática, a semântica e a
+ * geração de código tratam as funções em paralelo, num pool de threads
+ * threads (0 = número de CPUs); a saída é a mesma do modo serial. */
+static int main_front_end(const char* filepath, Stage stage, const char* target,
+                          OptLevel level, int show_passes, const Cache* cache,
+                          int parallel, int threads) {
+    MemoryContext memory;
+    Arena lexer_arena;
+    Arena ast_arena;
+    Arena node_arena;
+    memory_context_init(&memory);
+    arena_init(&lexer_arena, &memory);
+    arena_init(&ast_arena, &memory);
+    arena_init(&node_arena, &memory);
+
+    /* Os nós guardam posições no conteúdo: ele precisa ficar inteiro em
+     * memória, por isso aqui não há modo fluxo. */
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_LEITURA);
+    MappedFile file;
+    int mapped = map_file(&file, filepath, &memory);
+    if (mapped != MAP_OK) {
+        arena_destroy(&lexer_arena);
+        return map_failed(filepath, mapped);
+    }
+    stats_end(&timer);
+    memory.budget = front_end_budget(file.length);
+
+    /* Cada trabalhador tem sua arena e seu orçamento, como no modo
+     * paralelo do lexer. No pior caso, um trabalhador recebe os trechos do
+     * arquivo inteiro, e o contexto principal recebe a cópia deles: os dois
+     * têm o orçamento do modo serial. */
+    ThreadPool* pool = NULL;
+    int workers = 0;
+    Arena* worker_arenas = NULL;
+    if (parallel) {
+        pool = pool_create(threads);
+        workers = pool_size(pool);
+        MemoryContext* worker_memory = (MemoryContext*)arena_alloc(&ast_arena, workers * sizeof(MemoryContext));
+        worker_arenas = (Arena*)arena_alloc(&ast_arena, workers * sizeof(Arena));
+        for (int w = 0; w < workers; w++) {
+            memory_context_init(&worker_memory[w]);
+            worker_memory[w].budget = front_end_budget(file.length);
+            arena_init(&worker_arenas[w], &worker_memory[w]);
         }
+    }
+
+    LexerContext lexer;
+    lexer_init(&lexer, file.data, &lexer_arena);
+    Interner interner;
+    interner_init(&interner, &ast_arena);
+    Ast ast;
+    ast_init(&ast, file.data, &interner, &ast_arena, &node_arena);
+    CacheKey key;
+    int from_cache = 0;
+    if (cache != NULL) {
+        key = cache_key(file.data, file.length);
+        from_cache = cache_load_ast(cache, key, &ast, &memory);
+    }
+    Parser parser;
+    stats_begin(&timer, PHASE_SINTATICA);
+    int ok = from_cache || (pool != NULL
+        ? parse_program_parallel(pool, &parser, &lexer, &ast, file.length, worker_arenas)
+        : parse_program(&parser, &lexer, &ast));
+    stats_end(&timer);
+    /* Os trechos da análise paralela já foram copiados para ast. */
+    for (int w = 0; w < workers; w++) {
+        arena_reset(&worker_arenas[w]);
+    }
+    stats_input(file.length, from_cache ? 0 : parser.current.line);
+    if (ok && cache != NULL && !from_cache) {
+        cache_store_ast(cache, key, &ast);
+    }
+    FILE* report = stage == STAGE_EXECUCAO ? stderr : stdout;
 
-        if (c == '"') {
-            if (in_string) {
-                if (pop() != '"') {
-                    balance_error_line = line;
-                    return 0;
-                }
-                in_string = 0;
-            } else {
-                push('"');
-                in_string = 1;
+    if (!ok) {
+        fprintf(report, "Erro na linha %d: %s\n", parser.error_line, parser.error_msg);
+    } else if (stage == STAGE_SINTATICO) {
+        ast_dump(&ast, stdout);
+        printf("\nAnálise sintática concluída.\n");
+    } else {
+        /* A arena do lexer não é mais usada: as fases seguintes usam ela. */
+        arena_reset(&lexer_arena);
+        Diagnostics diagnostics;
+        diagnostics_init(&diagnostics, &lexer_arena);
+        stats_begin(&timer, PHASE_SEMANTICA);
+        ok = (pool != NULL
+            ? check_program_parallel(&ast, &diagnostics, pool, worker_arenas, &lexer_arena)
+            : check_program(&ast, &diagnostics, &lexer_arena)) == 0;
+        stats_end(&timer);
+        if (ok && (stage == STAGE_EXECUCAO || stage == STAGE_NATIVO)) {
+            stats_begin(&timer, PHASE_OTIMIZACAO);
+            optimize_program(&ast, level, show_passes ? report : NULL, &lexer_arena);
+            stats_end(&timer);
+        }
+        if (ok && stage == STAGE_EXECUCAO) {
+            Program program;
+            stats_begin(&timer, PHASE_GERACAO);
+            ok = (pool != NULL
+                ? compile_program_parallel(&ast, &program, &diagnostics, pool, worker_arenas, &lexer_arena)
+                : compile_program(&ast, &program, &diagnostics, &lexer_arena)) == 0;
+            stats_end(&timer);
+            diagnostics_print(&diagnostics, report);
+            if (ok) {
+                stats_begin(&timer, PHASE_EXECUCAO);
+                ok = vm_run(&program, &lexer_arena, stdin, stdout) == 0;
+                stats_end(&timer);
             }
-        } else if (!in_string) {
-            if (c == '(' || c == '{' || c == '[') {
-                push(c);
-            } else if (c == ')') {
-                if (pop() != '(') {
-                    balance_error_line = line;
-                    return 0;
-                }
-            } else if (c == '}') {
-                if (pop() != '{') {
-                    balance_error_line = line;
-                    return 0;
-                }
-            } else if (c == ']') {
-                if (pop() != '[') {
-                    balance_error_line = line;
-                    return 0;
-                }
+        } else {
+            diagnostics_print(&diagnostics, report);
+            if (ok && stage == STAGE_NATIVO) {
+                stats_begin(&timer, PHASE_GERACAO);
+                ok = write_native(&ast, target, &lexer_arena);
+                stats_end(&timer);
             }
         }
+        if (stage == STAGE_SEMANTICO) {
+            printf("\nAnálise semântica concluída: %d erro(s), %d alerta(s).\n",
+                   diagnostics.errors, diagnostics.warnings);
+        }
     }
-
-    if (!is_empty()) {
-        balance_error_line = line;
-        return 0;
+    if (stage != STAGE_EXECUCAO) {
+        if (cache != NULL) {
+            printf("Cache: %s.\n", from_cache ? "árvore carregada" : "árvore analisada e gravada");
+        }
+        printf("Nós da árvore: %u. Nomes distintos: %u.\n", ast.count - 1, interner.count - 1);
+        /* Em paralelo, conta também as arenas dos trabalhadores. */
+        printf("Valor máximo de memória utilizada: %ld bytes.\n",
+               pool != NULL ? memory_total_peak() : memory.max_used);
     }
 
-    return 1;
+    if (pool != NULL) {
+        pool_destroy(pool);
+    }
+    for (int w = 0; w < workers; w++) {
+        arena_destroy(&worker_arenas[w]);
+    }
+    arena_destroy(&node_arena);
+    arena_destroy(&ast_arena);
+    arena_destroy(&lexer_arena);
+    unmap_file(&file);
+    memory_shutdown();
+    return !ok;
 }
 
+/* Modo servidor: main --servidor=SOCKET [-j N]. */
+static int main_server(int argc, char *argv[], const char* socket_path) {
+    int threads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            threads = atoi(argv[i] + 2);
+        }
+    }
+    int status = run_server(socket_path, threads);
+    memory_shutdown();
+    return status;
+}
 
-/* --- Analisador Léxico --- */
-
-typedef enum {
-    TOKEN_EOF, TOKEN_ERRO,
-    /* Palavras Reservadas */
-    TOKEN_PRINCIPAL, TOKEN_FUNCAO, TOKEN_RETORNO, TOKEN_LEIA, TOKEN_ESCREVA,
-    TOKEN_SE, TOKEN_SENAO, TOKEN_PARA, TOKEN_INTEIRO, TOKEN_TEXTO, TOKEN_DECIMAL,
-    /* Identificadores */
-    TOKEN_ID_VAR, TOKEN_ID_FUNC,
-    /* Literais */
-    TOKEN_LITERAL_INT, TOKEN_LITERAL_DEC, TOKEN_LITERAL_TEXTO,
-    /* Operadores */
-    TOKEN_OP_SOMA, TOKEN_OP_SUB, TOKEN_OP_MULT, TOKEN_OP_DIV, TOKEN_OP_EXP,
-    TOKEN_OP_ATRIB, TOKEN_OP_IGUAL, TOKEN_OP_DIF, TOKEN_OP_MENOR, TOKEN_OP_MENOR_IGUAL,
-    TOKEN_OP_MAIOR, TOKEN_OP_MAIOR_IGUAL, TOKEN_OP_E, TOKEN_OP_OU, TOKEN_OP_INC, TOKEN_OP_DEC,
-    /* Separadores */
-    TOKEN_LPAREN, TOKEN_RPAREN, TOKEN_LBRACE, TOKEN_RBRACE,
-    TOKEN_LBRACKET, TOKEN_RBRACKET, TOKEN_VIRGULA, TOKEN_PONTO_VIRGULA, TOKEN_PONTO
-} TokenType;
-
-const char* token_type_to_string(TokenType type) {
-    switch (type) {
-        case TOKEN_EOF: return "EOF";
-        case TOKEN_ERRO: return "ERRO";
-        case TOKEN_PRINCIPAL: return "PRINCIPAL";
-        case TOKEN_FUNCAO: return "FUNCAO";
-        case TOKEN_RETORNO: return "RETORNO";
-        case TOKEN_LEIA: return "LEIA";
-        case TOKEN_ESCREVA: return "ESCREVA";
-        case TOKEN_SE: return "SE";
-        case TOKEN_SENAO: return "SENAO";
-        case TOKEN_PARA: return "PARA";
-        case TOKEN_INTEIRO: return "INTEIRO";
-        case TOKEN_TEXTO: return "TEXTO";
-        case TOKEN_DECIMAL: return "DECIMAL";
-        case TOKEN_ID_VAR: return "ID_VAR";
-        case TOKEN_ID_FUNC: return "ID_FUNC";
-        case TOKEN_LITERAL_INT: return "LITERAL_INT";
-        case TOKEN_LITERAL_DEC: return "LITERAL_DEC";
-        case TOKEN_LITERAL_TEXTO: return "LITERAL_TEXTO";
-        case TOKEN_OP_SOMA: return "OP_SOMA";
-        case TOKEN_OP_SUB: return "OP_SUB";
-        case TOKEN_OP_MULT: return "OP_MULT";
-        case TOKEN_OP_DIV: return "OP_DIV";
-        case TOKEN_OP_EXP: return "OP_EXP";
-        case TOKEN_OP_ATRIB: return "OP_ATRIB";
-        case TOKEN_OP_IGUAL: return "OP_IGUAL";
-        case TOKEN_OP_DIF: return "OP_DIF";
-        case TOKEN_OP_MENOR: return "OP_MENOR";
-        case TOKEN_OP_MENOR_IGUAL: return "OP_MENOR_IGUAL";
-        case TOKEN_OP_MAIOR: return "OP_MAIOR";
-        case TOKEN_OP_MAIOR_IGUAL: return "OP_MAIOR_IGUAL";
-        case TOKEN_OP_E: return "OP_E";
-        case TOKEN_OP_OU: return "OP_OU";
-        case TOKEN_OP_INC: return "OP_INC";
-        case TOKEN_OP_DEC: return "OP_DEC";
-        case TOKEN_LPAREN: return "LPAREN";
-        case TOKEN_RPAREN: return "RPAREN";
-        case TOKEN_LBRACE: return "LBRACE";
-        case TOKEN_RBRACE: return "RBRACE";
-        case TOKEN_LBRACKET: return "LBRACKET";
-        case TOKEN_RBRACKET: return "RBRACKET";
-        case TOKEN_VIRGULA: return "VIRGULA";
-        case TOKEN_PONTO_VIRGULA: return "PONTO_VIRGULA";
-        case TOKEN_PONTO: return "PONTO";
-        default: return "DESCONHECIDO";
+/* Modo observador: main --watch arquivo1 arquivo2 ... */
+static int main_watch(int argc, char *argv[]) {
+    const char** paths = (const char**)Malloc(argc * sizeof(char*));
+    int count = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--watch") != 0) paths[count++] = argv[i];
     }
+    if (count == 0) paths[count++] = "programa2.txt";
+    int status = run_watch(paths, count);
+    memory_shutdown();
+    return status;
 }
 
 typedef struct {
-    TokenType type;
-    char* value;
-    int line;
-} Token;
-
-char* current_file_content;
-int current_pos = 0;
-int current_line = 1;
-
-Token* create_token(TokenType type, char* value) {
-    Token* token = (Token*)Malloc(sizeof(Token));
-    token->type = type;
-    token->value = value;
-    token->line = current_line;
-    return token;
+    TokenWriter* writer;
+    const char* content;
+    Token last;
+    long written;
+} RemoteOutput;
+
+static void write_remote_token(void* context, Token token) {
+    RemoteOutput* output = (RemoteOutput*)context;
+    writer_token(output->writer, output->content, 0, token, "");
+    output->last = token;
+    output->written++;
 }
 
-void free_token(Token* token) {
-    if (token) {
-        if (token->value) Free(token->value, strlen(token->value) + 1);
-        Free(token, sizeof(Token));
+/* Pede os tokens ao servidor em socket_path e os escreve com os lexemas
+ * do arquivo local. Retorna 0 se o servidor respondeu, ou -1 para
+ * analisar localmente (sem servidor, scripts continuam funcionando).
+ * Se a conexão cair depois de algum token já escrito, analisar de novo
+ * duplicaria a saída: a falha vira um token de erro e o retorno é 1. */
+static int lex_on_server(const char* socket_path, const MappedFile* file, TokenWriter* writer,
+                         Arena* arena, ServerReply* reply) {
+    ServerConnection* connection = (ServerConnection*)arena_alloc(arena, sizeof(ServerConnection));
+    if (server_connect(connection, socket_path) != 0) return -1;
+    RemoteOutput output = { writer, file->data, { TOKEN_EOF, 0, 0, 1 }, 0 };
+    int status = server_request(connection, REQUEST_CONTEUDO, file->data, file->length,
+                                write_remote_token, &output, reply);
+    server_disconnect(connection);
+    if (status != 0 || reply->status != SERVER_OK) {
+        if (output.written == 0) return -1;
+        Token failed = { TOKEN_ERRO, output.last.offset + output.last.length, 0, output.last.line };
+        reply->last = failed;
+        snprintf(reply->message, sizeof(reply->message),
+                 "Conexão com o servidor interrompida no meio da resposta");
+        writer_token(writer, file->data, 0, reply->last, reply->message);
+        return 1;
     }
+    writer_token(writer, file->data, 0, reply->last, reply->message);
+    return 0;
 }
 
-int is_keyword(const char* str) {
-    if (strcmp(str, "principal") == 0) return TOKEN_PRINCIPAL;
-    if (strcmp(str, "funcao") == 0) return TOKEN_FUNCAO;
-    if (strcmp(str, "retorno") == 0) return TOKEN_RETORNO;
-    if (strcmp(str, "leia") == 0) return TOKEN_LEIA;
-    if (strcmp(str, "escreva") == 0) return TOKEN_ESCREVA;
-    if (strcmp(str, "se") == 0) return TOKEN_SE;
-    if (strcmp(str, "senao") == 0) return TOKEN_SENAO;
-    if (strcmp(str, "para") == 0) return TOKEN_PARA;
-    if (strcmp(str, "inteiro") == 0) return TOKEN_INTEIRO;
-    if (strcmp(str, "texto") == 0) return TOKEN_TEXTO;
-    if (strcmp(str, "decimal") == 0) return TOKEN_DECIMAL;
+static int has_flag(int argc, char *argv[], const char* flag) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], flag) == 0) return 1;
+    }
     return 0;
 }
 
-Token* get_next_token() {
-    while (current_file_content[current_pos] != '\0') {
-        char current_char = current_file_content[current_pos];
+static int is_batch_invocation(int argc, char *argv[]) {
+    if (argc > 2) return 1;
+    return argc == 2 && (argv[1][0] == '@' || strncmp(argv[1], "-j", 2) == 0);
+}
 
-        if (isspace(current_char) || current_char == '\\') {
-            if (current_char == '\n') current_line++;
-            current_pos++;
-            continue;
+/* Retira de argv a opção --saida=MODO, comum a todos os modos que
+ * exibem tokens. Retorna -1 se o modo for inválido. */
+static int parse_output_option(int* argc, char *argv[], OutputMode* output) {
+    *output = OUTPUT_TEXTO;
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strncmp(argv[i], "--saida=", 8) == 0) {
+            if (output_mode_from_string(argv[i] + 8, output) != 0) {
+                printf("Modo de saída inválido: %s (use texto, nenhuma, binaria ou ndjson)\n", argv[i] + 8);
+                return -1;
+            }
+        } else {
+            argv[kept++] = argv[i];
         }
+    }
+    *argc = kept;
+    return 0;
+}
 
-        if (is_special_char(current_file_content[current_pos]) &&
-            is_special_char(current_file_content[current_pos + 1]) &&
-            is_special_char(current_file_content[current_pos + 2])) {
-            char err_msg[100];
-            sprintf(err_msg, "ERRO: Sequência inválida de 3 ou mais caracteres especiais: %c%c%c",
-                    current_file_content[current_pos],
-                    current_file_content[current_pos + 1],
-                    current_file_content[current_pos + 2]);
-            current_pos += 3;
-            return create_token(TOKEN_ERRO, my_strdup(err_msg));
+/* Retira de argv as opções do otimizador: -O0, -O1, -O2 e
+ * --mostrar-passos. Retorna -1 se o nível for inválido. */
+static int parse_optimization_options(int* argc, char *argv[], OptLevel* level, int* show_passes) {
+    *level = OPT_O0;
+    *show_passes = 0;
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strncmp(argv[i], "-O", 2) == 0) {
+            if (strcmp(argv[i] + 2, "0") != 0 && strcmp(argv[i] + 2, "1") != 0 && strcmp(argv[i] + 2, "2") != 0) {
+                printf("Nível de otimização inválido: %s (use -O0, -O1 ou -O2)\n", argv[i]);
+                return -1;
+            }
+            *level = (OptLevel)(argv[i][2] - '0');
+        } else if (strcmp(argv[i], "--mostrar-passos") == 0) {
+            *show_passes = 1;
+        } else {
+            argv[kept++] = argv[i];
         }
+    }
+    *argc = kept;
+    return 0;
+}
 
-        if (current_char == '_') { /* Função */
-            if (current_file_content[current_pos + 1] == '_') {
-                int start = current_pos;
-                current_pos += 2; /* Pula o '__' */
-
-                if (!isalnum(current_file_content[current_pos])) {
-                    return create_token(TOKEN_ERRO, my_strdup("Nome de função inválido: '__' deve ser seguido por um caractere alfanumérico."));
-                }
-
-                while (isalnum(current_file_content[current_pos])) {
-                    current_pos++;
-                }
-                char* value = my_strndup(&current_file_content[start], current_pos - start);
-                return create_token(TOKEN_ID_FUNC, value);
-            }
+/* Retira de argv --cache=DIR e --cache-limite=MB. Sem --cache, *enabled
+ * fica 0. Retorna -1 se o diretório não puder ser usado. */
+static int parse_cache_options(int* argc, char *argv[], Cache* cache, int* enabled) {
+    const char* dir = NULL;
+    long limit_mb = CACHE_DEFAULT_LIMIT_MB;
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strncmp(argv[i], "--cache=", 8) == 0) {
+            dir = argv[i] + 8;
+        } else if (strncmp(argv[i], "--cache-limite=", 15) == 0) {
+            limit_mb = atol(argv[i] + 15);
+        } else {
+            argv[kept++] = argv[i];
         }
+    }
+    *argc = kept;
+    *enabled = dir != NULL;
+    if (dir != NULL && (limit_mb <= 0 || cache_init(cache, dir, limit_mb * 1024L * 1024L) != 0)) {
+        printf("Cache inválido: %s (limite de %ld MB)\n", dir, limit_mb);
+        return -1;
+    }
+    return 0;
+}
 
-        if (isalpha(current_char)) { /* Palavra reservada */
-            int start = current_pos;
-            while (isalnum(current_file_content[current_pos])) {
-                current_pos++;
-            }
-            char* value = my_strndup(&current_file_content[start], current_pos - start);
-            int keyword_token = is_keyword(value);
-            if (keyword_token) {
-                return create_token(keyword_token, value);
+/* Retira de argv --stats e --stats=FORMATO (texto ou json) e liga as
+ * estatísticas. Retorna -1 se o formato for inválido. */
+static int parse_stats_option(int* argc, char *argv[]) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            stats_start(STATS_TEXTO);
+        } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+            StatsFormat format;
+            if (stats_format_from_string(argv[i] + 8, &format) != 0) {
+                printf("Formato de estatísticas inválido: %s (use texto ou json)\n", argv[i] + 8);
+                return -1;
             }
-            Free(value, strlen(value) + 1);
-            return create_token(TOKEN_ERRO, my_strdup("Identificador inválido (deve começar com '!' ou '__')"));
+            stats_start(format);
+        } else {
+            argv[kept++] = argv[i];
         }
+    }
+    *argc = kept;
+    return 0;
+}
 
-        if (isdigit(current_char)) { /* Número */
-            int start = current_pos;
-            int is_decimal = 0;
-            while (isdigit(current_file_content[current_pos])) {
-                current_pos++;
-            }
-            if (current_file_content[current_pos] == '.') {
-                is_decimal = 1;
-                current_pos++;
-                while (isdigit(current_file_content[current_pos])) {
-                    current_pos++;
-                }
+/* Retira de argv --recuperar e --max-erros=N (que também liga a
+ * recuperação). Sem elas, *error_limit fica 0. Retorna -1 se o limite for
+ * inválido. */
+static int parse_recovery_options(int* argc, char *argv[], int* error_limit) {
+    *error_limit = 0;
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--recuperar") == 0) {
+            if (*error_limit == 0) *error_limit = LEXER_ERROR_LIMIT;
+        } else if (strncmp(argv[i], "--max-erros=", 12) == 0) {
+            *error_limit = atoi(argv[i] + 12);
+            if (*error_limit <= 0) {
+                printf("Limite de erros inválido: %s (use um número maior que zero)\n", argv[i] + 12);
+                return -1;
             }
-            char* value = my_strndup(&current_file_content[start], current_pos - start);
-            return create_token(is_decimal ? TOKEN_LITERAL_DEC : TOKEN_LITERAL_INT, value);
+        } else {
+            argv[kept++] = argv[i];
         }
+    }
+    *argc = kept;
+    return 0;
+}
 
-        if (current_char == '"') { /* String literal */
-            current_pos++;
-            int start = current_pos;
-            while (current_file_content[current_pos] != '"' && current_file_content[current_pos] != '\0') {
-                current_pos++;
-            }
-            if (current_file_content[current_pos] == '"') {
-                char* value = my_strndup(&current_file_content[start], current_pos - start);
-                current_pos++;
-                return create_token(TOKEN_LITERAL_TEXTO, value);
+int main(int argc, char *argv[]) {
+    scan_init();
+    if (parse_stats_option(&argc, argv) != 0) {
+        return 1;
+    }
+    OutputMode output;
+    if (parse_output_option(&argc, argv, &output) != 0) {
+        return 1;
+    }
+    OptLevel level;
+    int show_passes;
+    if (parse_optimization_options(&argc, argv, &level, &show_passes) != 0) {
+        return 1;
+    }
+    Cache cache_storage;
+    int cache_enabled;
+    if (parse_cache_options(&argc, argv, &cache_storage, &cache_enabled) != 0) {
+        return 1;
+    }
+    const Cache* cache = cache_enabled ? &cache_storage : NULL;
+    int error_limit;
+    if (parse_recovery_options(&argc, argv, &error_limit) != 0) {
+        return 1;
+    }
+    const char* server_socket = NULL;
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--servidor=", 11) == 0) {
+            return main_server(argc, argv, argv[i] + 11);
+        } else if (strncmp(argv[i], "--cliente=", 10) == 0) {
+            server_socket = argv[i] + 10;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    if (has_flag(argc, argv, "--watch")) {
+        return main_watch(argc, argv);
+    }
+    int run = has_flag(argc, argv, "--run");
+    int semantic = has_flag(argc, argv, "--semantico");
+    const char* target = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--nativo=", 9) == 0) target = argv[i] + 9;
+    }
+    if (run || semantic || target != NULL || has_flag(argc, argv, "--sintatico")) {
+        const char* filepath = "programa2.txt";
+        int threads = 0;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+                threads = atoi(argv[++i]);
+            } else if (strncmp(argv[i], "-j", 2) == 0) {
+                threads = atoi(argv[i] + 2);
+            } else if (argv[i][0] != '-' || argv[i][1] != '-') {
+                filepath = argv[i];
             }
-            return create_token(TOKEN_ERRO, my_strdup("String não terminada"));
         }
-
-        /* Operadores, Separadores e Variáveis */
-        switch (current_char) {
-            case '!':
-                if (current_file_content[current_pos + 1] == '=') {
-                    current_pos += 2;
-                    return create_token(TOKEN_ERRO, my_strdup("Operador inválido: !="));
-                }
-                int start = current_pos;
-                current_pos++;
-                if (islower(current_file_content[current_pos])) {
-                    current_pos++;
-                    while (isalnum(current_file_content[current_pos])) {
-                        current_pos++;
-                    }
-                    char* value = my_strndup(&current_file_content[start], current_pos - start);
-                    return create_token(TOKEN_ID_VAR, value);
-                }
-                return create_token(TOKEN_ERRO, my_strdup("Nome de variável inválido"));
-            case '+':
-                if (current_file_content[current_pos + 1] == '+') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_INC, my_strdup("++"));
-                }
-                current_pos++;
-                return create_token(TOKEN_OP_SOMA, my_strdup("+"));
-            case '-':
-                if (current_file_content[current_pos + 1] == '-') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_DEC, my_strdup("--"));
-                }
-                current_pos++;
-                return create_token(TOKEN_OP_SUB, my_strdup("-"));
-            case '=':
-                if (current_file_content[current_pos + 1] == '=') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_IGUAL, my_strdup("=="));
-                }
-                 if (current_file_content[current_pos + 1] == '<' || current_file_content[current_pos + 1] == '>') {
-                    current_pos += 2;
-                    return create_token(TOKEN_ERRO, my_strdup("Operador invertido inválido"));
-                }
-                current_pos++;
-                return create_token(TOKEN_OP_ATRIB, my_strdup("="));
-            case '<':
-                if (current_file_content[current_pos + 1] == '=') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_MENOR_IGUAL, my_strdup("<="));
-                }
-                if (current_file_content[current_pos + 1] == '>') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_DIF, my_strdup("<>"));
-                }
-                 if (current_file_content[current_pos + 1] == '<') {
-                    current_pos += 2;
-                    return create_token(TOKEN_ERRO, my_strdup("Operador duplicado inválido: <<"));
-                }
-                current_pos++;
-                return create_token(TOKEN_OP_MENOR, my_strdup("<"));
-            case '>':
-                if (current_file_content[current_pos + 1] == '=') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_MAIOR_IGUAL, my_strdup(">="));
-                }
-                if (current_file_content[current_pos + 1] == '>' || current_file_content[current_pos + 1] == '<') {
-                    current_pos += 2;
-                    return create_token(TOKEN_ERRO, my_strdup("Operador duplicado/invertido inválido"));
-                }
-                current_pos++;
-                return create_token(TOKEN_OP_MAIOR, my_strdup(">"));
-            case '&':
-                if (current_file_content[current_pos + 1] == '&') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_E, my_strdup("&&"));
-                }
-                break;
-            case '|':
-                if (current_file_content[current_pos + 1] == '|') {
-                    current_pos += 2;
-                    return create_token(TOKEN_OP_OU, my_strdup("||"));
-                }
-                break;
-            case '*': current_pos++; return create_token(TOKEN_OP_MULT, my_strdup("*"));
-            case '/': current_pos++; return create_token(TOKEN_OP_DIV, my_strdup("/"));
-            case '^': current_pos++; return create_token(TOKEN_OP_EXP, my_strdup("^"));
-            case '(': current_pos++; return create_token(TOKEN_LPAREN, my_strdup("("));
-            case ')': current_pos++; return create_token(TOKEN_RPAREN, my_strdup(")"));
-            case '{': current_pos++; return create_token(TOKEN_LBRACE, my_strdup("{"));
-            case '}': current_pos++; return create_token(TOKEN_RBRACE, my_strdup("}"));
-            case '[': current_pos++; return create_token(TOKEN_LBRACKET, my_strdup("["));
-            case ']': current_pos++; return create_token(TOKEN_RBRACKET, my_strdup("]"));
-            case ',': current_pos++; return create_token(TOKEN_VIRGULA, my_strdup(","));
-            case ';': current_pos++; return create_token(TOKEN_PONTO_VIRGULA, my_strdup(";"));
-            case '.': current_pos++; return create_token(TOKEN_PONTO, my_strdup("."));
+        Stage stage = run ? STAGE_EXECUCAO
+                    : target != NULL ? STAGE_NATIVO
+                    : semantic ? STAGE_SEMANTICO : STAGE_SINTATICO;
+        return main_front_end(filepath, stage, target, level, show_passes, cache,
+                              has_flag(argc, argv, "--paralelo"), threads);
+    }
+    if (has_flag(argc, argv, "--paralelo")) {
+        return main_parallel(argc, argv, output);
+    }
+    if (has_flag(argc, argv, "--fluxo")) {
+        const char* filepath = "-";
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--fluxo") != 0) filepath = argv[i];
         }
-
-        /* Se chegou aqui, é um caractere inválido */
-        char err_msg[100];
-        sprintf(err_msg, "Caractere ou sequência inesperada começando com: %c", current_char);
-        current_pos++;
-        return create_token(TOKEN_ERRO, my_strdup(err_msg));
+        return main_stream(filepath, output);
+    }
+    if (error_limit > 0) {
+        return main_recovering(argc > 1 ? argv[1] : "programa2.txt", output, error_limit);
+    }
+    if (is_batch_invocation(argc, argv)) {
+        return main_batch(argc, argv, cache);
     }
-    return create_token(TOKEN_EOF, NULL);
-}
-
-char* read_file_content(const char* filepath) {
-    FILE* file = fopen(filepath, "r");
-    if (!file) {
-        printf("Erro ao abrir o arquivo %s\n", filepath);
-        exit(1);
-    }
-    fseek(file, 0, SEEK_END);
-    long length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    char* buffer = (char*)Malloc(length + 1);
-    if (buffer == NULL) {
-        printf("Erro ao alocar memória para o conteúdo do arquivo.\n");
-        fclose(file);
-        exit(1);
-    }
-    fread(buffer, 1, length, file);
-    buffer[length] = '\0';
-    fclose(file);
-    return buffer;
-}
 
-int main(int argc, char *argv[]) {
     const char* filepath = "programa2.txt";
     if (argc > 1) {
         filepath = argv[1];
     }
-
-    current_file_content = read_file_content(filepath);
-    size_t file_content_size = strlen(current_file_content) + 1;
-
-    if (!check_balance(current_file_content)) {
-        printf("ERRO na linha %d: Símbolos desbalanceados.\n", balance_error_line);
-        Free(current_file_content, file_content_size);
-        return 1;
+    if (strcmp(filepath, "-") == 0) {
+        return main_stream(filepath, output);
     }
 
-    printf("Verificação de balanceamento concluída com sucesso.\n\n");
-
-    Token* token;
-    while (1) {
-        token = get_next_token();
-        
-        printf("Token: %s, Valor: '%s', Linha: %d\n", 
-               token_type_to_string(token->type), 
-               token->value ? token->value : "NULL", 
-               token->line);
+    /* Cada compilação tem seu próprio orçamento de memória. O arquivo é
+     * mapeado (fora do orçamento); os dados da análise ficam em lexer_arena. */
+    MemoryContext memory;
+    Arena lexer_arena;
+    memory_context_init(&memory);
+    arena_init(&lexer_arena, &memory);
+
+    StatsTimer timer;
+    stats_begin(&timer, PHASE_LEITURA);
+    MappedFile file;
+    int mapped = map_file(&file, filepath, &memory);
+    stats_end(&timer);
+    if (mapped == MAP_NAO_REGULAR || mapped == MAP_GRANDE_DEMAIS) {
+        arena_destroy(&lexer_arena);
+        return main_stream(filepath, output);
+    }
+    if (mapped != MAP_OK) {
+        return open_failed(filepath);
+    }
 
-        if (token->type == TOKEN_EOF || token->type == TOKEN_ERRO) {
-            if (token->type == TOKEN_ERRO) {
-                 printf("Erro na linha %d: %s\n", token->line, token->value);
-            }
-            free_token(token);
-            break;
+    /* O balanceamento é verificado pelo próprio lexer, na mesma passada.
+     * Com --cliente, quem analisa é o servidor; com o cache, os tokens de
+     * um conteúdo já visto vêm direto do disco. */
+    LexerContext lexer;
+    lexer_init(&lexer, file.data, &lexer_arena);
+    TokenWriter writer;
+    writer_init(&writer, output, stdout, &lexer_arena);
+    Token token;
+    const char* error_msg = lexer.error_msg;
+    long max_memory = 0;
+    ServerReply reply;
+    int remote = server_socket != NULL && lex_on_server(server_socket, &file, &writer, &lexer_arena, &reply) >= 0;
+    CacheKey key;
+    memset(&key, 0, sizeof(key));
+    CachedTokens cached;
+    int from_cache = 0;
+    if (cache != NULL && !remote) {
+        key = cache_key(file.data, file.length);
+        from_cache = cache_load_tokens(cache, key, &cached, &memory);
+    }
+    if (remote) {
+        token = reply.last;
+        error_msg = reply.message;
+        max_memory = reply.max_memory;
+    } else if (from_cache) {
+        error_msg = cached.error_msg;
+        for (long i = 0; i < cached.count; i++) {
+            token = cached.tokens[i];
+            writer_token(&writer, file.data, 0, token, error_msg);
         }
-        
-        free_token(token);
+    } else {
+        CacheWriter store;
+        cache_begin_tokens(&store, cache, key);
+        stats_begin(&timer, PHASE_LEXICA);
+        do {
+            token = get_next_token(&lexer);
+            writer_token(&writer, file.data, 0, token, lexer.error_msg);
+            cache_add_token(&store, token);
+        } while (token.type != TOKEN_EOF && token.type != TOKEN_ERRO);
+        stats_end(&timer);
+        cache_finish_tokens(&store, lexer.error_msg);
     }
+    stats_input(file.length, token.line);
 
-    printf("\nAnálise léxica concluída.\n");
-    printf("Valor máximo de memória utilizada: %ld bytes.\n", max_memory_used);
+    finish_output(&writer, token, error_msg, remote ? max_memory : memory.max_used, memory.mapped);
+    if (cache != NULL && !remote) {
+        fprintf(writer_report_file(&writer), "Cache: %s.\n",
+                from_cache ? "tokens carregados" : "tokens analisados e gravados");
+    }
+    if (from_cache) {
+        cache_release_tokens(&cached);
+    }
 
-    Free(current_file_content, file_content_size);
+    arena_destroy(&lexer_arena);
+    unmap_file(&file);
+    memory_shutdown();
 
-    return 0;
+    return token.type == TOKEN_ERRO;
 }
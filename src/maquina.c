@@ -0,0 +1,478 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "maquina.h"
+
+#if defined(__GNUC__) && !defined(VM_SWITCH_DISPATCH)
+#define VM_COMPUTED_GOTO
+#endif
+
+#define VM_TEXT_LINE_SIZE 4096
+
+typedef struct {
+    const uint8_t* ip;
+    Value* base;
+} Frame;
+
+/* --- Valores --- */
+
+static inline Value int_value(int64_t i) {
+    Value value;
+    value.type = TYPE_INTEIRO;
+    value.as.i = i;
+    return value;
+}
+
+static inline Value decimal_value(double d) {
+    Value value;
+    value.type = TYPE_DECIMAL;
+    value.as.d = d;
+    return value;
+}
+
+static Value text_value(Arena* arena, const char* data, int length) {
+    char* copy = (char*)arena_alloc(arena, length + 1);
+    memcpy(copy, data, length);
+    copy[length] = '\0';
+    Text* text = (Text*)arena_alloc(arena, sizeof(Text));
+    text->length = length;
+    text->data = copy;
+    Value value;
+    value.type = TYPE_TEXTO;
+    value.as.t = text;
+    return value;
+}
+
+/* Texto usado como número: inteiro se for só um inteiro, senão decimal. */
+static Value to_number(Value value) {
+    if (value.type != TYPE_TEXTO) return value;
+    char* end;
+    long long i = strtoll(value.as.t->data, &end, 10);
+    if (*end == '\0' && end != value.as.t->data) return int_value(i);
+    return decimal_value(strtod(value.as.t->data, NULL));
+}
+
+static double to_double(Value value) {
+    value = to_number(value);
+    return value.type == TYPE_DECIMAL ? value.as.d : (double)value.as.i;
+}
+
+/* decimal para inteiro trunca; valores fora do intervalo saturam. */
+static int64_t to_int(Value value) {
+    value = to_number(value);
+    if (value.type != TYPE_DECIMAL) return value.as.i;
+    double d = value.as.d;
+    if (d != d) return 0;
+    if (d >= 9.2e18) return INT64_MAX;
+    if (d <= -9.2e18) return INT64_MIN;
+    return (int64_t)d;
+}
+
+static Value to_text(Arena* arena, Value value) {
+    char buffer[64];
+    int length;
+    switch (value.type) {
+        case TYPE_TEXTO:
+            return value;
+        case TYPE_DECIMAL:
+            length = snprintf(buffer, sizeof(buffer), "%.15g", value.as.d);
+            break;
+        default:
+            length = snprintf(buffer, sizeof(buffer), "%lld", (long long)value.as.i);
+            break;
+    }
+    return text_value(arena, buffer, length);
+}
+
+static inline int truthy(Value value) {
+    switch (value.type) {
+        case TYPE_INTEIRO: return value.as.i != 0;
+        case TYPE_DECIMAL: return value.as.d != 0.0;
+        case TYPE_TEXTO: return value.as.t->length > 0;
+        default: return 0;
+    }
+}
+
+/* Soma, subtração e multiplicação de inteiros dão a volta em vez de
+ * estourar (estouro com sinal seria comportamento indefinido em C). */
+static inline int64_t wrap_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+static inline int64_t wrap_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+static inline int64_t wrap_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+
+/* Expoente negativo só tem resultado inteiro para as bases 1 e -1. */
+static int64_t int_pow(int64_t base, int64_t exponent) {
+    if (exponent < 0) {
+        if (base == 1) return 1;
+        if (base == -1) return (exponent & 1) ? -1 : 1;
+        return 0;
+    }
+    int64_t result = 1;
+    while (exponent > 0) {
+        if (exponent & 1) result = wrap_mul(result, base);
+        base = wrap_mul(base, base);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+/* Instruções genéricas: index segue a ordem ADD, SUB, MUL, DIV, POW.
+ * Retorna 0, ou -1 em divisão por zero. */
+static int arith_generic(int index, Value* left, Value right) {
+    Value a = to_number(*left);
+    Value b = to_number(right);
+    if (a.type == TYPE_INTEIRO && b.type == TYPE_INTEIRO) {
+        int64_t x = a.as.i;
+        int64_t y = b.as.i;
+        switch (index) {
+            case 0: *left = int_value(wrap_add(x, y)); return 0;
+            case 1: *left = int_value(wrap_sub(x, y)); return 0;
+            case 2: *left = int_value(wrap_mul(x, y)); return 0;
+            case 3:
+                if (y == 0) return -1;
+                *left = int_value(y == -1 ? wrap_sub(0, x) : x / y);
+                return 0;
+            default: *left = int_value(int_pow(x, y)); return 0;
+        }
+    }
+    double x = to_double(a);
+    double y = to_double(b);
+    switch (index) {
+        case 0: *left = decimal_value(x + y); return 0;
+        case 1: *left = decimal_value(x - y); return 0;
+        case 2: *left = decimal_value(x * y); return 0;
+        case 3:
+            if (y == 0.0) return -1;
+            *left = decimal_value(x / y);
+            return 0;
+        default: *left = decimal_value(pow(x, y)); return 0;
+    }
+}
+
+/* index segue a ordem EQ, NE, LT, LE, GT, GE. Textos são comparados
+ * byte a byte; misturados com números, valem como número. */
+static int compare_generic(int index, Value left, Value right) {
+    int order;
+    if (left.type == TYPE_TEXTO && right.type == TYPE_TEXTO) {
+        int length = left.as.t->length < right.as.t->length ? left.as.t->length : right.as.t->length;
+        order = memcmp(left.as.t->data, right.as.t->data, length);
+        if (order == 0) order = left.as.t->length - right.as.t->length;
+    } else {
+        Value a = to_number(left);
+        Value b = to_number(right);
+        if (a.type == TYPE_INTEIRO && b.type == TYPE_INTEIRO) {
+            order = (a.as.i > b.as.i) - (a.as.i < b.as.i);
+        } else {
+            double x = to_double(a);
+            double y = to_double(b);
+            order = (x > y) - (x < y);
+        }
+    }
+    switch (index) {
+        case 0: return order == 0;
+        case 1: return order != 0;
+        case 2: return order < 0;
+        case 3: return order <= 0;
+        case 4: return order > 0;
+        default: return order >= 0;
+    }
+}
+
+static void step(Value* value, int delta) {
+    if (value->type == TYPE_INTEIRO) {
+        value->as.i = wrap_add(value->as.i, delta);
+    } else if (value->type == TYPE_DECIMAL) {
+        value->as.d += delta;
+    } else {
+        Value one = int_value(delta);
+        arith_generic(0, value, one);
+    }
+}
+
+/* --- Entrada e Saída --- */
+
+static void print_value(FILE* out, Value value) {
+    switch (value.type) {
+        case TYPE_DECIMAL:
+            fprintf(out, "%.15g", value.as.d);
+            break;
+        case TYPE_TEXTO:
+            fwrite(value.as.t->data, 1, value.as.t->length, out);
+            break;
+        default:
+            fprintf(out, "%lld", (long long)value.as.i);
+            break;
+    }
+}
+
+/* Números são lidos como palavras; textos, até o fim da linha. No fim da
+ * entrada, o valor é o padrão do tipo. */
+static Value read_value(FILE* in, DataType type, Arena* arena) {
+    if (type == TYPE_INTEIRO) {
+        long long i = 0;
+        if (fscanf(in, "%lld", &i) != 1) i = 0;
+        return int_value(i);
+    }
+    if (type == TYPE_DECIMAL) {
+        double d = 0.0;
+        if (fscanf(in, "%lf", &d) != 1) d = 0.0;
+        return decimal_value(d);
+    }
+    char line[VM_TEXT_LINE_SIZE];
+    int c = fgetc(in);
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n') c = fgetc(in);
+    int length = 0;
+    while (c != EOF && c != '\n') {
+        if (length < VM_TEXT_LINE_SIZE) line[length++] = (char)c;
+        c = fgetc(in);
+    }
+    if (length > 0 && line[length - 1] == '\r') length--;
+    return text_value(arena, line, length);
+}
+
+/* --- Execução --- */
+
+static inline uint16_t read_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#define U16() (ip += 2, read_u16(ip - 2))
+#define U32() (ip += 4, read_u32(ip - 4))
+
+#ifdef VM_COMPUTED_GOTO
+#define VM_LOOP DISPATCH();
+#define VM_CASE(name) label_##name:
+#define DISPATCH() goto *labels[*ip++]
+#define VM_END
+#else
+#define VM_LOOP for (;;) switch (*ip++) {
+#define VM_CASE(name) case OP_##name:
+#define DISPATCH() continue
+#define VM_END default: goto halt; }
+#endif
+
+#define VM_ERROR(message) do { error = (message); goto runtime_error; } while (0)
+
+#define BINARY_I(expr) { \
+        int64_t b = sp[-1].as.i; int64_t a = sp[-2].as.i; \
+        sp[-2].as.i = (expr); sp--; DISPATCH(); }
+#define BINARY_D(expr) { \
+        double b = sp[-1].as.d; double a = sp[-2].as.d; \
+        sp[-2].as.d = (expr); sp--; DISPATCH(); }
+#define COMPARE_D(op) { \
+        double b = sp[-1].as.d; double a = sp[-2].as.d; \
+        sp[-2] = int_value(a op b); sp--; DISPATCH(); }
+#define GENERIC_ARITH(index) { \
+        if (arith_generic((index), &sp[-2], sp[-1]) != 0) VM_ERROR("Divisão por zero"); \
+        sp--; DISPATCH(); }
+#define GENERIC_COMPARE(index) { \
+        sp[-2] = int_value(compare_generic((index), sp[-2], sp[-1])); sp--; DISPATCH(); }
+#define JUMP_IF_I(op) { \
+        uint32_t target = U32(); \
+        int64_t b = sp[-1].as.i; int64_t a = sp[-2].as.i; sp -= 2; \
+        if (a op b) ip = code + target; \
+        DISPATCH(); }
+
+int vm_run(const Program* program, Arena* arena, FILE* in, FILE* out) {
+#ifdef VM_COMPUTED_GOTO
+#define LABEL_ADDRESS(name) &&label_##name,
+    static const void* labels[] = { OPCODES(LABEL_ADDRESS) };
+#undef LABEL_ADDRESS
+#endif
+    Value* stack = (Value*)arena_alloc(arena, VM_STACK_SIZE * sizeof(Value));
+    Value* stack_end = stack + VM_STACK_SIZE;
+    Frame* frames = (Frame*)arena_alloc(arena, VM_MAX_FRAMES * sizeof(Frame));
+    Value* globals = (Value*)arena_alloc(arena, (program->globals + 1) * sizeof(Value));
+    for (int i = 0; i < program->globals; i++) {
+        globals[i] = int_value(0);
+    }
+
+    const uint8_t* code = program->code;
+    const Value* constants = program->constants;
+    const uint8_t* ip = code;
+    Value* base = stack;
+    Value* sp = stack;
+    int frame_count = 0;
+    const char* error = NULL;
+    if (program->entry_max_stack > VM_STACK_SIZE) VM_ERROR("Estouro da pilha de valores");
+
+    VM_LOOP
+
+    VM_CASE(INT) {
+        sp->type = TYPE_INTEIRO;
+        sp->as.i = (int32_t)U32();
+        sp++;
+        DISPATCH();
+    }
+    VM_CASE(CONST) { *sp++ = constants[U32()]; DISPATCH(); }
+    VM_CASE(LOAD_LOCAL) { *sp++ = base[U16()]; DISPATCH(); }
+    VM_CASE(STORE_LOCAL) { base[U16()] = sp[-1]; DISPATCH(); }
+    VM_CASE(SET_LOCAL) { base[U16()] = *--sp; DISPATCH(); }
+    VM_CASE(LOAD_GLOBAL) { *sp++ = globals[U16()]; DISPATCH(); }
+    VM_CASE(STORE_GLOBAL) { globals[U16()] = sp[-1]; DISPATCH(); }
+    VM_CASE(SET_GLOBAL) { globals[U16()] = *--sp; DISPATCH(); }
+    VM_CASE(INC_LOCAL) {
+        Value* value = &base[U16()];
+        if (value->type == TYPE_INTEIRO) value->as.i = wrap_add(value->as.i, 1);
+        else step(value, 1);
+        DISPATCH();
+    }
+    VM_CASE(DEC_LOCAL) {
+        Value* value = &base[U16()];
+        if (value->type == TYPE_INTEIRO) value->as.i = wrap_sub(value->as.i, 1);
+        else step(value, -1);
+        DISPATCH();
+    }
+    VM_CASE(INC_GLOBAL) { step(&globals[U16()], 1); DISPATCH(); }
+    VM_CASE(DEC_GLOBAL) { step(&globals[U16()], -1); DISPATCH(); }
+    VM_CASE(POP) { sp--; DISPATCH(); }
+
+    VM_CASE(ADD_I) BINARY_I(wrap_add(a, b))
+    VM_CASE(SUB_I) BINARY_I(wrap_sub(a, b))
+    VM_CASE(MUL_I) BINARY_I(wrap_mul(a, b))
+    VM_CASE(DIV_I) {
+        int64_t b = sp[-1].as.i;
+        int64_t a = sp[-2].as.i;
+        if (b == 0) VM_ERROR("Divisão por zero");
+        sp[-2].as.i = b == -1 ? wrap_sub(0, a) : a / b;
+        sp--;
+        DISPATCH();
+    }
+    VM_CASE(POW_I) BINARY_I(int_pow(a, b))
+    VM_CASE(NEG_I) { sp[-1].as.i = wrap_sub(0, sp[-1].as.i); DISPATCH(); }
+
+    VM_CASE(ADD_D) BINARY_D(a + b)
+    VM_CASE(SUB_D) BINARY_D(a - b)
+    VM_CASE(MUL_D) BINARY_D(a * b)
+    VM_CASE(DIV_D) {
+        if (sp[-1].as.d == 0.0) VM_ERROR("Divisão por zero");
+        sp[-2].as.d /= sp[-1].as.d;
+        sp--;
+        DISPATCH();
+    }
+    VM_CASE(POW_D) BINARY_D(pow(a, b))
+    VM_CASE(NEG_D) { sp[-1].as.d = -sp[-1].as.d; DISPATCH(); }
+
+    VM_CASE(ADD) GENERIC_ARITH(0)
+    VM_CASE(SUB) GENERIC_ARITH(1)
+    VM_CASE(MUL) GENERIC_ARITH(2)
+    VM_CASE(DIV) GENERIC_ARITH(3)
+    VM_CASE(POW) GENERIC_ARITH(4)
+    VM_CASE(NEG) {
+        Value value = to_number(sp[-1]);
+        sp[-1] = value.type == TYPE_DECIMAL ? decimal_value(-value.as.d) : int_value(wrap_sub(0, value.as.i));
+        DISPATCH();
+    }
+
+    VM_CASE(EQ_I) BINARY_I(a == b)
+    VM_CASE(NE_I) BINARY_I(a != b)
+    VM_CASE(LT_I) BINARY_I(a < b)
+    VM_CASE(LE_I) BINARY_I(a <= b)
+    VM_CASE(GT_I) BINARY_I(a > b)
+    VM_CASE(GE_I) BINARY_I(a >= b)
+    VM_CASE(EQ_D) COMPARE_D(==)
+    VM_CASE(NE_D) COMPARE_D(!=)
+    VM_CASE(LT_D) COMPARE_D(<)
+    VM_CASE(LE_D) COMPARE_D(<=)
+    VM_CASE(GT_D) COMPARE_D(>)
+    VM_CASE(GE_D) COMPARE_D(>=)
+    VM_CASE(EQ) GENERIC_COMPARE(0)
+    VM_CASE(NE) GENERIC_COMPARE(1)
+    VM_CASE(LT) GENERIC_COMPARE(2)
+    VM_CASE(LE) GENERIC_COMPARE(3)
+    VM_CASE(GT) GENERIC_COMPARE(4)
+    VM_CASE(GE) GENERIC_COMPARE(5)
+
+    VM_CASE(TO_I) {
+        if (sp[-1].type != TYPE_INTEIRO) sp[-1] = int_value(to_int(sp[-1]));
+        DISPATCH();
+    }
+    VM_CASE(TO_D) {
+        if (sp[-1].type != TYPE_DECIMAL) sp[-1] = decimal_value(to_double(sp[-1]));
+        DISPATCH();
+    }
+    VM_CASE(TO_T) { sp[-1] = to_text(arena, sp[-1]); DISPATCH(); }
+    VM_CASE(FIT_T) {
+        uint16_t size = U16();
+        const Text* text = sp[-1].as.t;
+        if (text->length > size) {
+            Text* cut = (Text*)arena_alloc(arena, sizeof(Text));
+            cut->length = size;
+            cut->data = text->data;
+            sp[-1].as.t = cut;
+        }
+        DISPATCH();
+    }
+    VM_CASE(BOOL) { sp[-1] = int_value(truthy(sp[-1])); DISPATCH(); }
+
+    VM_CASE(JUMP) { ip = code + read_u32(ip); DISPATCH(); }
+    VM_CASE(JUMP_IF_FALSE) {
+        uint32_t target = U32();
+        sp--;
+        if (!truthy(*sp)) ip = code + target;
+        DISPATCH();
+    }
+    VM_CASE(JUMP_IF_TRUE) {
+        uint32_t target = U32();
+        sp--;
+        if (truthy(*sp)) ip = code + target;
+        DISPATCH();
+    }
+    VM_CASE(JUMP_IF_EQ_I) JUMP_IF_I(==)
+    VM_CASE(JUMP_IF_NE_I) JUMP_IF_I(!=)
+    VM_CASE(JUMP_IF_LT_I) JUMP_IF_I(<)
+    VM_CASE(JUMP_IF_LE_I) JUMP_IF_I(<=)
+    VM_CASE(JUMP_IF_GT_I) JUMP_IF_I(>)
+    VM_CASE(JUMP_IF_GE_I) JUMP_IF_I(>=)
+
+    VM_CASE(CALL) {
+        const FunctionInfo* function = &program->functions[U16()];
+        Value* callee = sp - function->params;
+        if (frame_count == VM_MAX_FRAMES) VM_ERROR("Estouro da pilha de chamadas");
+        if (callee + function->max_stack > stack_end) VM_ERROR("Estouro da pilha de valores");
+        frames[frame_count].ip = ip;
+        frames[frame_count].base = base;
+        frame_count++;
+        for (Value* local = sp; local < callee + function->locals; local++) {
+            *local = int_value(0);
+        }
+        base = callee;
+        sp = callee + function->locals;
+        ip = code + function->entry;
+        DISPATCH();
+    }
+    VM_CASE(RETURN) {
+        Value result = sp[-1];
+        frame_count--;
+        sp = base;
+        base = frames[frame_count].base;
+        ip = frames[frame_count].ip;
+        *sp++ = result;
+        DISPATCH();
+    }
+
+    VM_CASE(PRINT) { print_value(out, *--sp); DISPATCH(); }
+    VM_CASE(PRINT_NL) { fputc('\n', out); DISPATCH(); }
+    VM_CASE(READ) {
+        DataType type = (DataType)*ip++;
+        fflush(out);
+        *sp++ = read_value(in, type, arena);
+        DISPATCH();
+    }
+    VM_CASE(HALT) { goto halt; }
+
+    VM_END
+
+halt:
+    fflush(out);
+    return 0;
+
+runtime_error:
+    fflush(out);
+    printf("Erro de execução na linha %d: %s\n",
+           program_line(program, (uint32_t)(ip - code - 1)), error);
+    return 1;
+}
@@ -0,0 +1,26 @@
+#ifndef MAQUINA_H
+#define MAQUINA_H
+
+#include <stdio.h>
+#include "codigo.h"
+
+/* --- Máquina Virtual --- */
+
+/* Pilha de valores compartilhada por todas as chamadas e limite de
+ * chamadas aninhadas. */
+#ifndef VM_STACK_SIZE
+#define VM_STACK_SIZE 8192
+#endif
+#ifndef VM_MAX_FRAMES
+#define VM_MAX_FRAMES 1024
+#endif
+
+/* Executa o programa lendo de in (leia) e escrevendo em out (escreva).
+ * Pilha e textos criados na execução ficam em arena. O despacho é por
+ * goto computado (extensão do GCC e do Clang), ou por switch quando
+ * compilado com -DVM_SWITCH_DISPATCH ou em outros compiladores. Em erro
+ * de execução (divisão por zero, estouro da pilha) imprime a linha e a
+ * mensagem e retorna 1; senão retorna 0. */
+int vm_run(const Program* program, Arena* arena, FILE* in, FILE* out);
+
+#endif
@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+/* As alocações internas (arena_grow, Malloc) não são pontos de chamada. */
+#define MEMORIA_INTERNA
+#include "memoria.h"
+
+static MemoryContext default_memory = { 0, 0, MAX_MEMORY_KB * 1024L, 0, 0, 0, NULL };
+/* Arena de Malloc/Free, só para usos de uma única thread. */
+static Arena global_arena = { NULL, NULL, &default_memory };
+
+static atomic_long total_used;
+static atomic_long total_peak;
+static atomic_long total_mapped;
+
+static size_t align_size(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static char* chunk_data(ArenaChunk* chunk) {
+    return (char*)chunk + align_size(sizeof(ArenaChunk));
+}
+
+void memory_context_init(MemoryContext* memory) {
+    memory->current_used = 0;
+    memory->max_used = 0;
+    memory->budget = MAX_MEMORY_KB * 1024L;
+    memory->alert_emitted = 0;
+    memory->mapped = 0;
+    memory->allocations = 0;
+    memory->recover = NULL;
+}
+
+long memory_total_used(void) {
+    return atomic_load(&total_used);
+}
+
+long memory_total_peak(void) {
+    return atomic_load(&total_peak);
+}
+
+void memory_add_mapped(MemoryContext* memory, long bytes) {
+    memory->mapped += bytes;
+    atomic_fetch_add(&total_mapped, bytes);
+}
+
+long memory_total_mapped(void) {
+    return atomic_load(&total_mapped);
+}
+
+static void memory_charge(MemoryContext* memory, long bytes) {
+    memory->current_used += bytes;
+    if (memory->current_used > memory->max_used) {
+        memory->max_used = memory->current_used;
+    }
+
+    long total = atomic_fetch_add(&total_used, bytes) + bytes;
+    long peak = atomic_load(&total_peak);
+    while (total > peak && !atomic_compare_exchange_weak(&total_peak, &peak, total)) {
+    }
+}
+
+/* Sem recover, a falha encerra o processo. Com recover (biblioteca), o
+ * controle volta para quem chamou; nada foi alterado nas arenas. */
+static void memory_fail(MemoryContext* memory, const char* message) {
+    if (memory->recover != NULL) {
+        longjmp(*memory->recover, 1);
+    }
+    printf("%s\n", message);
+    exit(1);
+}
+
+static void memory_check_budget(MemoryContext* memory, long bytes) {
+    if (memory->current_used + bytes > memory->budget) {
+        memory_fail(memory, "ERRO: Memória Insuficiente.");
+    }
+}
+
+/* Quem desvia as falhas (recover) também não quer o alerta na saída. */
+static void memory_check_alert(MemoryContext* memory) {
+    if (!memory->alert_emitted && memory->recover == NULL && memory->current_used * 10 > memory->budget * 9) {
+        memory->alert_emitted = 1;
+        printf("ALERTA: Memória utilizada entre 90%% e 99%% do total disponível.\n");
+    }
+}
+
+/* O orçamento do contexto é verificado por bloco, e não por chamada. */
+static ArenaChunk* chunk_create(MemoryContext* memory, size_t min_size) {
+    size_t size = min_size > ARENA_CHUNK_SIZE ? min_size : ARENA_CHUNK_SIZE;
+    size_t total = align_size(sizeof(ArenaChunk)) + size;
+
+    memory_check_budget(memory, (long)total);
+    ArenaChunk* chunk = (ArenaChunk*)malloc(total);
+    if (chunk == NULL) {
+        memory_fail(memory, "ERRO: Falha ao alocar memória.");
+    }
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+
+    memory->allocations++;
+    memory_charge(memory, (long)total);
+    memory_check_alert(memory);
+    return chunk;
+}
+
+static ArenaChunk* chunk_resize(Arena* arena, ArenaChunk* chunk, size_t size) {
+    MemoryContext* memory = arena->memory;
+    long delta = (long)size - (long)chunk->size;
+    memory_check_budget(memory, delta);
+    ArenaChunk** link = &arena->head;
+    while (*link != chunk) {
+        link = &(*link)->next;
+    }
+    ArenaChunk* resized = (ArenaChunk*)realloc(chunk, align_size(sizeof(ArenaChunk)) + size);
+    if (resized == NULL) {
+        memory_fail(memory, "ERRO: Falha ao alocar memória.");
+    }
+    resized->size = size;
+    resized->used = size;
+    *link = resized;
+    arena->current = resized;
+
+    memory->allocations++;
+    memory_charge(memory, delta);
+    memory_check_alert(memory);
+    return resized;
+}
+
+void arena_init(Arena* arena, MemoryContext* memory) {
+    arena->head = NULL;
+    arena->current = NULL;
+    arena->memory = memory != NULL ? memory : &default_memory;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    size = align_size(size);
+
+    ArenaChunk* chunk = arena->current;
+    if (chunk != NULL && chunk->size - chunk->used >= size) {
+        void* ptr = chunk_data(chunk) + chunk->used;
+        chunk->used += size;
+        return ptr;
+    }
+
+    /* Reaproveita o próximo bloco retido por um reset, se couber. */
+    if (chunk != NULL && chunk->next != NULL && chunk->next->size >= size) {
+        chunk = chunk->next;
+        chunk->used = 0;
+    } else {
+        ArenaChunk* fresh = chunk_create(arena->memory, size);
+        if (chunk == NULL) {
+            fresh->next = arena->head;
+            arena->head = fresh;
+        } else {
+            fresh->next = chunk->next;
+            chunk->next = fresh;
+        }
+        chunk = fresh;
+    }
+    arena->current = chunk;
+    chunk->used = size;
+    return chunk_data(chunk);
+}
+
+void* arena_grow(Arena* arena, void* ptr, size_t old_size, size_t new_size) {
+    old_size = align_size(old_size);
+    ArenaChunk* chunk = arena->current;
+    if (ptr != NULL && chunk != NULL &&
+        (char*)ptr + old_size == chunk_data(chunk) + chunk->used &&
+        chunk->used - old_size + align_size(new_size) <= chunk->size) {
+        chunk->used = chunk->used - old_size + align_size(new_size);
+        return ptr;
+    }
+    /* Sozinha no bloco: o bloco inteiro é realocado, sem deixar a cópia
+     * antiga ocupando o orçamento até o reset. */
+    if (ptr != NULL && chunk != NULL && (char*)ptr == chunk_data(chunk) &&
+        chunk->used == old_size && new_size > chunk->size) {
+        return chunk_data(chunk_resize(arena, chunk, align_size(new_size)));
+    }
+    void* grown = arena_alloc(arena, new_size);
+    if (ptr != NULL) {
+        memcpy(grown, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return grown;
+}
+
+void arena_reset(Arena* arena) {
+    arena->current = arena->head;
+    if (arena->head != NULL) {
+        arena->head->used = 0;
+    }
+}
+
+void arena_destroy(Arena* arena) {
+    ArenaChunk* chunk = arena->head;
+    while (chunk != NULL) {
+        ArenaChunk* next = chunk->next;
+        memory_charge(arena->memory, -(long)(align_size(sizeof(ArenaChunk)) + chunk->size));
+        free(chunk);
+        chunk = next;
+    }
+    arena->head = NULL;
+    arena->current = NULL;
+}
+
+void memory_shutdown(void) {
+    arena_destroy(&global_arena);
+}
+
+void* Malloc(size_t size) {
+    return arena_alloc(&global_arena, size);
+}
+
+/* Só a última alocação da arena global é devolvida de imediato; o
+ * restante é recuperado em memory_shutdown. */
+void Free(void* ptr, size_t size) {
+    ArenaChunk* chunk = global_arena.current;
+    if (ptr == NULL || chunk == NULL) return;
+
+    size = align_size(size);
+    if (size <= chunk->used && (char*)ptr == chunk_data(chunk) + chunk->used - size) {
+        chunk->used -= size;
+    }
+}
+
+/* --- Funções Utilitárias de String --- */
+
+char* my_strdup(const char* s) {
+    if (s == NULL) return NULL;
+    size_t len = strlen(s) + 1;
+    char* new_s = (char*)Malloc(len);
+    if (new_s == NULL) return NULL;
+    memcpy(new_s, s, len);
+    return new_s;
+}
+
+size_t my_strnlen(const char *s, size_t maxlen) {
+    size_t len = 0;
+    while (len < maxlen && s[len] != '\0') {
+        len++;
+    }
+    return len;
+}
+
+char* my_strndup(const char* s, size_t n) {
+    if (s == NULL) return NULL;
+    size_t len = my_strnlen(s, n);
+    char* new_s = (char*)Malloc(len + 1);
+    if (new_s == NULL) return NULL;
+    memcpy(new_s, s, len);
+    new_s[len] = '\0';
+    return new_s;
+}
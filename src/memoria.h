@@ -0,0 +1,100 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stddef.h>
+#include <setjmp.h>
+#include "estatisticas.h"
+
+/* --- Configuração de Memória --- */
+#define MAX_MEMORY_KB 2048
+#define ARENA_CHUNK_SIZE (16 * 1024)
+#define ARENA_ALIGN 16
+
+/* Contabilidade de uma compilação: cada contexto tem seu próprio
+ * orçamento de MAX_MEMORY_KB e seu próprio pico. Um contexto é usado por
+ * uma thread de cada vez; os totais do processo são atômicos. */
+typedef struct {
+    long current_used;
+    long max_used;
+    long budget;
+    int alert_emitted;
+    long mapped;    /* arquivos mapeados (mmap), fora do orçamento */
+    long allocations; /* blocos pedidos ao sistema (malloc/realloc) */
+    jmp_buf* recover; /* se não for NULL, falhas desviam para cá em vez de exit(1) */
+} MemoryContext;
+
+/* Bloco de uma arena; os dados seguem o cabeçalho. */
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t size;
+    size_t used;
+} ArenaChunk;
+
+/* Arena com alocação por incremento (bump). O reset é O(1): os blocos são
+ * mantidos e reaproveitados na fase seguinte. Os blocos são contabilizados
+ * no MemoryContext dono da arena. */
+typedef struct {
+    ArenaChunk* head;
+    ArenaChunk* current;
+    MemoryContext* memory;
+} Arena;
+
+void memory_context_init(MemoryContext* memory);
+
+/* Totais do processo, somando todos os contextos (seguros entre threads). */
+long memory_total_used(void);
+long memory_total_peak(void);
+
+/* Mapeamentos de arquivo não usam o heap nem o orçamento: são somados à
+ * parte (bytes negativos ao desmapear). */
+void memory_add_mapped(MemoryContext* memory, long bytes);
+long memory_total_mapped(void);
+
+/* memory == NULL usa o contexto padrão do processo. */
+void arena_init(Arena* arena, MemoryContext* memory);
+void* arena_alloc(Arena* arena, size_t size);
+/* Aumenta a alocação ptr (old_size bytes) para new_size. Se ela for a
+ * última do bloco atual, cresce no lugar (ou o bloco é realocado, quando
+ * ela o ocupa sozinha); senão é copiada para uma nova alocação e a antiga
+ * só é recuperada no reset. */
+void* arena_grow(Arena* arena, void* ptr, size_t old_size, size_t new_size);
+void arena_reset(Arena* arena);
+void arena_destroy(Arena* arena);
+
+/* Libera a arena global ao final do programa. */
+void memory_shutdown(void);
+
+/* Alocam da arena global do processo, sem sincronização: só para código
+ * de uma única thread (como a lista de arquivos do modo observador). As
+ * compilações usam arenas próprias, passadas explicitamente. */
+void* Malloc(size_t size);
+void Free(void* ptr, size_t size);
+
+char* my_strdup(const char* s);
+size_t my_strnlen(const char *s, size_t maxlen);
+char* my_strndup(const char* s, size_t n);
+
+/* --- Pontos de Alocação --- */
+
+/* Fora de memoria.c, cada chamada conta a alocação no seu próprio ponto
+ * (estatisticas.h) antes de chamar a função: a macro não se expande de
+ * novo dentro dela mesma. */
+#if defined(__GNUC__) && !defined(STATS_DISABLED) && !defined(MEMORIA_INTERNA)
+#define STATS_ALLOC_SITE(size) __extension__ ({ \
+        static AllocSite stats_site_ = { .file = __FILE__, .line = __LINE__, .function = __func__ }; \
+        stats_alloc(&stats_site_, (size)); })
+#define arena_alloc(arena, size) __extension__ ({ \
+        size_t stats_size_ = (size); \
+        STATS_ALLOC_SITE(stats_size_); \
+        arena_alloc((arena), stats_size_); })
+#define arena_grow(arena, ptr, old_size, new_size) __extension__ ({ \
+        size_t stats_size_ = (new_size); \
+        STATS_ALLOC_SITE(stats_size_); \
+        arena_grow((arena), (ptr), (old_size), stats_size_); })
+#define Malloc(size) __extension__ ({ \
+        size_t stats_size_ = (size); \
+        STATS_ALLOC_SITE(stats_size_); \
+        Malloc(stats_size_); })
+#endif
+
+#endif
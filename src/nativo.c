@@ -0,0 +1,1099 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "nativo.h"
+#include "simbolos.h"
+
+#define NATIVE_INITIAL_CONSTANTS 64
+
+/* Onde uma variável vive durante a função. */
+typedef enum {
+    LOCATION_REGISTER,  /* offset: índice em int_registers */
+    LOCATION_FRAME,     /* offset: deslocamento em relação a rbp */
+    LOCATION_GLOBAL     /* offset: número da global (g_N) */
+} LocationKind;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t type;       /* DataType */
+    int32_t offset;
+    int size;           /* tamanho de um texto (0 = sem limite) */
+} Location;
+
+typedef struct {
+    const Ast* ast;
+    FILE* out;
+    Arena* arena;
+    SymbolTable symbols;
+    Location* locations;     /* por nó declarador/parâmetro */
+    AstIndex* functions;     /* por SymbolId: nó da função */
+    uint8_t* return_types;   /* por nó de função: 0 = a calcular */
+    double* decimals;        /* literais decimal, rótulo .Ldecimal_N */
+    int decimals_count;
+    int decimals_capacity;
+    AstIndex* texts;         /* literais texto, rótulo .Ltexto_N */
+    int texts_count;
+    int texts_capacity;
+    int one_decimal;         /* constante 1.0 dos incrementos (-1 = ainda não usada) */
+    int globals;
+    int labels;
+    int registers;           /* registradores já atribuídos na função atual */
+    int frame;               /* slots de 8 bytes já atribuídos abaixo de rbp */
+    int depth;               /* palavras empilhadas desde o fim do prólogo */
+    int function_id;
+    DataType return_type;
+} Native;
+
+static const char* const int_registers[NATIVE_INT_REGISTERS] = {
+    "%rbx", "%r12", "%r13", "%r14", "%r15"
+};
+
+/* Sufixos de salto/set na ordem IGUAL, DIF, MENOR, MENOR_IGUAL, MAIOR,
+ * MAIOR_IGUAL, e o índice da comparação contrária. */
+static const char* const int_conditions[6] = { "e", "ne", "l", "le", "g", "ge" };
+static const int negated_comparison[6] = { 1, 0, 5, 4, 3, 2 };
+
+/* --- Emissão --- */
+
+static const AstNode* node_at(const Native* native, AstIndex index) {
+    return ast_node(native->ast, index);
+}
+
+static void emit(Native* native, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    fputc('\t', native->out);
+    vfprintf(native->out, format, args);
+    fputc('\n', native->out);
+    va_end(args);
+}
+
+static int new_label(Native* native) {
+    return native->labels++;
+}
+
+static void emit_label(Native* native, int label) {
+    fprintf(native->out, ".L%d:\n", label);
+}
+
+static void emit_push(Native* native, DataType type) {
+    if (type == TYPE_DECIMAL) {
+        emit(native, "subq $8, %%rsp");
+        emit(native, "movsd %%xmm0, (%%rsp)");
+    } else {
+        emit(native, "pushq %%rax");
+    }
+    native->depth++;
+}
+
+/* Funções do suporte de execução seguem a ABI: a pilha precisa estar
+ * alinhada em 16 bytes na instrução call. */
+static void call_runtime(Native* native, const char* name) {
+    int pad = native->depth & 1;
+    if (pad) emit(native, "subq $8, %%rsp");
+    emit(native, "call %s@PLT", name);
+    if (pad) emit(native, "addq $8, %%rsp");
+}
+
+static void function_label(const Native* native, AstIndex function, char* buffer, size_t size) {
+    const AstNode* node = node_at(native, function);
+    if (node->kind == AST_PRINCIPAL) {
+        snprintf(buffer, size, "programa_principal");
+        return;
+    }
+    const SymbolName* name = interner_name(native->ast->interner, node->symbol);
+    snprintf(buffer, size, "funcao%.*s", (int)name->length, name->text);
+}
+
+/* --- Constantes --- */
+
+static int add_decimal(Native* native, double value) {
+    if (native->decimals_count == native->decimals_capacity) {
+        native->decimals = (double*)arena_grow(native->arena, native->decimals,
+                                               native->decimals_capacity * sizeof(double),
+                                               2 * native->decimals_capacity * sizeof(double));
+        native->decimals_capacity *= 2;
+    }
+    native->decimals[native->decimals_count] = value;
+    return native->decimals_count++;
+}
+
+static int add_text(Native* native, AstIndex literal) {
+    if (native->texts_count == native->texts_capacity) {
+        native->texts = (AstIndex*)arena_grow(native->arena, native->texts,
+                                              native->texts_capacity * sizeof(AstIndex),
+                                              2 * native->texts_capacity * sizeof(AstIndex));
+        native->texts_capacity *= 2;
+    }
+    native->texts[native->texts_count] = literal;
+    return native->texts_count++;
+}
+
+static void emit_constants(Native* native) {
+    FILE* out = native->out;
+    fprintf(out, "\n\t.section .rodata\n\t.p2align 3\n");
+    for (int i = 0; i < native->decimals_count; i++) {
+        uint64_t bits;
+        memcpy(&bits, &native->decimals[i], sizeof(bits));
+        fprintf(out, ".Ldecimal_%d:\n\t.quad 0x%llx\n", i, (unsigned long long)bits);
+    }
+    fprintf(out, ".Ltexto_vazio_dados:\n\t.byte 0\n");
+    for (int i = 0; i < native->texts_count; i++) {
+        const AstNode* node = node_at(native, native->texts[i]);
+        const unsigned char* text = (const unsigned char*)&native->ast->source[node->offset];
+        fprintf(out, ".Ltexto_%d_dados:\n\t.byte ", i);
+        for (int j = 0; j < node->length; j++) {
+            fprintf(out, "%d,", text[j]);
+        }
+        fprintf(out, "0\n");
+    }
+
+    /* Os textos guardam ponteiros: ficam numa seção que o ligador corrige
+     * antes de proteger, o que também funciona em executáveis PIE. */
+    fprintf(out, "\n\t.section .data.rel.ro,\"aw\"\n\t.p2align 3\n");
+    fprintf(out, ".Ltexto_vazio:\n\t.quad 0, .Ltexto_vazio_dados\n");
+    for (int i = 0; i < native->texts_count; i++) {
+        fprintf(out, ".Ltexto_%d:\n\t.quad %d, .Ltexto_%d_dados\n",
+                i, node_at(native, native->texts[i])->length, i);
+    }
+
+    if (native->globals > 0) {
+        fprintf(out, "\n\t.bss\n\t.p2align 3\n");
+        for (int i = 0; i < native->globals; i++) {
+            fprintf(out, "g_%d:\n\t.zero 8\n", i);
+        }
+    }
+}
+
+/* --- Tipos --- */
+
+/* O tipo anotado pela análise semântica fica TYPE_NENHUM em chamadas a
+ * funções definidas mais adiante e em contas com texto; aqui cada
+ * expressão precisa de um tipo fixo, então ele é recalculado: contas
+ * com texto viram decimal e chamadas usam o tipo final do retorno. */
+static DataType value_type(Native* native, AstIndex index);
+
+static AstIndex first_return(const Native* native, AstIndex first) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(native, item)->next) {
+        const AstNode* node = node_at(native, item);
+        AstIndex found = AST_NULL;
+        switch ((AstKind)node->kind) {
+            case AST_RETORNO:
+                return node->child[0];
+            case AST_BLOCO:
+                found = first_return(native, node->child[0]);
+                break;
+            case AST_SE:
+                found = first_return(native, node->child[1]);
+                if (found == AST_NULL) found = first_return(native, node->child[2]);
+                break;
+            case AST_PARA:
+                found = first_return(native, node->child[3]);
+                break;
+            default:
+                break;
+        }
+        if (found != AST_NULL) return found;
+    }
+    return AST_NULL;
+}
+
+/* Tipo devolvido por uma função: o do primeiro retorno. Funções que só
+ * retornam chamadas recursivas a si mesmas ficam inteiro. */
+static DataType return_type(Native* native, AstIndex function) {
+    const AstNode* node = node_at(native, function);
+    uint8_t known = native->return_types[function];
+    if (known != 0) return known == 0xFF ? TYPE_INTEIRO : (DataType)(known - 1);
+    DataType type = (DataType)node->type;
+    if (node->kind != AST_FUNCAO) {
+        type = TYPE_INTEIRO;
+    } else if (type == TYPE_NENHUM) {
+        native->return_types[function] = 0xFF;
+        AstIndex value = first_return(native, node_at(native, node->child[1])->child[0]);
+        type = value != AST_NULL ? value_type(native, value) : TYPE_INTEIRO;
+    }
+    if (type == TYPE_NENHUM) type = TYPE_INTEIRO;
+    native->return_types[function] = (uint8_t)(type + 1);
+    return type;
+}
+
+static int comparison_index(TokenType op) {
+    switch (op) {
+        case TOKEN_OP_IGUAL: return 0;
+        case TOKEN_OP_DIF: return 1;
+        case TOKEN_OP_MENOR: return 2;
+        case TOKEN_OP_MENOR_IGUAL: return 3;
+        case TOKEN_OP_MAIOR: return 4;
+        case TOKEN_OP_MAIOR_IGUAL: return 5;
+        default: return -1;
+    }
+}
+
+static DataType arithmetic_type(DataType left, DataType right) {
+    return left == TYPE_INTEIRO && right == TYPE_INTEIRO ? TYPE_INTEIRO : TYPE_DECIMAL;
+}
+
+/* Comparações entre dois textos são byte a byte; com um número, o texto
+ * vale como decimal. */
+static DataType comparison_type(DataType left, DataType right) {
+    if (left == TYPE_TEXTO && right == TYPE_TEXTO) return TYPE_TEXTO;
+    return arithmetic_type(left, right);
+}
+
+static DataType value_type(Native* native, AstIndex index) {
+    const AstNode* node = node_at(native, index);
+    switch ((AstKind)node->kind) {
+        case AST_LITERAL:
+            return data_type_from_token((TokenType)node->op);
+        case AST_VARIAVEL:
+            return node->type == TYPE_NENHUM ? TYPE_INTEIRO : (DataType)node->type;
+        case AST_ATRIBUICAO:
+        case AST_INCREMENTO:
+            return value_type(native, node->child[0]);
+        case AST_CHAMADA:
+            return return_type(native, native->functions[node->symbol]);
+        case AST_UNARIO:
+            return arithmetic_type(value_type(native, node->child[0]), TYPE_INTEIRO);
+        case AST_BINARIO:
+            if (node->op == TOKEN_OP_E || node->op == TOKEN_OP_OU ||
+                comparison_index((TokenType)node->op) >= 0) {
+                return TYPE_INTEIRO;
+            }
+            return arithmetic_type(value_type(native, node->child[0]), value_type(native, node->child[1]));
+        default:
+            return TYPE_INTEIRO;
+    }
+}
+
+/* Converte rax/xmm0 do tipo value para target; textos convertidos são
+ * cortados por emit_fit quando necessário. */
+static void emit_convert(Native* native, DataType target, DataType value) {
+    if (target == value) return;
+    switch (target) {
+        case TYPE_INTEIRO:
+            if (value == TYPE_DECIMAL) {
+                emit(native, "cvttsd2siq %%xmm0, %%rax");
+            } else {
+                emit(native, "movq %%rax, %%rdi");
+                call_runtime(native, "rt_texto_para_inteiro");
+            }
+            break;
+        case TYPE_DECIMAL:
+            if (value == TYPE_INTEIRO) {
+                emit(native, "cvtsi2sdq %%rax, %%xmm0");
+            } else {
+                emit(native, "movq %%rax, %%rdi");
+                call_runtime(native, "rt_texto_para_decimal");
+            }
+            break;
+        case TYPE_TEXTO:
+            if (value == TYPE_INTEIRO) {
+                emit(native, "movq %%rax, %%rdi");
+                call_runtime(native, "rt_texto_de_inteiro");
+            } else {
+                call_runtime(native, "rt_texto_de_decimal");
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void emit_fit(Native* native, int size) {
+    if (size <= 0) return;
+    emit(native, "movq %%rax, %%rdi");
+    emit(native, "movq $%d, %%rsi", size);
+    call_runtime(native, "rt_texto_cortar");
+}
+
+/* Valor inicial de uma variável declarada sem valor. */
+static void emit_default(Native* native, DataType type) {
+    if (type == TYPE_DECIMAL) {
+        emit(native, "xorpd %%xmm0, %%xmm0");
+    } else if (type == TYPE_TEXTO) {
+        emit(native, "leaq .Ltexto_vazio(%%rip), %%rax");
+    } else {
+        emit(native, "xorl %%eax, %%eax");
+    }
+}
+
+/* --- Variáveis --- */
+
+static void location_operand(const Location* location, char* buffer, size_t size) {
+    switch (location->kind) {
+        case LOCATION_REGISTER:
+            snprintf(buffer, size, "%s", int_registers[location->offset]);
+            break;
+        case LOCATION_FRAME:
+            snprintf(buffer, size, "%d(%%rbp)", location->offset);
+            break;
+        default:
+            snprintf(buffer, size, "g_%d(%%rip)", location->offset);
+            break;
+    }
+}
+
+static int declared_size(const Native* native, AstIndex declarator) {
+    const AstNode* node = node_at(native, declarator);
+    if (node->kind != AST_DECLARADOR || node->child[0] == AST_NULL) return 0;
+    return atoi(&native->ast->source[node_at(native, node->child[0])->offset]);
+}
+
+static Location resolve(Native* native, AstIndex var) {
+    int found = symtab_lookup(&native->symbols, node_at(native, var)->symbol);
+    if (found < 0) {
+        /* A análise semântica já garante que não acontece. */
+        Location none = { LOCATION_GLOBAL, TYPE_INTEIRO, 0, 0 };
+        return none;
+    }
+    return native->locations[symtab_symbol(&native->symbols, found)->node];
+}
+
+/* inteiro vai para um registrador enquanto houver; o resto ocupa um
+ * slot do quadro (ou da área de globais). */
+static Location allocate(Native* native, DataType type, int size, int global) {
+    Location location;
+    location.type = (uint8_t)type;
+    location.size = size;
+    if (global) {
+        location.kind = LOCATION_GLOBAL;
+        location.offset = native->globals++;
+    } else if (type == TYPE_INTEIRO && native->registers < NATIVE_INT_REGISTERS) {
+        location.kind = LOCATION_REGISTER;
+        location.offset = native->registers++;
+    } else {
+        location.kind = LOCATION_FRAME;
+        location.offset = -8 * ++native->frame;
+    }
+    return location;
+}
+
+static void emit_load(Native* native, const Location* location) {
+    char operand[32];
+    location_operand(location, operand, sizeof(operand));
+    if (location->type == TYPE_DECIMAL) emit(native, "movsd %s, %%xmm0", operand);
+    else emit(native, "movq %s, %%rax", operand);
+}
+
+static void emit_store(Native* native, const Location* location) {
+    char operand[32];
+    location_operand(location, operand, sizeof(operand));
+    if (location->type == TYPE_DECIMAL) emit(native, "movsd %%xmm0, %s", operand);
+    else emit(native, "movq %%rax, %s", operand);
+}
+
+/* --- Expressões --- */
+
+static DataType emit_expression(Native* native, AstIndex index);
+static void emit_branch(Native* native, AstIndex condition, int when_true, int label);
+
+static DataType emit_literal(Native* native, AstIndex index) {
+    const AstNode* node = node_at(native, index);
+    switch ((TokenType)node->op) {
+        case TOKEN_LITERAL_INT: {
+            long long value = ast_literal_int(native->ast, node);
+            if (value == 0) emit(native, "xorl %%eax, %%eax");
+            else if (value >= INT32_MIN && value <= INT32_MAX) emit(native, "movq $%lld, %%rax", value);
+            else emit(native, "movabsq $%lld, %%rax", value);
+            return TYPE_INTEIRO;
+        }
+        case TOKEN_LITERAL_DEC:
+            emit(native, "movsd .Ldecimal_%d(%%rip), %%xmm0", add_decimal(native, ast_literal_decimal(native->ast, node)));
+            return TYPE_DECIMAL;
+        default:
+            emit(native, "leaq .Ltexto_%d(%%rip), %%rax", add_text(native, index));
+            return TYPE_TEXTO;
+    }
+}
+
+/* Operando direto para uma instrução com rax: literal inteiro de 32 bits
+ * ou variável inteiro. Evita empilhar o lado direito. */
+static int int_operand(Native* native, AstIndex index, char* buffer, size_t size) {
+    const AstNode* node = node_at(native, index);
+    if (node->kind == AST_LITERAL && node->op == TOKEN_LITERAL_INT) {
+        long long value = ast_literal_int(native->ast, node);
+        if (value < INT32_MIN || value > INT32_MAX) return 0;
+        snprintf(buffer, size, "$%lld", value);
+        return 1;
+    }
+    if (node->kind == AST_VARIAVEL && value_type(native, index) == TYPE_INTEIRO) {
+        Location location = resolve(native, index);
+        location_operand(&location, buffer, size);
+        return 1;
+    }
+    return 0;
+}
+
+/* Mesma ideia para decimal: literal ou variável decimal. */
+static int decimal_operand(Native* native, AstIndex index, char* buffer, size_t size) {
+    const AstNode* node = node_at(native, index);
+    if (node->kind == AST_LITERAL && node->op == TOKEN_LITERAL_DEC) {
+        double value = ast_literal_decimal(native->ast, node);
+        snprintf(buffer, size, ".Ldecimal_%d(%%rip)", add_decimal(native, value));
+        return 1;
+    }
+    if (node->kind == AST_VARIAVEL && value_type(native, index) == TYPE_DECIMAL) {
+        Location location = resolve(native, index);
+        location_operand(&location, buffer, size);
+        return 1;
+    }
+    return 0;
+}
+
+/* Avalia os dois lados: esquerdo em rax (ou xmm0), direito em operand,
+ * que é um operando direto ou rcx (xmm1). */
+static void emit_operands(Native* native, AstIndex left, AstIndex right, DataType type,
+                          char* operand, size_t size) {
+    emit_convert(native, type, emit_expression(native, left));
+    if (type == TYPE_INTEIRO) {
+        if (int_operand(native, right, operand, size)) return;
+        emit_push(native, type);
+        emit_convert(native, type, emit_expression(native, right));
+        emit(native, "movq %%rax, %%rcx");
+        emit(native, "popq %%rax");
+        native->depth--;
+        snprintf(operand, size, "%%rcx");
+        return;
+    }
+    if (type == TYPE_DECIMAL && decimal_operand(native, right, operand, size)) {
+        emit(native, "movsd %s, %%xmm1", operand);
+    } else if (type == TYPE_DECIMAL) {
+        emit_push(native, type);
+        emit_convert(native, type, emit_expression(native, right));
+        emit(native, "movapd %%xmm0, %%xmm1");
+        emit(native, "movsd (%%rsp), %%xmm0");
+        emit(native, "addq $8, %%rsp");
+        native->depth--;
+    } else {
+        emit_push(native, type);
+        emit_convert(native, type, emit_expression(native, right));
+        emit(native, "movq %%rax, %%rsi");
+        emit(native, "popq %%rdi");
+        native->depth--;
+    }
+    snprintf(operand, size, "%%xmm1");
+}
+
+/* Divisor em rcx. Divisão por zero encerra o programa como na máquina
+ * virtual; dividir por -1 nega, pois idiv falha com INT64_MIN / -1. */
+static void emit_int_division(Native* native, int line) {
+    int nonzero = new_label(native);
+    int divide = new_label(native);
+    int done = new_label(native);
+    emit(native, "testq %%rcx, %%rcx");
+    emit(native, "jne .L%d", nonzero);
+    emit(native, "movq $%d, %%rdi", line);
+    call_runtime(native, "rt_divisao_por_zero");
+    emit_label(native, nonzero);
+    emit(native, "cmpq $-1, %%rcx");
+    emit(native, "jne .L%d", divide);
+    emit(native, "negq %%rax");
+    emit(native, "jmp .L%d", done);
+    emit_label(native, divide);
+    emit(native, "cqto");
+    emit(native, "idivq %%rcx");
+    emit_label(native, done);
+}
+
+static DataType emit_arithmetic(Native* native, AstIndex index) {
+    const AstNode* node = node_at(native, index);
+    TokenType op = (TokenType)node->op;
+    int line = node->line;
+    DataType type = arithmetic_type(value_type(native, node->child[0]), value_type(native, node->child[1]));
+    char operand[32];
+    emit_operands(native, node->child[0], node->child[1], type, operand, sizeof(operand));
+
+    if (type == TYPE_INTEIRO) {
+        switch (op) {
+            case TOKEN_OP_SOMA: emit(native, "addq %s, %%rax", operand); break;
+            case TOKEN_OP_SUB: emit(native, "subq %s, %%rax", operand); break;
+            case TOKEN_OP_MULT: emit(native, "imulq %s, %%rax", operand); break;
+            case TOKEN_OP_DIV:
+                if (strcmp(operand, "%rcx") != 0) emit(native, "movq %s, %%rcx", operand);
+                emit_int_division(native, line);
+                break;
+            default:
+                emit(native, "movq %s, %%rsi", operand);
+                emit(native, "movq %%rax, %%rdi");
+                call_runtime(native, "rt_potencia_inteiro");
+                break;
+        }
+        return TYPE_INTEIRO;
+    }
+
+    switch (op) {
+        case TOKEN_OP_SOMA: emit(native, "addsd %%xmm1, %%xmm0"); break;
+        case TOKEN_OP_SUB: emit(native, "subsd %%xmm1, %%xmm0"); break;
+        case TOKEN_OP_MULT: emit(native, "mulsd %%xmm1, %%xmm0"); break;
+        case TOKEN_OP_DIV: {
+            int nonzero = new_label(native);
+            emit(native, "xorpd %%xmm2, %%xmm2");
+            emit(native, "ucomisd %%xmm2, %%xmm1");
+            emit(native, "jne .L%d", nonzero);
+            emit(native, "jp .L%d", nonzero);
+            emit(native, "movq $%d, %%rdi", line);
+            call_runtime(native, "rt_divisao_por_zero");
+            emit_label(native, nonzero);
+            emit(native, "divsd %%xmm1, %%xmm0");
+            break;
+        }
+        default:
+            call_runtime(native, "rt_potencia");
+            break;
+    }
+    return TYPE_DECIMAL;
+}
+
+/* Compara os dois lados e retorna o tipo da comparação. Para inteiro e
+ * texto, as flags ficam prontas para int_conditions; para decimal, o
+ * esquerdo está em xmm0 e o direito em xmm1. */
+static DataType emit_compare(Native* native, const AstNode* node) {
+    DataType type = comparison_type(value_type(native, node->child[0]), value_type(native, node->child[1]));
+    char operand[32];
+    const AstNode* left = node_at(native, node->child[0]);
+    if (type == TYPE_INTEIRO && left->kind == AST_VARIAVEL &&
+        int_operand(native, node->child[1], operand, sizeof(operand))) {
+        /* Variável em registrador: compara sem copiar para rax. */
+        Location location = resolve(native, node->child[0]);
+        if (location.kind == LOCATION_REGISTER) {
+            emit(native, "cmpq %s, %s", operand, int_registers[location.offset]);
+            return type;
+        }
+    }
+    emit_operands(native, node->child[0], node->child[1], type, operand, sizeof(operand));
+    if (type == TYPE_INTEIRO) {
+        emit(native, "cmpq %s, %%rax", operand);
+    } else if (type == TYPE_TEXTO) {
+        call_runtime(native, "rt_texto_comparar");
+        emit(native, "cmpq $0, %%rax");
+    }
+    return type;
+}
+
+/* Resultado 0 ou 1 em rax. Em decimal, ucomisd marca "não ordenado"
+ * (NaN) em PF: só diferente é verdadeiro nesse caso. */
+static DataType emit_comparison(Native* native, AstIndex index) {
+    const AstNode* node = node_at(native, index);
+    int comparison = comparison_index((TokenType)node->op);
+    if (emit_compare(native, node) != TYPE_DECIMAL) {
+        emit(native, "set%s %%al", int_conditions[comparison]);
+    } else {
+        switch (comparison) {
+            case 0:
+                emit(native, "ucomisd %%xmm1, %%xmm0");
+                emit(native, "sete %%al");
+                emit(native, "setnp %%cl");
+                emit(native, "andb %%cl, %%al");
+                break;
+            case 1:
+                emit(native, "ucomisd %%xmm1, %%xmm0");
+                emit(native, "setne %%al");
+                emit(native, "setp %%cl");
+                emit(native, "orb %%cl, %%al");
+                break;
+            case 2:
+            case 3:
+                emit(native, "ucomisd %%xmm0, %%xmm1");
+                emit(native, "set%s %%al", comparison == 2 ? "a" : "ae");
+                break;
+            default:
+                emit(native, "ucomisd %%xmm1, %%xmm0");
+                emit(native, "set%s %%al", comparison == 4 ? "a" : "ae");
+                break;
+        }
+    }
+    emit(native, "movzbl %%al, %%eax");
+    return TYPE_INTEIRO;
+}
+
+/* Deixa ZF = 1 quando o valor é falso. */
+static void emit_truth(Native* native, DataType type) {
+    if (type == TYPE_TEXTO) {
+        emit(native, "cmpq $0, (%%rax)");
+    } else if (type == TYPE_DECIMAL) {
+        emit(native, "xorpd %%xmm1, %%xmm1");
+        emit(native, "ucomisd %%xmm1, %%xmm0");
+        emit(native, "setne %%al");
+        emit(native, "setp %%cl");
+        emit(native, "orb %%cl, %%al");
+    } else {
+        emit(native, "testq %%rax, %%rax");
+    }
+}
+
+/* "a && b" e "a || b" com curto-circuito; o resultado é 0 ou 1. */
+static DataType emit_logic(Native* native, AstIndex index) {
+    int is_and = node_at(native, index)->op == TOKEN_OP_E;
+    int short_circuit = new_label(native);
+    int end = new_label(native);
+    emit_branch(native, index, !is_and, short_circuit);
+    emit(native, "movl $%d, %%eax", is_and ? 1 : 0);
+    emit(native, "jmp .L%d", end);
+    emit_label(native, short_circuit);
+    emit(native, "movl $%d, %%eax", is_and ? 0 : 1);
+    emit_label(native, end);
+    return TYPE_INTEIRO;
+}
+
+static DataType emit_assignment(Native* native, AstIndex index) {
+    const AstNode* node = node_at(native, index);
+    AstIndex value = node->child[1];
+    Location location = resolve(native, node->child[0]);
+    emit_convert(native, (DataType)location.type, emit_expression(native, value));
+    if (location.type == TYPE_TEXTO) emit_fit(native, location.size);
+    emit_store(native, &location);
+    return (DataType)location.type;
+}
+
+/* keep: o valor da expressão é usado (em rax ou xmm0). */
+static DataType emit_increment(Native* native, AstIndex index, int keep) {
+    const AstNode* node = node_at(native, index);
+    Location location = resolve(native, node->child[0]);
+    int prefix = node->flags & AST_PREFIXO;
+    int up = node->op == TOKEN_OP_INC;
+    char operand[32];
+    location_operand(&location, operand, sizeof(operand));
+
+    if (location.type == TYPE_INTEIRO) {
+        if (keep && !prefix) emit(native, "movq %s, %%rax", operand);
+        emit(native, "%s %s", up ? "incq" : "decq", operand);
+        if (keep && prefix) emit(native, "movq %s, %%rax", operand);
+        return TYPE_INTEIRO;
+    }
+
+    if (native->one_decimal < 0) native->one_decimal = add_decimal(native, 1.0);
+    if (location.type == TYPE_DECIMAL) {
+        emit(native, "movsd %s, %%xmm0", operand);
+        if (keep && !prefix) emit(native, "movapd %%xmm0, %%xmm2");
+        emit(native, "%s .Ldecimal_%d(%%rip), %%xmm0", up ? "addsd" : "subsd", native->one_decimal);
+        emit(native, "movsd %%xmm0, %s", operand);
+        if (keep && !prefix) emit(native, "movapd %%xmm2, %%xmm0");
+        return TYPE_DECIMAL;
+    }
+
+    /* Texto: vale como número e volta a ser texto. */
+    emit(native, "movq %s, %%rax", operand);
+    emit_convert(native, TYPE_DECIMAL, TYPE_TEXTO);
+    emit(native, "%s .Ldecimal_%d(%%rip), %%xmm0", up ? "addsd" : "subsd", native->one_decimal);
+    emit_convert(native, TYPE_TEXTO, TYPE_DECIMAL);
+    emit_fit(native, location.size);
+    emit(native, "movq %%rax, %s", operand);
+    return TYPE_TEXTO;
+}
+
+/* Argumentos empilhados da esquerda para a direita, 8 bytes cada; o
+ * chamador os retira. O retorno vem em rax ou xmm0. */
+static DataType emit_call(Native* native, AstIndex index) {
+    const AstNode* call = node_at(native, index);
+    AstIndex function = native->functions[call->symbol];
+    int argc = 0;
+    for (AstIndex arg = call->child[0]; arg != AST_NULL; arg = node_at(native, arg)->next) {
+        argc++;
+    }
+    int pad = (native->depth + argc) & 1;
+    if (pad) {
+        emit(native, "subq $8, %%rsp");
+        native->depth++;
+    }
+    AstIndex param = node_at(native, function)->child[0];
+    for (AstIndex arg = call->child[0]; arg != AST_NULL; arg = node_at(native, arg)->next) {
+        DataType target = data_type_from_token((TokenType)node_at(native, param)->op);
+        emit_convert(native, target, emit_expression(native, arg));
+        if (target == TYPE_DECIMAL) emit(native, "movq %%xmm0, %%rax");
+        emit(native, "pushq %%rax");
+        native->depth++;
+        param = node_at(native, param)->next;
+    }
+    char label[128];
+    function_label(native, function, label, sizeof(label));
+    emit(native, "call %s", label);
+    if (argc + pad > 0) {
+        emit(native, "addq $%d, %%rsp", 8 * (argc + pad));
+        native->depth -= argc + pad;
+    }
+    return return_type(native, function);
+}
+
+static DataType emit_expression(Native* native, AstIndex index) {
+    const AstNode* node = node_at(native, index);
+    switch ((AstKind)node->kind) {
+        case AST_LITERAL:
+            return emit_literal(native, index);
+        case AST_VARIAVEL: {
+            Location location = resolve(native, index);
+            emit_load(native, &location);
+            return (DataType)location.type;
+        }
+        case AST_ATRIBUICAO:
+            return emit_assignment(native, index);
+        case AST_INCREMENTO:
+            return emit_increment(native, index, 1);
+        case AST_BINARIO:
+            if (node->op == TOKEN_OP_E || node->op == TOKEN_OP_OU) return emit_logic(native, index);
+            if (comparison_index((TokenType)node->op) >= 0) return emit_comparison(native, index);
+            return emit_arithmetic(native, index);
+        case AST_UNARIO: {
+            DataType type = emit_expression(native, node->child[0]);
+            if (type == TYPE_INTEIRO) {
+                emit(native, "negq %%rax");
+                return TYPE_INTEIRO;
+            }
+            emit_convert(native, TYPE_DECIMAL, type);
+            emit(native, "movapd %%xmm0, %%xmm1");
+            emit(native, "xorpd %%xmm0, %%xmm0");
+            emit(native, "subsd %%xmm1, %%xmm0");
+            return TYPE_DECIMAL;
+        }
+        case AST_CHAMADA:
+            return emit_call(native, index);
+        default:
+            emit_default(native, TYPE_INTEIRO);
+            return TYPE_INTEIRO;
+    }
+}
+
+/* Salta para label se a condição tiver o valor when_true. Comparações
+ * entre inteiros (e entre textos) saltam direto pelas flags; && e ||
+ * não materializam o resultado. */
+static void emit_branch(Native* native, AstIndex condition, int when_true, int label) {
+    const AstNode* node = node_at(native, condition);
+    if (node->kind == AST_BINARIO && (node->op == TOKEN_OP_E || node->op == TOKEN_OP_OU)) {
+        AstIndex left = node->child[0];
+        AstIndex right = node->child[1];
+        int is_and = node->op == TOKEN_OP_E;
+        if (is_and != when_true) {
+            /* (a && b) falso: a falso ou b falso; (a || b) verdadeiro:
+             * a verdadeiro ou b verdadeiro. */
+            emit_branch(native, left, when_true, label);
+            emit_branch(native, right, when_true, label);
+        } else {
+            int skip = new_label(native);
+            emit_branch(native, left, !when_true, skip);
+            emit_branch(native, right, when_true, label);
+            emit_label(native, skip);
+        }
+        return;
+    }
+    int comparison = node->kind == AST_BINARIO ? comparison_index((TokenType)node->op) : -1;
+    if (comparison >= 0 &&
+        comparison_type(value_type(native, node->child[0]), value_type(native, node->child[1])) != TYPE_DECIMAL) {
+        emit_compare(native, node);
+        if (!when_true) comparison = negated_comparison[comparison];
+        emit(native, "j%s .L%d", int_conditions[comparison], label);
+        return;
+    }
+    emit_truth(native, emit_expression(native, condition));
+    emit(native, "j%s .L%d", when_true ? "ne" : "e", label);
+}
+
+/* Expressão usada como comando: o valor é descartado. */
+static void emit_effect(Native* native, AstIndex index) {
+    if (node_at(native, index)->kind == AST_INCREMENTO) {
+        emit_increment(native, index, 0);
+    } else {
+        emit_expression(native, index);
+    }
+}
+
+/* --- Comandos --- */
+
+static void emit_statement(Native* native, AstIndex index);
+
+static void emit_statements(Native* native, AstIndex first) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(native, item)->next) {
+        emit_statement(native, item);
+    }
+}
+
+static void emit_declaration(Native* native, AstIndex index, int global) {
+    TokenType token_type = (TokenType)node_at(native, index)->op;
+    DataType type = data_type_from_token(token_type);
+    for (AstIndex declarator = node_at(native, index)->child[0]; declarator != AST_NULL;
+         declarator = node_at(native, declarator)->next) {
+        const AstNode* node = node_at(native, declarator);
+        int size = type == TYPE_TEXTO ? declared_size(native, declarator) : 0;
+        if (node->child[1] != AST_NULL) {
+            emit_convert(native, type, emit_expression(native, node->child[1]));
+            if (type == TYPE_TEXTO) emit_fit(native, size);
+        } else {
+            emit_default(native, type);
+        }
+        node = node_at(native, declarator);
+        native->locations[declarator] = allocate(native, type, size, global);
+        symtab_declare(&native->symbols, node->symbol, SYMBOL_VARIAVEL, token_type, declarator);
+        emit_store(native, &native->locations[declarator]);
+    }
+}
+
+static void emit_if(Native* native, const AstNode* node) {
+    AstIndex then_branch = node->child[1];
+    AstIndex else_branch = node->child[2];
+    int skip_then = new_label(native);
+    emit_branch(native, node->child[0], 0, skip_then);
+    emit_statement(native, then_branch);
+    if (else_branch == AST_NULL) {
+        emit_label(native, skip_then);
+        return;
+    }
+    int skip_else = new_label(native);
+    emit(native, "jmp .L%d", skip_else);
+    emit_label(native, skip_then);
+    emit_statement(native, else_branch);
+    emit_label(native, skip_else);
+}
+
+/* O teste fica depois do corpo, como na máquina virtual. */
+static void emit_for(Native* native, const AstNode* node) {
+    AstIndex parts[4] = { node->child[0], node->child[1], node->child[2], node->child[3] };
+    for (AstIndex init = parts[0]; init != AST_NULL; init = node_at(native, init)->next) {
+        emit_effect(native, init);
+    }
+    int condition = new_label(native);
+    int body = new_label(native);
+    emit(native, "jmp .L%d", condition);
+    emit_label(native, body);
+    emit_statement(native, parts[3]);
+    for (AstIndex update = parts[2]; update != AST_NULL; update = node_at(native, update)->next) {
+        emit_effect(native, update);
+    }
+    emit_label(native, condition);
+    if (parts[1] != AST_NULL) {
+        emit_branch(native, parts[1], 1, body);
+    } else {
+        emit(native, "jmp .L%d", body);
+    }
+}
+
+static void emit_read(Native* native, AstIndex var) {
+    static const char* const readers[] = { "rt_leia_inteiro", "rt_leia_inteiro", "rt_leia_decimal", "rt_leia_texto" };
+    Location location = resolve(native, var);
+    call_runtime(native, readers[location.type]);
+    if (location.type == TYPE_TEXTO) emit_fit(native, location.size);
+    emit_store(native, &location);
+}
+
+static void emit_write(Native* native, AstIndex expr) {
+    DataType type = emit_expression(native, expr);
+    if (type == TYPE_DECIMAL) {
+        call_runtime(native, "rt_escreva_decimal");
+        return;
+    }
+    emit(native, "movq %%rax, %%rdi");
+    call_runtime(native, type == TYPE_TEXTO ? "rt_escreva_texto" : "rt_escreva_inteiro");
+}
+
+static void emit_statement(Native* native, AstIndex index) {
+    const AstNode* node = node_at(native, index);
+    switch ((AstKind)node->kind) {
+        case AST_BLOCO:
+            symtab_enter(&native->symbols);
+            emit_statements(native, node->child[0]);
+            symtab_leave(&native->symbols);
+            break;
+        case AST_DECLARACAO:
+            emit_declaration(native, index, 0);
+            break;
+        case AST_SE:
+            emit_if(native, node);
+            break;
+        case AST_PARA:
+            emit_for(native, node);
+            break;
+        case AST_LEIA:
+            for (AstIndex var = node->child[0]; var != AST_NULL; var = node_at(native, var)->next) {
+                emit_read(native, var);
+            }
+            break;
+        case AST_ESCREVA:
+            for (AstIndex expr = node->child[0]; expr != AST_NULL; expr = node_at(native, expr)->next) {
+                emit_write(native, expr);
+            }
+            call_runtime(native, "rt_escreva_fim");
+            break;
+        case AST_RETORNO:
+            emit_convert(native, native->return_type, emit_expression(native, node->child[0]));
+            emit(native, "jmp .Lfim_%d", native->function_id);
+            break;
+        case AST_EXPRESSAO:
+            emit_effect(native, node->child[0]);
+            break;
+        default:
+            break;
+    }
+}
+
+/* --- Funções e Programa --- */
+
+/* Conta as variáveis locais para montar o quadro antes do corpo. */
+static void count_locals(const Native* native, AstIndex first, int* ints, int* others) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(native, item)->next) {
+        const AstNode* node = node_at(native, item);
+        switch ((AstKind)node->kind) {
+            case AST_DECLARACAO:
+                for (AstIndex d = node->child[0]; d != AST_NULL; d = node_at(native, d)->next) {
+                    if (data_type_from_token((TokenType)node->op) == TYPE_INTEIRO) (*ints)++;
+                    else (*others)++;
+                }
+                break;
+            case AST_BLOCO:
+                count_locals(native, node->child[0], ints, others);
+                break;
+            case AST_SE:
+                count_locals(native, node->child[1], ints, others);
+                count_locals(native, node->child[2], ints, others);
+                break;
+            case AST_PARA:
+                count_locals(native, node->child[3], ints, others);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/* Quadro: rbp salvo, slots das variáveis abaixo de rbp e, abaixo deles,
+ * os registradores preservados em uso. Argumentos ficam acima de rbp. */
+static void emit_prologue(Native* native, int saved, int frame_bytes) {
+    emit(native, "pushq %%rbp");
+    emit(native, "movq %%rsp, %%rbp");
+    if (frame_bytes > 0) emit(native, "subq $%d, %%rsp", frame_bytes);
+    for (int i = 0; i < saved; i++) {
+        emit(native, "pushq %s", int_registers[i]);
+    }
+}
+
+static void emit_epilogue(Native* native, int saved, int frame_bytes) {
+    if (saved > 0) {
+        emit(native, "leaq -%d(%%rbp), %%rsp", frame_bytes + 8 * saved);
+        for (int i = saved - 1; i >= 0; i--) {
+            emit(native, "popq %s", int_registers[i]);
+        }
+    }
+    emit(native, "leave");
+    emit(native, "ret");
+}
+
+static int frame_size(int slots, int saved) {
+    int bytes = 8 * slots;
+    if ((bytes + 8 * saved) % 16 != 0) bytes += 8;
+    return bytes;
+}
+
+static void emit_function(Native* native, AstIndex index, int id) {
+    const AstNode* node = node_at(native, index);
+    AstIndex body = node->child[1];
+    char label[128];
+    function_label(native, index, label, sizeof(label));
+    native->function_id = id;
+    native->return_type = return_type(native, index);
+    native->registers = 0;
+    native->frame = 0;
+    native->depth = 0;
+
+    int argc = 0;
+    int int_params = 0;
+    for (AstIndex param = node->child[0]; param != AST_NULL; param = node_at(native, param)->next) {
+        if (data_type_from_token((TokenType)node_at(native, param)->op) == TYPE_INTEIRO) int_params++;
+        argc++;
+    }
+    int ints = 0;
+    int others = 0;
+    count_locals(native, node_at(native, body)->child[0], &ints, &others);
+    int saved = int_params + ints < NATIVE_INT_REGISTERS ? int_params + ints : NATIVE_INT_REGISTERS;
+    int param_registers = int_params < NATIVE_INT_REGISTERS ? int_params : NATIVE_INT_REGISTERS;
+    int frame_bytes = frame_size(ints + others - (saved - param_registers), saved);
+
+    fprintf(native->out, "\n\t.type %s, @function\n%s:\n", label, label);
+    emit_prologue(native, saved, frame_bytes);
+
+    symtab_enter(&native->symbols);
+    int position = 0;
+    for (AstIndex param = node->child[0]; param != AST_NULL; param = node_at(native, param)->next) {
+        const AstNode* param_node = node_at(native, param);
+        DataType type = data_type_from_token((TokenType)param_node->op);
+        int offset = 16 + 8 * (argc - 1 - position++);
+        Location location = { LOCATION_FRAME, (uint8_t)type, offset, 0 };
+        if (type == TYPE_INTEIRO && native->registers < NATIVE_INT_REGISTERS) {
+            location = allocate(native, type, 0, 0);
+            emit(native, "movq %d(%%rbp), %s", offset, int_registers[location.offset]);
+        }
+        native->locations[param] = location;
+        symtab_declare(&native->symbols, param_node->symbol, SYMBOL_PARAMETRO, param_node->op, param);
+    }
+    emit_statements(native, node_at(native, body)->child[0]);
+    symtab_leave(&native->symbols);
+
+    /* Caminhos que chegam ao fim sem retorno devolvem o valor padrão. */
+    emit_default(native, native->return_type);
+    fprintf(native->out, ".Lfim_%d:\n", id);
+    emit_epilogue(native, saved, frame_bytes);
+    fprintf(native->out, "\t.size %s, .-%s\n", label, label);
+}
+
+void native_emit(const Ast* ast, FILE* out, Arena* arena) {
+    Native native;
+    native.ast = ast;
+    native.out = out;
+    native.arena = arena;
+    native.locations = (Location*)arena_alloc(arena, ast->count * sizeof(Location));
+    native.functions = (AstIndex*)arena_alloc(arena, (ast->interner->count + 1) * sizeof(AstIndex));
+    native.return_types = (uint8_t*)arena_alloc(arena, ast->count);
+    memset(native.return_types, 0, ast->count);
+    native.decimals_capacity = NATIVE_INITIAL_CONSTANTS;
+    native.decimals = (double*)arena_alloc(arena, native.decimals_capacity * sizeof(double));
+    native.decimals_count = 0;
+    native.texts_capacity = NATIVE_INITIAL_CONSTANTS;
+    native.texts = (AstIndex*)arena_alloc(arena, native.texts_capacity * sizeof(AstIndex));
+    native.texts_count = 0;
+    native.one_decimal = -1;
+    native.globals = 0;
+    native.labels = 0;
+    native.registers = 0;
+    native.frame = 0;
+    native.depth = 0;
+    native.function_id = 0;
+    native.return_type = TYPE_INTEIRO;
+    symtab_init(&native.symbols, ast->interner, arena);
+
+    AstIndex first = ast_node(ast, ast->root)->child[0];
+    AstIndex principal = AST_NULL;
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&native, item)->next) {
+        const AstNode* node = node_at(&native, item);
+        if (node->kind == AST_FUNCAO) {
+            native.functions[node->symbol] = item;
+            symtab_declare(&native.symbols, node->symbol, SYMBOL_FUNCAO, TOKEN_EOF, item);
+        } else if (node->kind == AST_PRINCIPAL) {
+            principal = item;
+        }
+    }
+
+    fprintf(out, "\t.text\n");
+
+    /* main: globais na ordem do código, depois principal. As globais
+     * ficam na memória, então main não usa registradores preservados. */
+    fprintf(out, "\n\t.globl main\n\t.type main, @function\nmain:\n");
+    emit_prologue(&native, 0, 0);
+    call_runtime(&native, "rt_iniciar");
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&native, item)->next) {
+        if (node_at(&native, item)->kind == AST_DECLARACAO) {
+            emit_declaration(&native, item, 1);
+        }
+    }
+    char label[128];
+    function_label(&native, principal, label, sizeof(label));
+    emit(&native, "call %s", label);
+    emit(&native, "xorl %%eax, %%eax");
+    emit_epilogue(&native, 0, 0);
+    fprintf(out, "\t.size main, .-main\n");
+
+    int id = 0;
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&native, item)->next) {
+        AstKind kind = (AstKind)node_at(&native, item)->kind;
+        if (kind == AST_FUNCAO || kind == AST_PRINCIPAL) {
+            emit_function(&native, item, id++);
+        }
+    }
+
+    emit_constants(&native);
+    fprintf(out, "\n\t.section .note.GNU-stack,\"\",@progbits\n");
+}
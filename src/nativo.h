@@ -0,0 +1,23 @@
+#ifndef NATIVO_H
+#define NATIVO_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "semantico.h"
+
+/* --- Código Nativo x86-64 --- */
+
+/* Registradores preservados entre chamadas (rbx, r12-r15) que guardam as
+ * primeiras variáveis inteiro de cada função; as demais ficam na pilha. */
+#define NATIVE_INT_REGISTERS 5
+
+/* Gera assembly GNU (sintaxe AT&T, System V x86-64) de uma árvore já
+ * verificada, sem erros semânticos: um símbolo por funcao, um para
+ * principal e um main que inicializa as globais e chama principal.
+ * inteiro usa registradores de uso geral, decimal usa SSE2 e texto é um
+ * ponteiro; escreva, leia, textos e potências chamam o suporte de
+ * execução em runtime/execucao.c, ligado junto com o arquivo gerado.
+ * Usa arena para tabelas temporárias. */
+void native_emit(const Ast* ast, FILE* out, Arena* arena);
+
+#endif
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include "memoria.h"
+#include "entrada.h"
+#include "incremental.h"
+#include "lote.h"
+#include "observador.h"
+
+/* Orçamento da lista de arquivos observados (não é memória de compilação). */
+#define WATCH_LIST_MEMORY_KB 1024
+
+/* Eventos lidos de uma vez do inotify. */
+#define WATCH_EVENT_BUFFER (16 * 1024)
+
+/* Um arquivo observado: o diretório dele é vigiado, e os eventos são
+ * filtrados pelo nome. */
+typedef struct {
+    const char* path;
+    const char* name;
+    int watch;
+    int dirty;
+    MemoryContext memory;
+    IncrementalLexer lexer;
+} WatchedFile;
+
+static volatile sig_atomic_t stopping;
+
+static void on_signal(int signal) {
+    (void)signal;
+    stopping = 1;
+}
+
+/* Uma linha por análise: o resultado e quanto foi refeito. */
+static void report(WatchedFile* file, int full, double seconds) {
+    const IncrementalLexer* inc = &file->lexer;
+    Token last = inc->result_last;
+    long tokens = inc->result_count - (last.type == TOKEN_EOF);
+    if (last.type == TOKEN_ERRO) {
+        printf("%s: ERRO na linha %d: %s\n", file->path, last.line, inc->error_msg);
+    } else {
+        printf("%s: OK, %ld tokens\n", file->path, tokens);
+    }
+    if (full) {
+        printf("    análise completa, %.3f ms, memória máxima %ld bytes\n",
+               seconds * 1000.0, file->memory.max_used);
+    } else {
+        printf("    %ld token(s) refeitos a partir da linha %d, %ld rebalanceados, %.3f ms\n",
+               inc->relexed, inc->restart_line, inc->rebalanced, seconds * 1000.0);
+    }
+    fflush(stdout);
+}
+
+/* Analisa o arquivo de novo (full) ou só a diferença para a versão
+ * anterior. Um arquivo que sumiu (no meio de uma gravação, por exemplo)
+ * mantém a análise anterior até o próximo evento. */
+static void check_file(WatchedFile* file, int full) {
+    MappedFile mapped;
+    if (map_file(&mapped, file->path, &file->memory) != MAP_OK) {
+        printf("Erro ao abrir o arquivo %s\n", file->path);
+        fflush(stdout);
+        return;
+    }
+    double start = monotonic_seconds();
+    int changed = 1;
+    if (full) {
+        incremental_load(&file->lexer, mapped.data, mapped.length);
+    } else {
+        changed = incremental_update(&file->lexer, mapped.data, mapped.length);
+    }
+    double elapsed = monotonic_seconds() - start;
+    unmap_file(&mapped);
+    if (changed) {
+        report(file, full, elapsed);
+    }
+}
+
+int run_watch(const char** paths, int count) {
+    MemoryContext list_memory;
+    Arena list_arena;
+    memory_context_init(&list_memory);
+    list_memory.budget = WATCH_LIST_MEMORY_KB * 1024L;
+    arena_init(&list_arena, &list_memory);
+
+    int notify = inotify_init1(IN_CLOEXEC);
+    if (notify < 0) {
+        printf("Erro ao iniciar o inotify\n");
+        arena_destroy(&list_arena);
+        return 1;
+    }
+
+    printf("Observando %d arquivo(s). Ctrl+C termina.\n", count);
+    WatchedFile* files = (WatchedFile*)arena_alloc(&list_arena, count * sizeof(WatchedFile));
+    for (int i = 0; i < count; i++) {
+        WatchedFile* file = &files[i];
+        file->path = paths[i];
+        const char* slash = strrchr(paths[i], '/');
+        file->name = slash != NULL ? slash + 1 : paths[i];
+
+        /* O mesmo diretório devolve o mesmo descritor de vigia. */
+        long dir_length = slash != NULL ? slash - paths[i] : 0;
+        char* dir = (char*)arena_alloc(&list_arena, dir_length + 2);
+        if (slash == NULL) {
+            strcpy(dir, ".");
+        } else if (dir_length == 0) {
+            strcpy(dir, "/");
+        } else {
+            memcpy(dir, paths[i], dir_length);
+            dir[dir_length] = '\0';
+        }
+        file->watch = inotify_add_watch(notify, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (file->watch < 0) {
+            printf("Erro ao observar o diretório %s\n", dir);
+        }
+
+        memory_context_init(&file->memory);
+        incremental_init(&file->lexer, &file->memory);
+        file->dirty = 0;
+        check_file(file, 1);
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    /* Os eventos de uma leitura são juntados: um arquivo gravado em vários
+     * passos é analisado uma vez. Sem SA_RESTART, o sinal interrompe o
+     * read. */
+    char* events = (char*)arena_alloc(&list_arena, WATCH_EVENT_BUFFER);
+    while (!stopping) {
+        ssize_t length = read(notify, events, WATCH_EVENT_BUFFER);
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (char* p = events; p < events + length;) {
+            struct inotify_event* event = (struct inotify_event*)p;
+            for (int i = 0; i < count; i++) {
+                if (event->wd == files[i].watch && event->len > 0 && strcmp(event->name, files[i].name) == 0) {
+                    files[i].dirty = 1;
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+        for (int i = 0; i < count; i++) {
+            if (files[i].dirty) {
+                files[i].dirty = 0;
+                check_file(&files[i], 0);
+            }
+        }
+    }
+
+    close(notify);
+    for (int i = 0; i < count; i++) {
+        incremental_destroy(&files[i].lexer);
+    }
+    arena_destroy(&list_arena);
+    printf("Observação encerrada.\n");
+    return 0;
+}
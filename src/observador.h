@@ -0,0 +1,14 @@
+#ifndef OBSERVADOR_H
+#define OBSERVADOR_H
+
+/* --- Modo Observador --- */
+
+/* Analisa os arquivos e volta a analisar cada um quando ele é gravado
+ * (inotify sobre os diretórios, então editores que gravam um arquivo novo
+ * e o renomeiam também são vistos). Cada arquivo tem seu IncrementalLexer:
+ * só o trecho alterado é analisado de novo. Imprime uma linha por
+ * análise, até SIGINT ou SIGTERM. Retorna 1 se o inotify não puder ser
+ * usado. */
+int run_watch(const char** paths, int count);
+
+#endif
@@ -0,0 +1,991 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "otimizador.h"
+#include "semantico.h"
+
+#define OPT_CSE_MAX_CANDIDATES 64
+#define OPT_CSE_MAX_PER_STATEMENT 8
+#define OPT_CSE_MAX_ROOTS 32
+
+typedef struct {
+    Ast* ast;
+    Arena* arena;
+    uint32_t names;          /* nomes existentes quando a otimização começou */
+    uint8_t* globals;        /* por SymbolId: 1 se o nome é de uma global */
+    AstIndex* functions;     /* por SymbolId: nó da função */
+    uint32_t* read_marks;    /* por SymbolId: última função em que o nome foi lido */
+    uint32_t mark;
+    int temporaries;         /* variáveis !_tN criadas */
+    int changes;
+} Optimizer;
+
+/* Recebe cada expressão de um comando; effect indica que o valor é
+ * descartado (comando de expressão, inicializações e atualizações do
+ * para). */
+typedef void (*ExpressionPass)(Optimizer* optimizer, AstIndex expression, int effect);
+
+typedef int (*NodeTest)(const Optimizer* optimizer, const AstNode* node, SymbolId name);
+
+/* --- Árvore --- */
+
+static AstNode* node_at(const Optimizer* optimizer, AstIndex index) {
+    return ast_node(optimizer->ast, index);
+}
+
+static int is_global(const Optimizer* optimizer, SymbolId name) {
+    return name < optimizer->names && optimizer->globals[name];
+}
+
+static int is_number(const AstNode* node) {
+    return node->kind == AST_LITERAL && (node->op == TOKEN_LITERAL_INT || node->op == TOKEN_LITERAL_DEC);
+}
+
+/* Copia o conteúdo de source para target, que continua na mesma lista. */
+static void replace_node(Optimizer* optimizer, AstIndex target, AstIndex source) {
+    AstIndex next = node_at(optimizer, target)->next;
+    *node_at(optimizer, target) = *node_at(optimizer, source);
+    node_at(optimizer, target)->next = next;
+}
+
+/* Transforma o nó num bloco com os comandos de first. */
+static void make_block(Optimizer* optimizer, AstIndex index, AstIndex first) {
+    AstNode* node = node_at(optimizer, index);
+    AstIndex next = node->next;
+    int line = node->line;
+    memset(node, 0, sizeof(*node));
+    node->kind = AST_BLOCO;
+    node->line = line;
+    node->child[0] = first;
+    node->next = next;
+}
+
+static void make_variable(Optimizer* optimizer, AstIndex index, SymbolId name, DataType type) {
+    AstNode* node = node_at(optimizer, index);
+    AstIndex next = node->next;
+    int line = node->line;
+    memset(node, 0, sizeof(*node));
+    node->kind = AST_VARIAVEL;
+    node->line = line;
+    node->symbol = name;
+    node->type = (uint8_t)type;
+    node->next = next;
+}
+
+static void set_int(Optimizer* optimizer, AstIndex index, int64_t value) {
+    AstConstant constant;
+    constant.i = value;
+    ast_set_constant(optimizer->ast, index, TOKEN_LITERAL_INT, constant);
+    node_at(optimizer, index)->type = TYPE_INTEIRO;
+    optimizer->changes++;
+}
+
+static void set_decimal(Optimizer* optimizer, AstIndex index, double value) {
+    AstConstant constant;
+    constant.d = value;
+    ast_set_constant(optimizer->ast, index, TOKEN_LITERAL_DEC, constant);
+    node_at(optimizer, index)->type = TYPE_DECIMAL;
+    optimizer->changes++;
+}
+
+/* Retira item da lista que começa em parent->child[slot]. */
+static void unlink_item(Optimizer* optimizer, AstIndex parent, int slot, AstIndex previous, AstIndex item) {
+    AstIndex next = node_at(optimizer, item)->next;
+    if (previous == AST_NULL) node_at(optimizer, parent)->child[slot] = next;
+    else node_at(optimizer, previous)->next = next;
+    optimizer->changes++;
+}
+
+/* Cópia profunda de uma expressão, com as listas de filhos. */
+static AstIndex copy_tree(Optimizer* optimizer, AstIndex index) {
+    AstIndex copy = ast_add(optimizer->ast, AST_LITERAL, 0);
+    *node_at(optimizer, copy) = *node_at(optimizer, index);
+    node_at(optimizer, copy)->next = AST_NULL;
+    for (int i = 0; i < 4; i++) {
+        AstIndex last = AST_NULL;
+        for (AstIndex child = node_at(optimizer, index)->child[i]; child != AST_NULL;
+             child = node_at(optimizer, child)->next) {
+            AstIndex child_copy = copy_tree(optimizer, child);
+            if (last == AST_NULL) node_at(optimizer, copy)->child[i] = child_copy;
+            else node_at(optimizer, last)->next = child_copy;
+            last = child_copy;
+        }
+    }
+    return copy;
+}
+
+static int count_matches(const Optimizer* optimizer, AstIndex index, NodeTest test, SymbolId name) {
+    const AstNode* node = node_at(optimizer, index);
+    int count = test(optimizer, node, name);
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node->child[i]; child != AST_NULL; child = node_at(optimizer, child)->next) {
+            count += count_matches(optimizer, child, test, name);
+        }
+    }
+    return count;
+}
+
+static int test_any(const Optimizer* optimizer, const AstNode* node, SymbolId name) {
+    (void)optimizer; (void)node; (void)name;
+    return 1;
+}
+
+static int test_call(const Optimizer* optimizer, const AstNode* node, SymbolId name) {
+    (void)optimizer; (void)name;
+    return node->kind == AST_CHAMADA;
+}
+
+static int test_call_to(const Optimizer* optimizer, const AstNode* node, SymbolId name) {
+    (void)optimizer;
+    return node->kind == AST_CHAMADA && node->symbol == name;
+}
+
+static int test_write(const Optimizer* optimizer, const AstNode* node, SymbolId name) {
+    (void)optimizer; (void)name;
+    return node->kind == AST_ATRIBUICAO || node->kind == AST_INCREMENTO;
+}
+
+static int test_use(const Optimizer* optimizer, const AstNode* node, SymbolId name) {
+    (void)optimizer;
+    return node->kind == AST_VARIAVEL && node->symbol == name;
+}
+
+static int test_global(const Optimizer* optimizer, const AstNode* node, SymbolId name) {
+    (void)name;
+    return node->kind == AST_VARIAVEL && is_global(optimizer, node->symbol);
+}
+
+/* Sem efeitos e sem erro de execução possível: pode ser avaliada antes,
+ * depois, mais de uma vez ou nenhuma. Divisões ficam de fora (divisão
+ * por zero), assim como chamadas (podem escrever). */
+static int is_pure(const Optimizer* optimizer, AstIndex index) {
+    const AstNode* node = node_at(optimizer, index);
+    switch ((AstKind)node->kind) {
+        case AST_ATRIBUICAO:
+        case AST_INCREMENTO:
+        case AST_CHAMADA:
+            return 0;
+        case AST_BINARIO:
+            return node->op != TOKEN_OP_DIV &&
+                   is_pure(optimizer, node->child[0]) && is_pure(optimizer, node->child[1]);
+        case AST_UNARIO:
+            return is_pure(optimizer, node->child[0]);
+        default:
+            return 1;
+    }
+}
+
+static int same_tree(const Optimizer* optimizer, AstIndex a, AstIndex b) {
+    const AstNode* x = node_at(optimizer, a);
+    const AstNode* y = node_at(optimizer, b);
+    if (x->kind != y->kind || x->op != y->op || x->symbol != y->symbol) return 0;
+    if (x->kind == AST_LITERAL) {
+        if (x->op == TOKEN_LITERAL_INT) {
+            return ast_literal_int(optimizer->ast, x) == ast_literal_int(optimizer->ast, y);
+        }
+        if (x->op == TOKEN_LITERAL_DEC) {
+            double u = ast_literal_decimal(optimizer->ast, x);
+            double v = ast_literal_decimal(optimizer->ast, y);
+            return memcmp(&u, &v, sizeof(u)) == 0;
+        }
+        return x->length == y->length &&
+               memcmp(&optimizer->ast->source[x->offset], &optimizer->ast->source[y->offset], x->length) == 0;
+    }
+    if (x->flags != y->flags) return 0;
+    for (int i = 0; i < 4; i++) {
+        AstIndex p = x->child[i];
+        AstIndex q = y->child[i];
+        while (p != AST_NULL && q != AST_NULL) {
+            if (!same_tree(optimizer, p, q)) return 0;
+            p = node_at(optimizer, p)->next;
+            q = node_at(optimizer, q)->next;
+        }
+        if (p != q) return 0;
+    }
+    return 1;
+}
+
+/* Valor lógico de um literal; retorna 0 se não for literal. */
+static int literal_truth(const Optimizer* optimizer, AstIndex index, int* truth) {
+    const AstNode* node = node_at(optimizer, index);
+    if (node->kind != AST_LITERAL) return 0;
+    switch ((TokenType)node->op) {
+        case TOKEN_LITERAL_INT: *truth = ast_literal_int(optimizer->ast, node) != 0; break;
+        case TOKEN_LITERAL_DEC: *truth = ast_literal_decimal(optimizer->ast, node) != 0.0; break;
+        default: *truth = node->length > 0; break;
+    }
+    return 1;
+}
+
+/* --- Percurso --- */
+
+static void visit_statement(Optimizer* optimizer, AstIndex index, ExpressionPass pass);
+
+static void visit_list(Optimizer* optimizer, AstIndex first, ExpressionPass pass, int effect) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(optimizer, item)->next) {
+        pass(optimizer, item, effect);
+    }
+}
+
+static void visit_statements(Optimizer* optimizer, AstIndex first, ExpressionPass pass) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(optimizer, item)->next) {
+        visit_statement(optimizer, item, pass);
+    }
+}
+
+static void visit_declarators(Optimizer* optimizer, AstIndex declaration, ExpressionPass pass) {
+    for (AstIndex declarator = node_at(optimizer, declaration)->child[0]; declarator != AST_NULL;
+         declarator = node_at(optimizer, declarator)->next) {
+        AstIndex value = node_at(optimizer, declarator)->child[1];
+        if (value != AST_NULL) pass(optimizer, value, 0);
+    }
+}
+
+static void visit_statement(Optimizer* optimizer, AstIndex index, ExpressionPass pass) {
+    const AstNode* node = node_at(optimizer, index);
+    AstIndex child[4] = { node->child[0], node->child[1], node->child[2], node->child[3] };
+    switch ((AstKind)node->kind) {
+        case AST_BLOCO:
+            visit_statements(optimizer, child[0], pass);
+            break;
+        case AST_DECLARACAO:
+            visit_declarators(optimizer, index, pass);
+            break;
+        case AST_SE:
+            pass(optimizer, child[0], 0);
+            visit_statement(optimizer, child[1], pass);
+            if (child[2] != AST_NULL) visit_statement(optimizer, child[2], pass);
+            break;
+        case AST_PARA:
+            visit_list(optimizer, child[0], pass, 1);
+            if (child[1] != AST_NULL) pass(optimizer, child[1], 0);
+            visit_list(optimizer, child[2], pass, 1);
+            visit_statement(optimizer, child[3], pass);
+            break;
+        case AST_ESCREVA:
+            visit_list(optimizer, child[0], pass, 0);
+            break;
+        case AST_RETORNO:
+            pass(optimizer, child[0], 0);
+            break;
+        case AST_EXPRESSAO:
+            pass(optimizer, child[0], 1);
+            break;
+        default:
+            break;
+    }
+}
+
+static AstIndex body_of(const Optimizer* optimizer, AstIndex function) {
+    return node_at(optimizer, function)->child[1];
+}
+
+/* Todas as expressões do programa: inicializações das globais e corpos
+ * das funções. */
+static void visit_program(Optimizer* optimizer, ExpressionPass pass) {
+    AstIndex first = node_at(optimizer, optimizer->ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(optimizer, item)->next) {
+        if (node_at(optimizer, item)->kind == AST_DECLARACAO) {
+            visit_declarators(optimizer, item, pass);
+        } else if (body_of(optimizer, item) != AST_NULL) {
+            visit_statement(optimizer, body_of(optimizer, item), pass);
+        }
+    }
+}
+
+/* --- Expansão de Funções --- */
+
+/* Expressão de uma função "retorno expressão" pequena, sem escritas e
+ * sem chamar a si mesma; AST_NULL se não puder ser expandida. */
+static AstIndex inline_value(const Optimizer* optimizer, AstIndex function) {
+    AstIndex body = body_of(optimizer, function);
+    AstIndex first = body != AST_NULL ? node_at(optimizer, body)->child[0] : AST_NULL;
+    if (first == AST_NULL || node_at(optimizer, first)->kind != AST_RETORNO ||
+        node_at(optimizer, first)->next != AST_NULL) {
+        return AST_NULL;
+    }
+    AstIndex value = node_at(optimizer, first)->child[0];
+    if (count_matches(optimizer, value, test_any, SYMBOL_NULL) > OPT_INLINE_MAX_NODES ||
+        count_matches(optimizer, value, test_write, SYMBOL_NULL) > 0 ||
+        count_matches(optimizer, value, test_call_to, node_at(optimizer, function)->symbol) > 0) {
+        return AST_NULL;
+    }
+    return value;
+}
+
+static void set_lines(Optimizer* optimizer, AstIndex index, int line) {
+    node_at(optimizer, index)->line = line;
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node_at(optimizer, index)->child[i]; child != AST_NULL;
+             child = node_at(optimizer, child)->next) {
+            set_lines(optimizer, child, line);
+        }
+    }
+}
+
+/* Troca cada parâmetro de copy por uma cópia do argumento. Não desce nas
+ * cópias já inseridas: um argumento pode usar um nome igual ao de um
+ * parâmetro. */
+static void substitute(Optimizer* optimizer, AstIndex index, AstIndex function, AstIndex call) {
+    const AstNode* node = node_at(optimizer, index);
+    if (node->kind == AST_VARIAVEL) {
+        AstIndex arg = node_at(optimizer, call)->child[0];
+        for (AstIndex param = node_at(optimizer, function)->child[0]; param != AST_NULL;
+             param = node_at(optimizer, param)->next) {
+            if (node_at(optimizer, param)->symbol == node_at(optimizer, index)->symbol) {
+                DataType expected = data_type_from_token((TokenType)node_at(optimizer, param)->op);
+                /* Com a linha do parâmetro: erros de execução dentro da
+                 * expressão continuam apontando para a função. */
+                AstIndex copy = copy_tree(optimizer, arg);
+                set_lines(optimizer, copy, node_at(optimizer, index)->line);
+                replace_node(optimizer, index, copy);
+                if (expected == TYPE_DECIMAL && node_at(optimizer, index)->type == TYPE_INTEIRO) {
+                    /* Só literais chegam aqui (ver try_inline). */
+                    double value = (double)ast_literal_int(optimizer->ast, node_at(optimizer, index));
+                    set_decimal(optimizer, index, value);
+                    optimizer->changes--;
+                }
+                return;
+            }
+            arg = node_at(optimizer, arg)->next;
+        }
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node_at(optimizer, index)->child[i]; child != AST_NULL;
+             child = node_at(optimizer, child)->next) {
+            substitute(optimizer, child, function, call);
+        }
+    }
+}
+
+/* Os argumentos precisam ser puros (a ordem e o número de avaliações
+ * mudam) e do tipo do parâmetro, ou literais inteiros para decimal;
+ * um parâmetro usado mais de uma vez só recebe literal ou variável.
+ * Se a expressão chama funções, elas podem mudar globais passadas como
+ * argumento. */
+static int can_inline(const Optimizer* optimizer, AstIndex call, AstIndex function, AstIndex value) {
+    int has_calls = count_matches(optimizer, value, test_call, SYMBOL_NULL) > 0;
+    AstIndex param = node_at(optimizer, function)->child[0];
+    for (AstIndex arg = node_at(optimizer, call)->child[0]; arg != AST_NULL; arg = node_at(optimizer, arg)->next) {
+        const AstNode* arg_node = node_at(optimizer, arg);
+        const AstNode* param_node = node_at(optimizer, param);
+        DataType expected = data_type_from_token((TokenType)param_node->op);
+        int uses = count_matches(optimizer, value, test_use, param_node->symbol);
+        if (!is_pure(optimizer, arg)) return 0;
+        if (arg_node->type != expected &&
+            !(expected == TYPE_DECIMAL && arg_node->kind == AST_LITERAL && arg_node->op == TOKEN_LITERAL_INT)) {
+            return 0;
+        }
+        if (uses > 1 && arg_node->kind != AST_LITERAL && arg_node->kind != AST_VARIAVEL) return 0;
+        if (has_calls && count_matches(optimizer, arg, test_global, SYMBOL_NULL) > 0) return 0;
+        param = param_node->next;
+    }
+    return 1;
+}
+
+static void inline_expression(Optimizer* optimizer, AstIndex index, int effect) {
+    (void)effect;
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node_at(optimizer, index)->child[i]; child != AST_NULL;
+             child = node_at(optimizer, child)->next) {
+            inline_expression(optimizer, child, 0);
+        }
+    }
+    const AstNode* node = node_at(optimizer, index);
+    if (node->kind != AST_CHAMADA || node->symbol >= optimizer->names) return;
+    AstIndex function = optimizer->functions[node->symbol];
+    AstIndex value = function != AST_NULL ? inline_value(optimizer, function) : AST_NULL;
+    if (value == AST_NULL || !can_inline(optimizer, index, function, value)) return;
+    AstIndex copy = copy_tree(optimizer, value);
+    substitute(optimizer, copy, function, index);
+    replace_node(optimizer, index, copy);
+    optimizer->changes++;
+}
+
+static void mark_calls(Optimizer* optimizer, AstIndex index, uint8_t* called) {
+    const AstNode* node = node_at(optimizer, index);
+    if (node->kind == AST_CHAMADA && node->symbol < optimizer->names) called[node->symbol] = 1;
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node->child[i]; child != AST_NULL; child = node_at(optimizer, child)->next) {
+            mark_calls(optimizer, child, called);
+        }
+    }
+}
+
+/* Depois da expansão, funções sem nenhuma chamada saem do programa. */
+static void inline_calls(Optimizer* optimizer) {
+    visit_program(optimizer, inline_expression);
+
+    uint8_t* called = (uint8_t*)arena_alloc(optimizer->arena, optimizer->names);
+    memset(called, 0, optimizer->names);
+    AstIndex root = optimizer->ast->root;
+    mark_calls(optimizer, root, called);
+    AstIndex previous = AST_NULL;
+    for (AstIndex item = node_at(optimizer, root)->child[0]; item != AST_NULL;
+         item = node_at(optimizer, item)->next) {
+        const AstNode* node = node_at(optimizer, item);
+        if (node->kind == AST_FUNCAO && !called[node->symbol]) {
+            unlink_item(optimizer, root, 0, previous, item);
+            optimizer->functions[node->symbol] = AST_NULL;
+            continue;
+        }
+        previous = item;
+    }
+}
+
+/* --- Dobra de Constantes --- */
+
+/* Mesma aritmética da máquina virtual: inteiros dão a volta, divisão por
+ * zero não é dobrada (continua sendo um erro de execução). */
+static int64_t wrap_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+static int64_t wrap_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+static int64_t wrap_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+
+static int64_t int_pow(int64_t base, int64_t exponent) {
+    if (exponent < 0) {
+        if (base == 1) return 1;
+        if (base == -1) return (exponent & 1) ? -1 : 1;
+        return 0;
+    }
+    int64_t result = 1;
+    while (exponent > 0) {
+        if (exponent & 1) result = wrap_mul(result, base);
+        base = wrap_mul(base, base);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+static int compare(TokenType op, int order) {
+    switch (op) {
+        case TOKEN_OP_IGUAL: return order == 0;
+        case TOKEN_OP_DIF: return order != 0;
+        case TOKEN_OP_MENOR: return order < 0;
+        case TOKEN_OP_MENOR_IGUAL: return order <= 0;
+        case TOKEN_OP_MAIOR: return order > 0;
+        default: return order >= 0;
+    }
+}
+
+/* Com os operadores de C: comparações com NaN dão falso, como na
+ * máquina. */
+static int compare_decimal(TokenType op, double x, double y) {
+    switch (op) {
+        case TOKEN_OP_IGUAL: return x == y;
+        case TOKEN_OP_DIF: return x != y;
+        case TOKEN_OP_MENOR: return x < y;
+        case TOKEN_OP_MENOR_IGUAL: return x <= y;
+        case TOKEN_OP_MAIOR: return x > y;
+        default: return x >= y;
+    }
+}
+
+static int is_comparison(TokenType op) {
+    return op == TOKEN_OP_IGUAL || op == TOKEN_OP_DIF || op == TOKEN_OP_MENOR ||
+           op == TOKEN_OP_MENOR_IGUAL || op == TOKEN_OP_MAIOR || op == TOKEN_OP_MAIOR_IGUAL;
+}
+
+static void fold_logic(Optimizer* optimizer, AstIndex index) {
+    const AstNode* node = node_at(optimizer, index);
+    int is_and = node->op == TOKEN_OP_E;
+    AstIndex right = node->child[1];
+    int left_truth;
+    int right_truth;
+    if (!literal_truth(optimizer, node->child[0], &left_truth)) return;
+    if (left_truth != is_and) {
+        /* 0 && x é 0 e 1 || x é 1, sem avaliar x. */
+        set_int(optimizer, index, left_truth);
+    } else if (literal_truth(optimizer, right, &right_truth)) {
+        set_int(optimizer, index, right_truth);
+    }
+}
+
+static void fold_binary(Optimizer* optimizer, AstIndex index) {
+    const AstNode* node = node_at(optimizer, index);
+    TokenType op = (TokenType)node->op;
+    if (op == TOKEN_OP_E || op == TOKEN_OP_OU) {
+        fold_logic(optimizer, index);
+        return;
+    }
+    const AstNode* left = node_at(optimizer, node->child[0]);
+    const AstNode* right = node_at(optimizer, node->child[1]);
+    if (!is_number(left) || !is_number(right)) return;
+
+    if (left->op == TOKEN_LITERAL_INT && right->op == TOKEN_LITERAL_INT) {
+        int64_t x = ast_literal_int(optimizer->ast, left);
+        int64_t y = ast_literal_int(optimizer->ast, right);
+        if (is_comparison(op)) {
+            set_int(optimizer, index, compare(op, (x > y) - (x < y)));
+            return;
+        }
+        switch (op) {
+            case TOKEN_OP_SOMA: set_int(optimizer, index, wrap_add(x, y)); break;
+            case TOKEN_OP_SUB: set_int(optimizer, index, wrap_sub(x, y)); break;
+            case TOKEN_OP_MULT: set_int(optimizer, index, wrap_mul(x, y)); break;
+            case TOKEN_OP_DIV:
+                if (y != 0) set_int(optimizer, index, y == -1 ? wrap_sub(0, x) : x / y);
+                break;
+            default: set_int(optimizer, index, int_pow(x, y)); break;
+        }
+        return;
+    }
+
+    double x = left->op == TOKEN_LITERAL_INT ? (double)ast_literal_int(optimizer->ast, left)
+                                             : ast_literal_decimal(optimizer->ast, left);
+    double y = right->op == TOKEN_LITERAL_INT ? (double)ast_literal_int(optimizer->ast, right)
+                                              : ast_literal_decimal(optimizer->ast, right);
+    if (is_comparison(op)) {
+        set_int(optimizer, index, compare_decimal(op, x, y));
+        return;
+    }
+    switch (op) {
+        case TOKEN_OP_SOMA: set_decimal(optimizer, index, x + y); break;
+        case TOKEN_OP_SUB: set_decimal(optimizer, index, x - y); break;
+        case TOKEN_OP_MULT: set_decimal(optimizer, index, x * y); break;
+        case TOKEN_OP_DIV:
+            if (y != 0.0) set_decimal(optimizer, index, x / y);
+            break;
+        default: set_decimal(optimizer, index, pow(x, y)); break;
+    }
+}
+
+static void fold_expression(Optimizer* optimizer, AstIndex index, int effect) {
+    (void)effect;
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node_at(optimizer, index)->child[i]; child != AST_NULL;
+             child = node_at(optimizer, child)->next) {
+            fold_expression(optimizer, child, 0);
+        }
+    }
+    const AstNode* node = node_at(optimizer, index);
+    if (node->kind == AST_BINARIO) {
+        fold_binary(optimizer, index);
+    } else if (node->kind == AST_UNARIO && is_number(node_at(optimizer, node->child[0]))) {
+        const AstNode* operand = node_at(optimizer, node->child[0]);
+        if (operand->op == TOKEN_LITERAL_INT) {
+            set_int(optimizer, index, wrap_sub(0, ast_literal_int(optimizer->ast, operand)));
+        } else {
+            set_decimal(optimizer, index, -ast_literal_decimal(optimizer->ast, operand));
+        }
+    }
+}
+
+static void fold_constants(Optimizer* optimizer) {
+    visit_program(optimizer, fold_expression);
+}
+
+/* --- Ramos Inalcançáveis --- */
+
+static void prune_statement(Optimizer* optimizer, AstIndex index);
+
+/* Também corta os comandos depois de um retorno e retira blocos vazios. */
+static void prune_list(Optimizer* optimizer, AstIndex parent, int slot) {
+    AstIndex previous = AST_NULL;
+    AstIndex item = node_at(optimizer, parent)->child[slot];
+    while (item != AST_NULL) {
+        prune_statement(optimizer, item);
+        AstNode* node = node_at(optimizer, item);
+        if (node->kind == AST_RETORNO && node->next != AST_NULL) {
+            node->next = AST_NULL;
+            optimizer->changes++;
+        }
+        if (node->kind == AST_BLOCO && node->child[0] == AST_NULL) {
+            unlink_item(optimizer, parent, slot, previous, item);
+        } else {
+            previous = item;
+        }
+        item = node_at(optimizer, item)->next;
+    }
+}
+
+/* "se" com condição constante vira o ramo escolhido (num bloco, para não
+ * mudar o escopo); "para" com condição falsa vira as inicializações. */
+static void prune_statement(Optimizer* optimizer, AstIndex index) {
+    const AstNode* node = node_at(optimizer, index);
+    int truth;
+    switch ((AstKind)node->kind) {
+        case AST_BLOCO:
+            prune_list(optimizer, index, 0);
+            break;
+        case AST_SE: {
+            AstIndex then_branch = node->child[1];
+            AstIndex else_branch = node->child[2];
+            prune_statement(optimizer, then_branch);
+            if (else_branch != AST_NULL) prune_statement(optimizer, else_branch);
+            if (!literal_truth(optimizer, node_at(optimizer, index)->child[0], &truth)) break;
+            AstIndex chosen = truth ? then_branch : else_branch;
+            if (chosen != AST_NULL && node_at(optimizer, chosen)->kind == AST_BLOCO) {
+                replace_node(optimizer, index, chosen);
+            } else {
+                make_block(optimizer, index, chosen);
+            }
+            optimizer->changes++;
+            break;
+        }
+        case AST_PARA: {
+            prune_statement(optimizer, node->child[3]);
+            node = node_at(optimizer, index);
+            if (node->child[1] == AST_NULL || !literal_truth(optimizer, node->child[1], &truth) || truth) break;
+            AstIndex first = AST_NULL;
+            AstIndex last = AST_NULL;
+            AstIndex init = node->child[0];
+            while (init != AST_NULL) {
+                AstIndex next = node_at(optimizer, init)->next;
+                node_at(optimizer, init)->next = AST_NULL;
+                AstIndex statement = ast_add(optimizer->ast, AST_EXPRESSAO, node_at(optimizer, init)->line);
+                node_at(optimizer, statement)->child[0] = init;
+                if (last == AST_NULL) first = statement;
+                else node_at(optimizer, last)->next = statement;
+                last = statement;
+                init = next;
+            }
+            make_block(optimizer, index, first);
+            optimizer->changes++;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void prune_branches(Optimizer* optimizer) {
+    AstIndex first = node_at(optimizer, optimizer->ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(optimizer, item)->next) {
+        if (node_at(optimizer, item)->kind != AST_DECLARACAO && body_of(optimizer, item) != AST_NULL) {
+            prune_list(optimizer, body_of(optimizer, item), 0);
+        }
+    }
+}
+
+/* --- Subexpressões Comuns --- */
+
+/* Expressões avaliadas por um comando antes de qualquer escrita: o valor
+ * de uma atribuição, o que escreva imprime, o retorno e a condição do
+ * se. */
+static int statement_roots(const Optimizer* optimizer, AstIndex index, AstIndex* roots) {
+    const AstNode* node = node_at(optimizer, index);
+    int count = 0;
+    switch ((AstKind)node->kind) {
+        case AST_EXPRESSAO: {
+            const AstNode* expression = node_at(optimizer, node->child[0]);
+            roots[count++] = expression->kind == AST_ATRIBUICAO ? expression->child[1] : node->child[0];
+            break;
+        }
+        case AST_ESCREVA:
+            for (AstIndex expr = node->child[0]; expr != AST_NULL && count < OPT_CSE_MAX_ROOTS;
+                 expr = node_at(optimizer, expr)->next) {
+                roots[count++] = expr;
+            }
+            break;
+        case AST_RETORNO:
+        case AST_SE:
+            roots[count++] = node->child[0];
+            break;
+        default:
+            break;
+    }
+    return count;
+}
+
+static void collect_candidates(const Optimizer* optimizer, AstIndex index, int allow_globals,
+                               AstIndex* candidates, int* count) {
+    const AstNode* node = node_at(optimizer, index);
+    if (*count >= OPT_CSE_MAX_CANDIDATES) return;
+    if ((node->kind == AST_BINARIO || node->kind == AST_UNARIO) &&
+        (node->type == TYPE_INTEIRO || node->type == TYPE_DECIMAL) &&
+        is_pure(optimizer, index) &&
+        (allow_globals || count_matches(optimizer, index, test_global, SYMBOL_NULL) == 0)) {
+        candidates[(*count)++] = index;
+    }
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node->child[i]; child != AST_NULL; child = node_at(optimizer, child)->next) {
+            collect_candidates(optimizer, child, allow_globals, candidates, count);
+        }
+    }
+}
+
+static void replace_matches(Optimizer* optimizer, AstIndex index, AstIndex model, SymbolId name, DataType type) {
+    if (same_tree(optimizer, index, model)) {
+        make_variable(optimizer, index, name, type);
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node_at(optimizer, index)->child[i]; child != AST_NULL;
+             child = node_at(optimizer, child)->next) {
+            replace_matches(optimizer, child, model, name, type);
+        }
+    }
+}
+
+/* Uma subexpressão repetida no comando, a primeira em pré-ordem (a maior
+ * entre as que contêm outras); AST_NULL se não houver. Os nomes lidos
+ * não mudam durante o comando: não há escritas nas raízes e, se houver
+ * chamadas, só entram expressões sem globais. */
+static AstIndex find_common(const Optimizer* optimizer, const AstIndex* roots, int root_count) {
+    int has_calls = 0;
+    for (int i = 0; i < root_count; i++) {
+        if (count_matches(optimizer, roots[i], test_write, SYMBOL_NULL) > 0) return AST_NULL;
+        has_calls |= count_matches(optimizer, roots[i], test_call, SYMBOL_NULL) > 0;
+    }
+    AstIndex candidates[OPT_CSE_MAX_CANDIDATES];
+    int count = 0;
+    for (int i = 0; i < root_count; i++) {
+        collect_candidates(optimizer, roots[i], !has_calls, candidates, &count);
+    }
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            if (same_tree(optimizer, candidates[i], candidates[j])) return candidates[i];
+        }
+    }
+    return AST_NULL;
+}
+
+/* "comando" vira "{ tipo !_tN = expressão; comando }", com as
+ * ocorrências trocadas por !_tN. Retorna o índice do comando movido. */
+static AstIndex hoist(Optimizer* optimizer, AstIndex statement, AstIndex expression,
+                      const AstIndex* roots, int root_count) {
+    DataType type = (DataType)node_at(optimizer, expression)->type;
+    int line = node_at(optimizer, statement)->line;
+    char name[32];
+    int length = snprintf(name, sizeof(name), "!_t%d", optimizer->temporaries++);
+    SymbolId id = interner_intern(optimizer->ast->interner, name, length);
+
+    AstIndex value = copy_tree(optimizer, expression);
+    AstIndex declaration = ast_add(optimizer->ast, AST_DECLARACAO, line);
+    AstIndex declarator = ast_add(optimizer->ast, AST_DECLARADOR, line);
+    node_at(optimizer, declaration)->op = (uint8_t)(type == TYPE_DECIMAL ? TOKEN_DECIMAL : TOKEN_INTEIRO);
+    node_at(optimizer, declaration)->child[0] = declarator;
+    node_at(optimizer, declarator)->symbol = id;
+    node_at(optimizer, declarator)->type = (uint8_t)type;
+    node_at(optimizer, declarator)->child[1] = value;
+
+    for (int i = 0; i < root_count; i++) {
+        replace_matches(optimizer, roots[i], value, id, type);
+    }
+
+    AstIndex moved = ast_add(optimizer->ast, AST_BLOCO, line);
+    replace_node(optimizer, moved, statement);
+    node_at(optimizer, declaration)->next = moved;
+    make_block(optimizer, statement, declaration);
+    optimizer->changes++;
+    return moved;
+}
+
+static void eliminate_in_statement(Optimizer* optimizer, AstIndex index) {
+    AstNode* node = node_at(optimizer, index);
+    AstIndex child[4] = { node->child[0], node->child[1], node->child[2], node->child[3] };
+    switch ((AstKind)node->kind) {
+        case AST_BLOCO:
+            for (AstIndex item = child[0]; item != AST_NULL; item = node_at(optimizer, item)->next) {
+                eliminate_in_statement(optimizer, item);
+            }
+            return;
+        case AST_SE:
+            eliminate_in_statement(optimizer, child[1]);
+            if (child[2] != AST_NULL) eliminate_in_statement(optimizer, child[2]);
+            break;
+        case AST_PARA:
+            eliminate_in_statement(optimizer, child[3]);
+            return;
+        default:
+            break;
+    }
+
+    AstIndex roots[OPT_CSE_MAX_ROOTS];
+    for (int round = 0; round < OPT_CSE_MAX_PER_STATEMENT; round++) {
+        int root_count = statement_roots(optimizer, index, roots);
+        AstIndex common = root_count > 0 ? find_common(optimizer, roots, root_count) : AST_NULL;
+        if (common == AST_NULL) return;
+        index = hoist(optimizer, index, common, roots, root_count);
+    }
+}
+
+static void eliminate_common(Optimizer* optimizer) {
+    AstIndex first = node_at(optimizer, optimizer->ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(optimizer, item)->next) {
+        if (node_at(optimizer, item)->kind != AST_DECLARACAO && body_of(optimizer, item) != AST_NULL) {
+            eliminate_in_statement(optimizer, body_of(optimizer, item));
+        }
+    }
+}
+
+/* --- Escritas Mortas --- */
+
+static void mark_reads(Optimizer* optimizer, AstIndex index, int effect) {
+    const AstNode* node = node_at(optimizer, index);
+    switch ((AstKind)node->kind) {
+        case AST_VARIAVEL:
+            optimizer->read_marks[node->symbol] = optimizer->mark;
+            return;
+        case AST_ATRIBUICAO:
+            mark_reads(optimizer, node->child[1], 0);
+            return;
+        case AST_INCREMENTO:
+            /* "!x++;" sozinho só escreve. */
+            if (!effect) optimizer->read_marks[node_at(optimizer, node->child[0])->symbol] = optimizer->mark;
+            return;
+        default:
+            break;
+    }
+    for (int i = 0; i < 4; i++) {
+        for (AstIndex child = node->child[i]; child != AST_NULL; child = node_at(optimizer, child)->next) {
+            mark_reads(optimizer, child, 0);
+        }
+    }
+}
+
+/* Local (ou parâmetro) nunca lido na função atual. Nomes repetidos em
+ * escopos diferentes contam juntos, o que só deixa de retirar escritas. */
+static int is_dead(const Optimizer* optimizer, SymbolId name) {
+    return !is_global(optimizer, name) && optimizer->read_marks[name] != optimizer->mark;
+}
+
+/* Atribuição do comando seguinte à mesma variável, sem ler o valor
+ * anterior. */
+static int overwritten_by(const Optimizer* optimizer, AstIndex assignment, AstIndex next_statement) {
+    if (next_statement == AST_NULL || node_at(optimizer, next_statement)->kind != AST_EXPRESSAO) return 0;
+    const AstNode* next = node_at(optimizer, node_at(optimizer, next_statement)->child[0]);
+    SymbolId name = node_at(optimizer, node_at(optimizer, assignment)->child[0])->symbol;
+    if (next->kind != AST_ATRIBUICAO || node_at(optimizer, next->child[0])->symbol != name) return 0;
+    if (count_matches(optimizer, next->child[1], test_use, name) > 0) return 0;
+    return !is_global(optimizer, name) || count_matches(optimizer, next->child[1], test_call, SYMBOL_NULL) == 0;
+}
+
+static void remove_dead(Optimizer* optimizer, AstIndex index);
+
+static void remove_dead_in_list(Optimizer* optimizer, AstIndex parent, int slot) {
+    AstIndex previous = AST_NULL;
+    AstIndex item = node_at(optimizer, parent)->child[slot];
+    while (item != AST_NULL) {
+        remove_dead(optimizer, item);
+        AstNode* node = node_at(optimizer, item);
+        AstIndex next = node->next;
+        if (node->kind == AST_EXPRESSAO) {
+            AstIndex expression = node->child[0];
+            const AstNode* effect = node_at(optimizer, expression);
+            int removable = 0;
+            if (effect->kind == AST_ATRIBUICAO) {
+                SymbolId name = node_at(optimizer, effect->child[0])->symbol;
+                if (is_pure(optimizer, effect->child[1]) &&
+                    (is_dead(optimizer, name) || overwritten_by(optimizer, expression, next))) {
+                    removable = 1;
+                } else if (is_dead(optimizer, name)) {
+                    /* O valor ainda tem efeitos: fica só ele. */
+                    node->child[0] = effect->child[1];
+                    optimizer->changes++;
+                }
+            } else if (effect->kind == AST_INCREMENTO) {
+                removable = is_dead(optimizer, node_at(optimizer, effect->child[0])->symbol);
+            }
+            if (removable) {
+                unlink_item(optimizer, parent, slot, previous, item);
+                item = next;
+                continue;
+            }
+        } else if (node->kind == AST_DECLARACAO) {
+            for (AstIndex declarator = node->child[0]; declarator != AST_NULL;
+                 declarator = node_at(optimizer, declarator)->next) {
+                AstNode* d = node_at(optimizer, declarator);
+                if (d->child[1] != AST_NULL && is_dead(optimizer, d->symbol) && is_pure(optimizer, d->child[1])) {
+                    d->child[1] = AST_NULL;
+                    optimizer->changes++;
+                }
+            }
+        }
+        previous = item;
+        item = next;
+    }
+}
+
+static void remove_dead(Optimizer* optimizer, AstIndex index) {
+    const AstNode* node = node_at(optimizer, index);
+    switch ((AstKind)node->kind) {
+        case AST_BLOCO:
+            remove_dead_in_list(optimizer, index, 0);
+            break;
+        case AST_SE:
+            remove_dead(optimizer, node->child[1]);
+            if (node->child[2] != AST_NULL) remove_dead(optimizer, node->child[2]);
+            break;
+        case AST_PARA:
+            remove_dead(optimizer, node->child[3]);
+            break;
+        default:
+            break;
+    }
+}
+
+static void eliminate_dead_stores(Optimizer* optimizer) {
+    uint32_t names = optimizer->ast->interner->count;
+    optimizer->read_marks = (uint32_t*)arena_alloc(optimizer->arena, names * sizeof(uint32_t));
+    memset(optimizer->read_marks, 0, names * sizeof(uint32_t));
+    AstIndex first = node_at(optimizer, optimizer->ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(optimizer, item)->next) {
+        AstIndex body = node_at(optimizer, item)->kind != AST_DECLARACAO ? body_of(optimizer, item) : AST_NULL;
+        if (body == AST_NULL) continue;
+        optimizer->mark++;
+        visit_statement(optimizer, body, mark_reads);
+        remove_dead(optimizer, body);
+    }
+}
+
+/* --- Passos --- */
+
+typedef struct {
+    const char* name;
+    OptLevel level;
+    void (*run)(Optimizer* optimizer);
+} OptPass;
+
+/* A expansão vem antes da dobra, que vem antes dos ramos: argumentos
+ * constantes viram condições constantes. */
+static const OptPass passes[] = {
+    { "expansão de funções", OPT_O2, inline_calls },
+    { "dobra de constantes", OPT_O1, fold_constants },
+    { "ramos inalcançáveis", OPT_O1, prune_branches },
+    { "subexpressões comuns", OPT_O2, eliminate_common },
+    { "escritas mortas", OPT_O1, eliminate_dead_stores },
+};
+
+int optimize_program(Ast* ast, OptLevel level, FILE* dump, Arena* arena) {
+    Optimizer optimizer;
+    optimizer.ast = ast;
+    optimizer.arena = arena;
+    optimizer.names = ast->interner->count;
+    optimizer.globals = (uint8_t*)arena_alloc(arena, optimizer.names);
+    memset(optimizer.globals, 0, optimizer.names);
+    optimizer.functions = (AstIndex*)arena_alloc(arena, optimizer.names * sizeof(AstIndex));
+    memset(optimizer.functions, 0, optimizer.names * sizeof(AstIndex));
+    optimizer.read_marks = NULL;
+    optimizer.mark = 0;
+    optimizer.temporaries = 0;
+    optimizer.changes = 0;
+
+    AstIndex first = ast_node(ast, ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = ast_node(ast, item)->next) {
+        const AstNode* node = ast_node(ast, item);
+        if (node->kind == AST_FUNCAO) {
+            optimizer.functions[node->symbol] = item;
+        } else if (node->kind == AST_DECLARACAO) {
+            for (AstIndex d = node->child[0]; d != AST_NULL; d = ast_node(ast, d)->next) {
+                optimizer.globals[ast_node(ast, d)->symbol] = 1;
+            }
+        }
+    }
+
+    if (dump != NULL) {
+        fprintf(dump, "--- Antes da otimização (-O%d) ---\n", (int)level);
+        ast_dump(ast, dump);
+    }
+    for (size_t i = 0; i < sizeof(passes) / sizeof(passes[0]); i++) {
+        if (level < passes[i].level) continue;
+        int before = optimizer.changes;
+        passes[i].run(&optimizer);
+        if (dump != NULL) {
+            fprintf(dump, "--- Depois de %s: %d mudança(s) ---\n", passes[i].name, optimizer.changes - before);
+            ast_dump(ast, dump);
+        }
+    }
+    return optimizer.changes;
+}
@@ -0,0 +1,31 @@
+#ifndef OTIMIZADOR_H
+#define OTIMIZADOR_H
+
+#include <stdio.h>
+#include "ast.h"
+
+/* --- Otimização --- */
+
+/* -O0 não muda nada; -O1 dobra constantes, retira ramos inalcançáveis e
+ * escritas mortas; -O2 também expande funções pequenas nas chamadas e
+ * elimina subexpressões comuns. */
+typedef enum {
+    OPT_O0,
+    OPT_O1,
+    OPT_O2
+} OptLevel;
+
+/* Funções cujo corpo é só "retorno expressão" são expandidas nas
+ * chamadas quando a expressão tem até este número de nós. */
+#ifndef OPT_INLINE_MAX_NODES
+#define OPT_INLINE_MAX_NODES 32
+#endif
+
+/* Otimiza a árvore já verificada, sem erros semânticos, reescrevendo os
+ * nós no lugar: os dois geradores de código (bytecode e nativo) usam o
+ * resultado sem mudanças. Com dump != NULL, imprime a árvore antes dos
+ * passos e depois de cada um. Usa arena para tabelas temporárias; nós
+ * novos vão para a arena da árvore. Retorna o número de mudanças. */
+int optimize_program(Ast* ast, OptLevel level, FILE* dump, Arena* arena);
+
+#endif
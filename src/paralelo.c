@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "paralelo.h"
+
+typedef struct {
+    TaskFn fn;
+    void* arg;
+} Task;
+
+/* Fila de duas pontas de um trabalhador: o dono retira do fim, os outros
+ * trabalhadores roubam do início. */
+typedef struct {
+    Task* tasks;
+    int head;
+    int count;
+    int capacity;
+    pthread_mutex_t lock;
+} WorkQueue;
+
+struct ThreadPool {
+    int size;
+    pthread_t* threads;
+    WorkQueue* queues;
+    pthread_mutex_t lock;
+    pthread_cond_t work_available;
+    pthread_cond_t all_done;
+    atomic_int queued;
+    atomic_int pending;
+    atomic_uint next_queue;
+    int shutdown;
+};
+
+typedef struct {
+    ThreadPool* pool;
+    int index;
+} WorkerStart;
+
+static _Thread_local int worker_index = -1;
+static _Thread_local ThreadPool* worker_pool = NULL;
+
+int cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+int pool_worker_index(void) {
+    return worker_index;
+}
+
+int pool_size(const ThreadPool* pool) {
+    return pool->size;
+}
+
+/* A infraestrutura do pool vive fora do orçamento de uma compilação, por
+ * isso usa malloc diretamente. */
+static void* pool_alloc(void* ptr, size_t size) {
+    void* result = realloc(ptr, size);
+    if (result == NULL) {
+        printf("ERRO: Falha ao alocar memória.\n");
+        exit(1);
+    }
+    return result;
+}
+
+static void queue_push(WorkQueue* queue, Task task) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == queue->capacity) {
+        int capacity = queue->capacity ? queue->capacity * 2 : 64;
+        Task* tasks = (Task*)pool_alloc(NULL, capacity * sizeof(Task));
+        for (int i = 0; i < queue->count; i++) {
+            tasks[i] = queue->tasks[(queue->head + i) % queue->capacity];
+        }
+        free(queue->tasks);
+        queue->tasks = tasks;
+        queue->head = 0;
+        queue->capacity = capacity;
+    }
+    queue->tasks[(queue->head + queue->count) % queue->capacity] = task;
+    queue->count++;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/* Retira do fim (dono, LIFO) ou do início (ladrão, FIFO). */
+static int queue_take(WorkQueue* queue, int steal, Task* task) {
+    int found = 0;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0) {
+        if (steal) {
+            *task = queue->tasks[queue->head];
+            queue->head = (queue->head + 1) % queue->capacity;
+        } else {
+            *task = queue->tasks[(queue->head + queue->count - 1) % queue->capacity];
+        }
+        queue->count--;
+        found = 1;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+/* A própria fila primeiro; depois rouba das outras. */
+static int pool_take(ThreadPool* pool, int self, Task* task) {
+    if (queue_take(&pool->queues[self], 0, task)) return 1;
+    for (int i = 1; i < pool->size; i++) {
+        if (queue_take(&pool->queues[(self + i) % pool->size], 1, task)) return 1;
+    }
+    return 0;
+}
+
+static void run_task(ThreadPool* pool, Task* task) {
+    atomic_fetch_sub(&pool->queued, 1);
+    task->fn(task->arg);
+    if (atomic_fetch_sub(&pool->pending, 1) == 1) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->all_done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void* worker_main(void* arg) {
+    WorkerStart* start = (WorkerStart*)arg;
+    ThreadPool* pool = start->pool;
+    int self = start->index;
+    free(start);
+
+    worker_index = self;
+    worker_pool = pool;
+
+    for (;;) {
+        Task task;
+        if (pool_take(pool, self, &task)) {
+            run_task(pool, &task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_available, &pool->lock);
+        }
+        int stop = pool->shutdown && atomic_load(&pool->queued) == 0;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+ThreadPool* pool_create(int size) {
+    if (size <= 0) size = cpu_count();
+
+    ThreadPool* pool = (ThreadPool*)pool_alloc(NULL, sizeof(ThreadPool));
+    pool->size = size;
+    pool->threads = (pthread_t*)pool_alloc(NULL, size * sizeof(pthread_t));
+    pool->queues = (WorkQueue*)pool_alloc(NULL, size * sizeof(WorkQueue));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->next_queue, 0);
+    pool->shutdown = 0;
+
+    for (int i = 0; i < size; i++) {
+        WorkQueue* queue = &pool->queues[i];
+        queue->tasks = NULL;
+        queue->head = 0;
+        queue->count = 0;
+        queue->capacity = 0;
+        pthread_mutex_init(&queue->lock, NULL);
+    }
+    for (int i = 0; i < size; i++) {
+        WorkerStart* start = (WorkerStart*)pool_alloc(NULL, sizeof(WorkerStart));
+        start->pool = pool;
+        start->index = i;
+        pthread_create(&pool->threads[i], NULL, worker_main, start);
+    }
+    return pool;
+}
+
+void pool_submit(ThreadPool* pool, TaskFn fn, void* arg) {
+    Task task;
+    task.fn = fn;
+    task.arg = arg;
+
+    int target = worker_pool == pool
+        ? worker_index
+        : (int)(atomic_fetch_add(&pool->next_queue, 1) % (unsigned)pool->size);
+
+    atomic_fetch_add(&pool->pending, 1);
+    queue_push(&pool->queues[target], task);
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->queued, 1);
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void pool_wait(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->pending) > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void pool_destroy(ThreadPool* pool) {
+    pool_wait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->size; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->size; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].tasks);
+    }
+    pthread_cond_destroy(&pool->all_done);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->queues);
+    free(pool->threads);
+    free(pool);
+}
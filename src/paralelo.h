@@ -0,0 +1,30 @@
+#ifndef PARALELO_H
+#define PARALELO_H
+
+/* --- Pool de Threads com Roubo de Trabalho --- */
+
+typedef void (*TaskFn)(void* arg);
+
+typedef struct ThreadPool ThreadPool;
+
+/* Cria um pool com `size` trabalhadores (size <= 0 usa o número de CPUs). */
+ThreadPool* pool_create(int size);
+int pool_size(const ThreadPool* pool);
+
+/* Enfileira uma tarefa. Chamada de dentro de um
+ * trabalhador, vai para a fila dele; de fora, as tarefas são distribuídas
+ * entre as filas. */
+void pool_submit(ThreadPool* pool, TaskFn fn, void* arg);
+
+/* Espera todas as tarefas do pool (inclusive as criadas por outras
+ * tarefas) terminarem. Não deve ser chamada de dentro de uma tarefa. */
+void pool_wait(ThreadPool* pool);
+void pool_destroy(ThreadPool* pool);
+
+/* Índice do trabalhador atual em [0, pool_size), ou -1 fora do pool. Serve
+ * para indexar estados por thread, como as arenas de cada trabalhador. */
+int pool_worker_index(void);
+
+int cpu_count(void);
+
+#endif
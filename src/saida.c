@@ -0,0 +1,173 @@
+#include <string.h>
+#include <stdint.h>
+#include "memoria.h"
+#include "saida.h"
+
+int output_mode_from_string(const char* name, OutputMode* mode) {
+    if (strcmp(name, "texto") == 0) {
+        *mode = OUTPUT_TEXTO;
+    } else if (strcmp(name, "nenhuma") == 0) {
+        *mode = OUTPUT_NENHUMA;
+    } else if (strcmp(name, "binaria") == 0) {
+        *mode = OUTPUT_BINARIA;
+    } else if (strcmp(name, "ndjson") == 0) {
+        *mode = OUTPUT_NDJSON;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+void writer_flush(TokenWriter* writer) {
+    if (writer->used > 0) {
+        fwrite(writer->data, 1, writer->used, writer->file);
+        writer->used = 0;
+    }
+}
+
+FILE* writer_report_file(const TokenWriter* writer) {
+    return writer->mode == OUTPUT_BINARIA || writer->mode == OUTPUT_NDJSON ? stderr : stdout;
+}
+
+/* --- Montagem do Buffer --- */
+
+static void put_bytes(TokenWriter* writer, const char* bytes, size_t length) {
+    if (writer->used + length > OUTPUT_BUFFER_SIZE) {
+        writer_flush(writer);
+        if (length > OUTPUT_BUFFER_SIZE) {
+            fwrite(bytes, 1, length, writer->file);
+            return;
+        }
+    }
+    memcpy(writer->data + writer->used, bytes, length);
+    writer->used += length;
+}
+
+static void put_string(TokenWriter* writer, const char* text) {
+    put_bytes(writer, text, strlen(text));
+}
+
+static void put_int(TokenWriter* writer, long value) {
+    char digits[24];
+    int i = sizeof(digits);
+    unsigned long magnitude = value < 0 ? -(unsigned long)value : (unsigned long)value;
+    do {
+        digits[--i] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) digits[--i] = '-';
+    put_bytes(writer, digits + i, sizeof(digits) - i);
+}
+
+static void put_u32(char* out, uint32_t value) {
+    out[0] = (char)(value & 0xFF);
+    out[1] = (char)((value >> 8) & 0xFF);
+    out[2] = (char)((value >> 16) & 0xFF);
+    out[3] = (char)((value >> 24) & 0xFF);
+}
+
+/* Texto JSON entre aspas; bytes acima de 0x7F (UTF-8) passam sem mudança. */
+static void put_json_string(TokenWriter* writer, const char* text, int length) {
+    static const char hex[] = "0123456789abcdef";
+    put_bytes(writer, "\"", 1);
+    int run = 0;
+    for (int i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        put_bytes(writer, text + run, i - run);
+        run = i + 1;
+        char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+        switch (c) {
+            case '"': put_bytes(writer, "\\\"", 2); break;
+            case '\\': put_bytes(writer, "\\\\", 2); break;
+            case '\n': put_bytes(writer, "\\n", 2); break;
+            case '\r': put_bytes(writer, "\\r", 2); break;
+            case '\t': put_bytes(writer, "\\t", 2); break;
+            default: put_bytes(writer, escape, sizeof(escape)); break;
+        }
+    }
+    put_bytes(writer, text + run, length - run);
+    put_bytes(writer, "\"", 1);
+}
+
+void writer_init(TokenWriter* writer, OutputMode mode, FILE* file, Arena* arena) {
+    writer->mode = mode;
+    writer->file = file;
+    writer->used = 0;
+    writer->data = mode != OUTPUT_NENHUMA ? (char*)arena_alloc(arena, OUTPUT_BUFFER_SIZE) : NULL;
+
+    if (mode == OUTPUT_BINARIA) {
+        char header[TOKEN_STREAM_HEADER_SIZE] = { 0 };
+        memcpy(header, TOKEN_STREAM_MAGIC, 4);
+        header[4] = TOKEN_STREAM_VERSION & 0xFF;
+        header[5] = TOKEN_STREAM_VERSION >> 8;
+        header[6] = TOKEN_STREAM_RECORD_SIZE & 0xFF;
+        header[7] = TOKEN_STREAM_RECORD_SIZE >> 8;
+        put_bytes(writer, header, sizeof(header));
+    }
+}
+
+/* --- Formatos --- */
+
+static void write_text(TokenWriter* writer, const char* content, Token token, const char* error_msg) {
+    put_string(writer, "Token: ");
+    put_string(writer, token_type_to_string(token.type));
+    put_string(writer, ", Valor: '");
+    if (token.type == TOKEN_ERRO) {
+        put_string(writer, error_msg);
+    } else if (token.type == TOKEN_EOF) {
+        put_string(writer, "NULL");
+    } else {
+        put_bytes(writer, &content[token.offset], token.length);
+    }
+    put_string(writer, "', Linha: ");
+    put_int(writer, token.line);
+    put_bytes(writer, "\n", 1);
+
+    if (token.type == TOKEN_ERRO) {
+        put_string(writer, "Erro na linha ");
+        put_int(writer, token.line);
+        put_string(writer, ": ");
+        put_string(writer, error_msg);
+        put_bytes(writer, "\n", 1);
+    }
+}
+
+static void write_ndjson(TokenWriter* writer, const char* content, long base, Token token,
+                         const char* error_msg) {
+    put_string(writer, "{\"tipo\":\"");
+    put_string(writer, token_type_to_string(token.type));
+    put_string(writer, "\",\"linha\":");
+    put_int(writer, token.line);
+    put_string(writer, ",\"offset\":");
+    put_int(writer, base + token.offset);
+    put_string(writer, ",\"comprimento\":");
+    put_int(writer, token.length);
+    if (token.type == TOKEN_ERRO) {
+        put_string(writer, ",\"mensagem\":");
+        put_json_string(writer, error_msg, (int)strlen(error_msg));
+    } else if (token.type != TOKEN_EOF) {
+        put_string(writer, ",\"valor\":");
+        put_json_string(writer, &content[token.offset], token.length);
+    }
+    put_string(writer, "}\n");
+}
+
+static void write_binary(TokenWriter* writer, long base, Token token) {
+    char record[TOKEN_STREAM_RECORD_SIZE];
+    put_u32(record, (uint32_t)token.type);
+    put_u32(record + 4, (uint32_t)(base + token.offset));
+    put_u32(record + 8, (uint32_t)token.length);
+    put_u32(record + 12, (uint32_t)token.line);
+    put_bytes(writer, record, sizeof(record));
+}
+
+void writer_token(TokenWriter* writer, const char* content, long base, Token token,
+                  const char* error_msg) {
+    switch (writer->mode) {
+        case OUTPUT_TEXTO: write_text(writer, content, token, error_msg); break;
+        case OUTPUT_NDJSON: write_ndjson(writer, content, base, token, error_msg); break;
+        case OUTPUT_BINARIA: write_binary(writer, base, token); break;
+        case OUTPUT_NENHUMA: break;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SAIDA_H
+#define SAIDA_H
+
+#include <stdio.h>
+#include "lexico.h"
+
+/* --- Saída dos Tokens --- */
+
+/* Tudo é montado num único buffer e escrito em blocos deste tamanho. */
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+typedef enum {
+    OUTPUT_TEXTO,   /* "Token: TIPO, Valor: '...', Linha: N" (padrão) */
+    OUTPUT_NENHUMA, /* só o resumo */
+    OUTPUT_BINARIA, /* cabeçalho + registros de tamanho fixo */
+    OUTPUT_NDJSON   /* um objeto JSON por linha */
+} OutputMode;
+
+/* Formato binário: um cabeçalho de 16 bytes seguido de um registro de 16
+ * bytes por token, todos os campos little-endian:
+ *   cabeçalho: "CTOK", u16 versão, u16 tamanho do registro, u32 0, u32 0
+ *   registro:  u32 tipo (TokenType), u32 offset, u32 comprimento, u32 linha
+ * O offset é a posição do lexema na entrada (para textos, após a aspa). */
+#define TOKEN_STREAM_MAGIC "CTOK"
+#define TOKEN_STREAM_VERSION 1
+#define TOKEN_STREAM_HEADER_SIZE 16
+#define TOKEN_STREAM_RECORD_SIZE 16
+
+typedef struct {
+    OutputMode mode;
+    FILE* file;
+    char* data;
+    size_t used;
+} TokenWriter;
+
+/* Reconhece "texto", "nenhuma", "binaria" ou "ndjson". Retorna 0, ou -1
+ * se o nome for inválido. */
+int output_mode_from_string(const char* name, OutputMode* mode);
+
+/* O buffer é alocado em arena; no modo binário o cabeçalho já é escrito. */
+void writer_init(TokenWriter* writer, OutputMode mode, FILE* file, Arena* arena);
+
+/* Escreve um token de content. base é a posição de content[0] na entrada
+ * (diferente de 0 só na leitura em fluxo); error_msg é a mensagem usada
+ * quando o token é um TOKEN_ERRO. */
+void writer_token(TokenWriter* writer, const char* content, long base, Token token,
+                  const char* error_msg);
+void writer_flush(TokenWriter* writer);
+
+/* Os modos binário e NDJSON reservam a saída para os tokens; mensagens e
+ * resumo vão para a saída de erro. */
+FILE* writer_report_file(const TokenWriter* writer);
+
+#endif
@@ -0,0 +1,580 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "semantico.h"
+#include "simbolos.h"
+
+typedef struct {
+    Ast* ast;
+    SymbolTable symbols;
+    Diagnostics* diagnostics;
+    AstIndex function;  /* função atual; AST_NULL em principal e nas globais */
+    AstIndex item;      /* item do programa em verificação */
+    int returns;        /* retornos vistos na função atual */
+    atomic_uchar* ready; /* em paralelo, por nó: tipo de retorno da função já final */
+} Checker;
+
+const char* data_type_to_string(DataType type) {
+    switch (type) {
+        case TYPE_INTEIRO: return "inteiro";
+        case TYPE_DECIMAL: return "decimal";
+        case TYPE_TEXTO: return "texto";
+        default: return "desconhecido";
+    }
+}
+
+DataType data_type_from_token(TokenType type) {
+    switch (type) {
+        case TOKEN_INTEIRO:
+        case TOKEN_LITERAL_INT: return TYPE_INTEIRO;
+        case TOKEN_DECIMAL:
+        case TOKEN_LITERAL_DEC: return TYPE_DECIMAL;
+        case TOKEN_TEXTO:
+        case TOKEN_LITERAL_TEXTO: return TYPE_TEXTO;
+        default: return TYPE_NENHUM;
+    }
+}
+
+/* --- Auxiliares --- */
+
+static AstNode* node_at(const Checker* checker, AstIndex index) {
+    return ast_node(checker->ast, index);
+}
+
+static const char* name_of(const Checker* checker, AstIndex index) {
+    return interner_name(checker->ast->interner, node_at(checker, index)->symbol)->text;
+}
+
+static int count_list(const Checker* checker, AstIndex first) {
+    int count = 0;
+    for (AstIndex item = first; item != AST_NULL; item = node_at(checker, item)->next) {
+        count++;
+    }
+    return count;
+}
+
+/* Inteiro em decimal é ampliação e não gera alerta; qualquer outra
+ * diferença de tipos gera. */
+static int compatible(DataType target, DataType value) {
+    return target == TYPE_NENHUM || value == TYPE_NENHUM || target == value ||
+           (target == TYPE_DECIMAL && value == TYPE_INTEIRO);
+}
+
+static int is_numeric(DataType type) {
+    return type == TYPE_INTEIRO || type == TYPE_DECIMAL;
+}
+
+/* --- Expressões --- */
+
+static DataType check_expression(Checker* checker, AstIndex index);
+
+static DataType check_variable(Checker* checker, AstIndex index) {
+    AstNode* node = node_at(checker, index);
+    int found = symtab_lookup(&checker->symbols, node->symbol);
+    if (found < 0) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, node->line,
+                        "Variável %s usada sem ter sido declarada", name_of(checker, index));
+        return TYPE_NENHUM;
+    }
+    DataType type = data_type_from_token((TokenType)symtab_symbol(&checker->symbols, found)->type);
+    node->type = (uint8_t)type;
+    return type;
+}
+
+/* Chamadas a funções ainda não verificadas (as que vêm depois no código)
+ * têm tipo desconhecido. Os itens vêm na ordem do código, então os
+ * índices dos nós também: comparar índices é comparar posições. */
+static DataType callee_type(const Checker* checker, AstIndex function) {
+    if (function > checker->item) return TYPE_NENHUM;
+    if (function < checker->item && checker->ready != NULL) {
+        /* Em paralelo, a função pode estar em verificação em outro
+         * trabalhador; seu tipo é final a partir do primeiro retorno. */
+        while (!atomic_load_explicit(&checker->ready[function], memory_order_acquire)) {
+            sched_yield();
+        }
+    }
+    return (DataType)node_at(checker, function)->type;
+}
+
+static void publish_type(const Checker* checker) {
+    if (checker->ready != NULL) {
+        atomic_store_explicit(&checker->ready[checker->function], 1, memory_order_release);
+    }
+}
+
+static DataType check_call(Checker* checker, AstIndex index) {
+    AstNode* call = node_at(checker, index);
+    int line = call->line;
+    AstIndex args = call->child[0];
+    int found = symtab_lookup(&checker->symbols, call->symbol);
+    if (found < 0) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                        "Função %s não declarada", name_of(checker, index));
+        for (AstIndex arg = args; arg != AST_NULL; arg = node_at(checker, arg)->next) {
+            check_expression(checker, arg);
+        }
+        return TYPE_NENHUM;
+    }
+
+    AstIndex function = symtab_symbol(&checker->symbols, found)->node;
+    AstIndex params = node_at(checker, function)->child[0];
+    int expected = count_list(checker, params);
+    int received = count_list(checker, args);
+    if (expected != received) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                        "Função %s espera %d argumento(s), mas recebeu %d",
+                        name_of(checker, index), expected, received);
+    }
+
+    AstIndex param = params;
+    int position = 1;
+    for (AstIndex arg = args; arg != AST_NULL; arg = node_at(checker, arg)->next, position++) {
+        DataType value = check_expression(checker, arg);
+        if (param == AST_NULL) continue;
+        DataType target = data_type_from_token((TokenType)node_at(checker, param)->op);
+        if (!compatible(target, value)) {
+            diagnostics_add(checker->diagnostics, DIAG_ALERTA, line,
+                            "Argumento %d de %s: esperado %s, recebido %s",
+                            position, name_of(checker, index),
+                            data_type_to_string(target), data_type_to_string(value));
+        }
+        param = node_at(checker, param)->next;
+    }
+
+    DataType type = callee_type(checker, function);
+    node_at(checker, index)->type = (uint8_t)type;
+    return type;
+}
+
+static DataType check_binary(Checker* checker, AstIndex index) {
+    AstNode* node = node_at(checker, index);
+    TokenType op = (TokenType)node->op;
+    int line = node->line;
+    AstIndex left_index = node->child[0];
+    AstIndex right_index = node->child[1];
+    DataType left = check_expression(checker, left_index);
+    DataType right = check_expression(checker, right_index);
+
+    switch (op) {
+        case TOKEN_OP_E:
+        case TOKEN_OP_OU:
+            return TYPE_INTEIRO;
+        case TOKEN_OP_IGUAL: case TOKEN_OP_DIF:
+        case TOKEN_OP_MENOR: case TOKEN_OP_MENOR_IGUAL:
+        case TOKEN_OP_MAIOR: case TOKEN_OP_MAIOR_IGUAL:
+            if (left != TYPE_NENHUM && right != TYPE_NENHUM &&
+                left != right && !(is_numeric(left) && is_numeric(right))) {
+                diagnostics_add(checker->diagnostics, DIAG_ALERTA, line,
+                                "Comparação entre tipos diferentes: %s e %s",
+                                data_type_to_string(left), data_type_to_string(right));
+            }
+            return TYPE_INTEIRO;
+        default:
+            if (left == TYPE_TEXTO || right == TYPE_TEXTO) {
+                diagnostics_add(checker->diagnostics, DIAG_ALERTA, line,
+                                "Operação aritmética com texto");
+                return TYPE_NENHUM;
+            }
+            if (left == TYPE_NENHUM || right == TYPE_NENHUM) return TYPE_NENHUM;
+            return left == TYPE_DECIMAL || right == TYPE_DECIMAL ? TYPE_DECIMAL : TYPE_INTEIRO;
+    }
+}
+
+static DataType check_expression(Checker* checker, AstIndex index) {
+    if (index == AST_NULL) return TYPE_NENHUM;
+    AstNode* node = node_at(checker, index);
+    DataType type = TYPE_NENHUM;
+    switch ((AstKind)node->kind) {
+        case AST_LITERAL:
+            type = data_type_from_token((TokenType)node->op);
+            break;
+        case AST_VARIAVEL:
+            return check_variable(checker, index);
+        case AST_CHAMADA:
+            return check_call(checker, index);
+        case AST_BINARIO:
+            type = check_binary(checker, index);
+            break;
+        case AST_UNARIO:
+        case AST_INCREMENTO: {
+            int line = node->line;
+            type = check_expression(checker, node->child[0]);
+            if (type == TYPE_TEXTO) {
+                diagnostics_add(checker->diagnostics, DIAG_ALERTA, line,
+                                "Operação aritmética com texto");
+                type = TYPE_NENHUM;
+            }
+            break;
+        }
+        case AST_ATRIBUICAO: {
+            int line = node->line;
+            AstIndex target_index = node->child[0];
+            AstIndex value_index = node->child[1];
+            DataType value = check_expression(checker, value_index);
+            type = check_variable(checker, target_index);
+            if (!compatible(type, value)) {
+                diagnostics_add(checker->diagnostics, DIAG_ALERTA, line,
+                                "Atribuição de valor %s à variável %s (%s)",
+                                data_type_to_string(value), name_of(checker, target_index),
+                                data_type_to_string(type));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    node_at(checker, index)->type = (uint8_t)type;
+    return type;
+}
+
+static void check_expression_list(Checker* checker, AstIndex first) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(checker, item)->next) {
+        check_expression(checker, item);
+    }
+}
+
+/* --- Declarações --- */
+
+static void declare_variable(Checker* checker, AstIndex index, SymbolKind kind, int type) {
+    AstNode* node = node_at(checker, index);
+    SymbolId id = node->symbol;
+    int line = node->line;
+    int visible = symtab_lookup(&checker->symbols, id);
+    if (visible >= 0 && checker->symbols.depth > 0 && symtab_symbol(&checker->symbols, visible)->depth == 0) {
+        /* Item 2.2 da especificação: o nome de uma global é único. */
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                        "Variável %s já declarada como global na linha %d",
+                        name_of(checker, index),
+                        node_at(checker, symtab_symbol(&checker->symbols, visible)->node)->line);
+        return;
+    }
+    if (symtab_declare(&checker->symbols, id, kind, type, index) < 0) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                        "Variável %s já declarada na linha %d", name_of(checker, index),
+                        node_at(checker, symtab_symbol(&checker->symbols, visible)->node)->line);
+    }
+}
+
+/* texto exige tamanho inteiro >= 1; decimal exige tamanho "[n.m]";
+ * inteiro não tem tamanho. */
+static void check_size(Checker* checker, AstIndex declarator, TokenType type) {
+    AstNode* node = node_at(checker, declarator);
+    int line = node->line;
+    const char* name = name_of(checker, declarator);
+    if (node->child[0] == AST_NULL) {
+        if (type != TOKEN_INTEIRO) {
+            diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                            "Variável %s do tipo %s precisa de tamanho", name,
+                            data_type_to_string(data_type_from_token(type)));
+        }
+        return;
+    }
+
+    const AstNode* size = node_at(checker, node->child[0]);
+    const char* text = &checker->ast->source[size->offset];
+    if (type == TOKEN_INTEIRO) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                        "Variável %s do tipo inteiro não tem tamanho", name);
+    } else if (type == TOKEN_TEXTO && (size->op != TOKEN_LITERAL_INT || atoi(text) < 1)) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                        "Tamanho de %s deve ser um inteiro maior ou igual a 1", name);
+    } else if (type == TOKEN_DECIMAL && size->op != TOKEN_LITERAL_DEC) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line,
+                        "Tamanho de %s deve indicar as casas antes e depois do ponto, como [2.5]", name);
+    }
+}
+
+static void check_declaration(Checker* checker, AstIndex index) {
+    TokenType type = (TokenType)node_at(checker, index)->op;
+    DataType target = data_type_from_token(type);
+    for (AstIndex declarator = node_at(checker, index)->child[0]; declarator != AST_NULL;
+         declarator = node_at(checker, declarator)->next) {
+        check_size(checker, declarator, type);
+        /* O valor inicial é verificado antes de declarar: "!a = !a" usa
+         * um !a anterior, se houver. */
+        AstIndex value_index = node_at(checker, declarator)->child[1];
+        if (value_index != AST_NULL) {
+            DataType value = check_expression(checker, value_index);
+            if (!compatible(target, value)) {
+                diagnostics_add(checker->diagnostics, DIAG_ALERTA, node_at(checker, declarator)->line,
+                                "Atribuição de valor %s à variável %s (%s)",
+                                data_type_to_string(value), name_of(checker, declarator),
+                                data_type_to_string(target));
+            }
+        }
+        node_at(checker, declarator)->type = (uint8_t)target;
+        declare_variable(checker, declarator, SYMBOL_VARIAVEL, type);
+    }
+}
+
+/* --- Comandos --- */
+
+static void check_statement(Checker* checker, AstIndex index);
+
+static void check_statements(Checker* checker, AstIndex first) {
+    for (AstIndex item = first; item != AST_NULL; item = node_at(checker, item)->next) {
+        check_statement(checker, item);
+    }
+}
+
+static void check_return(Checker* checker, AstIndex index) {
+    int line = node_at(checker, index)->line;
+    DataType value = check_expression(checker, node_at(checker, index)->child[0]);
+    if (checker->function == AST_NULL) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, line, "retorno fora de uma função");
+        return;
+    }
+    AstNode* function = node_at(checker, checker->function);
+    if (checker->returns++ == 0) {
+        function->type = (uint8_t)value;
+        publish_type(checker);
+    } else if (!compatible((DataType)function->type, value) && !compatible(value, (DataType)function->type)) {
+        diagnostics_add(checker->diagnostics, DIAG_ALERTA, line,
+                        "Retorno do tipo %s, mas %s já retornou %s",
+                        data_type_to_string(value), name_of(checker, checker->function),
+                        data_type_to_string((DataType)function->type));
+    }
+}
+
+static void check_statement(Checker* checker, AstIndex index) {
+    AstNode* node = node_at(checker, index);
+    AstIndex child[4] = { node->child[0], node->child[1], node->child[2], node->child[3] };
+    switch ((AstKind)node->kind) {
+        case AST_BLOCO:
+            symtab_enter(&checker->symbols);
+            check_statements(checker, child[0]);
+            symtab_leave(&checker->symbols);
+            break;
+        case AST_DECLARACAO:
+            check_declaration(checker, index);
+            break;
+        case AST_SE:
+            check_expression(checker, child[0]);
+            check_statement(checker, child[1]);
+            if (child[2] != AST_NULL) check_statement(checker, child[2]);
+            break;
+        case AST_PARA:
+            check_expression_list(checker, child[0]);
+            check_expression(checker, child[1]);
+            check_expression_list(checker, child[2]);
+            check_statement(checker, child[3]);
+            break;
+        case AST_LEIA:
+            for (AstIndex var = child[0]; var != AST_NULL; var = node_at(checker, var)->next) {
+                check_variable(checker, var);
+            }
+            break;
+        case AST_ESCREVA:
+            check_expression_list(checker, child[0]);
+            break;
+        case AST_RETORNO:
+            check_return(checker, index);
+            break;
+        case AST_EXPRESSAO:
+            check_expression(checker, child[0]);
+            break;
+        default:
+            break;
+    }
+}
+
+/* --- Funções e Programa --- */
+
+/* Parâmetros e locais ficam no mesmo escopo: um local com o nome de um
+ * parâmetro é uma redeclaração (item 1.4.2.1.2). */
+static void check_function(Checker* checker, AstIndex index) {
+    checker->function = node_at(checker, index)->kind == AST_FUNCAO ? index : AST_NULL;
+    checker->returns = 0;
+    symtab_enter(&checker->symbols);
+    for (AstIndex param = node_at(checker, index)->child[0]; param != AST_NULL;
+         param = node_at(checker, param)->next) {
+        declare_variable(checker, param, SYMBOL_PARAMETRO, node_at(checker, param)->op);
+        node_at(checker, param)->type = (uint8_t)data_type_from_token((TokenType)node_at(checker, param)->op);
+    }
+    AstIndex body = node_at(checker, index)->child[1];
+    if (body != AST_NULL) {
+        check_statements(checker, node_at(checker, body)->child[0]);
+    }
+    symtab_leave(&checker->symbols);
+
+    if (checker->function != AST_NULL && checker->returns == 0) {
+        diagnostics_add(checker->diagnostics, DIAG_ERRO, node_at(checker, index)->line,
+                        "Função %s não apresenta retorno", name_of(checker, index));
+        publish_type(checker);
+    }
+    checker->function = AST_NULL;
+}
+
+static void checker_init(Checker* checker, Ast* ast, Diagnostics* diagnostics, Arena* arena) {
+    checker->ast = ast;
+    checker->diagnostics = diagnostics;
+    checker->function = AST_NULL;
+    checker->item = AST_NULL;
+    checker->returns = 0;
+    checker->ready = NULL;
+    symtab_init(&checker->symbols, ast->interner, arena);
+}
+
+/* Só os nomes das funções são declarados antes, para que possam ser
+ * chamadas antes da definição; o resto é uma única passada. Com report
+ * 0, as declarações são só repetidas, sem diagnósticos. */
+static void declare_functions(Checker* checker, int report) {
+    AstIndex first = node_at(checker, checker->ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(checker, item)->next) {
+        if (node_at(checker, item)->kind != AST_FUNCAO) continue;
+        SymbolId id = node_at(checker, item)->symbol;
+        if (symtab_declare(&checker->symbols, id, SYMBOL_FUNCAO, TOKEN_EOF, item) < 0 && report) {
+            AstIndex previous = symtab_symbol(&checker->symbols, symtab_lookup(&checker->symbols, id))->node;
+            diagnostics_add(checker->diagnostics, DIAG_ERRO, node_at(checker, item)->line,
+                            "Função %s já declarada na linha %d",
+                            name_of(checker, item), node_at(checker, previous)->line);
+        }
+    }
+}
+
+int check_program(Ast* ast, Diagnostics* diagnostics, Arena* arena) {
+    Checker checker;
+    checker_init(&checker, ast, diagnostics, arena);
+    int errors_before = diagnostics->errors;
+    declare_functions(&checker, 1);
+
+    AstIndex first = node_at(&checker, ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&checker, item)->next) {
+        checker.item = item;
+        if (node_at(&checker, item)->kind == AST_DECLARACAO) {
+            check_declaration(&checker, item);
+        } else {
+            check_function(&checker, item);
+        }
+    }
+    return diagnostics->errors - errors_before;
+}
+
+/* --- Verificação Paralela --- */
+
+/* Cada trabalhador tem sua tabela de símbolos, com as funções e as globais
+ * declaradas antes do item em verificação, e sua lista de diagnósticos;
+ * de cada item, guarda-se o trecho dessa lista que ele gerou. */
+typedef struct {
+    Checker checker;
+    Diagnostics diagnostics;
+    int declared;       /* itens anteriores cujas globais já estão na tabela */
+    int started;
+} CheckWorker;
+
+typedef struct {
+    Diagnostics* diagnostics;   /* de quem verificou o item */
+    int first;
+    int count;
+} CheckedItem;
+
+typedef struct {
+    Ast* ast;
+    AstIndex* items;
+    CheckedItem* checked;
+    int count;
+    atomic_int next;
+    atomic_uchar* ready;
+    CheckWorker* workers;
+    Arena* worker_arenas;
+} ParallelCheck;
+
+/* As funções são retiradas em ordem, por um contador comum: uma função só
+ * espera por funções anteriores, que já foram retiradas e estão em
+ * verificação ou prontas, então a mais antiga em verificação nunca espera
+ * e não há impasse, qualquer que seja a ordem em que o pool rode as
+ * tarefas. */
+static void check_worker(void* arg) {
+    ParallelCheck* job = (ParallelCheck*)arg;
+    int index = pool_worker_index();
+    CheckWorker* worker = &job->workers[index];
+    Checker* checker = &worker->checker;
+    if (!worker->started) {
+        diagnostics_init(&worker->diagnostics, &job->worker_arenas[index]);
+        checker_init(checker, job->ast, &worker->diagnostics, &job->worker_arenas[index]);
+        checker->ready = job->ready;
+        declare_functions(checker, 0);
+        worker->started = 1;
+    }
+
+    for (;;) {
+        int position = atomic_fetch_add(&job->next, 1);
+        if (position >= job->count) break;
+        AstIndex item = job->items[position];
+        if (node_at(checker, item)->kind == AST_DECLARACAO) continue;
+
+        /* As globais são verificadas depois, em série; aqui só entram na
+         * tabela, como declare_variable faria (repetidas ficam de fora). */
+        for (; worker->declared < position; worker->declared++) {
+            AstIndex previous = job->items[worker->declared];
+            if (node_at(checker, previous)->kind != AST_DECLARACAO) continue;
+            int type = node_at(checker, previous)->op;
+            for (AstIndex declarator = node_at(checker, previous)->child[0]; declarator != AST_NULL;
+                 declarator = node_at(checker, declarator)->next) {
+                symtab_declare(&checker->symbols, node_at(checker, declarator)->symbol,
+                               SYMBOL_VARIAVEL, type, declarator);
+            }
+        }
+
+        CheckedItem* checked = &job->checked[position];
+        checked->diagnostics = &worker->diagnostics;
+        checked->first = worker->diagnostics.count;
+        checker->item = item;
+        check_function(checker, item);
+        checked->count = worker->diagnostics.count - checked->first;
+    }
+}
+
+int check_program_parallel(Ast* ast, Diagnostics* diagnostics, ThreadPool* pool,
+                           Arena* worker_arenas, Arena* arena) {
+    Checker checker;
+    checker_init(&checker, ast, diagnostics, arena);
+    int errors_before = diagnostics->errors;
+    declare_functions(&checker, 1);
+
+    ParallelCheck job;
+    job.ast = ast;
+    job.count = 0;
+    AstIndex first = node_at(&checker, ast->root)->child[0];
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&checker, item)->next) {
+        job.count++;
+    }
+    job.items = (AstIndex*)arena_alloc(arena, job.count * sizeof(AstIndex));
+    job.checked = (CheckedItem*)arena_alloc(arena, job.count * sizeof(CheckedItem));
+    int position = 0;
+    for (AstIndex item = first; item != AST_NULL; item = node_at(&checker, item)->next) {
+        job.items[position++] = item;
+    }
+    atomic_init(&job.next, 0);
+    job.ready = (atomic_uchar*)arena_alloc(arena, ast->count * sizeof(atomic_uchar));
+    memset(job.ready, 0, ast->count * sizeof(atomic_uchar));
+    int workers = pool_size(pool);
+    job.workers = (CheckWorker*)arena_alloc(arena, workers * sizeof(CheckWorker));
+    memset(job.workers, 0, workers * sizeof(CheckWorker));
+    job.worker_arenas = worker_arenas;
+
+    for (int w = 0; w < workers; w++) {
+        pool_submit(pool, check_worker, &job);
+    }
+    pool_wait(pool);
+
+    /* As globais, em série: os tipos das funções anteriores já são finais. */
+    Diagnostics globals;
+    diagnostics_init(&globals, arena);
+    checker.diagnostics = &globals;
+    for (int p = 0; p < job.count; p++) {
+        AstIndex item = job.items[p];
+        if (node_at(&checker, item)->kind != AST_DECLARACAO) continue;
+        job.checked[p].diagnostics = &globals;
+        job.checked[p].first = globals.count;
+        checker.item = item;
+        check_declaration(&checker, item);
+        job.checked[p].count = globals.count - job.checked[p].first;
+    }
+
+    for (int p = 0; p < job.count; p++) {
+        diagnostics_append(diagnostics, job.checked[p].diagnostics, job.checked[p].first, job.checked[p].count);
+    }
+    return diagnostics->errors - errors_before;
+}
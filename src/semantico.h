@@ -0,0 +1,42 @@
+#ifndef SEMANTICO_H
+#define SEMANTICO_H
+
+#include "ast.h"
+#include "diagnostico.h"
+#include "paralelo.h"
+
+/* --- Análise Semântica --- */
+
+typedef enum {
+    TYPE_NENHUM,   /* desconhecido (erro já reportado ou função ainda sem retorno) */
+    TYPE_INTEIRO,
+    TYPE_DECIMAL,
+    TYPE_TEXTO
+} DataType;
+
+const char* data_type_to_string(DataType type);
+
+/* DataType do TokenType de um tipo (TOKEN_INTEIRO...) ou de um literal. */
+DataType data_type_from_token(TokenType type);
+
+/* Verifica o programa numa única passada pela árvore: declarações antes
+ * do uso, nomes repetidos, tamanhos de texto/decimal, aridade e tipos dos
+ * argumentos, retorno das funções e tipos em atribuições e testes. Todos
+ * os problemas vão para diagnostics; conforme a especificação, tipos
+ * diferentes geram alertas, e o restante, erros. O tipo de cada
+ * expressão fica em node->type. Usa arena para a tabela de símbolos.
+ * Retorna o número de erros. */
+int check_program(Ast* ast, Diagnostics* diagnostics, Arena* arena);
+
+/* Como check_program, com as funções verificadas em paralelo no pool. As
+ * assinaturas (nomes e parâmetros) são declaradas antes, e cada
+ * trabalhador guarda sua tabela e seus diagnósticos em
+ * worker_arenas[pool_worker_index()]. Uma chamada a uma função anterior
+ * espera o primeiro retorno dela, que dá o tipo da chamada na passada
+ * única; as globais são verificadas no fim, em série. Os diagnósticos
+ * são juntados na ordem do código: o resultado é o mesmo de
+ * check_program. */
+int check_program_parallel(Ast* ast, Diagnostics* diagnostics, ThreadPool* pool,
+                           Arena* worker_arenas, Arena* arena);
+
+#endif
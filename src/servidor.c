@@ -0,0 +1,454 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "memoria.h"
+#include "entrada.h"
+#include "paralelo.h"
+#include "servidor.h"
+
+/* Zeros depois do conteúdo recebido: as leituras alinhadas dos núcleos
+ * de varredura podem passar do '\0' final. */
+#define SERVER_PADDING 64
+
+/* Estado de um trabalhador, reaproveitado de um pedido para o outro: a
+ * arena fica aquecida e o buffer de saída é alocado uma vez. O lexer e o
+ * arquivo do pedido ficam aqui, e não na pilha, porque a falta de memória
+ * volta para serve_request por recover. */
+typedef struct {
+    MemoryContext memory;
+    Arena arena;
+    unsigned char* out;
+    size_t used;
+    int fd;
+    atomic_int active_fd;  /* conexão atendida agora, ou -1 */
+    jmp_buf recover;
+    LexerContext lexer;
+    int streaming;         /* o SERVER_OK já foi para o buffer de saída */
+    MappedFile file;
+    int mapped;
+} ServerWorker;
+
+typedef struct {
+    int listen_fd;
+    ServerWorker* workers;
+    int count;
+} Server;
+
+static atomic_int stopping;
+static Server* running_server;
+
+/* --- Entrada e Saída --- */
+
+static void put_u32(unsigned char* out, uint32_t value) {
+    out[0] = (unsigned char)(value & 0xFF);
+    out[1] = (unsigned char)((value >> 8) & 0xFF);
+    out[2] = (unsigned char)((value >> 16) & 0xFF);
+    out[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+static uint32_t get_u32(const unsigned char* in) {
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+static int read_full(int fd, void* data, size_t length) {
+    char* next = (char*)data;
+    while (length > 0) {
+        ssize_t got = read(fd, next, length);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return -1;
+        next += got;
+        length -= (size_t)got;
+    }
+    return 0;
+}
+
+/* MSG_NOSIGNAL: um cliente que fecha a conexão não derruba o servidor. */
+static int write_full(int fd, const void* data, size_t length) {
+    const char* next = (const char*)data;
+    while (length > 0) {
+        ssize_t sent = send(fd, next, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return -1;
+        next += sent;
+        length -= (size_t)sent;
+    }
+    return 0;
+}
+
+static int flush_out(ServerWorker* worker) {
+    int status = write_full(worker->fd, worker->out, worker->used);
+    worker->used = 0;
+    return status;
+}
+
+static int put_out(ServerWorker* worker, const void* data, size_t length) {
+    if (worker->used + length > SERVER_BUFFER_SIZE && flush_out(worker) != 0) return -1;
+    memcpy(worker->out + worker->used, data, length);
+    worker->used += length;
+    return 0;
+}
+
+static int put_out_u32(ServerWorker* worker, uint32_t value) {
+    unsigned char bytes[4];
+    put_u32(bytes, value);
+    return put_out(worker, bytes, sizeof(bytes));
+}
+
+static int put_message(ServerWorker* worker, const char* message) {
+    size_t length = strlen(message);
+    if (put_out_u32(worker, (uint32_t)length) != 0) return -1;
+    return put_out(worker, message, length);
+}
+
+/* --- Servidor --- */
+
+/* Acorda os trabalhadores parados em accept ou em read: o servidor termina
+ * sem esperar os clientes fecharem as conexões. Usada também pelo
+ * tratador de sinais. */
+static void request_stop(void) {
+    atomic_store(&stopping, 1);
+    Server* server = running_server;
+    if (server == NULL) return;
+    shutdown(server->listen_fd, SHUT_RDWR);
+    for (int i = 0; i < server->count; i++) {
+        int fd = atomic_load(&server->workers[i].active_fd);
+        if (fd >= 0) shutdown(fd, SHUT_RDWR);
+    }
+}
+
+static void on_signal(int signal) {
+    (void)signal;
+    request_stop();
+}
+
+static int reply_failure(ServerWorker* worker, ServerStatus status, const char* message) {
+    unsigned char header[8];
+    memcpy(header, SERVER_RESPONSE_MAGIC, 4);
+    put_u32(header + 4, (uint32_t)status);
+    if (put_out(worker, header, sizeof(header)) != 0 || put_message(worker, message) != 0) return -1;
+    return flush_out(worker);
+}
+
+static int put_record(ServerWorker* worker, Token token) {
+    unsigned char record[SERVER_RECORD_SIZE];
+    put_u32(record, (uint32_t)token.type);
+    put_u32(record + 4, (uint32_t)token.offset);
+    put_u32(record + 8, (uint32_t)token.length);
+    put_u32(record + 12, (uint32_t)token.line);
+    return put_out(worker, record, sizeof(record));
+}
+
+static int finish_tokens(ServerWorker* worker, const char* message) {
+    if (put_out_u32(worker, (uint32_t)worker->memory.max_used) != 0 ||
+        put_message(worker, message) != 0) {
+        return -1;
+    }
+    return flush_out(worker);
+}
+
+/* Os tokens vão para o buffer de saída à medida que o lexer os produz. */
+static int reply_tokens(ServerWorker* worker, const char* content) {
+    unsigned char header[8];
+    memcpy(header, SERVER_RESPONSE_MAGIC, 4);
+    put_u32(header + 4, SERVER_OK);
+    if (put_out(worker, header, sizeof(header)) != 0) return -1;
+    worker->streaming = 1;
+
+    LexerContext* lexer = &worker->lexer;
+    lexer_init(lexer, content, &worker->arena);
+    Token token;
+    do {
+        token = get_next_token(lexer);
+        if (put_record(worker, token) != 0) return -1;
+    } while (token.type != TOKEN_EOF && token.type != TOKEN_ERRO);
+
+    return finish_tokens(worker, token.type == TOKEN_ERRO ? lexer->error_msg : "");
+}
+
+/* Faltou memória no meio do pedido. Com os tokens já a caminho, a
+ * resposta termina num TOKEN_ERRO onde o lexer parou, como um erro léxico;
+ * antes deles, o estado é SERVER_SEM_MEMORIA. Nada foi alterado nas
+ * arenas, e os registros no buffer de saída estão inteiros. */
+static int reply_out_of_memory(ServerWorker* worker) {
+    static const char message[] = "Memória insuficiente para a análise";
+    if (!worker->streaming) {
+        return reply_failure(worker, SERVER_SEM_MEMORIA, message);
+    }
+    Token token = { TOKEN_ERRO, worker->lexer.pos, 0, worker->lexer.line };
+    if (put_record(worker, token) != 0) return -1;
+    return finish_tokens(worker, message);
+}
+
+/* Atende um pedido. Retorna 0 se a conexão pode continuar. */
+static int serve_request(ServerWorker* worker) {
+    unsigned char header[SERVER_HEADER_SIZE];
+    if (read_full(worker->fd, header, sizeof(header)) != 0) return -1;
+    uint32_t kind = get_u32(header + 4);
+    uint32_t length = get_u32(header + 8);
+    if (memcmp(header, SERVER_REQUEST_MAGIC, 4) != 0 || kind < REQUEST_CAMINHO || kind > REQUEST_ENCERRAR ||
+        length > SERVER_MAX_REQUEST_MB * 1024u * 1024u) {
+        reply_failure(worker, SERVER_PEDIDO_INVALIDO, "Pedido inválido");
+        return -1;
+    }
+    if (kind == REQUEST_ENCERRAR) {
+        reply_failure(worker, SERVER_ENCERRANDO, "Servidor encerrado");
+        request_stop();
+        return -1;
+    }
+
+    /* O orçamento é o de uma compilação, mais o conteúdo recebido. Um
+     * pedido que passa dele recebe o erro, e o servidor continua. Depois
+     * da falha, a conexão é fechada: o conteúdo pode não ter sido lido. */
+    worker->memory.budget = worker->memory.current_used + MAX_MEMORY_KB * 1024L + length + 2 * ARENA_CHUNK_SIZE;
+    worker->memory.max_used = worker->memory.current_used;
+    worker->streaming = 0;
+    worker->mapped = 0;
+    int status;
+    if (setjmp(worker->recover) != 0) {
+        reply_out_of_memory(worker);
+        status = -1;
+    } else {
+        char* content = (char*)arena_alloc(&worker->arena, length + SERVER_PADDING);
+        if (read_full(worker->fd, content, length) != 0) return -1;
+        memset(content + length, 0, SERVER_PADDING);
+
+        if (kind == REQUEST_CAMINHO) {
+            if (map_file(&worker->file, content, &worker->memory) != MAP_OK) {
+                char message[LEXER_ERROR_MSG_SIZE];
+                snprintf(message, sizeof(message), "Erro ao abrir o arquivo %s", content);
+                status = reply_failure(worker, SERVER_ERRO_LEITURA, message);
+            } else {
+                worker->mapped = 1;
+                status = reply_tokens(worker, worker->file.data);
+            }
+        } else {
+            status = reply_tokens(worker, content);
+        }
+    }
+    if (worker->mapped) {
+        unmap_file(&worker->file);
+        worker->mapped = 0;
+    }
+
+    /* Um pedido grande não deixa blocos grandes retidos para sempre. */
+    if (worker->memory.current_used > MAX_MEMORY_KB * 1024L) {
+        arena_destroy(&worker->arena);
+        arena_init(&worker->arena, &worker->memory);
+        worker->out = (unsigned char*)arena_alloc(&worker->arena, SERVER_BUFFER_SIZE);
+    } else {
+        /* O buffer de saída é a primeira alocação: o reset o mantém. */
+        arena_reset(&worker->arena);
+        worker->out = (unsigned char*)arena_alloc(&worker->arena, SERVER_BUFFER_SIZE);
+    }
+    return status;
+}
+
+/* Cada trabalhador aceita conexões por conta própria e atende todos os
+ * pedidos de uma conexão antes de aceitar a próxima. */
+static void serve_connections(void* arg) {
+    Server* server = (Server*)arg;
+    ServerWorker* worker = &server->workers[pool_worker_index()];
+    while (!atomic_load(&stopping)) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        worker->fd = fd;
+        atomic_store(&worker->active_fd, fd);
+        if (atomic_load(&stopping)) shutdown(fd, SHUT_RDWR);
+        while (!atomic_load(&stopping) && serve_request(worker) == 0) {
+        }
+        atomic_store(&worker->active_fd, -1);
+        close(fd);
+    }
+}
+
+static int open_listener(const char* socket_path) {
+    struct sockaddr_un address;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) return -1;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    /* Um socket antigo de um servidor que não terminou direito. */
+    unlink(socket_path);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int run_server(const char* socket_path, int threads) {
+    int listen_fd = open_listener(socket_path);
+    if (listen_fd < 0) {
+        printf("Erro ao criar o socket %s\n", socket_path);
+        return 1;
+    }
+
+    MemoryContext server_memory;
+    Arena server_arena;
+    memory_context_init(&server_memory);
+    arena_init(&server_arena, &server_memory);
+
+    ThreadPool* pool = pool_create(threads);
+    Server server;
+    server.listen_fd = listen_fd;
+    server.count = pool_size(pool);
+    server.workers = (ServerWorker*)arena_alloc(&server_arena, server.count * sizeof(ServerWorker));
+    for (int i = 0; i < server.count; i++) {
+        ServerWorker* worker = &server.workers[i];
+        memory_context_init(&worker->memory);
+        worker->memory.recover = &worker->recover;
+        arena_init(&worker->arena, &worker->memory);
+        worker->out = (unsigned char*)arena_alloc(&worker->arena, SERVER_BUFFER_SIZE);
+        worker->used = 0;
+        worker->fd = -1;
+        atomic_init(&worker->active_fd, -1);
+    }
+    running_server = &server;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Servidor de compilação em %s com %d trabalhadores.\n", socket_path, server.count);
+    fflush(stdout);
+    for (int i = 0; i < server.count; i++) {
+        pool_submit(pool, serve_connections, &server);
+    }
+    pool_wait(pool);
+    pool_destroy(pool);
+
+    running_server = NULL;
+    close(listen_fd);
+    unlink(socket_path);
+    for (int i = 0; i < server.count; i++) {
+        arena_destroy(&server.workers[i].arena);
+    }
+    arena_destroy(&server_arena);
+    printf("Servidor encerrado.\n");
+    return 0;
+}
+
+/* --- Cliente --- */
+
+int server_connect(ServerConnection* connection, const char* socket_path) {
+    struct sockaddr_un address;
+    connection->fd = -1;
+    connection->start = connection->end = 0;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) return -1;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    connection->fd = fd;
+    return 0;
+}
+
+void server_disconnect(ServerConnection* connection) {
+    if (connection->fd >= 0) close(connection->fd);
+    connection->fd = -1;
+}
+
+static int read_buffered(ServerConnection* connection, void* data, size_t length) {
+    unsigned char* out = (unsigned char*)data;
+    while (length > 0) {
+        if (connection->start == connection->end) {
+            ssize_t got = read(connection->fd, connection->buffer, sizeof(connection->buffer));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return -1;
+            connection->start = 0;
+            connection->end = (size_t)got;
+        }
+        size_t chunk = connection->end - connection->start;
+        if (chunk > length) chunk = length;
+        memcpy(out, connection->buffer + connection->start, chunk);
+        connection->start += chunk;
+        out += chunk;
+        length -= chunk;
+    }
+    return 0;
+}
+
+static int read_u32(ServerConnection* connection, uint32_t* value) {
+    unsigned char bytes[4];
+    if (read_buffered(connection, bytes, sizeof(bytes)) != 0) return -1;
+    *value = get_u32(bytes);
+    return 0;
+}
+
+/* Mensagens maiores que o buffer da resposta são cortadas. */
+static int read_message(ServerConnection* connection, char* message) {
+    uint32_t length;
+    if (read_u32(connection, &length) != 0) return -1;
+    for (uint32_t i = 0; i < length; i++) {
+        char c;
+        if (read_buffered(connection, &c, 1) != 0) return -1;
+        if (i < LEXER_ERROR_MSG_SIZE - 1) message[i] = c;
+    }
+    message[length < LEXER_ERROR_MSG_SIZE - 1 ? length : LEXER_ERROR_MSG_SIZE - 1] = '\0';
+    return 0;
+}
+
+int server_request(ServerConnection* connection, ServerRequestKind kind, const char* data, long length,
+                   TokenSink sink, void* context, ServerReply* reply) {
+    unsigned char header[SERVER_HEADER_SIZE];
+    memcpy(header, SERVER_REQUEST_MAGIC, 4);
+    put_u32(header + 4, (uint32_t)kind);
+    put_u32(header + 8, (uint32_t)length);
+    put_u32(header + 12, 0);
+    if (write_full(connection->fd, header, sizeof(header)) != 0 ||
+        write_full(connection->fd, data, (size_t)length) != 0) {
+        return -1;
+    }
+
+    memset(reply, 0, sizeof(*reply));
+    unsigned char start[8];
+    if (read_buffered(connection, start, sizeof(start)) != 0 ||
+        memcmp(start, SERVER_RESPONSE_MAGIC, 4) != 0) {
+        return -1;
+    }
+    reply->status = (ServerStatus)get_u32(start + 4);
+    if (reply->status != SERVER_OK) {
+        return read_message(connection, reply->message);
+    }
+
+    for (;;) {
+        unsigned char record[SERVER_RECORD_SIZE];
+        if (read_buffered(connection, record, sizeof(record)) != 0) return -1;
+        Token token;
+        token.type = (TokenType)get_u32(record);
+        token.offset = (int)get_u32(record + 4);
+        token.length = (int)get_u32(record + 8);
+        token.line = (int)get_u32(record + 12);
+        reply->tokens++;
+        if (token.type == TOKEN_EOF || token.type == TOKEN_ERRO) {
+            reply->last = token;
+            break;
+        }
+        if (sink != NULL) sink(context, token);
+    }
+    uint32_t max_memory;
+    if (read_u32(connection, &max_memory) != 0) return -1;
+    reply->max_memory = (long)max_memory;
+    return read_message(connection, reply->message);
+}
@@ -0,0 +1,83 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <stdint.h>
+#include "lexico.h"
+
+/* --- Servidor de Compilação --- */
+
+/* Protocolo sobre um socket UNIX de fluxo, com inteiros u32
+ * little-endian. Uma conexão pode fazer vários pedidos em sequência.
+ *   pedido:   "CREQ", u32 tipo (ServerRequestKind), u32 comprimento,
+ *             u32 0 e os bytes: o caminho ou o conteúdo do arquivo
+ *   resposta: "CRES", u32 estado (ServerStatus) e então
+ *     SERVER_OK: registros de 16 bytes como os do formato binário da
+ *       saída (u32 tipo, offset, comprimento, linha) até o TOKEN_EOF ou
+ *       o TOKEN_ERRO, inclusive; depois u32 memória máxima da análise,
+ *       u32 comprimento e a mensagem do erro léxico (vazia sem erro);
+ *       se faltar memória no meio da análise, o último registro é um
+ *       TOKEN_ERRO e a mensagem diz isso
+ *     outros estados: u32 comprimento e a mensagem */
+#define SERVER_REQUEST_MAGIC "CREQ"
+#define SERVER_RESPONSE_MAGIC "CRES"
+#define SERVER_HEADER_SIZE 16
+#define SERVER_RECORD_SIZE 16
+
+/* Maior conteúdo aceito num pedido. */
+#define SERVER_MAX_REQUEST_MB 64
+
+/* Buffer de saída de cada trabalhador (e de leitura do cliente). */
+#define SERVER_BUFFER_SIZE (64 * 1024)
+
+typedef enum {
+    REQUEST_CAMINHO = 1,  /* o servidor lê o arquivo (caminho absoluto ou relativo ao servidor) */
+    REQUEST_CONTEUDO = 2, /* o conteúdo vem no pedido */
+    REQUEST_ENCERRAR = 3  /* termina o servidor */
+} ServerRequestKind;
+
+typedef enum {
+    SERVER_OK = 0,
+    SERVER_ERRO_LEITURA = 1,
+    SERVER_PEDIDO_INVALIDO = 2,
+    SERVER_ENCERRANDO = 3,
+    SERVER_SEM_MEMORIA = 4   /* o pedido passou do orçamento antes dos tokens */
+} ServerStatus;
+
+/* Atende pedidos em socket_path com `threads` trabalhadores (<= 0 usa
+ * todas as CPUs), cada um com sua arena reaproveitada entre pedidos, até
+ * SIGINT, SIGTERM ou um pedido REQUEST_ENCERRAR. Retorna 0, ou 1 se o
+ * socket não puder ser criado. */
+int run_server(const char* socket_path, int threads);
+
+/* --- Cliente --- */
+
+typedef struct {
+    int fd;
+    unsigned char buffer[SERVER_BUFFER_SIZE];
+    size_t start;
+    size_t end;
+} ServerConnection;
+
+/* Resposta de um pedido; com SERVER_OK, last é o TOKEN_EOF ou TOKEN_ERRO
+ * final e message a mensagem do erro léxico. */
+typedef struct {
+    ServerStatus status;
+    Token last;
+    long tokens;
+    long max_memory;
+    char message[LEXER_ERROR_MSG_SIZE];
+} ServerReply;
+
+typedef void (*TokenSink)(void* context, Token token);
+
+/* Retorna 0, ou -1 se não houver servidor em socket_path. */
+int server_connect(ServerConnection* connection, const char* socket_path);
+void server_disconnect(ServerConnection* connection);
+
+/* Envia um pedido e lê a resposta. sink recebe cada token, menos o
+ * último, que fica em reply->last (a mensagem de erro vem depois dele).
+ * Retorna 0, ou -1 se a conexão cair. */
+int server_request(ServerConnection* connection, ServerRequestKind kind, const char* data, long length,
+                   TokenSink sink, void* context, ServerReply* reply);
+
+#endif
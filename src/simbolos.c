@@ -0,0 +1,178 @@
+#include <string.h>
+#include "simbolos.h"
+
+#define INTERNER_INITIAL_CAPACITY 64
+#define SYMTAB_INITIAL_CAPACITY 64
+#define SYMTAB_INITIAL_SCOPES 16
+#define INTERNER_TEXT_BLOCK 4096
+
+/* --- Internação de Nomes --- */
+
+/* FNV-1a de 32 bits. */
+static uint32_t hash_name(const char* text, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static SymbolId* slots_create(Arena* arena, uint32_t capacity) {
+    SymbolId* slots = (SymbolId*)arena_alloc(arena, capacity * sizeof(SymbolId));
+    memset(slots, 0, capacity * sizeof(SymbolId));
+    return slots;
+}
+
+void interner_init(Interner* interner, Arena* arena) {
+    interner->arena = arena;
+    interner->capacity = INTERNER_INITIAL_CAPACITY;
+    interner->slots = slots_create(arena, interner->capacity);
+    interner->names_capacity = INTERNER_INITIAL_CAPACITY / 2;
+    interner->names = (SymbolName*)arena_alloc(arena, interner->names_capacity * sizeof(SymbolName));
+    memset(&interner->names[SYMBOL_NULL], 0, sizeof(SymbolName));
+    interner->count = 1;
+    interner->text_pool = NULL;
+    interner->text_left = 0;
+}
+
+/* Cópia do nome num bloco de textos: arena_alloc alinharia cada nome a 16
+ * bytes, o que dobraria o espaço dos nomes curtos. */
+static const char* interner_copy(Interner* interner, const char* text, int length) {
+    if (interner->text_left < length + 1) {
+        int size = length + 1 > INTERNER_TEXT_BLOCK ? length + 1 : INTERNER_TEXT_BLOCK;
+        interner->text_pool = (char*)arena_alloc(interner->arena, size);
+        interner->text_left = size;
+    }
+    char* copy = interner->text_pool;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    interner->text_pool += length + 1;
+    interner->text_left -= length + 1;
+    return copy;
+}
+
+/* Dobra a tabela e reinsere os ids; o hash guardado evita recalcular. */
+static void interner_rehash(Interner* interner) {
+    uint32_t capacity = interner->capacity * 2;
+    SymbolId* slots = slots_create(interner->arena, capacity);
+    for (SymbolId id = 1; id < interner->count; id++) {
+        uint32_t slot = interner->names[id].hash & (capacity - 1);
+        while (slots[slot] != SYMBOL_NULL) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        slots[slot] = id;
+    }
+    interner->slots = slots;
+    interner->capacity = capacity;
+}
+
+SymbolId interner_intern(Interner* interner, const char* text, int length) {
+    uint32_t hash = hash_name(text, length);
+    uint32_t mask = interner->capacity - 1;
+    uint32_t slot = hash & mask;
+    for (SymbolId id = interner->slots[slot]; id != SYMBOL_NULL; id = interner->slots[slot]) {
+        const SymbolName* name = &interner->names[id];
+        if (name->hash == hash && name->length == length && memcmp(name->text, text, length) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (interner->count == interner->names_capacity) {
+        interner->names = (SymbolName*)arena_grow(interner->arena, interner->names,
+                                                  interner->names_capacity * sizeof(SymbolName),
+                                                  2 * interner->names_capacity * sizeof(SymbolName));
+        interner->names_capacity *= 2;
+    }
+    SymbolId id = interner->count++;
+    interner->names[id].text = interner_copy(interner, text, length);
+    interner->names[id].length = length;
+    interner->names[id].hash = hash;
+    interner->slots[slot] = id;
+
+    if (2 * interner->count > interner->capacity) {
+        interner_rehash(interner);
+    }
+    return id;
+}
+
+/* --- Tabela de Símbolos com Escopos --- */
+
+void symtab_init(SymbolTable* table, Interner* interner, Arena* arena) {
+    table->interner = interner;
+    table->arena = arena;
+    table->capacity = SYMTAB_INITIAL_CAPACITY;
+    table->symbols = (Symbol*)arena_alloc(arena, table->capacity * sizeof(Symbol));
+    table->count = 0;
+    table->bindings_capacity = 0;
+    table->bindings = NULL;
+    table->scopes_capacity = SYMTAB_INITIAL_SCOPES;
+    table->scopes = (int*)arena_alloc(arena, table->scopes_capacity * sizeof(int));
+    table->scopes[0] = 0;
+    table->depth = 0;
+}
+
+void symtab_enter(SymbolTable* table) {
+    if (table->depth + 1 == table->scopes_capacity) {
+        table->scopes = (int*)arena_grow(table->arena, table->scopes,
+                                         table->scopes_capacity * sizeof(int),
+                                         2 * table->scopes_capacity * sizeof(int));
+        table->scopes_capacity *= 2;
+    }
+    table->scopes[++table->depth] = table->count;
+}
+
+/* Os símbolos do escopo são descartados e cada nome volta a apontar para
+ * a declaração que ele sombreava. */
+void symtab_leave(SymbolTable* table) {
+    if (table->depth == 0) return;
+    int start = table->scopes[table->depth--];
+    while (table->count > start) {
+        const Symbol* symbol = &table->symbols[--table->count];
+        table->bindings[symbol->id] = symbol->shadowed;
+    }
+}
+
+/* O vetor de ligações acompanha o número de ids do interner. */
+static void symtab_reserve_bindings(SymbolTable* table, SymbolId id) {
+    if (id < table->bindings_capacity) return;
+    uint32_t capacity = table->bindings_capacity > 0 ? table->bindings_capacity : SYMTAB_INITIAL_CAPACITY;
+    while (capacity <= id) capacity *= 2;
+    table->bindings = (int*)arena_grow(table->arena, table->bindings,
+                                       table->bindings_capacity * sizeof(int),
+                                       capacity * sizeof(int));
+    for (uint32_t i = table->bindings_capacity; i < capacity; i++) {
+        table->bindings[i] = -1;
+    }
+    table->bindings_capacity = capacity;
+}
+
+int symtab_declare(SymbolTable* table, SymbolId id, SymbolKind kind, int type, uint32_t node) {
+    symtab_reserve_bindings(table, id);
+    int previous = table->bindings[id];
+    if (previous >= table->scopes[table->depth]) {
+        return -1;
+    }
+
+    if (table->count == table->capacity) {
+        table->symbols = (Symbol*)arena_grow(table->arena, table->symbols,
+                                             table->capacity * sizeof(Symbol),
+                                             2 * table->capacity * sizeof(Symbol));
+        table->capacity *= 2;
+    }
+    int index = table->count++;
+    Symbol* symbol = &table->symbols[index];
+    symbol->id = id;
+    symbol->kind = (uint8_t)kind;
+    symbol->type = (uint16_t)type;
+    symbol->depth = table->depth;
+    symbol->node = node;
+    symbol->shadowed = previous;
+    table->bindings[id] = index;
+    return index;
+}
+
+int symtab_lookup(const SymbolTable* table, SymbolId id) {
+    return id < table->bindings_capacity ? table->bindings[id] : -1;
+}
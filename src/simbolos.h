@@ -0,0 +1,96 @@
+#ifndef SIMBOLOS_H
+#define SIMBOLOS_H
+
+#include <stdint.h>
+#include "memoria.h"
+
+/* --- Internação de Nomes --- */
+
+/* Cada nome distinto (!variavel ou __funcao) recebe um id estável de 32
+ * bits; comparar nomes nas fases seguintes é comparar ids. O id 0 é
+ * reservado e significa "nenhum símbolo". */
+typedef uint32_t SymbolId;
+#define SYMBOL_NULL 0
+
+typedef struct {
+    const char* text; /* cópia única, terminada em '\0' */
+    int length;
+    uint32_t hash;
+} SymbolName;
+
+/* Tabela de endereçamento aberto (sondagem linear) de ids, indexada pelo
+ * hash do nome; os nomes ficam num vetor indexado pelo id. A carga é
+ * mantida abaixo de 1/2. Tudo fica na arena: a memória é proporcional ao
+ * número de nomes distintos, não ao de ocorrências. */
+typedef struct {
+    SymbolId* slots;
+    uint32_t capacity;
+    SymbolName* names;
+    uint32_t count; /* ids emitidos + 1 (o id 0) */
+    uint32_t names_capacity;
+    char* text_pool;   /* os nomes são copiados lado a lado, sem alinhamento */
+    int text_left;
+    Arena* arena;
+} Interner;
+
+void interner_init(Interner* interner, Arena* arena);
+
+/* Retorna o id de text[0..length), criando-o na primeira ocorrência. */
+SymbolId interner_intern(Interner* interner, const char* text, int length);
+
+static inline const SymbolName* interner_name(const Interner* interner, SymbolId id) {
+    return &interner->names[id];
+}
+
+/* --- Tabela de Símbolos com Escopos --- */
+
+typedef enum {
+    SYMBOL_FUNCAO,
+    SYMBOL_PARAMETRO,
+    SYMBOL_VARIAVEL
+} SymbolKind;
+
+typedef struct {
+    SymbolId id;
+    uint8_t kind;
+    uint16_t type;     /* TokenType do tipo de dado (inteiro, texto, decimal) */
+    int depth;         /* 0 = global */
+    uint32_t node;     /* AstIndex da declaração */
+    int shadowed;      /* ligação anterior do mesmo nome, ou -1 */
+} Symbol;
+
+/* Escopos aninhados: global (funções e variáveis globais), o de cada
+ * função (parâmetros e locais) e os blocos internos. Cada id guarda sua
+ * ligação mais interna, então a busca é um acesso direto ao vetor, sem
+ * percorrer os escopos; sair de um escopo restaura as ligações sombreadas. */
+typedef struct {
+    Symbol* symbols;
+    int count;
+    int capacity;
+    int* bindings;          /* por SymbolId: índice em symbols, ou -1 */
+    uint32_t bindings_capacity;
+    int* scopes;            /* início de cada escopo aberto em symbols */
+    int depth;
+    int scopes_capacity;
+    Interner* interner;
+    Arena* arena;
+} SymbolTable;
+
+/* Cria a tabela já com o escopo global aberto. */
+void symtab_init(SymbolTable* table, Interner* interner, Arena* arena);
+void symtab_enter(SymbolTable* table);
+void symtab_leave(SymbolTable* table);
+
+/* Declara no escopo atual e retorna o índice do símbolo, ou -1 se o nome
+ * já foi declarado neste mesmo escopo (nomes de escopos externos podem
+ * ser sombreados). */
+int symtab_declare(SymbolTable* table, SymbolId id, SymbolKind kind, int type, uint32_t node);
+
+/* Índice da declaração visível mais interna, ou -1. */
+int symtab_lookup(const SymbolTable* table, SymbolId id);
+
+static inline Symbol* symtab_symbol(const SymbolTable* table, int index) {
+    return &table->symbols[index];
+}
+
+#endif
@@ -0,0 +1,583 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <limits.h>
+#include "sintatico.h"
+
+/* Gramática (chaves = repetição, colchetes = opcional):
+ *
+ *   programa    = { funcao | principal | declaracao }
+ *   funcao      = "funcao" ID_FUNC "(" [ parametro { "," parametro } ] ")" bloco
+ *   principal   = "principal" "(" ")" bloco
+ *   parametro   = tipo ID_VAR
+ *   declaracao  = tipo declarador { "," declarador } ";"
+ *   declarador  = ID_VAR [ "[" (INT | DEC) "]" ] [ "=" expressao ]
+ *   comando     = bloco | declaracao | se | para | leia | escreva
+ *               | "retorno" expressao ";" | expressao ";"
+ *   bloco       = "{" { comando } "}"
+ *   se          = "se" "(" expressao ")" comando [ "senao" comando ]
+ *   para        = "para" "(" [ lista ] ";" [ expressao ] ";" [ lista ] ")" comando
+ *   leia        = "leia" "(" ID_VAR { "," ID_VAR } ")" ";"
+ *   escreva     = "escreva" "(" lista ")" ";"
+ *
+ * Expressões, da menor para a maior precedência: atribuição (à direita),
+ * "||", "&&", relacionais, "+" "-", "*" "/", "-" unário e "++"/"--"
+ * prefixos, "^" (à direita), "++"/"--" posfixos e, por fim, variáveis,
+ * literais, chamadas e agrupamentos com "( )" ou "[ ]". */
+
+/* --- Tokens e Erros --- */
+
+static int check(const Parser* parser, TokenType type) {
+    return parser->current.type == type;
+}
+
+static void fail(Parser* parser, int line, const char* format, ...) {
+    if (parser->failed) return;
+    parser->failed = 1;
+    parser->error_line = line;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(parser->error_msg, sizeof(parser->error_msg), format, args);
+    va_end(args);
+}
+
+static void advance(Parser* parser) {
+    parser->previous = parser->current;
+    parser->current = get_next_token(parser->lexer);
+    if (parser->current.type == TOKEN_ERRO) {
+        fail(parser, parser->current.line, "%s", parser->lexer->error_msg);
+    }
+}
+
+static int match(Parser* parser, TokenType type) {
+    if (!check(parser, type)) return 0;
+    advance(parser);
+    return 1;
+}
+
+/* Erro sintático no token atual: "esperado X, encontrado Y". */
+static void expected(Parser* parser, const char* what) {
+    Token token = parser->current;
+    const char* text = &parser->lexer->content[token.offset];
+    int length = token.length > 40 ? 40 : token.length;
+    if (token.type == TOKEN_EOF) {
+        fail(parser, token.line, "Erro sintático: esperado %s, encontrado fim do arquivo", what);
+    } else if (token.type == TOKEN_LITERAL_TEXTO) {
+        fail(parser, token.line, "Erro sintático: esperado %s, encontrado \"%.*s\"", what, length, text);
+    } else {
+        fail(parser, token.line, "Erro sintático: esperado %s, encontrado '%.*s'", what, length, text);
+    }
+}
+
+static int expect(Parser* parser, TokenType type, const char* what) {
+    if (match(parser, type)) return 1;
+    expected(parser, what);
+    return 0;
+}
+
+static int is_type(TokenType type) {
+    return type == TOKEN_INTEIRO || type == TOKEN_TEXTO || type == TOKEN_DECIMAL;
+}
+
+/* --- Nós --- */
+
+static AstIndex add_node(Parser* parser, AstKind kind, int line) {
+    return ast_add(parser->ast, kind, line);
+}
+
+/* Novo nó com o nome/literal de token; nomes são internados. */
+static AstIndex add_named(Parser* parser, AstKind kind, Token token) {
+    SymbolId symbol = SYMBOL_NULL;
+    if (kind != AST_LITERAL) {
+        symbol = interner_intern(parser->ast->interner, &parser->lexer->content[token.offset], token.length);
+    }
+    AstIndex index = add_node(parser, kind, token.line);
+    AstNode* node = ast_node(parser->ast, index);
+    node->offset = token.offset;
+    node->length = token.length;
+    node->symbol = symbol;
+    return index;
+}
+
+static void set_child(Parser* parser, AstIndex parent, int slot, AstIndex child) {
+    ast_node(parser->ast, parent)->child[slot] = child;
+}
+
+static void list_append(Parser* parser, AstIndex* first, AstIndex* last, AstIndex item) {
+    if (item == AST_NULL) return;
+    if (*last != AST_NULL) {
+        ast_node(parser->ast, *last)->next = item;
+    } else {
+        *first = item;
+    }
+    *last = item;
+}
+
+/* --- Expressões --- */
+
+static AstIndex parse_expression(Parser* parser);
+static AstIndex parse_unary(Parser* parser);
+
+static AstIndex make_binary(Parser* parser, Token op, AstIndex left, AstIndex right) {
+    AstIndex index = add_node(parser, AST_BINARIO, op.line);
+    AstNode* node = ast_node(parser->ast, index);
+    node->op = (uint8_t)op.type;
+    node->child[0] = left;
+    node->child[1] = right;
+    return index;
+}
+
+/* expressao { "," expressao } até `closing` (que não é consumido). */
+static AstIndex parse_list(Parser* parser) {
+    AstIndex first = AST_NULL;
+    AstIndex last = AST_NULL;
+    do {
+        list_append(parser, &first, &last, parse_expression(parser));
+    } while (!parser->failed && match(parser, TOKEN_VIRGULA));
+    return first;
+}
+
+static AstIndex parse_call(Parser* parser) {
+    AstIndex call = add_named(parser, AST_CHAMADA, parser->current);
+    advance(parser);
+    expect(parser, TOKEN_LPAREN, "'(' após o nome da função");
+    if (!parser->failed && !check(parser, TOKEN_RPAREN)) {
+        AstIndex args = parse_list(parser);
+        set_child(parser, call, 0, args);
+    }
+    expect(parser, TOKEN_RPAREN, "')'");
+    return call;
+}
+
+static AstIndex parse_primary(Parser* parser) {
+    if (parser->failed) return AST_NULL;
+    Token token = parser->current;
+    switch (token.type) {
+        case TOKEN_ID_VAR: {
+            advance(parser);
+            return add_named(parser, AST_VARIAVEL, token);
+        }
+        case TOKEN_LITERAL_INT:
+        case TOKEN_LITERAL_DEC:
+        case TOKEN_LITERAL_TEXTO: {
+            advance(parser);
+            AstIndex literal = add_named(parser, AST_LITERAL, token);
+            ast_node(parser->ast, literal)->op = (uint8_t)token.type;
+            return literal;
+        }
+        case TOKEN_ID_FUNC:
+            return parse_call(parser);
+        case TOKEN_LPAREN:
+        case TOKEN_LBRACKET: {
+            /* "[ ]" também delimita prioridades (item 3.1.2 da especificação). */
+            TokenType closing = token.type == TOKEN_LPAREN ? TOKEN_RPAREN : TOKEN_RBRACKET;
+            advance(parser);
+            AstIndex inner = parse_expression(parser);
+            expect(parser, closing, closing == TOKEN_RPAREN ? "')'" : "']'");
+            return inner;
+        }
+        default:
+            expected(parser, "expressão");
+            return AST_NULL;
+    }
+}
+
+static AstIndex make_increment(Parser* parser, Token op, AstIndex operand, int prefix) {
+    if (parser->failed) return AST_NULL;
+    if (ast_node(parser->ast, operand)->kind != AST_VARIAVEL) {
+        fail(parser, op.line, "Erro sintático: '%s' deve ser aplicado a uma variável",
+             op.type == TOKEN_OP_INC ? "++" : "--");
+        return AST_NULL;
+    }
+    AstIndex index = add_node(parser, AST_INCREMENTO, op.line);
+    AstNode* node = ast_node(parser->ast, index);
+    node->op = (uint8_t)op.type;
+    node->flags = prefix ? AST_PREFIXO : 0;
+    node->child[0] = operand;
+    return index;
+}
+
+static AstIndex parse_postfix(Parser* parser) {
+    AstIndex operand = parse_primary(parser);
+    if (!parser->failed && (check(parser, TOKEN_OP_INC) || check(parser, TOKEN_OP_DEC))) {
+        Token op = parser->current;
+        advance(parser);
+        return make_increment(parser, op, operand, 0);
+    }
+    return operand;
+}
+
+static AstIndex parse_power(Parser* parser) {
+    AstIndex base = parse_postfix(parser);
+    if (!parser->failed && check(parser, TOKEN_OP_EXP)) {
+        Token op = parser->current;
+        advance(parser);
+        AstIndex exponent = parse_unary(parser);
+        return make_binary(parser, op, base, exponent);
+    }
+    return base;
+}
+
+static AstIndex parse_unary(Parser* parser) {
+    if (parser->failed) return AST_NULL;
+    Token op = parser->current;
+    if (op.type == TOKEN_OP_SUB) {
+        advance(parser);
+        AstIndex operand = parse_unary(parser);
+        AstIndex index = add_node(parser, AST_UNARIO, op.line);
+        ast_node(parser->ast, index)->op = (uint8_t)op.type;
+        set_child(parser, index, 0, operand);
+        return index;
+    }
+    if (op.type == TOKEN_OP_INC || op.type == TOKEN_OP_DEC) {
+        advance(parser);
+        AstIndex operand = parse_postfix(parser);
+        return make_increment(parser, op, operand, 1);
+    }
+    return parse_power(parser);
+}
+
+static AstIndex parse_multiplicative(Parser* parser) {
+    AstIndex left = parse_unary(parser);
+    while (!parser->failed && (check(parser, TOKEN_OP_MULT) || check(parser, TOKEN_OP_DIV))) {
+        Token op = parser->current;
+        advance(parser);
+        AstIndex right = parse_unary(parser);
+        left = make_binary(parser, op, left, right);
+    }
+    return left;
+}
+
+static AstIndex parse_additive(Parser* parser) {
+    AstIndex left = parse_multiplicative(parser);
+    while (!parser->failed && (check(parser, TOKEN_OP_SOMA) || check(parser, TOKEN_OP_SUB))) {
+        Token op = parser->current;
+        advance(parser);
+        AstIndex right = parse_multiplicative(parser);
+        left = make_binary(parser, op, left, right);
+    }
+    return left;
+}
+
+static int is_relational(TokenType type) {
+    switch (type) {
+        case TOKEN_OP_IGUAL: case TOKEN_OP_DIF:
+        case TOKEN_OP_MENOR: case TOKEN_OP_MENOR_IGUAL:
+        case TOKEN_OP_MAIOR: case TOKEN_OP_MAIOR_IGUAL:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static AstIndex parse_relational(Parser* parser) {
+    AstIndex left = parse_additive(parser);
+    while (!parser->failed && is_relational(parser->current.type)) {
+        Token op = parser->current;
+        advance(parser);
+        AstIndex right = parse_additive(parser);
+        left = make_binary(parser, op, left, right);
+    }
+    return left;
+}
+
+static AstIndex parse_and(Parser* parser) {
+    AstIndex left = parse_relational(parser);
+    while (!parser->failed && check(parser, TOKEN_OP_E)) {
+        Token op = parser->current;
+        advance(parser);
+        AstIndex right = parse_relational(parser);
+        left = make_binary(parser, op, left, right);
+    }
+    return left;
+}
+
+static AstIndex parse_or(Parser* parser) {
+    AstIndex left = parse_and(parser);
+    while (!parser->failed && check(parser, TOKEN_OP_OU)) {
+        Token op = parser->current;
+        advance(parser);
+        AstIndex right = parse_and(parser);
+        left = make_binary(parser, op, left, right);
+    }
+    return left;
+}
+
+static AstIndex parse_expression(Parser* parser) {
+    AstIndex left = parse_or(parser);
+    if (parser->failed || !check(parser, TOKEN_OP_ATRIB)) return left;
+
+    Token op = parser->current;
+    if (ast_node(parser->ast, left)->kind != AST_VARIAVEL) {
+        fail(parser, op.line, "Erro sintático: o lado esquerdo da atribuição deve ser uma variável");
+        return AST_NULL;
+    }
+    advance(parser);
+    AstIndex value = parse_expression(parser);
+    AstIndex index = add_node(parser, AST_ATRIBUICAO, op.line);
+    set_child(parser, index, 0, left);
+    set_child(parser, index, 1, value);
+    return index;
+}
+
+/* --- Comandos --- */
+
+static AstIndex parse_statement(Parser* parser);
+
+static AstIndex parse_block(Parser* parser) {
+    AstIndex block = add_node(parser, AST_BLOCO, parser->current.line);
+    if (!expect(parser, TOKEN_LBRACE, "'{'")) return block;
+
+    AstIndex first = AST_NULL;
+    AstIndex last = AST_NULL;
+    while (!parser->failed && !check(parser, TOKEN_RBRACE) && !check(parser, TOKEN_EOF)) {
+        list_append(parser, &first, &last, parse_statement(parser));
+    }
+    set_child(parser, block, 0, first);
+    expect(parser, TOKEN_RBRACE, "'}'");
+    return block;
+}
+
+static AstIndex parse_declaration(Parser* parser) {
+    Token type = parser->current;
+    AstIndex declaration = add_node(parser, AST_DECLARACAO, type.line);
+    ast_node(parser->ast, declaration)->op = (uint8_t)type.type;
+    advance(parser);
+
+    AstIndex first = AST_NULL;
+    AstIndex last = AST_NULL;
+    do {
+        Token name = parser->current;
+        if (!expect(parser, TOKEN_ID_VAR, "nome de variável")) break;
+        AstIndex declarator = add_named(parser, AST_DECLARADOR, name);
+        list_append(parser, &first, &last, declarator);
+
+        if (match(parser, TOKEN_LBRACKET)) {
+            Token size = parser->current;
+            if (size.type != TOKEN_LITERAL_INT && size.type != TOKEN_LITERAL_DEC) {
+                expected(parser, "tamanho da variável");
+                break;
+            }
+            advance(parser);
+            AstIndex literal = add_named(parser, AST_LITERAL, size);
+            ast_node(parser->ast, literal)->op = (uint8_t)size.type;
+            set_child(parser, declarator, 0, literal);
+            expect(parser, TOKEN_RBRACKET, "']'");
+        }
+        if (!parser->failed && match(parser, TOKEN_OP_ATRIB)) {
+            AstIndex value = parse_expression(parser);
+            set_child(parser, declarator, 1, value);
+        }
+    } while (!parser->failed && match(parser, TOKEN_VIRGULA));
+
+    set_child(parser, declaration, 0, first);
+    expect(parser, TOKEN_PONTO_VIRGULA, "';'");
+    return declaration;
+}
+
+static AstIndex parse_if(Parser* parser) {
+    AstIndex node = add_node(parser, AST_SE, parser->current.line);
+    advance(parser);
+    expect(parser, TOKEN_LPAREN, "'(' após 'se'");
+    AstIndex condition = parse_expression(parser);
+    expect(parser, TOKEN_RPAREN, "')'");
+    AstIndex then_branch = parse_statement(parser);
+    set_child(parser, node, 0, condition);
+    set_child(parser, node, 1, then_branch);
+    if (!parser->failed && match(parser, TOKEN_SENAO)) {
+        AstIndex else_branch = parse_statement(parser);
+        set_child(parser, node, 2, else_branch);
+    }
+    return node;
+}
+
+static AstIndex parse_for(Parser* parser) {
+    AstIndex node = add_node(parser, AST_PARA, parser->current.line);
+    advance(parser);
+    expect(parser, TOKEN_LPAREN, "'(' após 'para'");
+    AstIndex parts[3] = { AST_NULL, AST_NULL, AST_NULL };
+    if (!parser->failed && !check(parser, TOKEN_PONTO_VIRGULA)) {
+        parts[0] = parse_list(parser);
+    }
+    expect(parser, TOKEN_PONTO_VIRGULA, "';'");
+    if (!parser->failed && !check(parser, TOKEN_PONTO_VIRGULA)) {
+        parts[1] = parse_expression(parser);
+    }
+    expect(parser, TOKEN_PONTO_VIRGULA, "';'");
+    if (!parser->failed && !check(parser, TOKEN_RPAREN)) {
+        parts[2] = parse_list(parser);
+    }
+    expect(parser, TOKEN_RPAREN, "')'");
+    AstIndex body = parse_statement(parser);
+    for (int i = 0; i < 3; i++) {
+        set_child(parser, node, i, parts[i]);
+    }
+    set_child(parser, node, 3, body);
+    return node;
+}
+
+static AstIndex parse_read(Parser* parser) {
+    AstIndex node = add_node(parser, AST_LEIA, parser->current.line);
+    advance(parser);
+    expect(parser, TOKEN_LPAREN, "'(' após 'leia'");
+    AstIndex first = AST_NULL;
+    AstIndex last = AST_NULL;
+    do {
+        Token name = parser->current;
+        if (!expect(parser, TOKEN_ID_VAR, "nome de variável")) break;
+        list_append(parser, &first, &last, add_named(parser, AST_VARIAVEL, name));
+    } while (!parser->failed && match(parser, TOKEN_VIRGULA));
+    set_child(parser, node, 0, first);
+    expect(parser, TOKEN_RPAREN, "')'");
+    expect(parser, TOKEN_PONTO_VIRGULA, "';'");
+    return node;
+}
+
+/* escreva, retorno e comandos de expressão: palavra, expressões e ";". */
+static AstIndex parse_simple(Parser* parser, AstKind kind) {
+    AstIndex node = add_node(parser, kind, parser->current.line);
+    AstIndex value;
+    if (kind == AST_ESCREVA) {
+        advance(parser);
+        expect(parser, TOKEN_LPAREN, "'(' após 'escreva'");
+        value = parser->failed ? AST_NULL : parse_list(parser);
+        expect(parser, TOKEN_RPAREN, "')'");
+    } else {
+        if (kind == AST_RETORNO) advance(parser);
+        value = parse_expression(parser);
+    }
+    set_child(parser, node, 0, value);
+    expect(parser, TOKEN_PONTO_VIRGULA, "';'");
+    return node;
+}
+
+static AstIndex parse_statement(Parser* parser) {
+    if (parser->failed) return AST_NULL;
+    switch (parser->current.type) {
+        case TOKEN_LBRACE: return parse_block(parser);
+        case TOKEN_INTEIRO:
+        case TOKEN_TEXTO:
+        case TOKEN_DECIMAL: return parse_declaration(parser);
+        case TOKEN_SE: return parse_if(parser);
+        case TOKEN_PARA: return parse_for(parser);
+        case TOKEN_LEIA: return parse_read(parser);
+        case TOKEN_ESCREVA: return parse_simple(parser, AST_ESCREVA);
+        case TOKEN_RETORNO: return parse_simple(parser, AST_RETORNO);
+        default: return parse_simple(parser, AST_EXPRESSAO);
+    }
+}
+
+/* --- Funções e Programa --- */
+
+static AstIndex parse_function(Parser* parser) {
+    int line = parser->current.line;
+    advance(parser);
+    Token name = parser->current;
+    if (!expect(parser, TOKEN_ID_FUNC, "nome de função após 'funcao'")) return AST_NULL;
+    AstIndex function = add_named(parser, AST_FUNCAO, name);
+    ast_node(parser->ast, function)->line = line;
+
+    expect(parser, TOKEN_LPAREN, "'('");
+    AstIndex first = AST_NULL;
+    AstIndex last = AST_NULL;
+    if (!parser->failed && !check(parser, TOKEN_RPAREN)) {
+        do {
+            Token type = parser->current;
+            if (!is_type(type.type)) {
+                expected(parser, "tipo do parâmetro");
+                break;
+            }
+            advance(parser);
+            Token param = parser->current;
+            if (!expect(parser, TOKEN_ID_VAR, "nome do parâmetro")) break;
+            AstIndex node = add_named(parser, AST_PARAMETRO, param);
+            ast_node(parser->ast, node)->op = (uint8_t)type.type;
+            list_append(parser, &first, &last, node);
+        } while (!parser->failed && match(parser, TOKEN_VIRGULA));
+    }
+    expect(parser, TOKEN_RPAREN, "')'");
+    set_child(parser, function, 0, first);
+    if (!parser->failed) {
+        AstIndex body = parse_block(parser);
+        set_child(parser, function, 1, body);
+    }
+    return function;
+}
+
+static AstIndex parse_principal(Parser* parser) {
+    AstIndex principal = add_node(parser, AST_PRINCIPAL, parser->current.line);
+    advance(parser);
+    expect(parser, TOKEN_LPAREN, "'(' após 'principal'");
+    expect(parser, TOKEN_RPAREN, "')' (principal não tem parâmetros)");
+    if (!parser->failed) {
+        AstIndex body = parse_block(parser);
+        set_child(parser, principal, 1, body);
+    }
+    return principal;
+}
+
+static void parser_start(Parser* parser, LexerContext* lexer, Ast* ast) {
+    parser->lexer = lexer;
+    parser->ast = ast;
+    parser->failed = 0;
+    parser->error_line = 0;
+    parser->error_msg[0] = '\0';
+}
+
+/* Itens do programa que começam antes de end, encadeados em
+ * program->child[0]. Retorna a linha do último principal, ou 0. */
+static int parse_items(Parser* parser, AstIndex program, int end) {
+    AstIndex first = AST_NULL;
+    AstIndex last = AST_NULL;
+    int principal_line = 0;
+    while (!parser->failed && !check(parser, TOKEN_EOF) && parser->current.offset < end) {
+        AstIndex item = AST_NULL;
+        switch (parser->current.type) {
+            case TOKEN_FUNCAO:
+                item = parse_function(parser);
+                break;
+            case TOKEN_PRINCIPAL:
+                if (principal_line != 0) {
+                    fail(parser, parser->current.line,
+                         "Erro sintático: módulo principal duplicado (já declarado na linha %d)",
+                         principal_line);
+                    break;
+                }
+                principal_line = parser->current.line;
+                item = parse_principal(parser);
+                break;
+            case TOKEN_INTEIRO:
+            case TOKEN_TEXTO:
+            case TOKEN_DECIMAL:
+                item = parse_declaration(parser);
+                break;
+            default:
+                expected(parser, "'funcao', 'principal' ou declaração");
+                break;
+        }
+        list_append(parser, &first, &last, item);
+    }
+    set_child(parser, program, 0, first);
+    return principal_line;
+}
+
+int parse_program(Parser* parser, LexerContext* lexer, Ast* ast) {
+    parser_start(parser, lexer, ast);
+    AstIndex program = add_node(parser, AST_PROGRAMA, 1);
+    ast->root = program;
+    advance(parser);
+
+    int principal_line = parse_items(parser, program, INT_MAX);
+    if (!parser->failed && principal_line == 0) {
+        fail(parser, parser->current.line, "Módulo Principal Inexistente");
+    }
+    return !parser->failed;
+}
+
+int parse_fragment(Parser* parser, LexerContext* lexer, Ast* ast, int end) {
+    parser_start(parser, lexer, ast);
+    AstIndex program = add_node(parser, AST_PROGRAMA, lexer->line);
+    ast->root = program;
+    advance(parser);
+    parse_items(parser, program, end);
+    return !parser->failed;
+}
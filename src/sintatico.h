@@ -0,0 +1,33 @@
+#ifndef SINTATICO_H
+#define SINTATICO_H
+
+#include "lexico.h"
+#include "ast.h"
+
+/* --- Analisador Sintático --- */
+
+#define PARSER_ERROR_MSG_SIZE 256
+
+/* Descendente recursivo com um token de antecipação, puxado de
+ * get_next_token. A análise para no primeiro erro, léxico ou sintático. */
+typedef struct {
+    LexerContext* lexer;
+    Ast* ast;
+    Token current;
+    Token previous;
+    int failed;
+    int error_line;
+    char error_msg[PARSER_ERROR_MSG_SIZE];
+} Parser;
+
+/* Analisa o programa inteiro e constrói a árvore em ast (ast->root).
+ * Retorna 1 em caso de sucesso; em caso de erro retorna 0 e deixa a linha
+ * e a mensagem em parser->error_line e parser->error_msg. */
+int parse_program(Parser* parser, LexerContext* lexer, Ast* ast);
+
+/* Analisa só os itens (funções, principal e declarações globais) que
+ * começam antes do deslocamento end, a partir da posição do lexer. Não
+ * exige principal: serve para analisar um trecho do programa. */
+int parse_fragment(Parser* parser, LexerContext* lexer, Ast* ast, int end);
+
+#endif
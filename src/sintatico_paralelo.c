@@ -0,0 +1,168 @@
+#include <string.h>
+#include <limits.h>
+#include "memoria.h"
+#include "sintatico_paralelo.h"
+
+/* Nos programas, quase todo o código está dentro de funções, e cada item
+ * do nível de fora (função, principal ou declaração global) termina num
+ * '}' que volta à profundidade 0 ou num ';' na profundidade 0. Como a
+ * linguagem não tem comentários nem escapes, basta contar chaves e aspas
+ * para achar esses pontos sem passar pelo lexer. Os trechos começam logo
+ * depois de um deles, com o lexer posicionado por lexer_init_at; cada
+ * trecho analisa os itens que começam dentro dele. */
+
+typedef struct ParallelParse ParallelParse;
+
+typedef struct {
+    ParallelParse* job;
+    int start;
+    int end;            /* itens que começam em [start, end) */
+    int first_line;
+    Interner interner;
+    Ast ast;
+    int ok;
+    int principals;
+} ParseChunk;
+
+struct ParallelParse {
+    const char* content;
+    Arena* worker_arenas;
+};
+
+/* --- Pré-passada: Cortes entre Itens --- */
+
+/* Cortes no primeiro fim de item depois de cada target bytes. Retorna o
+ * número de trechos, ou 0 se as chaves ou as aspas não fecharem; *lines
+ * recebe o número de linhas do conteúdo. */
+static int split_items(const char* content, int length, int target, ParseChunk* chunks,
+                       int* lines) {
+    int count = 0;
+    int depth = 0;
+    int in_string = 0;
+    int line = 1;
+    int start = 0;
+    int start_line = 1;
+    for (int i = 0; i < length; i++) {
+        char c = content[i];
+        int item_end = 0;
+        if (c == '\n') {
+            line++;
+        } else if (c == '"') {
+            in_string = !in_string;
+        } else if (in_string) {
+            continue;
+        } else if (c == '{') {
+            depth++;
+        } else if (c == '}') {
+            if (--depth < 0) return 0;
+            item_end = depth == 0;
+        } else if (c == ';') {
+            item_end = depth == 0;
+        }
+        if (item_end && i + 1 - start >= target) {
+            chunks[count].start = start;
+            chunks[count].end = i + 1;
+            chunks[count].first_line = start_line;
+            count++;
+            start = i + 1;
+            start_line = line;
+        }
+    }
+    if (depth != 0 || in_string) return 0;
+
+    /* O último trecho vai até o TOKEN_EOF. */
+    chunks[count].start = start;
+    chunks[count].end = INT_MAX;
+    chunks[count].first_line = start_line;
+    *lines = line;
+    return count + 1;
+}
+
+/* --- Análise de Cada Trecho --- */
+
+static void parse_chunk(void* arg) {
+    ParseChunk* chunk = (ParseChunk*)arg;
+    Arena* arena = &chunk->job->worker_arenas[pool_worker_index()];
+    LexerContext lexer;
+    lexer_init_at(&lexer, chunk->job->content, chunk->start, chunk->first_line, arena);
+    interner_init(&chunk->interner, arena);
+    ast_init(&chunk->ast, chunk->job->content, &chunk->interner, arena, arena);
+
+    Parser parser;
+    chunk->ok = parse_fragment(&parser, &lexer, &chunk->ast, chunk->end);
+    chunk->principals = 0;
+    for (AstIndex item = ast_node(&chunk->ast, chunk->ast.root)->child[0]; item != AST_NULL;
+         item = ast_node(&chunk->ast, item)->next) {
+        chunk->principals += ast_node(&chunk->ast, item)->kind == AST_PRINCIPAL;
+    }
+}
+
+/* --- Junção --- */
+
+int parse_program_parallel(ThreadPool* pool, Parser* parser, LexerContext* lexer, Ast* ast,
+                           long length, Arena* worker_arenas) {
+    ParallelParse job = { lexer->content, worker_arenas };
+    int target = (int)(length / (4 * pool_size(pool)));
+    if (target < PARSE_CHUNK_MIN) target = PARSE_CHUNK_MIN;
+
+    int capacity = (int)(length / target) + 1;
+    ParseChunk* chunks = (ParseChunk*)arena_alloc(lexer->arena, capacity * sizeof(ParseChunk));
+    int lines = 1;
+    int count = split_items(job.content, (int)length, target, chunks, &lines);
+    if (count <= 1) {
+        return parse_program(parser, lexer, ast);
+    }
+
+    for (int c = 0; c < count; c++) {
+        chunks[c].job = &job;
+        pool_submit(pool, parse_chunk, &chunks[c]);
+    }
+    pool_wait(pool);
+
+    /* Erros e principal ausente ou duplicado: a análise serial dá a
+     * mensagem, a linha e o ponto de parada exatos. */
+    int principals = 0;
+    uint32_t names_capacity = 0;
+    uint32_t nodes = 2;
+    for (int c = 0; c < count; c++) {
+        if (!chunks[c].ok) return parse_program(parser, lexer, ast);
+        principals += chunks[c].principals;
+        nodes += chunks[c].ast.count - 2;
+        if (chunks[c].interner.count > names_capacity) names_capacity = chunks[c].interner.count;
+    }
+    if (principals != 1) {
+        return parse_program(parser, lexer, ast);
+    }
+
+    parser->lexer = lexer;
+    parser->ast = ast;
+    parser->failed = 0;
+    parser->error_line = 0;
+    parser->error_msg[0] = '\0';
+    parser->current.type = TOKEN_EOF;
+    parser->current.offset = (int)length;
+    parser->current.length = 0;
+    parser->current.line = lines;
+
+    /* O vetor de nós cresce uma vez só, antes dos nomes. */
+    ast_reserve(ast, nodes);
+    AstIndex program = ast_add(ast, AST_PROGRAMA, 1);
+    ast->root = program;
+    SymbolId* names = (SymbolId*)arena_alloc(lexer->arena, names_capacity * sizeof(SymbolId));
+    AstIndex last = AST_NULL;
+    for (int c = 0; c < count; c++) {
+        memset(names, 0, chunks[c].interner.count * sizeof(SymbolId));
+        AstIndex first = ast_append_fragment(ast, &chunks[c].ast, names);
+        if (first == AST_NULL) continue;
+        if (last != AST_NULL) {
+            ast_node(ast, last)->next = first;
+        } else {
+            ast_node(ast, program)->child[0] = first;
+        }
+        last = first;
+        while (ast_node(ast, last)->next != AST_NULL) {
+            last = ast_node(ast, last)->next;
+        }
+    }
+    return 1;
+}
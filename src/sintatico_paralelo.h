@@ -0,0 +1,27 @@
+#ifndef SINTATICO_PARALELO_H
+#define SINTATICO_PARALELO_H
+
+#include "sintatico.h"
+#include "paralelo.h"
+
+/* --- Análise Sintática Paralela de um Programa --- */
+
+/* Tamanho mínimo de um trecho: trechos menores custam mais para criar e
+ * juntar do que para analisar. */
+#ifndef PARSE_CHUNK_MIN
+#define PARSE_CHUNK_MIN (4 * 1024)
+#endif
+
+/* Como parse_program, com o programa cortado em trechos de itens inteiros
+ * (funções, principal e declarações globais), analisados em paralelo no
+ * pool. Cada trecho tem sua árvore e seu interner, em
+ * worker_arenas[pool_worker_index()]; depois, os trechos são copiados para
+ * ast na ordem do código, e a árvore e os ids dos nomes são os mesmos da
+ * análise serial. lexer está no início de content[0..length). Se algum
+ * trecho falhar, ou se a pré-passada não achar os cortes (chaves ou aspas
+ * sem par), o programa é analisado de novo em série com lexer, para que o
+ * erro seja o mesmo do modo serial. */
+int parse_program_parallel(ThreadPool* pool, Parser* parser, LexerContext* lexer, Ast* ast,
+                           long length, Arena* worker_arenas);
+
+#endif
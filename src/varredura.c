@@ -0,0 +1,211 @@
+#include <stdlib.h>
+#include <string.h>
+#include "varredura.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VARREDURA_X86 1
+#include <immintrin.h>
+#endif
+
+/* --- Implementação Escalar --- */
+
+static int is_blank(unsigned char c) {
+    return c == ' ' || c == '\\' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+static int is_alnum_ascii(unsigned char c) {
+    return (unsigned char)(c - '0') <= 9 || (unsigned char)((c | 0x20) - 'a') <= 25;
+}
+
+static int scalar_skip_whitespace(const char* src, int pos, int* lines) {
+    while (is_blank((unsigned char)src[pos])) {
+        *lines += (src[pos] == '\n');
+        pos++;
+    }
+    return pos;
+}
+
+static int scalar_skip_alnum(const char* src, int pos) {
+    while (is_alnum_ascii((unsigned char)src[pos])) pos++;
+    return pos;
+}
+
+static int scalar_skip_digits(const char* src, int pos) {
+    while ((unsigned char)(src[pos] - '0') <= 9) pos++;
+    return pos;
+}
+
+static int scalar_skip_string(const char* src, int pos, int* lines) {
+    while (src[pos] != '"' && src[pos] != '\0') {
+        *lines += (src[pos] == '\n');
+        pos++;
+    }
+    return pos;
+}
+
+static const ScanKernels scalar_kernels = {
+    "escalar",
+    scalar_skip_whitespace, scalar_skip_alnum, scalar_skip_digits, scalar_skip_string
+};
+
+const ScanKernels* scan_kernels = &scalar_kernels;
+
+#ifdef VARREDURA_X86
+
+/* Os núcleos vetoriais leem blocos alinhados: um bloco alinhado nunca
+ * cruza uma página, então ler além do '\0' final é seguro. Os bytes
+ * anteriores a pos no primeiro bloco são descartados pela máscara. */
+#define NO_ASAN __attribute__((no_sanitize_address))
+
+/* --- SSE2 --- */
+
+/* Bytes de v em [lo, lo + span] (comparação sem sinal). */
+static inline __m128i sse2_in_range(__m128i v, char lo, char span) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(span)), shifted);
+}
+
+static inline __m128i sse2_blank(__m128i v) {
+    return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                        sse2_in_range(v, '\t', '\r' - '\t'));
+}
+
+static inline __m128i sse2_digit(__m128i v) {
+    return sse2_in_range(v, '0', 9);
+}
+
+static inline __m128i sse2_alnum(__m128i v) {
+    return _mm_or_si128(sse2_digit(v), sse2_in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 25));
+}
+
+/* Avança enquanto os bytes pertencem à classe; conta '\n' se lines != NULL. */
+#define SSE2_SKIP(name, member, count_lines)                                        \
+    NO_ASAN static int name(const char* src, int pos, int* lines) {                 \
+        const char* base = (const char*)((size_t)(src + pos) & ~(size_t)15);        \
+        unsigned skip = (unsigned)((src + pos) - base);                             \
+        unsigned valid = (0xFFFFu << skip) & 0xFFFFu;                              \
+        for (;;) {                                                                  \
+            __m128i v = _mm_load_si128((const __m128i*)base);                      \
+            unsigned stop = ~(unsigned)_mm_movemask_epi8(member(v)) & valid;        \
+            if (count_lines) {                                                      \
+                unsigned nl = (unsigned)_mm_movemask_epi8(                          \
+                    _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))) & valid;                \
+                if (stop) nl &= (stop & -stop) - 1;                                 \
+                *lines += __builtin_popcount(nl);                                   \
+            }                                                                       \
+            if (stop) return (int)(base - src) + __builtin_ctz(stop);               \
+            base += 16;                                                             \
+            valid = 0xFFFFu;                                                        \
+        }                                                                           \
+    }
+
+/* Para texto, a classe é "nem aspas nem fim". */
+static inline __m128i sse2_string_body(__m128i v) {
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    return _mm_xor_si128(stop, _mm_set1_epi8((char)0xFF));
+}
+
+SSE2_SKIP(sse2_skip_blank_impl, sse2_blank, 1)
+SSE2_SKIP(sse2_skip_alnum_impl, sse2_alnum, 0)
+SSE2_SKIP(sse2_skip_digits_impl, sse2_digit, 0)
+SSE2_SKIP(sse2_skip_string_impl, sse2_string_body, 1)
+
+static int sse2_skip_alnum(const char* src, int pos) {
+    return sse2_skip_alnum_impl(src, pos, NULL);
+}
+
+static int sse2_skip_digits(const char* src, int pos) {
+    return sse2_skip_digits_impl(src, pos, NULL);
+}
+
+static const ScanKernels sse2_kernels = {
+    "sse2",
+    sse2_skip_blank_impl, sse2_skip_alnum, sse2_skip_digits, sse2_skip_string_impl
+};
+
+/* --- AVX2 --- */
+
+#define AVX2 __attribute__((target("avx2")))
+
+static inline AVX2 __m256i avx2_in_range(__m256i v, char lo, char span) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(span)), shifted);
+}
+
+static inline AVX2 __m256i avx2_blank(__m256i v) {
+    return _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                           _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+                           avx2_in_range(v, '\t', '\r' - '\t'));
+}
+
+static inline AVX2 __m256i avx2_digit(__m256i v) {
+    return avx2_in_range(v, '0', 9);
+}
+
+static inline AVX2 __m256i avx2_alnum(__m256i v) {
+    return _mm256_or_si256(avx2_digit(v),
+                           avx2_in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 25));
+}
+
+static inline AVX2 __m256i avx2_string_body(__m256i v) {
+    __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                                   _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    return _mm256_xor_si256(stop, _mm256_set1_epi8((char)0xFF));
+}
+
+#define AVX2_SKIP(name, member, count_lines)                                        \
+    NO_ASAN AVX2 static int name(const char* src, int pos, int* lines) {            \
+        const char* base = (const char*)((size_t)(src + pos) & ~(size_t)31);        \
+        unsigned skip = (unsigned)((src + pos) - base);                             \
+        unsigned valid = 0xFFFFFFFFu << skip;                                       \
+        for (;;) {                                                                  \
+            __m256i v = _mm256_load_si256((const __m256i*)base);                   \
+            unsigned stop = ~(unsigned)_mm256_movemask_epi8(member(v)) & valid;     \
+            if (count_lines) {                                                      \
+                unsigned nl = (unsigned)_mm256_movemask_epi8(                       \
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))) & valid;          \
+                if (stop) nl &= (stop & -stop) - 1;                                 \
+                *lines += __builtin_popcount(nl);                                   \
+            }                                                                       \
+            if (stop) return (int)(base - src) + __builtin_ctz(stop);               \
+            base += 32;                                                             \
+            valid = 0xFFFFFFFFu;                                                    \
+        }                                                                           \
+    }
+
+AVX2_SKIP(avx2_skip_blank_impl, avx2_blank, 1)
+AVX2_SKIP(avx2_skip_alnum_impl, avx2_alnum, 0)
+AVX2_SKIP(avx2_skip_digits_impl, avx2_digit, 0)
+AVX2_SKIP(avx2_skip_string_impl, avx2_string_body, 1)
+
+static int avx2_skip_alnum(const char* src, int pos) {
+    return avx2_skip_alnum_impl(src, pos, NULL);
+}
+
+static int avx2_skip_digits(const char* src, int pos) {
+    return avx2_skip_digits_impl(src, pos, NULL);
+}
+
+static const ScanKernels avx2_kernels = {
+    "avx2",
+    avx2_skip_blank_impl, avx2_skip_alnum, avx2_skip_digits, avx2_skip_string_impl
+};
+
+#endif /* VARREDURA_X86 */
+
+void scan_init(void) {
+    const char* forced = getenv("COMPILADOR_SIMD");
+
+    scan_kernels = &scalar_kernels;
+    if (forced != NULL && strcmp(forced, "escalar") == 0) return;
+#ifdef VARREDURA_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && (forced == NULL || strcmp(forced, "avx2") == 0)) {
+        scan_kernels = &avx2_kernels;
+    } else if (__builtin_cpu_supports("sse2")) {
+        scan_kernels = &sse2_kernels;
+    }
+#endif
+}
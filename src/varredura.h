@@ -0,0 +1,29 @@
+#ifndef VARREDURA_H
+#define VARREDURA_H
+
+/* --- Varredura Vetorizada --- */
+
+/* Núcleos que avançam sobre sequências longas de um mesmo tipo de
+ * caractere. Todos param no '\0' final do buffer e recebem/retornam
+ * posições absolutas em src. */
+typedef struct {
+    const char* name;
+    /* Espaços em branco e '\\'; soma em *lines as quebras de linha puladas. */
+    int (*skip_whitespace)(const char* src, int pos, int* lines);
+    /* [A-Za-z0-9]* */
+    int (*skip_alnum)(const char* src, int pos);
+    /* [0-9]* */
+    int (*skip_digits)(const char* src, int pos);
+    /* Até a próxima '"' ou '\0'; soma em *lines as quebras de linha. */
+    int (*skip_string)(const char* src, int pos, int* lines);
+} ScanKernels;
+
+/* Núcleos em uso; escalares até que scan_init seja chamada. */
+extern const ScanKernels* scan_kernels;
+
+/* Escolhe a melhor implementação suportada pela CPU (AVX2, SSE2 ou
+ * escalar). A variável de ambiente COMPILADOR_SIMD=escalar|sse2|avx2
+ * força uma implementação específica. */
+void scan_init(void);
+
+#endif